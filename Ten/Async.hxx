@@ -0,0 +1,299 @@
+/// \file Ten/Async.hxx
+
+#ifndef TENSEUR_ASYNC_HXX
+#define TENSEUR_ASYNC_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <Ten/Expr.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten {
+
+namespace details {
+// Evaluation of a node of a task graph
+struct AsyncTask {
+   std::function<void()> run;
+   // Tasks reading the output of the task
+   std::vector<size_type> dependents;
+   // Number of tasks whose output is read by the task
+   size_type numInputs = 0;
+};
+
+// Collect the nodes of an expression evaluated by their own call to eval()
+// Elementwise nodes read by an elementwise node are fused with it and aren't
+// tasks, shared nodes are a single task. The tasks are ordered so that the
+// inputs of a task come before it, the last one being the root.
+class TaskGraphBuilder {
+ private:
+   std::vector<AsyncTask> _tasks;
+   std::unordered_map<const void *, size_type> _visited;
+
+   // Whether the node is evaluated in a single pass with its elementwise
+   // inputs
+   template <class Node> static constexpr bool isFused() {
+      return details::isElementwiseNode<Node>::value &&
+             !::ten::isScalarNode<typename Node::output_node_type>::value;
+   }
+
+   // Add the tasks the input of a node depends on to inputs
+   template <bool fused, class Node>
+   void collect(const std::shared_ptr<Node> &node,
+                std::vector<size_type> &inputs) {
+      if constexpr (::ten::isUnaryNode<Node>::value ||
+                    ::ten::isBinaryNode<Node>::value) {
+         if (node.get()->evaluated()) {
+            return;
+         }
+         if constexpr (fused && details::isElementwiseNode<Node>::value) {
+            collectInputs<true>(node, inputs);
+         } else {
+            inputs.push_back(add(node));
+         }
+      }
+   }
+
+   template <bool fused, class Node>
+   void collectInputs(const std::shared_ptr<Node> &node,
+                      std::vector<size_type> &inputs) {
+      if constexpr (::ten::isUnaryNode<Node>::value) {
+         collect<fused>(node.get()->input(), inputs);
+      } else {
+         collect<fused>(node.get()->left(), inputs);
+         collect<fused>(node.get()->right(), inputs);
+      }
+   }
+
+ public:
+   /// Add the task of a node after the tasks of its inputs
+   /// Returns the index of the task.
+   template <class Node> size_type add(const std::shared_ptr<Node> &node) {
+      auto it = _visited.find(node.get());
+      if (it != _visited.end()) {
+         return it->second;
+      }
+      std::vector<size_type> inputs;
+      if (!node.get()->evaluated()) {
+         collectInputs<isFused<Node>()>(node, inputs);
+      }
+      std::sort(inputs.begin(), inputs.end());
+      inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+
+      size_type index = _tasks.size();
+      _tasks.push_back(
+          AsyncTask{[node] { node.get()->eval(); }, {}, inputs.size()});
+      for (size_type input : inputs) {
+         _tasks[input].dependents.push_back(index);
+      }
+      _visited[node.get()] = index;
+      return index;
+   }
+
+   /// Returns the tasks of the graph
+   std::vector<AsyncTask> tasks() { return std::move(_tasks); }
+};
+
+// Shared state of an asynchronous evaluation
+// A task is pushed to the thread pool once all its inputs are evaluated. The
+// thread finishing a task continues with one of the tasks it made ready and
+// pushes the others. After an exception the remaining tasks are skipped.
+class AsyncState {
+ private:
+   std::vector<AsyncTask> _tasks;
+   std::unique_ptr<std::atomic<size_type>[]> _pending;
+   std::atomic<bool> _done = false;
+   std::atomic<bool> _failed = false;
+   std::exception_ptr _error = nullptr;
+   std::mutex _mutex;
+
+   static void submit(const std::shared_ptr<AsyncState> &state,
+                      size_type index) {
+      ::ten::parallel::threadPool().submit(
+          [state, index] { run(state, index); });
+   }
+
+   static void run(const std::shared_ptr<AsyncState> &state, size_type index) {
+      AsyncState &s = *state.get();
+      while (true) {
+         if (!s._failed.load(std::memory_order_acquire)) {
+            try {
+               s._tasks[index].run();
+            } catch (...) {
+               std::lock_guard<std::mutex> lock(s._mutex);
+               if (!s._error) {
+                  s._error = std::current_exception();
+               }
+               s._failed.store(true, std::memory_order_release);
+            }
+         }
+         if (index + 1 == s._tasks.size()) {
+            s._done.store(true, std::memory_order_release);
+            return;
+         }
+         size_type next = s._tasks.size();
+         for (size_type dependent : s._tasks[index].dependents) {
+            if (s._pending[dependent].fetch_sub(
+                    1, std::memory_order_acq_rel) == 1) {
+               if (next == s._tasks.size()) {
+                  next = dependent;
+               } else {
+                  submit(state, dependent);
+               }
+            }
+         }
+         if (next == s._tasks.size()) {
+            return;
+         }
+         index = next;
+      }
+   }
+
+ public:
+   explicit AsyncState(std::vector<AsyncTask> &&tasks)
+       : _tasks(std::move(tasks)),
+         _pending(new std::atomic<size_type>[_tasks.size()]) {
+      for (size_type i = 0; i < _tasks.size(); i++) {
+         _pending[i].store(_tasks[i].numInputs, std::memory_order_relaxed);
+      }
+   }
+
+   /// Push the tasks without inputs to the thread pool
+   static void start(const std::shared_ptr<AsyncState> &state) {
+      for (size_type i = 0; i < state.get()->_tasks.size(); i++) {
+         if (state.get()->_tasks[i].numInputs == 0) {
+            submit(state, i);
+         }
+      }
+   }
+
+   /// Returns whether the root task has run
+   [[nodiscard]] bool done() const {
+      return _done.load(std::memory_order_acquire);
+   }
+
+   /// Rethrow the first exception thrown by a task
+   void rethrow() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_error) {
+         std::rethrow_exception(_error);
+      }
+   }
+};
+} // namespace details
+
+/// \class Future
+/// Handle of an expression evaluated asynchronously by evalAsync()
+///
+/// The nodes of the expression are evaluated as tasks of the thread pool,
+/// each one as soon as its inputs are evaluated, so that independent
+/// subexpressions run concurrently. The kernels of a task running on a worker
+/// thread don't split their loops between the threads, so an expression of a
+/// single node to evaluate is evaluated by evalAsync() on the calling thread
+/// instead, with its kernels split between the threads. The expression and
+/// its inputs must not be modified until the evaluation is done.
+template <class E> class Future {
+ public:
+   using expr_type = E;
+   using evaluated_type = typename E::evaluated_type;
+
+ private:
+   E _expr;
+   std::shared_ptr<details::AsyncState> _state = nullptr;
+   /// Exception thrown by an evaluation on the calling thread
+   std::exception_ptr _error = nullptr;
+
+   /// Evaluate the expression on the calling thread
+   void evalNow() {
+      try {
+         _expr.eval();
+      } catch (...) {
+         _error = std::current_exception();
+      }
+   }
+
+ public:
+   explicit Future(const E &expr) : _expr(expr) {
+      if (_expr.evaluated()) {
+         return;
+      }
+      // Without worker threads the tasks would only run in wait()
+      if (::ten::parallel::threadPool().size() == 1) {
+         evalNow();
+         return;
+      }
+      details::TaskGraphBuilder builder;
+      builder.add(_expr.node());
+      auto tasks = builder.tasks();
+      // A single task on a worker thread would run its kernels on one thread
+      if (tasks.size() == 1) {
+         evalNow();
+         return;
+      }
+      _state = std::make_shared<details::AsyncState>(std::move(tasks));
+      details::AsyncState::start(_state);
+   }
+
+   /// Returns whether the evaluation is done
+   [[nodiscard]] bool ready() const { return !_state || _state.get()->done(); }
+
+   /// Wait until the evaluation is done
+   /// The calling thread runs pending tasks of the thread pool meanwhile.
+   void wait() const {
+      if (_state) {
+         ::ten::parallel::threadPool().wait(
+             [this] { return _state.get()->done(); });
+      }
+   }
+
+   /// Wait for the evaluation and returns the value of the expression
+   /// Rethrows the exception thrown by the evaluation of a node.
+   [[nodiscard]] evaluated_type get() {
+      wait();
+      if (_error) {
+         std::rethrow_exception(_error);
+      }
+      if (_state) {
+         _state.get()->rethrow();
+      }
+      return _expr.value();
+   }
+
+   /// Returns the expression
+   [[nodiscard]] const E &expr() const { return _expr; }
+};
+
+/// \fn evalAsync
+/// Evaluate an expression asynchronously on the thread pool
+/// Returns a handle to wait for the value of the expression.
+template <class E>
+   requires ::ten::isUnaryExpr<std::remove_cvref_t<E>>::value ||
+            ::ten::isBinaryExpr<std::remove_cvref_t<E>>::value
+[[nodiscard]] auto evalAsync(E &&expr) {
+   return Future<std::remove_cvref_t<E>>(expr);
+}
+
+template <typename E, template <class...> class Func, typename... Args>
+Future<UnaryExpr<E, Func, Args...>>
+UnaryExpr<E, Func, Args...>::evalAsync() const {
+   return Future<UnaryExpr>(*this);
+}
+
+template <typename L, typename R, template <typename...> class Func,
+          typename... Args>
+Future<BinaryExpr<L, R, Func, Args...>>
+BinaryExpr<L, R, Func, Args...>::evalAsync() const {
+   return Future<BinaryExpr>(*this);
+}
+
+} // namespace ten
+
+#endif
@@ -1,8 +1,17 @@
 #ifndef TENSEUR_CONFIG_HXX
 #define TENSEUR_CONFIG_HXX
 
+#include <cstddef>
+#include <experimental/simd>
 #include <optional>
 #include <ostream>
+#include <type_traits>
+
+// Use the native matrix products when no CBLAS header is available
+#if !defined(TENSEUR_NO_BLAS) && !defined(__APPLE__) &&                        \
+    !defined(TENSEUR_MKL) && !__has_include(<cblas.h>)
+#define TENSEUR_NO_BLAS
+#endif
 
 namespace ten {
 
@@ -34,11 +43,34 @@ enum class SimdBackend { std, unknown };
 #endif
 static SimdBackend simdBackend = TENSEUR_SIMDBACKEND;
 
-// TODO Two simdvecLen default to 8 and 4 for floats, 4 and 2 for doubles
-#ifndef TENSEUR_SIMDVECLEN
-#define TENSEUR_SIMDVECLEN 4
+// Types that can be stored in a simd vector
+template <class T> struct isVectorizable {
+   static constexpr bool value =
+       std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+};
+
+namespace details {
+template <class T> consteval size_t nativeSimdVecLen() {
+   if constexpr (isVectorizable<T>::value) {
+      return std::experimental::native_simd<T>::size();
+   } else {
+      return 1;
+   }
+}
+} // namespace details
+
+// Simd vector length of type T
+// Defaults to the native width of T for the target architecture, for example
+// 16 floats and 8 doubles with AVX-512. TENSEUR_SIMDVECLEN forces the same
+// length for all the types.
+#ifdef TENSEUR_SIMDVECLEN
+template <class T>
+static constexpr size_t simdVecLen =
+    isVectorizable<T>::value ? TENSEUR_SIMDVECLEN : 1;
+#else
+template <class T>
+static constexpr size_t simdVecLen = details::nativeSimdVecLen<T>();
 #endif
-static constexpr size_t simdVecLen = TENSEUR_SIMDVECLEN;
 
 } // namespace ten
 
@@ -0,0 +1,269 @@
+/// \file Ten/Contract.hxx
+
+#ifndef TENSEUR_CONTRACT_HXX
+#define TENSEUR_CONTRACT_HXX
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Ten/Kernels/Contract.hxx>
+#include <Ten/Tensor.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten {
+
+namespace details {
+/// \struct FixedString
+/// String literal used as a template parameter
+template <size_t N> struct FixedString {
+   char value[N]{};
+
+   constexpr FixedString(const char (&s)[N]) { std::copy_n(s, N, value); }
+
+   [[nodiscard]] constexpr size_t size() const { return N - 1; }
+   [[nodiscard]] constexpr char operator[](size_t i) const { return value[i]; }
+};
+
+// Maximum number of operands and of indices of a contraction
+inline constexpr size_type maxContractOperands = 16;
+inline constexpr size_type maxContractIndices = 52;
+
+enum class ContractError {
+   none,
+   syntax,
+   tooManyOperands,
+   repeatedOutputIndex,
+   unknownOutputIndex
+};
+
+// Indices of the operands and of the output of a contraction
+struct ContractIndices {
+   size_type numInputs = 0;
+   std::array<std::array<char, maxContractIndices>, maxContractOperands>
+       inputs{};
+   std::array<size_type, maxContractOperands> ranks{};
+   std::array<char, maxContractIndices> output{};
+   size_type outputRank = 0;
+   ContractError error = ContractError::none;
+
+   constexpr size_type count(char label) const {
+      size_type n = 0;
+      for (size_type i = 0; i < numInputs; i++) {
+         for (size_type d = 0; d < ranks[i]; d++) {
+            n += inputs[i][d] == label;
+         }
+      }
+      return n;
+   }
+};
+
+constexpr bool isIndexLabel(char c) {
+   return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Parse "ij,jk->ik" at compile time
+// Spaces are ignored. Without "->", the output indices are the ones that
+// appear once in the operands, in alphabetical order.
+template <FixedString s> constexpr ContractIndices parseContract() {
+   ContractIndices r;
+   r.numInputs = 1;
+   bool arrow = false;
+   for (size_t i = 0; i < s.size(); i++) {
+      char c = s[i];
+      if (c == ' ') {
+         continue;
+      }
+      if (c == '-' && !arrow && i + 1 < s.size() && s[i + 1] == '>') {
+         arrow = true;
+         i++;
+      } else if (c == ',' && !arrow) {
+         if (r.numInputs == maxContractOperands) {
+            r.error = ContractError::tooManyOperands;
+            return r;
+         }
+         r.numInputs++;
+      } else if (isIndexLabel(c) && arrow) {
+         if (r.outputRank == maxContractIndices) {
+            r.error = ContractError::syntax;
+            return r;
+         }
+         r.output[r.outputRank++] = c;
+      } else if (isIndexLabel(c)) {
+         size_type p = r.numInputs - 1;
+         if (r.ranks[p] == maxContractIndices) {
+            r.error = ContractError::syntax;
+            return r;
+         }
+         r.inputs[p][r.ranks[p]++] = c;
+      } else {
+         r.error = ContractError::syntax;
+         return r;
+      }
+   }
+   if (!arrow) {
+      for (char c = 'A'; c <= 'z'; c++) {
+         if (isIndexLabel(c) && r.count(c) == 1) {
+            r.output[r.outputRank++] = c;
+         }
+      }
+   }
+   for (size_type i = 0; i < r.outputRank; i++) {
+      for (size_type j = 0; j < i; j++) {
+         if (r.output[i] == r.output[j]) {
+            r.error = ContractError::repeatedOutputIndex;
+            return r;
+         }
+      }
+      if (r.count(r.output[i]) == 0) {
+         r.error = ContractError::unknownOutputIndex;
+         return r;
+      }
+   }
+   return r;
+}
+
+// Evaluated operand of a contraction
+template <class E> auto contractOperand(const E &expr) {
+   if constexpr (::ten::isTensor<E>::value) {
+      return expr;
+   } else {
+      E e = expr;
+      return e.eval();
+   }
+}
+
+// Whether the ranks of the operands are the numbers of their indices
+template <ContractIndices indices, class Tuple, size_t... i>
+constexpr bool contractRanksMatch(std::index_sequence<i...>) {
+   return ((std::tuple_element_t<i, Tuple>::shape_type::rank() ==
+            indices.ranks[i]) &&
+           ...);
+}
+
+// Whether the operands have the same value type
+template <class Tuple, size_t... i>
+constexpr bool sameValueType(std::index_sequence<i...>) {
+   using T = typename std::tuple_element_t<0, Tuple>::value_type;
+   return (std::is_same_v<typename std::tuple_element_t<i, Tuple>::value_type,
+                          T> &&
+           ...);
+}
+
+// Labeled operand of a tensor
+template <class T, class X>
+::ten::kernels::ContractOperand<const T *>
+makeContractOperand(const X &x,
+                    const std::array<char, maxContractIndices> &labels) {
+   ::ten::kernels::ContractOperand<const T *> op;
+   op.data = x.data();
+   for (size_type d = 0; d < X::shape_type::rank(); d++) {
+      op.labels.push_back(labels[d]);
+      op.dims.push_back(x.dim(d));
+      op.strides.push_back(x.stride(d));
+   }
+   return op;
+}
+} // namespace details
+
+/// \fn contract
+/// Contraction of tensors written in index notation
+///
+/// contract<"ijk,kl->ijl">(a, b) returns the tensor c of rank 3 such that
+/// c(i, j, l) = sum_k a(i, j, k) * b(k, l). The indices are letters, one per
+/// dimension of each operand, and the indices of the operands that aren't
+/// indices of the result are summed. An index repeated in an operand reads its
+/// diagonal, as in contract<"ii->">(a) for the trace. Without "->" the result
+/// has the indices appearing once, in alphabetical order.
+///
+/// The indices are parsed at compile time. The operands are contracted
+/// pairwise, the cheapest pair first, and each pairwise contraction is mapped
+/// to a batch of matrix products, permuting the operands when they can't be
+/// read as matrices (see kernels::contract). Expressions are evaluated first.
+/// The result is a tensor of the storage order of the first operand, or a
+/// scalar when it has no indices.
+template <details::FixedString indices, class... E>
+   requires(sizeof...(E) > 0 &&
+            ((::ten::isTensor<std::remove_cvref_t<E>>::value ||
+              ::ten::isUnaryExpr<std::remove_cvref_t<E>>::value ||
+              ::ten::isBinaryExpr<std::remove_cvref_t<E>>::value) &&
+             ...))
+[[nodiscard]] auto contract(E &&...exprs) {
+   constexpr details::ContractIndices spec = details::parseContract<indices>();
+   using details::ContractError;
+   static_assert(spec.error != ContractError::syntax,
+                 "Tenseur: Contraction indices must be letters separated by "
+                 "',' with an optional '->' before the result.");
+   static_assert(spec.error != ContractError::tooManyOperands,
+                 "Tenseur: Too many operands in a contraction.");
+   static_assert(spec.error != ContractError::repeatedOutputIndex,
+                 "Tenseur: Repeated index in the result of a contraction.");
+   static_assert(spec.error != ContractError::unknownOutputIndex,
+                 "Tenseur: Index of the result of a contraction missing from "
+                 "the operands.");
+   static_assert(spec.numInputs == sizeof...(E),
+                 "Tenseur: The number of operands doesn't match the indices "
+                 "of the contraction.");
+
+   auto operands = std::make_tuple(
+       details::contractOperand(std::remove_cvref_t<E>(exprs))...);
+   using operands_type = decltype(operands);
+   using first_type = std::tuple_element_t<0, operands_type>;
+   using T = typename first_type::value_type;
+   static_assert(details::contractRanksMatch<spec, operands_type>(
+                     std::index_sequence_for<E...>()),
+                 "Tenseur: The rank of an operand doesn't match its number "
+                 "of indices.");
+   static_assert(details::sameValueType<operands_type>(
+                     std::index_sequence_for<E...>()),
+                 "Tenseur: Contraction of operands of different value types.");
+
+   std::vector<::ten::kernels::ContractOperand<const T *>> labeled;
+   std::apply(
+       [&](const auto &...x) {
+          size_type i = 0;
+          (labeled.push_back(
+               details::makeContractOperand<T>(x, spec.inputs[i++])),
+           ...);
+       },
+       operands);
+
+   constexpr size_type rank = spec.outputRank;
+   // Dimensions of the indices of the result
+   std::array<size_type, rank> dims{};
+   for (size_type d = 0; d < rank; d++) {
+      for (const auto &x : labeled) {
+         size_t i = x.find(spec.output[d]);
+         if (i < x.labels.size()) {
+            dims[d] = x.dims[i];
+         }
+      }
+   }
+
+   ::ten::kernels::ContractOperand<T *> c;
+   c.labels.assign(spec.output.begin(), spec.output.begin() + rank);
+   c.dims.assign(dims.begin(), dims.end());
+   if constexpr (rank == 0) {
+      T value = T(0);
+      c.data = &value;
+      ::ten::kernels::contract<T>(std::move(labeled), c);
+      return Scalar<T>(value);
+   } else {
+      Tensor<T, rank, first_type::storageOrder()> result{
+          DynamicShape<rank>(dims)};
+      c.data = result.data();
+      for (size_type d = 0; d < rank; d++) {
+         c.strides.push_back(result.stride(d));
+      }
+      ::ten::kernels::contract<T>(std::move(labeled), c);
+      return result;
+   }
+}
+
+} // namespace ten
+
+#endif
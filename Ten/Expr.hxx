@@ -3,9 +3,13 @@
 
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <type_traits>
 
+#include <experimental/simd>
+
 #include <Ten/Functional.hxx>
+#include <Ten/Profile.hxx>
 #include <Ten/Types.hxx>
 
 namespace ten {
@@ -101,6 +105,141 @@ struct OutputNodeType<::ten::BinaryNode<L, R, Output, F, Args...>> {
 };
 } // namespace details
 
+namespace details {
+// Elementwise node, can be evaluated in a single loop with its inputs
+template <class> struct isElementwiseNode : std::false_type {};
+
+template <class Input, class Output, template <typename...> class F,
+          class... Args>
+struct isElementwiseNode<::ten::UnaryNode<Input, Output, F, Args...>> {
+   static constexpr bool value = ::ten::functional::IsElementwise<
+       typename ::ten::UnaryNode<Input, Output, F, Args...>::func_type>::value;
+};
+
+template <class L, class R, class Output, template <typename...> class F,
+          class... Args>
+struct isElementwiseNode<::ten::BinaryNode<L, R, Output, F, Args...>> {
+   static constexpr bool value = ::ten::functional::IsElementwise<
+       typename ::ten::BinaryNode<L, R, Output, F, Args...>::func_type>::value;
+};
+
+// Rank of the output of a node, 0 for scalars
+template <class Node> struct NodeRank {
+   static constexpr size_type value = 0;
+};
+template <class Node>
+   requires(!::ten::isScalarNode<typename OutputNodeType<Node>::type>::value)
+struct NodeRank<Node> {
+   static constexpr size_type value = OutputNodeType<Node>::type::rank();
+};
+
+// Storage order of the output of a node, column major for scalars
+template <class Node> struct NodeOrder {
+   static constexpr StorageOrder value = StorageOrder::ColMajor;
+};
+template <class Node>
+   requires(!::ten::isScalarNode<typename OutputNodeType<Node>::type>::value)
+struct NodeOrder<Node> {
+   static constexpr StorageOrder value =
+       OutputNodeType<Node>::type::storageOrder();
+};
+
+// Evaluator of a tree of elementwise nodes
+// Rank is the rank of the output of the tree, the leaves of lower rank or with
+// dimensions equal to 1 are broadcasted to the output shape.
+// Order is the storage order of the output, the elements of the leaves are
+// traversed in this order whatever their own storage order.
+template <class Node, size_type Rank = NodeRank<Node>::value,
+          StorageOrder Order = NodeOrder<Node>::value>
+struct FusedEvaluator;
+
+// Returns whether the output node can store a result of the given shape
+template <class Output, class... S>
+bool isValidOutput(const std::shared_ptr<Output> &output, const S &...shape) {
+   if (!output) {
+      return false;
+   }
+   if constexpr (sizeof...(S) == 0) {
+      return true;
+   } else {
+      return ((output.get()->shape() == shape) && ...);
+   }
+}
+
+// Returns the range of bytes spanned by the elements of a dense tensor node
+template <class Node>
+std::pair<const std::byte *, const std::byte *>
+storageExtent(const Node &node) {
+   const auto *first = reinterpret_cast<const std::byte *>(node.data());
+   if (node.size() == 0) {
+      return {first, first};
+   }
+   size_type last = 0;
+   for (size_type i = 0; i < Node::rank(); i++) {
+      last += (node.dim(i) - 1) * node.stride(i);
+   }
+   return {first, first + (last + 1) * sizeof(typename Node::value_type)};
+}
+
+// Returns whether two tensor nodes share elements
+// Sparse and structured nodes are compared by the address of their elements.
+template <class A, class B> bool overlaps(const A &a, const B &b) {
+   if constexpr (::ten::isDenseStorage<typename A::storage_type>::value &&
+                 ::ten::isDenseStorage<typename B::storage_type>::value) {
+      auto [firstA, lastA] = storageExtent(a);
+      auto [firstB, lastB] = storageExtent(b);
+      return firstA < lastB && firstB < lastA;
+   } else {
+      return static_cast<const void *>(a.data()) ==
+             static_cast<const void *>(b.data());
+   }
+}
+
+// Returns whether the output node shares elements with the input node
+template <class Output, class Input>
+bool isAliased(const std::shared_ptr<Output> &output,
+               const std::shared_ptr<Input> &input) {
+   if constexpr (::ten::isScalarNode<Output>::value ||
+                 ::ten::isScalarNode<
+                     typename OutputNodeType<Input>::type>::value) {
+      return false;
+   } else {
+      return output && overlaps(*output.get(), *NodeWrapper<Input>::ptr(input));
+   }
+}
+
+// Returns a contiguous copy of a tensor node
+template <class Node> std::shared_ptr<Node> contiguousCopy(const Node &node) {
+   auto copy = std::make_shared<Node>(node.shape());
+   ::ten::kernels::elementwise(FusedEvaluator<Node>(node), *copy.get());
+   return copy;
+}
+
+// Input of a function
+// Non contiguous views are copied to contiguous nodes, unless the function
+// reads its inputs through their strides.
+template <class Func, class Node> class FunctionInput {
+ private:
+   std::shared_ptr<Node> _copy = nullptr;
+   const Node *_node;
+
+ public:
+   explicit FunctionInput(const Node &node) : _node(&node) {
+      if constexpr (::ten::isTensorNode<Node>::value &&
+                    !::ten::functional::IsStrided<Func>::value) {
+         if constexpr (Node::isDynamic()) {
+            if (!node.isContiguous()) {
+               _copy = contiguousCopy(node);
+               _node = _copy.get();
+            }
+         }
+      }
+   }
+
+   const Node &get() const { return *_node; }
+};
+} // namespace details
+
 // \class UnaryNode
 // Apply a function to a ten::Tensor or a ten::Scalar
 template <class Input, class Output, template <typename...> class Func,
@@ -122,8 +261,40 @@ class UnaryNode {
    std::optional<func_type> _func = std::nullopt;
    //// Output value
    std::shared_ptr<Output> _value = nullptr;
+   /// Output of the previous evaluation, reused by the next one
+   std::shared_ptr<Output> _buffer = nullptr;
    std::shared_ptr<Input> _input = nullptr;
 
+   /// Returns the shape of a dynamic output
+   /// The shape is given by the function when it changes the shape of its
+   /// input, otherwise it's the shape of the input.
+   auto outputShape() {
+      auto shape = ::ten::details::NodeWrapper<Input>::shape(_input);
+      if constexpr (requires(func_type &f) { f.outputShape(shape); }) {
+         if constexpr (::ten::functional::HasParams<func_type>::value) {
+            return _func.value().outputShape(shape);
+         } else {
+            return func_type().outputShape(shape);
+         }
+      } else {
+         return shape;
+      }
+   }
+
+   /// Use the output node if possible, otherwise allocate a new one
+   /// An aliased output, read by the evaluation, isn't used.
+   template <class... S>
+   void setOutput(const std::shared_ptr<Output> &output, bool aliased,
+                  const S &...shape) {
+      if (!aliased && details::isValidOutput(output, shape...)) {
+         _value = output;
+      } else {
+         _value.reset(new Output(shape...));
+         TENSEUR_PROFILE_ALLOC(
+             ::ten::profile::details::outputBytes(*_value.get()));
+      }
+   }
+
  public:
    UnaryNode() {}
 
@@ -140,20 +311,83 @@ class UnaryNode {
       requires(::ten::functional::HasParams<func_type>::value)
        : _input(input), _func(func_type(std::forward<FuncArgs>(args)...)) {}
 
+   /// Construct an unevaluated copy of a node, reading the node input
+   UnaryNode(const UnaryNode &node, const std::shared_ptr<Input> &input)
+       : _func(node._func), _input(input) {}
+
    [[nodiscard]] inline std::shared_ptr<Output> node() { return _value; }
 
+   /// Returns the input node
+   [[nodiscard]] inline const std::shared_ptr<Input> &input() const {
+      return _input;
+   }
+
+   /// Returns the optional function
+   [[nodiscard]] inline const std::optional<func_type> &func() const {
+      return _func;
+   }
+
    /// Returns whether the expression is evaluated
    [[nodiscard]] bool evaluated() const { return _value.get(); }
 
+   /// Invalidate the value of the node and of its input
+   /// The output is kept and reused by the next evaluation.
+   void invalidate() {
+      if (_value) {
+         _buffer = _value;
+         _value = nullptr;
+      }
+      if constexpr (::ten::isUnaryNode<Input>::value ||
+                    ::ten::isBinaryNode<Input>::value) {
+         _input.get()->invalidate();
+      }
+   }
+
+   /// Set the output used by the next evaluation
+   void setBuffer(const std::shared_ptr<Output> &buffer) { _buffer = buffer; }
+
    /// Returns the evaluated expression of type ten::Scalar or ten::Tensor
    [[nodiscard]] auto value() -> evaluated_type {
       return evaluated_type(_value);
    }
 
    /// Evaluated the expression
-   [[maybe_unused]] auto eval() noexcept -> evaluated_type {
+   [[maybe_unused]] auto eval() -> evaluated_type {
+      return eval(nullptr);
+   }
+
+   /// Evaluate the expression into output
+   /// The output node is used when it has the shape of the result and the
+   /// evaluation doesn't read its elements: a non elementwise function doesn't
+   /// share elements with its input, and the leaves of elementwise nodes sharing
+   /// elements with it read each one at the position it's written to.
+   /// Otherwise a new output node is allocated. Without an output node, the
+   /// output of the previous evaluation is reused.
+   [[maybe_unused]] auto eval(const std::shared_ptr<Output> &output)
+       -> evaluated_type {
       if (_value)
          return evaluated_type(_value);
+      if (!output && _buffer) {
+         return eval(_buffer);
+      }
+
+      // Evaluate the tree of elementwise nodes in a single pass
+      if constexpr (details::isElementwiseNode<UnaryNode>::value &&
+                    !::ten::isScalarNode<Output>::value) {
+         details::FusedEvaluator<UnaryNode> expr(*this);
+         auto shape = expr.shape();
+         expr.broadcastTo(shape);
+         TENSEUR_PROFILE_SCOPE(
+             ::ten::profile::details::typeName<func_type>(), "node");
+         const bool aliased = output && expr.isAliasedWith(*output.get());
+         if constexpr (Output::isStatic()) {
+            setOutput(output, aliased);
+         } else {
+            setOutput(output, aliased, shape);
+         }
+         ::ten::kernels::elementwise(expr, *_value.get());
+         return evaluated_type(_value);
+      }
 
       // Evaluate Input
       if constexpr (::ten::isUnaryNode<Input>::value ||
@@ -163,24 +397,32 @@ class UnaryNode {
          }
       }
 
+      TENSEUR_PROFILE_SCOPE(::ten::profile::details::typeName<func_type>(),
+                            "node");
+
       // Allocate output
+      // The output of a function returning a view of its input is set by the
+      // function
       if constexpr (::ten::isScalarNode<Output>::value) {
          _value.reset(new Output());
+      } else if constexpr (::ten::functional::IsViewOutput<func_type>::value &&
+                           Output::isDynamic()) {
+         _value = std::make_shared<Output>();
       } else if constexpr (!::ten::isScalarNode<Output>::value &&
                            Output::isStatic()) {
-         _value.reset(new Output());
+         setOutput(output, details::isAliased(output, _input));
       } else {
-         _value.reset(
-             new Output(::ten::details::NodeWrapper<Input>::shape(_input)));
+         setOutput(output, details::isAliased(output, _input),
+                   outputShape());
       }
 
       // Evaluate
+      details::FunctionInput<func_type, input_node_type> arg(
+          *::ten::details::NodeWrapper<Input>::ptr(_input));
       if constexpr (::ten::functional::HasParams<func_type>::value) {
-         _func.value()(*::ten::details::NodeWrapper<Input>::ptr(_input),
-                       *_value.get());
+         _func.value()(arg.get(), *_value.get());
       } else {
-         func_type::operator()(*::ten::details::NodeWrapper<Input>::ptr(_input),
-                               *_value.get());
+         func_type::operator()(arg.get(), *_value.get());
       }
 
       return evaluated_type(_value);
@@ -229,6 +471,9 @@ class UnaryExpr : ::ten::Expr<UnaryExpr<E, Func, Args...>> {
        : _node(std::make_shared<node_type>(expr,
                                            std::forward<FuncArgs>(args)...)) {}
 
+   /// Construct an expression from its node
+   explicit UnaryExpr(const std::shared_ptr<node_type> &node) : _node(node) {}
+
    // Returns the shared pointer to the node of the expression
    [[nodiscard]] std::shared_ptr<node_type> node() const { return _node; }
 
@@ -246,6 +491,21 @@ class UnaryExpr : ::ten::Expr<UnaryExpr<E, Func, Args...>> {
    [[maybe_unused]] auto eval() -> evaluated_type {
       return _node.get()->eval();
    }
+
+   /// Invalidate the value of the expression, so that it's evaluated again
+   /// into the same output
+   void invalidate() { _node.get()->invalidate(); }
+
+   /// Evaluate a unary expression into the output node when possible
+   [[maybe_unused]] auto
+   eval(const std::shared_ptr<typename node_type::output_node_type> &output)
+       -> evaluated_type {
+      return _node.get()->eval(output);
+   }
+
+   /// Evaluate the expression asynchronously on the thread pool, the
+   /// independent subexpressions concurrently (defined in Ten/Async.hxx)
+   [[nodiscard]] Future<UnaryExpr> evalAsync() const;
 };
 
 // \class BinaryNode
@@ -277,9 +537,25 @@ class BinaryNode {
    std::optional<func_type> _func = std::nullopt;
    // std::optional<typename Output::shape_type> _shape = std::nullopt;
    std::shared_ptr<Output> _value = nullptr;
+   /// Output of the previous evaluation, reused by the next one
+   std::shared_ptr<Output> _buffer = nullptr;
    std::shared_ptr<Left> _left;
    std::shared_ptr<Right> _right;
 
+   /// Use the output node if possible, otherwise allocate a new one
+   /// An aliased output, read by the evaluation, isn't used.
+   template <class... S>
+   void setOutput(const std::shared_ptr<Output> &output, bool aliased,
+                  const S &...shape) {
+      if (!aliased && details::isValidOutput(output, shape...)) {
+         _value = output;
+      } else {
+         _value.reset(new Output(shape...));
+         TENSEUR_PROFILE_ALLOC(
+             ::ten::profile::details::outputBytes(*_value.get()));
+      }
+   }
+
  public:
    BinaryNode() {}
 
@@ -295,19 +571,94 @@ class BinaryNode {
        : _func(func_type(std::forward<FuncArgs>(args)...)), _left(left),
          _right(right) {}
 
+   /// Construct an unevaluated copy of a node, reading the nodes left and
+   /// right
+   BinaryNode(const BinaryNode &node, const std::shared_ptr<Left> &left,
+              const std::shared_ptr<Right> &right)
+       : _func(node._func), _left(left), _right(right) {}
+
    [[nodiscard]] inline std::shared_ptr<Output> node() { return _value; }
 
+   /// Returns the left input node
+   [[nodiscard]] inline const std::shared_ptr<Left> &left() const {
+      return _left;
+   }
+
+   /// Returns the right input node
+   [[nodiscard]] inline const std::shared_ptr<Right> &right() const {
+      return _right;
+   }
+
+   /// Returns the optional function
+   [[nodiscard]] inline const std::optional<func_type> &func() const {
+      return _func;
+   }
+
    /// Returns whether the expression is evaluated
    [[nodiscard]] bool evaluated() const { return _value.get(); }
 
+   /// Invalidate the value of the node and of its inputs
+   /// The output is kept and reused by the next evaluation.
+   void invalidate() {
+      if (_value) {
+         _buffer = _value;
+         _value = nullptr;
+      }
+      if constexpr (::ten::isUnaryNode<Left>::value ||
+                    ::ten::isBinaryNode<Left>::value) {
+         _left.get()->invalidate();
+      }
+      if constexpr (::ten::isUnaryNode<Right>::value ||
+                    ::ten::isBinaryNode<Right>::value) {
+         _right.get()->invalidate();
+      }
+   }
+
+   /// Set the output used by the next evaluation
+   void setBuffer(const std::shared_ptr<Output> &buffer) { _buffer = buffer; }
+
    /// Returns the the evaluated expression of type ten::Scalar of ten::Tensor
    [[nodiscard]] auto value() -> evaluated_type {
       return evaluated_type(_value);
    }
 
-   [[maybe_unused]] auto eval() noexcept -> evaluated_type {
+   /// Evaluate the expression
+   [[maybe_unused]] auto eval() -> evaluated_type {
+      return eval(nullptr);
+   }
+
+   /// Evaluate the expression into output
+   /// The output node is used when it has the shape of the result and the
+   /// evaluation doesn't read its elements: a non elementwise function doesn't
+   /// share elements with its inputs, and the leaves of elementwise nodes sharing
+   /// elements with it read each one at the position it's written to.
+   /// Otherwise a new output node is allocated. Without an output node, the
+   /// output of the previous evaluation is reused.
+   [[maybe_unused]] auto eval(const std::shared_ptr<Output> &output)
+       -> evaluated_type {
       if (_value)
          return evaluated_type(_value);
+      if (!output && _buffer) {
+         return eval(_buffer);
+      }
+
+      // Evaluate the tree of elementwise nodes in a single pass
+      if constexpr (details::isElementwiseNode<BinaryNode>::value &&
+                    !::ten::isScalarNode<Output>::value) {
+         details::FusedEvaluator<BinaryNode> expr(*this);
+         auto shape = expr.shape();
+         expr.broadcastTo(shape);
+         TENSEUR_PROFILE_SCOPE(
+             ::ten::profile::details::typeName<func_type>(), "node");
+         const bool aliased = output && expr.isAliasedWith(*output.get());
+         if constexpr (Output::isStatic()) {
+            setOutput(output, aliased);
+         } else {
+            setOutput(output, aliased, shape);
+         }
+         ::ten::kernels::elementwise(expr, *_value.get());
+         return evaluated_type(_value);
+      }
 
       // Evaluate LeftExpr
       if constexpr (::ten::isUnaryNode<Left>::value ||
@@ -324,37 +675,352 @@ class BinaryNode {
          }
       }
 
+      TENSEUR_PROFILE_SCOPE(::ten::profile::details::typeName<func_type>(),
+                            "node");
+
+      const bool aliased = details::isAliased(output, _left) ||
+                           details::isAliased(output, _right);
       if constexpr (Output::isStatic()) {
-         _value.reset(new Output());
+         setOutput(output, aliased);
       } else {
          if constexpr (!::ten::isScalarNode<Left>::value &&
                        !::ten::isScalarNode<Right>::value) {
-            _value.reset(new Output(func_type::outputShape(
-                ::ten::details::NodeWrapper<Left>::shape(_left),
-                ::ten::details::NodeWrapper<Right>::shape(_right))));
+            setOutput(output, aliased,
+                      func_type::outputShape(
+                          ::ten::details::NodeWrapper<Left>::shape(_left),
+                          ::ten::details::NodeWrapper<Right>::shape(_right)));
          } else {
             if constexpr (::ten::isScalarNode<Left>::value &&
                           !::ten::isScalarNode<Right>::value) {
-               _value.reset(new Output(func_type::outputShape(
-                   ::ten::details::NodeWrapper<Right>::shape(_right))));
+               setOutput(output, aliased,
+                         func_type::outputShape(
+                             ::ten::details::NodeWrapper<Right>::shape(_right)));
             }
             if constexpr (!::ten::isScalarNode<Left>::value &&
                           ::ten::isScalarNode<Right>::value) {
-               _value.reset(new Output(func_type::outputShape(
-                   ::ten::details::NodeWrapper<Left>::shape(_left))));
+               setOutput(output, aliased,
+                         func_type::outputShape(
+                             ::ten::details::NodeWrapper<Left>::shape(_left)));
             }
          }
       }
 
       // Call F
-      func_type::operator()(*details::NodeWrapper<Left>::ptr(_left),
-                            *details::NodeWrapper<Right>::ptr(_right),
-                            *_value.get());
+      details::FunctionInput<func_type, left_node_type> leftArg(
+          *details::NodeWrapper<Left>::ptr(_left));
+      details::FunctionInput<func_type, right_node_type> rightArg(
+          *details::NodeWrapper<Right>::ptr(_right));
+      func_type::operator()(leftArg.get(), rightArg.get(), *_value.get());
 
       return evaluated_type(_value);
    }
 };
 
+namespace details {
+// Input of a fused evaluator
+// Elementwise nodes are fused with their parent, other nodes are evaluated
+// and read as leaves.
+template <class Node, size_type Rank, StorageOrder Order>
+using FusedInput = std::conditional_t<
+    isElementwiseNode<Node>::value, FusedEvaluator<Node, Rank, Order>,
+    FusedEvaluator<typename OutputNodeType<Node>::type, Rank, Order>>;
+
+template <size_type Rank, StorageOrder Order, class Node>
+auto makeFusedInput(const std::shared_ptr<Node> &node) {
+   if constexpr (isElementwiseNode<Node>::value) {
+      return FusedEvaluator<Node, Rank, Order>(*node.get());
+   } else if constexpr (::ten::isUnaryNode<Node>::value ||
+                        ::ten::isBinaryNode<Node>::value) {
+      if (!node.get()->evaluated()) {
+         node.get()->eval();
+      }
+      return FusedEvaluator<typename OutputNodeType<Node>::type, Rank, Order>(
+          *node.get()->node().get());
+   } else {
+      return FusedEvaluator<Node, Rank, Order>(*node.get());
+   }
+}
+
+// Scalar leaf, broadcasted to all the elements
+template <class T, size_type Rank, StorageOrder Order>
+struct FusedEvaluator<ScalarNode<T>, Rank, Order> {
+   T _value;
+
+   explicit FusedEvaluator(const ScalarNode<T> &node) : _value(node.value()) {}
+
+   template <class S> void broadcastTo(const S &) {}
+
+   template <class Out> bool isAliasedWith(const Out &) const { return false; }
+
+   bool isContiguous() const { return true; }
+
+   bool hasUnitInnerStride() const { return true; }
+
+   template <class V> V load(size_type) const {
+      if constexpr (std::experimental::is_simd_v<V>) {
+         return V(static_cast<typename V::value_type>(_value));
+      } else {
+         return static_cast<V>(_value);
+      }
+   }
+
+   template <class V> V load(size_type, size_type) const {
+      return load<V>(0);
+   }
+};
+
+// Tensor leaf
+// load(offset) reads the element at a linear offset of a contiguous tensor,
+// load(run, index) the index'th element of a run along the innermost
+// dimension of a tensor of any strides.
+// The tensor is seen as a tensor of rank Rank with leading dimensions equal to
+// 1, broadcasted dimensions are read with a zero stride.
+// The runs are taken in the storage order Order of the output, a tensor stored
+// in the other order is read through its strides.
+template <class T, class Shape, StorageOrder NodeOrder, class Storage,
+          class Allocator, size_type Rank, StorageOrder Order>
+struct FusedEvaluator<TensorNode<T, Shape, NodeOrder, Storage, Allocator>, Rank,
+                      Order> {
+   static_assert(Rank >= Shape::rank(), "Rank lower than the tensor rank.");
+   static_assert(!::ten::isSparseStorage<Storage>::value &&
+                     !::ten::isStructuredStorage<Storage>::value,
+                 "Tenseur: Sparse and structured matrices aren't operands of "
+                 "dense elementwise expressions, convert them with toDense.");
+   static constexpr size_type pad = Rank - Shape::rank();
+   using node_type = TensorNode<T, Shape, NodeOrder, Storage, Allocator>;
+
+   const node_type *_node;
+   const T *_data;
+   StridedRuns<Rank, Order> _runs;
+   bool _broadcast = false;
+
+   static std::array<size_type, Rank>
+   paddedDims(const node_type &node) {
+      std::array<size_type, Rank> dims;
+      for (size_type i = 0; i < Rank; i++) {
+         dims[i] = i < pad ? 1 : node.dim(i - pad);
+      }
+      return dims;
+   }
+
+   static std::array<size_type, Rank>
+   paddedStrides(const node_type &node) {
+      std::array<size_type, Rank> strides;
+      for (size_type i = 0; i < Rank; i++) {
+         strides[i] = i < pad ? 0 : node.stride(i - pad);
+      }
+      return strides;
+   }
+
+   explicit FusedEvaluator(const node_type &node)
+       : _node(&node), _data(node.data()),
+         _runs(paddedDims(node), paddedStrides(node)) {}
+
+   /// Broadcast to a shape of rank Rank
+   template <class S> void broadcastTo(const S &shape) {
+      static_assert(S::rank() == Rank, "Broadcast to a shape of another rank.");
+      auto dims = paddedDims(*_node);
+      auto strides = paddedStrides(*_node);
+      _broadcast = false;
+      for (size_type i = 0; i < Rank; i++) {
+         if (dims[i] != shape.dim(i)) {
+            dims[i] = shape.dim(i);
+            strides[i] = 0;
+            _broadcast = true;
+         }
+      }
+      _runs = StridedRuns<Rank, Order>(dims, strides);
+   }
+
+   const Shape &shape() const { return _node->shape(); }
+
+   /// Returns whether the leaf shares elements with the output node and reads
+   /// some of them at another position than the one they're written to, so
+   /// that writing the output would change the elements still to be read
+   template <class Out> bool isAliasedWith(const Out &output) const {
+      if (!overlaps(*_node, output)) {
+         return false;
+      }
+      if (_broadcast || !std::is_same_v<T, typename Out::value_type> ||
+          static_cast<const void *>(_data) !=
+              static_cast<const void *>(output.data())) {
+         return true;
+      }
+      const auto dims = paddedDims(*_node);
+      const auto strides = paddedStrides(*_node);
+      for (size_type i = 0; i < Rank; i++) {
+         if (dims[i] != output.dim(i) ||
+             (dims[i] > 1 && strides[i] != output.stride(i))) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   bool isContiguous() const {
+      return !_broadcast && _node->isContiguous() &&
+             (NodeOrder == Order || Shape::rank() <= 1);
+   }
+
+   bool hasUnitInnerStride() const {
+      return _runs.innerStride() <= 1 || _runs.innerDim() <= 1;
+   }
+
+   template <class V> V load(size_type offset) const {
+      if constexpr (std::experimental::is_simd_v<V>) {
+         V v;
+         v.copy_from(_data + offset, std::experimental::element_aligned);
+         return v;
+      } else {
+         return static_cast<V>(_data[offset]);
+      }
+   }
+
+   template <class V> V load(size_type run, size_type index) const {
+      const size_type stride = _runs.innerStride();
+      const T *ptr = _data + _runs.position(run) + index * stride;
+      if constexpr (std::experimental::is_simd_v<V>) {
+         using value_type = typename V::value_type;
+         if (stride == 1) {
+            return V(ptr, std::experimental::element_aligned);
+         }
+         if (stride == 0) {
+            return V(static_cast<value_type>(*ptr));
+         }
+         return V([ptr, stride](auto k) {
+            return static_cast<value_type>(ptr[k * stride]);
+         });
+      } else {
+         return static_cast<V>(*ptr);
+      }
+   }
+};
+
+// Unary node
+template <class Input, class Output, template <typename...> class F,
+          class... Args, size_type Rank, StorageOrder Order>
+struct FusedEvaluator<::ten::UnaryNode<Input, Output, F, Args...>, Rank,
+                      Order> {
+   using node_type = ::ten::UnaryNode<Input, Output, F, Args...>;
+   using func_type = typename node_type::func_type;
+
+   FusedInput<Input, Rank, Order> _input;
+   std::optional<func_type> _func;
+
+   explicit FusedEvaluator(const node_type &node)
+       : _input(makeFusedInput<Rank, Order>(node.input())), _func(node.func()) {}
+
+   template <class S> void broadcastTo(const S &shape) {
+      _input.broadcastTo(shape);
+   }
+
+   template <class Out> bool isAliasedWith(const Out &output) const {
+      return _input.isAliasedWith(output);
+   }
+
+   auto shape() const { return _input.shape(); }
+
+   bool isContiguous() const { return _input.isContiguous(); }
+
+   bool hasUnitInnerStride() const { return _input.hasUnitInnerStride(); }
+
+   template <class V, class... Index> V load(Index... index) const {
+      if constexpr (::ten::functional::HasParams<func_type>::value) {
+         return _func.value().apply(_input.template load<V>(index...));
+      } else {
+         return func_type::apply(_input.template load<V>(index...));
+      }
+   }
+};
+
+// Binary node
+template <class L, class R, class Output, template <typename...> class F,
+          class... Args, size_type Rank, StorageOrder Order>
+struct FusedEvaluator<::ten::BinaryNode<L, R, Output, F, Args...>, Rank,
+                      Order> {
+   using node_type = ::ten::BinaryNode<L, R, Output, F, Args...>;
+   using func_type = typename node_type::func_type;
+
+   FusedInput<L, Rank, Order> _left;
+   FusedInput<R, Rank, Order> _right;
+   std::optional<func_type> _func;
+
+   explicit FusedEvaluator(const node_type &node)
+       : _left(makeFusedInput<Rank, Order>(node.left())),
+         _right(makeFusedInput<Rank, Order>(node.right())),
+         _func(node.func()) {}
+
+   template <class S> void broadcastTo(const S &shape) {
+      _left.broadcastTo(shape);
+      _right.broadcastTo(shape);
+   }
+
+   template <class Out> bool isAliasedWith(const Out &output) const {
+      return _left.isAliasedWith(output) || _right.isAliasedWith(output);
+   }
+
+   /// Returns the shape of the output, the broadcasted shape of the inputs
+   auto shape() const {
+      if constexpr (::ten::isScalarNode<
+                        typename node_type::left_node_type>::value) {
+         return _right.shape();
+      } else if constexpr (::ten::isScalarNode<
+                               typename node_type::right_node_type>::value) {
+         return _left.shape();
+      } else {
+         return ::ten::details::broadcastShape<typename Output::shape_type>(
+             _left.shape(), _right.shape());
+      }
+   }
+
+   bool isContiguous() const {
+      return _left.isContiguous() && _right.isContiguous();
+   }
+
+   bool hasUnitInnerStride() const {
+      return _left.hasUnitInnerStride() && _right.hasUnitInnerStride();
+   }
+
+   template <class V, class... Index> V load(Index... index) const {
+      if constexpr (::ten::functional::HasParams<func_type>::value) {
+         return _func.value().apply(_left.template load<V>(index...),
+                                    _right.template load<V>(index...));
+      } else {
+         return func_type::apply(_left.template load<V>(index...),
+                                 _right.template load<V>(index...));
+      }
+   }
+};
+
+// Copy the evaluated node src into the storage of the view dst
+template <class Src, class Dst> void assignToView(const Src &src, Dst &dst) {
+   using T = typename Dst::value_type;
+   if (!(src.shape() == dst.shape())) {
+      throw std::invalid_argument(
+          "Tenseur: Assignment to a view of a different shape.");
+   }
+   FusedEvaluator<Src, Src::rank(), Dst::storageOrder()> input(src);
+   auto runs = dst.stridedRuns();
+   size_type inner = runs.innerDim();
+   size_type stride = runs.innerStride();
+   if (inner == 0) {
+      return;
+   }
+   T *data = dst.data();
+   ::ten::parallel::parallelFor(
+       0, dst.size() / inner, 1,
+       [&](size_type first, size_type last) {
+          for (size_type run = first; run < last; run++) {
+             T *ptr = data + runs.position(run);
+             for (size_type i = 0; i < inner; i++) {
+                ptr[i * stride] = input.template load<T>(run, i);
+             }
+          }
+       },
+       inner);
+}
+} // namespace details
+
 /// \class BinaryExpr
 /// Binary expression
 // Left and Right can be ScalarNode, TensorNode or BinaryExpr
@@ -392,6 +1058,9 @@ class BinaryExpr : ::ten::Expr<BinaryExpr<Left, Right, Func, Args...>> {
                        const std::shared_ptr<Right> &right) noexcept
        : _node(std::make_shared<node_type>(left, right)) {}
 
+   /// Construct an expression from its node
+   explicit BinaryExpr(const std::shared_ptr<node_type> &node) : _node(node) {}
+
    /// Returns a shared pointer to the node of the expression
    [[nodiscard]] std::shared_ptr<node_type> node() const { return _node; }
 
@@ -409,6 +1078,21 @@ class BinaryExpr : ::ten::Expr<BinaryExpr<Left, Right, Func, Args...>> {
    [[maybe_unused]] auto eval() -> evaluated_type {
       return _node.get()->eval();
    }
+
+   /// Invalidate the value of the expression, so that it's evaluated again
+   /// into the same output
+   void invalidate() { _node.get()->invalidate(); }
+
+   /// Evaluate a binary expression into the output node when possible
+   [[maybe_unused]] auto
+   eval(const std::shared_ptr<typename node_type::output_node_type> &output)
+       -> evaluated_type {
+      return _node.get()->eval(output);
+   }
+
+   /// Evaluate the expression asynchronously on the thread pool, the
+   /// independent subexpressions concurrently (defined in Ten/Async.hxx)
+   [[nodiscard]] Future<BinaryExpr> evalAsync() const;
 };
 
 } // namespace ten
@@ -1,13 +1,19 @@
 #ifndef TENSEUR_FUNCTIONAL_HXX
 #define TENSEUR_FUNCTIONAL_HXX
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
 #include <type_traits>
 
+#include <experimental/simd>
+
 #include <Ten/Kernels/Host>
+#include <Ten/Shape.hxx>
+#include <Ten/Stack.hxx>
 #include <Ten/Types.hxx>
 
 namespace ten::functional {
@@ -18,35 +24,183 @@ template <class T> struct HasParams {
    static constexpr bool value = std::is_base_of_v<Func<true>, T>;
 };
 
+/// \class Elementwise
+/// Tag for functions that apply independently to each element. They provide
+/// an apply function working on scalars and on simd vectors, so that a tree
+/// of elementwise nodes can be evaluated in a single loop.
+struct Elementwise {};
+
+template <class T> struct IsElementwise {
+   static constexpr bool value = std::is_base_of_v<Elementwise, T>;
+};
+
+/// \class Strided
+/// Tag for functions that read their tensor inputs through their strides.
+/// Non contiguous views are passed to them without being copied.
+struct Strided {};
+
+template <class T> struct IsStrided {
+   static constexpr bool value = std::is_base_of_v<Strided, T>;
+};
+
+/// \class ViewOutput
+/// Tag for functions that set their output to a view of the storage of their
+/// input. Their output node is default constructed rather than allocated.
+struct ViewOutput {};
+
+template <class T> struct IsViewOutput {
+   static constexpr bool value = std::is_base_of_v<ViewOutput, T>;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Unary functions
 
 /// Square root
-template <class A, class B = A> struct Sqrt : Func<> {
+template <class A, class B = A> struct Sqrt : Func<>, Elementwise {
    using output_type = B;
 
+   template <class V> static V apply(const V &x) {
+      using std::sqrt;
+      return sqrt(x);
+   }
+
    static void operator()(const A &a, B &b) {
-      using value_type = typename B::value_type;
-      for (size_t i = 0; i < a.size(); i++) {
-         b[i] = std::sqrt(static_cast<value_type>(a[i]));
-      }
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
    }
 };
 
 /// Absolute value
-template <class A, class B = A> struct Abs : Func<> {
+template <class A, class B = A> struct Abs : Func<>, Elementwise {
    using output_type = B;
 
+   template <class V> static V apply(const V &x) {
+      using std::abs;
+      return abs(x);
+   }
+
    static void operator()(const A &a, B &b) {
-      using value_type = typename B::value_type;
-      for (size_t i = 0; i < a.size(); i++) {
-         b[i] = std::abs(static_cast<value_type>(a[i]));
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+namespace details {
+// Whether the kernels of Ten/Kernels/Math.hxx apply to V, a scalar or a simd
+// vector, other types use the functions of the standard library
+template <class V>
+static constexpr bool isMathValue = ::ten::kernels::math::isMathType<
+    ::ten::kernels::math::details::scalar_t<V>>;
+} // namespace details
+
+/// Exponential
+template <class A, class B = A> struct Exp : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::exp(x);
+      } else {
+         using std::exp;
+         return exp(x);
+      }
+   }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+/// Natural logarithm
+template <class A, class B = A> struct Log : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::log(x);
+      } else {
+         using std::log;
+         return log(x);
+      }
+   }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+/// Natural logarithm of 1 + x, accurate for small x
+template <class A, class B = A> struct Log1p : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::log1p(x);
+      } else {
+         using std::log1p;
+         return log1p(x);
       }
    }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+/// Hyperbolic tangent
+template <class A, class B = A> struct Tanh : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::tanh(x);
+      } else {
+         using std::tanh;
+         return tanh(x);
+      }
+   }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+/// Logistic sigmoid 1 / (1 + exp(-x))
+template <class A, class B = A> struct Sigmoid : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::sigmoid(x);
+      } else {
+         using std::exp;
+         return V(1) / (V(1) + exp(-x));
+      }
+   }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
+};
+
+/// Error function
+template <class A, class B = A> struct Erf : Func<>, Elementwise {
+   using output_type = B;
+
+   template <class V> static V apply(const V &x) {
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::erf(x);
+      } else {
+         using std::erf;
+         return erf(x);
+      }
+   }
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::unaryOps(a, b, [](const auto &x) { return apply(x); });
+   }
 };
 
 /// Power
-template <class A, class B = A> struct Pow : Func<true> {
+template <class A, class B = A> struct Pow : Func<true>, Elementwise {
  private:
    double _n;
 
@@ -55,10 +209,75 @@ template <class A, class B = A> struct Pow : Func<true> {
 
    explicit Pow(double n) : _n(n) {}
 
-   void operator()(const A &a, B &b) const {
+   template <class V> V apply(const V &x) const {
       using value_type = typename B::value_type;
-      for (size_t i = 0; i < a.size(); i++) {
-         b[i] = std::pow(static_cast<value_type>(a[i]), _n);
+      if constexpr (details::isMathValue<V>) {
+         return ::ten::kernels::math::pow(x, _n);
+      } else if constexpr (std::experimental::is_simd_v<V>) {
+         using std::pow;
+         return pow(x, V(static_cast<value_type>(_n)));
+      } else {
+         using std::pow;
+         return static_cast<V>(pow(x, _n));
+      }
+   }
+
+   void operator()(const A &a, B &b) const {
+      ::ten::kernels::unaryOps(a, b,
+                               [this](const auto &x) { return apply(x); });
+   }
+};
+
+namespace details {
+// Result of a transpose, a view of the storage for dynamic shapes and a
+// static tensor for static shapes
+template <class A> struct TransposeResult {
+   using value_type = typename A::value_type;
+   using shape_type =
+       ::ten::details::reverse_shape_t<typename A::shape_type>;
+   using storage_type = std::conditional_t<
+       shape_type::isStatic(), ::ten::StaticDenseStorage<value_type, shape_type>,
+       typename A::storage_type>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+} // namespace details
+
+/// Transpose, reverses the order of the dimensions
+/// The output of a dynamic tensor is a view with the shape and the strides
+/// reversed, static tensors are copied.
+template <class A, class B = typename details::TransposeResult<A>::type>
+struct Transpose : Func<>, Strided, ViewOutput {
+   using output_type = B;
+
+   static typename B::shape_type
+   outputShape(const typename A::shape_type &shape) {
+      return ::ten::details::reverseShape(shape);
+   }
+
+   static void operator()(const A &a, B &b) {
+      constexpr size_type rank = A::rank();
+      if constexpr (B::isDynamic()) {
+         std::array<size_type, rank> strides;
+         for (size_type i = 0; i < rank; i++) {
+            strides[i] = a.stride(rank - 1 - i);
+         }
+         b = B(a.storage(), outputShape(a.shape()),
+               typename B::stride_type(strides), a.offset(),
+               !a.isTransposed());
+      } else {
+         std::array<size_type, rank> dims;
+         std::array<size_type, rank> strides;
+         for (size_type i = 0; i < rank; i++) {
+            dims[i] = b.dim(i);
+            strides[i] = a.stride(rank - 1 - i);
+         }
+         ::ten::details::StridedRuns<rank, B::storageOrder()> input(dims,
+                                                                   strides);
+         for (size_type i = 0; i < b.size(); i++) {
+            b[i] = a.data()[input.offset(i)];
+         }
       }
    }
 };
@@ -67,12 +286,7 @@ template <class A, class B = typename A::scalarnode_type> struct Min : Func<> {
    using output_type = B;
 
    static constexpr void operator()(const A &a, B &b) {
-      using type = typename A::value_type;
-      type res = a[0];
-      for (size_t i = 1; i < a.size(); i++) {
-         res = std::min(static_cast<type>(a[i]), res);
-      }
-      b = res;
+      b = ::ten::kernels::min(a);
    }
 };
 
@@ -80,20 +294,141 @@ template <class A, class B = typename A::scalarnode_type> struct Max : Func<> {
    using output_type = B;
 
    static constexpr void operator()(const A &a, B &b) {
-      using type = typename A::value_type;
-      type res = a[0];
-      for (size_t i = 1; i < a.size(); i++) {
-         res = std::max(static_cast<type>(a[i]), res);
+      b = ::ten::kernels::max(a);
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Reductions
+namespace details {
+// Value type of the result of a reduction
+// Indices for argmin and argmax, floating point values for the mean, the
+// variance and the euclidean norm of integers.
+template <::ten::ReduceOperation kind, class T> struct ReduceValueType {
+   static constexpr bool isIndex = kind == ::ten::ReduceOperation::argmin ||
+                                   kind == ::ten::ReduceOperation::argmax;
+   static constexpr bool isReal = kind == ::ten::ReduceOperation::mean ||
+                                  kind == ::ten::ReduceOperation::var ||
+                                  kind == ::ten::ReduceOperation::norm2 ||
+                                  kind == ::ten::ReduceOperation::logsumexp;
+   using type = std::conditional_t<
+       isIndex, size_type,
+       std::conditional_t<isReal && std::is_integral_v<T>, double, T>>;
+};
+
+// Result of a reduction along an axis
+template <::ten::ReduceOperation kind, size_type axis, class A>
+struct ReduceAxisResult {
+   using value_type =
+       typename ReduceValueType<kind, typename A::value_type>::type;
+   using shape_type =
+       ::ten::details::remove_dim_t<axis, typename A::shape_type>;
+   using storage_type = std::conditional_t<
+       shape_type::isStatic(), ::ten::StaticDenseStorage<value_type, shape_type>,
+       typename A::storage_type::template casted_type<value_type>>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+} // namespace details
+
+/// Reduction of all the elements to a scalar
+template <::ten::ReduceOperation kind> struct Reduce {
+   template <class A,
+             class B = ::ten::ScalarNode<typename details::ReduceValueType<
+                 kind, typename A::value_type>::type>>
+   struct Func : ::ten::functional::Func<true> {
+    public:
+      using output_type = B;
+      using value_type =
+          typename details::ReduceValueType<kind, typename A::value_type>::type;
+
+    private:
+      ::ten::Summation _method;
+
+    public:
+      explicit Func(::ten::Summation method) : _method(method) {}
+
+      void operator()(const A &a, B &b) const {
+         b = ::ten::kernels::reduce<kind, value_type>(a, _method);
+      }
+   };
+};
+
+/// Reduction along an axis
+/// The output has the shape of the input without the axis.
+template <::ten::ReduceOperation kind, size_type axis> struct ReduceAxis {
+   template <class A,
+             class B = typename details::ReduceAxisResult<kind, axis, A>::type>
+   struct Func : ::ten::functional::Func<true> {
+    public:
+      using output_type = B;
+
+    private:
+      ::ten::Summation _method;
+
+    public:
+      explicit Func(::ten::Summation method) : _method(method) {}
+
+      typename B::shape_type
+      outputShape(const typename A::shape_type &shape) const {
+         return ::ten::details::removeDim<axis>(shape);
+      }
+
+      void operator()(const A &a, B &b) const {
+         ::ten::kernels::reduceAxis<kind>(a, b, axis, _method);
       }
-      b = res;
+   };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Normalizations
+namespace details {
+// Result of a softmax, a tensor of the shape of the input and of floating
+// point values
+template <class A> struct SoftmaxResult {
+   using value_type = std::conditional_t<
+       std::is_integral_v<typename A::value_type>, double,
+       typename A::value_type>;
+   using shape_type = typename A::shape_type;
+   using storage_type = std::conditional_t<
+       shape_type::isStatic(), ::ten::StaticDenseStorage<value_type, shape_type>,
+       typename A::storage_type::template casted_type<value_type>>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+} // namespace details
+
+/// Softmax of all the elements, exp(x - max(x)) / sum(exp(x - max(x)))
+template <class A, class B = typename details::SoftmaxResult<A>::type>
+struct Softmax : Func<> {
+   using output_type = B;
+
+   static void operator()(const A &a, B &b) {
+      ::ten::kernels::softmax(a, b);
    }
 };
 
+/// Softmax along an axis
+/// Each slice of the input along the axis is normalized independently.
+template <size_type axis> struct SoftmaxAxis {
+   template <class A, class B = typename details::SoftmaxResult<A>::type>
+   struct Func : ::ten::functional::Func<> {
+      using output_type = B;
+
+      static void operator()(const A &a, B &b) {
+         ::ten::kernels::softmaxAxis(a, b, axis);
+      }
+   };
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Binary functions (Add, Sub, Mul and Div)
 namespace details {
 template <class, class> struct CommonType;
 
+// Tensors of the same shape
 template <::ten::traits::TensorNode A, ::ten::traits::TensorNode B>
    requires SameShape<A, B> && SameStorageOrder<A, B> && SameStorage<A, B> &&
             SameAllocator<A, B>
@@ -105,6 +440,29 @@ struct CommonType<A, B> {
                   typename A::storage_type, typename A::allocator_type>;
 };
 
+// Tensors of broadcastable shapes or of different storage orders
+// The output has the storage order of the left operand. It has a static
+// storage when its shape is static, otherwise the storage of the dynamic
+// operand.
+template <::ten::traits::TensorNode A, ::ten::traits::TensorNode B>
+   requires(!(SameShape<A, B> && SameStorageOrder<A, B> &&
+              SameStorage<A, B> && SameAllocator<A, B>)) &&
+           ::ten::details::BroadcastShape<typename A::shape_type,
+                                          typename B::shape_type>::value
+struct CommonType<A, B> {
+   using value_type =
+       std::common_type_t<typename A::value_type, typename B::value_type>;
+   using shape_type =
+       ::ten::details::broadcast_shape_t<typename A::shape_type,
+                                         typename B::shape_type>;
+   using storage_type = std::conditional_t<
+       shape_type::isStatic(), ::ten::StaticDenseStorage<value_type, shape_type>,
+       typename std::conditional_t<A::isDynamic(), A, B>::storage_type>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+
 template <class A, class B>
 using common_type_t = typename CommonType<A, B>::type;
 } // namespace details
@@ -113,50 +471,189 @@ using common_type_t = typename CommonType<A, B>::type;
 template <BinaryOperation kind> struct BinaryFunc {
 
    template <class A, class B, class C = details::common_type_t<A, B>>
-   struct Func : ::ten::functional::Func<> {
+   struct Func : ::ten::functional::Func<>, Elementwise {
 
       using output_type = C;
 
-      static constexpr typename C::shape_type
-      outputShape(const A::shape_type &left, const B::shape_type &right) {
-         typename C::shape_type s(left);
-         return s;
+      template <class V> static V apply(const V &a, const V &b) {
+         return ::ten::kernels::binaryOp<kind>(a, b);
       }
 
-      static auto outputShape(const A &a, const B &b) { return a.shape(); }
+      /// Returns the broadcasted shape of the operands
+      static typename C::shape_type outputShape(const A::shape_type &left,
+                                                const B::shape_type &right) {
+         return ::ten::details::broadcastShape<typename C::shape_type>(left,
+                                                                       right);
+      }
 
       static void operator()(const A &left, const B &right, C &result) {
          ::ten::kernels::binaryOps<kind>(left, right, result);
       }
    };
+
+   // Sparse matrices of the same format
+   template <::ten::traits::SparseNode A, ::ten::traits::SparseNode B, class C>
+   struct Func<A, B, C> : ::ten::functional::Func<>, Strided {
+      static_assert(SameStorage<A, B>,
+                    "Tenseur: Sparse matrices of different formats.");
+
+      using output_type = C;
+
+      static typename C::shape_type outputShape(const A::shape_type &left,
+                                                const B::shape_type &right) {
+         if (!(left == right)) {
+            throw std::invalid_argument(
+                "Tenseur: Sparse matrices of different shapes.");
+         }
+         return left;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         ::ten::kernels::sparseBinaryOps<kind>(left, right, result);
+      }
+   };
+
+   // Diagonal or triangular matrices of the same format
+   template <::ten::traits::StructuredNode A,
+             ::ten::traits::StructuredNode B, class C>
+   struct Func<A, B, C> : ::ten::functional::Func<>, Strided {
+      static_assert(SameStorage<A, B>,
+                    "Tenseur: Structured matrices of different formats.");
+
+      using output_type = C;
+
+      static typename C::shape_type outputShape(const A::shape_type &left,
+                                                const B::shape_type &right) {
+         if (!(left == right)) {
+            throw std::invalid_argument(
+                "Tenseur: Structured matrices of different shapes.");
+         }
+         return left;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         ::ten::kernels::packedBinaryOps<kind>(left, right, result);
+      }
+   };
 };
 
 namespace details {
+// Elementwise multiplication of tensors
+// The products of two matrices and of a matrix by a vector are matrix
+// products, the other products of tensors are elementwise with broadcasting.
+template <class A, class B>
+concept ElementwiseMul =
+    ::ten::traits::TensorNode<A> && ::ten::traits::TensorNode<B> &&
+    !::ten::traits::SparseNode<A> && !::ten::traits::SparseNode<B> &&
+    !::ten::traits::StructuredNode<A> && !::ten::traits::StructuredNode<B> &&
+    !(MatrixNode<A> && (MatrixNode<B> || VectorNode<B>));
+
 template <class, class> struct MulResult;
 
-// vector * vector
-template <VectorNode A, VectorNode B>
-   requires SameShape<A, B> && SameStorageOrder<A, B> && SameStorage<A, B> &&
-            SameAllocator<A, B>
+// elementwise tensor * tensor
+template <class A, class B>
+   requires ElementwiseMul<A, B>
 struct MulResult<A, B> {
+   using type = common_type_t<A, B>;
+};
+
+// Operands of a matrix product, of the same storage or of static shapes
+template <class A, class B>
+concept MulOperands = (SameStorage<A, B> && SameAllocator<A, B>) ||
+                      (A::isStatic() && B::isStatic());
+
+// Output node of a matrix product of the given shape
+// The output has a static storage when both operands are of static shape.
+template <class A, class B, class Shape, StorageOrder Order>
+struct MulOutput {
    using value_type =
        std::common_type_t<typename A::value_type, typename B::value_type>;
+   using storage_type =
+       std::conditional_t<A::isStatic() && B::isStatic(),
+                          ::ten::StaticDenseStorage<value_type, Shape>,
+                          typename A::storage_type>;
    using type =
-       TensorNode<value_type, typename A::shape_type, A::storageOrder(),
-                  typename A::storage_type, typename A::allocator_type>;
+       TensorNode<value_type, Shape, Order, storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
 };
 
 // matrix * matrix
+// The output has the storage order of the left operand
 template <MatrixNode A, MatrixNode B>
-   requires SameStorageOrder<A, B> && SameStorage<A, B> && SameAllocator<A, B>
+   requires MulOperands<A, B>
 struct MulResult<A, B> {
+   using type = typename MulOutput<
+       A, B,
+       Shape<A::shape_type::template staticDim<0>(),
+             B::shape_type::template staticDim<1>()>,
+       A::storageOrder()>::type;
+};
+
+// matrix * vector
+// The output has the storage order of the vector
+template <MatrixNode A, VectorNode B>
+   requires MulOperands<A, B>
+struct MulResult<A, B> {
+   using type = typename MulOutput<
+       A, B, Shape<A::shape_type::template staticDim<0>()>,
+       B::storageOrder()>::type;
+};
+
+// sparse matrix * vector
+// The output is a dense vector
+template <traits::SparseNode A, VectorNode B> struct MulResult<A, B> {
+   using value_type =
+       std::common_type_t<typename A::value_type, typename B::value_type>;
+   using shape_type = ::ten::DynamicShape<1>;
+   using storage_type = ::ten::DefaultStorage<value_type, shape_type>;
+   using type =
+       TensorNode<value_type, shape_type, B::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+
+// sparse matrix * matrix
+// The output is a dense matrix of the storage order of the right operand
+template <traits::SparseNode A, MatrixNode B> struct MulResult<A, B> {
+   using value_type =
+       std::common_type_t<typename A::value_type, typename B::value_type>;
+   using shape_type = ::ten::DynamicShape<2>;
+   using storage_type = ::ten::DefaultStorage<value_type, shape_type>;
+   using type =
+       TensorNode<value_type, shape_type, B::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+
+// diagonal or triangular matrix * matrix or vector
+// The output is dense, of the storage order of the right operand
+template <traits::StructuredNode A, class B>
+   requires(MatrixNode<B> || VectorNode<B>)
+struct MulResult<A, B> {
+   using value_type =
+       std::common_type_t<typename A::value_type, typename B::value_type>;
+   using shape_type = ::ten::DynamicShape<B::shape_type::rank()>;
+   using storage_type = ::ten::DefaultStorage<value_type, shape_type>;
+   using type =
+       TensorNode<value_type, shape_type, B::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+
+// matrix * diagonal matrix
+// The output is a dense matrix of the storage order of the left operand
+template <MatrixNode A, traits::DiagonalNode B> struct MulResult<A, B> {
    using value_type =
        std::common_type_t<typename A::value_type, typename B::value_type>;
-   using type = TensorNode<value_type,
-                           Shape<A::shape_type::template staticDim<0>(),
-                                 B::shape_type::template staticDim<1>()>,
-                           A::storageOrder(), typename A::storage_type,
-                           typename A::allocator_type>;
+   using shape_type = ::ten::DynamicShape<2>;
+   using storage_type = ::ten::DefaultStorage<value_type, shape_type>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+
+// diagonal matrix * diagonal matrix
+template <traits::DiagonalNode A, traits::DiagonalNode B>
+   requires std::same_as<A, B>
+struct MulResult<A, B> {
+   using type = A;
 };
 
 // scalar * tensor
@@ -169,11 +666,13 @@ template <traits::ScalarNode A, traits::TensorNode B> struct MulResult<A, B> {
 template <class A, class B, class C = typename details::MulResult<A, B>::type>
 struct Mul;
 
-// vector * vector
-template <VectorNode X, VectorNode Y, VectorNode Z> struct Mul<X, Y, Z> {
+// elementwise tensor * tensor
+template <class X, class Y, class Z>
+   requires details::ElementwiseMul<X, Y>
+struct Mul<X, Y, Z> {
 
-   template <VectorNode A, VectorNode B,
-             VectorNode C = typename details::MulResult<A, B>::type>
+   template <class A, class B,
+             class C = typename details::MulResult<A, B>::type>
    using Func = BinaryFunc<::ten::BinaryOperation::mul>::Func<A, B, C>;
 };
 
@@ -182,7 +681,7 @@ template <MatrixNode X, MatrixNode Y, MatrixNode Z> struct Mul<X, Y, Z> {
 
    template <MatrixNode A, MatrixNode B,
              MatrixNode C = typename details::MulResult<A, B>::type>
-   struct Func : ::ten::functional::Func<> {
+   struct Func : ::ten::functional::Func<>, Strided {
       using output_type = C;
 
       static C::shape_type outputShape(const A::shape_type &left,
@@ -198,26 +697,332 @@ template <MatrixNode X, MatrixNode Y, MatrixNode Z> struct Mul<X, Y, Z> {
    };
 };
 
+// matrix * vector
+template <MatrixNode X, VectorNode Y, VectorNode Z> struct Mul<X, Y, Z> {
+
+   template <MatrixNode A, VectorNode B,
+             VectorNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &) {
+         std::initializer_list<size_type> &&dims = {left.dim(0)};
+         typename C::shape_type s(std::move(dims));
+         return s;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::mul(left, right, result);
+      }
+   };
+};
+
 // scalar * tensor
 template <traits::ScalarNode X, traits::TensorNode Y, traits::TensorNode Z>
 struct Mul<X, Y, Z> {
 
    template <traits::ScalarNode A, traits::TensorNode B,
              traits::TensorNode C = typename details::MulResult<A, B>::type>
-   struct Func : ::ten::functional::Func<> {
+   struct Func : ::ten::functional::Func<>, Elementwise {
       using output_type = C;
 
+      template <class V> static V apply(const V &a, const V &b) {
+         return a * b;
+      }
+
       static C::shape_type outputShape(const B::shape_type &right) {
          return right;
       }
 
       static void operator()(const A &left, const B &right, C &result) {
-         size_t n = result.size();
          using value_type = typename C::value_type;
-         for (size_t i = 0; i < n; i++) {
-            result[i] = static_cast<value_type>(left.value()) *
-                        static_cast<value_type>(right[i]);
+         value_type alpha = static_cast<value_type>(left.value());
+         ::ten::kernels::unaryOps(right, result, [alpha](const auto &x) {
+            using V = std::remove_cvref_t<decltype(x)>;
+            return V(alpha) * x;
+         });
+      }
+   };
+};
+
+// sparse matrix * vector
+template <traits::SparseNode X, VectorNode Y, VectorNode Z>
+struct Mul<X, Y, Z> {
+
+   template <traits::SparseNode A, VectorNode B,
+             VectorNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         if (left.dim(1) != right.dim(0)) {
+            throw std::invalid_argument(
+                "Tenseur: Sparse matrix vector product of incompatible "
+                "shapes.");
          }
+         std::initializer_list<size_type> &&dims = {left.dim(0)};
+         typename C::shape_type s(std::move(dims));
+         return s;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::spmv(left, right, result);
+      }
+   };
+};
+
+// sparse matrix * matrix
+template <traits::SparseNode X, MatrixNode Y, MatrixNode Z>
+struct Mul<X, Y, Z> {
+
+   template <traits::SparseNode A, MatrixNode B,
+             MatrixNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         if (left.dim(1) != right.dim(0)) {
+            throw std::invalid_argument(
+                "Tenseur: Sparse matrix product of incompatible shapes.");
+         }
+         std::initializer_list<size_type> &&dims = {left.dim(0),
+                                                    right.dim(1)};
+         typename C::shape_type s(std::move(dims));
+         return s;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::spmm(left, right, result);
+      }
+   };
+};
+
+// scalar * sparse matrix
+template <traits::ScalarNode X, traits::SparseNode Y, traits::SparseNode Z>
+struct Mul<X, Y, Z> {
+
+   template <traits::ScalarNode A, traits::SparseNode B,
+             traits::SparseNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const B::shape_type &right) {
+         return right;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::sparseScale(left.value(), right, result);
+      }
+   };
+};
+
+// diagonal or triangular matrix * matrix or vector
+template <traits::StructuredNode X, class Y, class Z>
+   requires(MatrixNode<Y> || VectorNode<Y>)
+struct Mul<X, Y, Z> {
+
+   template <traits::StructuredNode A, class B,
+             class C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         if (left.dim(1) != right.dim(0)) {
+            throw std::invalid_argument(
+                "Tenseur: Structured matrix product of incompatible shapes.");
+         }
+         if constexpr (B::isVector()) {
+            std::initializer_list<size_type> &&dims = {left.dim(0)};
+            typename C::shape_type s(std::move(dims));
+            return s;
+         } else {
+            std::initializer_list<size_type> &&dims = {left.dim(0),
+                                                       right.dim(1)};
+            typename C::shape_type s(std::move(dims));
+            return s;
+         }
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         if constexpr (traits::DiagonalNode<A>) {
+            kernels::diagonalMul(left, right, result);
+         } else {
+            kernels::triangularMul(left, right, result);
+         }
+      }
+   };
+};
+
+// matrix * diagonal matrix
+template <MatrixNode X, traits::DiagonalNode Y, MatrixNode Z>
+struct Mul<X, Y, Z> {
+
+   template <MatrixNode A, traits::DiagonalNode B,
+             MatrixNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         if (left.dim(1) != right.dim(0)) {
+            throw std::invalid_argument(
+                "Tenseur: Diagonal matrix product of incompatible shapes.");
+         }
+         std::initializer_list<size_type> &&dims = {left.dim(0),
+                                                    right.dim(1)};
+         typename C::shape_type s(std::move(dims));
+         return s;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::diagonalMulRight(left, right, result);
+      }
+   };
+};
+
+// diagonal matrix * diagonal matrix
+template <traits::DiagonalNode X, traits::DiagonalNode Y,
+          traits::DiagonalNode Z>
+struct Mul<X, Y, Z> {
+
+   template <traits::DiagonalNode A, traits::DiagonalNode B,
+             traits::DiagonalNode C = typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         if (!(left == right)) {
+            throw std::invalid_argument(
+                "Tenseur: Diagonal matrices of different shapes.");
+         }
+         return left;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::packedBinaryOps<::ten::BinaryOperation::mul>(left, right,
+                                                               result);
+      }
+   };
+};
+
+// scalar * diagonal or triangular matrix
+template <traits::ScalarNode X, traits::StructuredNode Y,
+          traits::StructuredNode Z>
+struct Mul<X, Y, Z> {
+
+   template <traits::ScalarNode A, traits::StructuredNode B,
+             traits::StructuredNode C =
+                 typename details::MulResult<A, B>::type>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const B::shape_type &right) {
+         return right;
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::packedScale(left.value(), right, result);
+      }
+   };
+};
+
+namespace details {
+// Dense operands of a batched matrix product
+// Tensors of rank two or more of the same storage order, a matrix being
+// broadcast over the batch of the other operand.
+template <class A, class B>
+concept BatchMulOperands =
+    traits::TensorNode<A> && traits::TensorNode<B> &&
+    !traits::SparseNode<A> && !traits::SparseNode<B> &&
+    !traits::StructuredNode<A> && !traits::StructuredNode<B> &&
+    A::shape_type::rank() >= 2 && B::shape_type::rank() >= 2 &&
+    (A::shape_type::rank() == B::shape_type::rank() ||
+     A::shape_type::rank() == 2 || B::shape_type::rank() == 2) &&
+    A::storageOrder() == B::storageOrder();
+
+// Output node of a batched matrix product
+template <class A, class B> struct BatchMulResult {
+   using value_type =
+       std::common_type_t<typename A::value_type, typename B::value_type>;
+   using shape_type = ::ten::DynamicShape<std::max(A::shape_type::rank(),
+                                                   B::shape_type::rank())>;
+   using storage_type = ::ten::DefaultStorage<value_type, shape_type>;
+   using type =
+       TensorNode<value_type, shape_type, A::storageOrder(), storage_type,
+                  typename ::ten::details::AllocatorType<storage_type>::type>;
+};
+} // namespace details
+
+// Batched matrix product
+template <class X, class Y> struct BatchMul {
+
+   template <class A, class B,
+             class C = typename details::BatchMulResult<A, B>::type>
+      requires details::BatchMulOperands<A, B>
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         constexpr size_type rank = C::shape_type::rank();
+         constexpr size_type rankA = A::shape_type::rank();
+         constexpr size_type rankB = B::shape_type::rank();
+         constexpr size_type row =
+             kernels::details::batchMatrixDim<C::storageOrder(), rank>();
+         constexpr size_type rowA =
+             kernels::details::batchMatrixDim<A::storageOrder(), rankA>();
+         constexpr size_type rowB =
+             kernels::details::batchMatrixDim<B::storageOrder(), rankB>();
+         if (left.dim(rowA + 1) != right.dim(rowB)) {
+            throw std::invalid_argument(
+                "Tenseur: Batched matrix product of incompatible shapes.");
+         }
+         std::array<size_type, rank> dims{};
+         dims[row] = left.dim(rowA);
+         dims[row + 1] = right.dim(rowB + 1);
+         for (size_type i = 0; i < rank; i++) {
+            if (i == row || i == row + 1) {
+               continue;
+            }
+            size_type dimA = rankA == rank ? left.dim(i) : 1;
+            size_type dimB = rankB == rank ? right.dim(i) : 1;
+            if (dimA != dimB && dimA != 1 && dimB != 1) {
+               throw std::invalid_argument(
+                   "Tenseur: Batched matrix product of different batch "
+                   "shapes.");
+            }
+            dims[i] = dimA == 1 ? dimB : dimA;
+         }
+         return typename C::shape_type(dims);
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::batchMul(left, right, result);
+      }
+   };
+};
+
+// Solve of a triangular system a * x = b
+template <class X, class Y> struct TriangularSolve {
+
+   template <traits::TriangularNode A, class B,
+             class C = typename details::MulResult<A, B>::type>
+      requires(MatrixNode<B> || VectorNode<B>)
+   struct Func : ::ten::functional::Func<>, Strided {
+      using output_type = C;
+
+      static C::shape_type outputShape(const A::shape_type &left,
+                                       const B::shape_type &right) {
+         return Mul<A, B>::template Func<A, B, C>::outputShape(left, right);
+      }
+
+      static void operator()(const A &left, const B &right, C &result) {
+         kernels::triangularSolve(left, right, result);
       }
    };
 };
@@ -240,7 +1045,15 @@ template <class S> struct StaticReshape {
       using output_type = B;
 
       static void operator()(const A &left, B &right) {
-         right = B(left.storage());
+         if constexpr (::ten::stack::isInlineNode<A>::value) {
+            // Storage held by value
+            std::copy_n(left.data(), left.size(), right.data());
+         } else if (left.offset() == 0) {
+            right = B(left.storage());
+         } else {
+            // View starting inside its storage
+            std::copy_n(left.data(), left.size(), right.data());
+         }
       }
    };
 };
@@ -252,7 +1065,7 @@ using DimsStaticReshape = StaticReshape<::ten::Shape<dims...>>;
 template <class Shape> struct DynamicReshape {
 
    template <class A, class B = details::ReshapeResult<A, Shape>::type>
-   struct Func : ::ten::functional::Func<true> {
+   struct Func : ::ten::functional::Func<true>, ViewOutput {
     public:
       using output_type = B;
 
@@ -266,7 +1079,12 @@ template <class Shape> struct DynamicReshape {
       B::shape_type outputShape(const A::shape_type &) { return _shape; }
 
       void operator()(const A &left, B &right) {
-         right = B(left.storage(), _shape);
+         if (left.offset() == 0) {
+            right = B(left.storage(), _shape);
+         } else {
+            right = B(left.storage(), _shape, typename B::stride_type(_shape),
+                      left.offset());
+         }
       }
    };
 };
@@ -0,0 +1,13 @@
+/// \file Ten/IO.hxx
+/// Tensor files, the files are mapped in memory using POSIX
+
+#ifndef TENSEUR_IO_HXX
+#define TENSEUR_IO_HXX
+
+#include <Ten/IO/Format.hxx>
+#include <Ten/IO/MappedFile.hxx>
+#include <Ten/IO/Native.hxx>
+#include <Ten/IO/Npy.hxx>
+#include <Ten/IO/Stream.hxx>
+
+#endif
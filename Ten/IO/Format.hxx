@@ -0,0 +1,209 @@
+/// \file Ten/IO/Format.hxx
+
+#ifndef TENSEUR_IO_FORMAT_HXX
+#define TENSEUR_IO_FORMAT_HXX
+
+#include <array>
+#include <bit>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/IO/MappedFile.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::io {
+
+static_assert(std::endian::native == std::endian::little,
+              "Tenseur: The file formats are little endian.");
+
+/// \enum DType
+/// Type of the elements of a tensor file
+enum class DType : std::uint32_t {
+   float32 = 1,
+   float64,
+   int8,
+   int16,
+   int32,
+   int64,
+   uint8,
+   uint16,
+   uint32,
+   uint64,
+   complex64,
+   complex128,
+   boolean
+};
+
+namespace details {
+// Type code and NumPy type string of a value type
+template <class T> struct DTypeOf;
+
+#define TENSEUR_IO_DTYPE(type, code, descr)                                    \
+   template <> struct DTypeOf<type> {                                          \
+      static constexpr DType value = DType::code;                              \
+      static constexpr const char *numpy = descr;                              \
+   };
+
+TENSEUR_IO_DTYPE(float, float32, "<f4")
+TENSEUR_IO_DTYPE(double, float64, "<f8")
+TENSEUR_IO_DTYPE(std::int8_t, int8, "|i1")
+TENSEUR_IO_DTYPE(std::int16_t, int16, "<i2")
+TENSEUR_IO_DTYPE(std::int32_t, int32, "<i4")
+TENSEUR_IO_DTYPE(std::int64_t, int64, "<i8")
+TENSEUR_IO_DTYPE(std::uint8_t, uint8, "|u1")
+TENSEUR_IO_DTYPE(std::uint16_t, uint16, "<u2")
+TENSEUR_IO_DTYPE(std::uint32_t, uint32, "<u4")
+TENSEUR_IO_DTYPE(std::uint64_t, uint64, "<u8")
+TENSEUR_IO_DTYPE(std::complex<float>, complex64, "<c8")
+TENSEUR_IO_DTYPE(std::complex<double>, complex128, "<c16")
+TENSEUR_IO_DTYPE(bool, boolean, "|b1")
+
+#undef TENSEUR_IO_DTYPE
+
+// Product of two sizes read from a file
+// Throws std::runtime_error when it overflows.
+inline size_type checkedMul(size_type a, size_type b) {
+   if (b != 0 && a > std::numeric_limits<size_type>::max() / b) {
+      throw std::runtime_error(
+          "Tenseur: The number of elements of the tensor overflows.");
+   }
+   return a * b;
+}
+} // namespace details
+
+/// \class TensorHeader
+/// Type, shape and storage order of a tensor stored in a file, and the offset
+/// of its elements in the file
+struct TensorHeader {
+   DType dtype = DType::float32;
+   std::vector<size_type> shape;
+   StorageOrder order = StorageOrder::ColMajor;
+   std::size_t offset = 0;
+
+   /// Returns the number of elements
+   /// Throws std::runtime_error when it overflows.
+   [[nodiscard]] size_type size() const {
+      size_type n = 1;
+      for (auto dim : shape) {
+         n = details::checkedMul(n, dim);
+      }
+      return n;
+   }
+};
+
+namespace details {
+// Check the header of a file against the tensor type T
+template <class T>
+void checkHeader(const TensorHeader &header, const std::string &path) {
+   using value_type = typename T::value_type;
+   using shape_type = typename T::shape_type;
+   if (header.dtype != DTypeOf<value_type>::value) {
+      throw std::runtime_error("Tenseur: " + path +
+                               " has elements of another type.");
+   }
+   if (header.shape.size() != shape_type::rank()) {
+      throw std::runtime_error("Tenseur: " + path + " has a tensor of rank " +
+                               std::to_string(header.shape.size()) +
+                               ", expected " +
+                               std::to_string(shape_type::rank()) + ".");
+   }
+   if (header.order != T::storageOrder() && header.shape.size() > 1) {
+      throw std::runtime_error("Tenseur: " + path +
+                               " has a tensor of another storage order.");
+   }
+   if constexpr (shape_type::isStatic()) {
+      for (size_type i = 0; i < shape_type::rank(); i++) {
+         if (header.shape[i] != shape_type().dim(i)) {
+            throw std::runtime_error("Tenseur: " + path +
+                                     " has a tensor of another shape.");
+         }
+      }
+   }
+}
+
+// Header of a tensor
+template <class T> TensorHeader tensorHeader(const T &x) {
+   TensorHeader header;
+   header.dtype = DTypeOf<typename T::value_type>::value;
+   header.order = T::storageOrder();
+   for (size_type i = 0; i < T::shape_type::rank(); i++) {
+      header.shape.push_back(x.dim(i));
+   }
+   return header;
+}
+
+// Tensor over the elements of a mapped file
+// Dynamic dense tensors use the mapped pages as their storage when the
+// elements are aligned for the simd kernels, other tensors are copied.
+template <class T>
+T mapTensor(const TensorHeader &header,
+            const std::shared_ptr<MappedFile> &file, const std::string &path) {
+   using value_type = typename T::value_type;
+   using shape_type = typename T::shape_type;
+   using storage_type = typename T::storage_type;
+   using node_type = typename T::node_type;
+   checkHeader<T>(header, path);
+   const size_type size = header.size();
+   if (header.offset > file->size() ||
+       size > (file->size() - header.offset) / sizeof(value_type)) {
+      throw std::runtime_error("Tenseur: " + path + " is truncated.");
+   }
+   std::byte *ptr = file->data() + header.offset;
+   if constexpr (shape_type::isDynamic()) {
+      std::array<size_type, shape_type::rank()> dims;
+      for (size_type i = 0; i < shape_type::rank(); i++) {
+         dims[i] = header.shape[i];
+      }
+      shape_type shape(dims);
+      if constexpr (std::is_constructible_v<storage_type, value_type *,
+                                            size_type, std::shared_ptr<void>>) {
+         if (reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0) {
+            auto storage = std::make_shared<storage_type>(
+                reinterpret_cast<value_type *>(ptr), size, file);
+            return T(std::make_shared<node_type>(storage, shape));
+         }
+      }
+      T x(shape);
+      std::memcpy(x.data(), ptr, size * sizeof(value_type));
+      return x;
+   } else {
+      T x;
+      std::memcpy(x.data(), ptr, size * sizeof(value_type));
+      return x;
+   }
+}
+
+// Write the elements of a tensor in its storage order
+// Write is called with contiguous blocks of bytes.
+template <class T, class Write> void writeElements(const T &x, Write &&write) {
+   using value_type = typename T::value_type;
+   if (x.isContiguous()) {
+      write(reinterpret_cast<const char *>(x.data()),
+            x.size() * sizeof(value_type));
+      return;
+   }
+   // Non contiguous views are gathered by blocks
+   constexpr size_type blockSize = 4096;
+   std::vector<value_type> block;
+   block.reserve(blockSize);
+   for (size_type i = 0; i < x.size(); i++) {
+      block.push_back(x[i]);
+      if (block.size() == blockSize || i + 1 == x.size()) {
+         write(reinterpret_cast<const char *>(block.data()),
+               block.size() * sizeof(value_type));
+         block.clear();
+      }
+   }
+}
+} // namespace details
+
+} // namespace ten::io
+
+#endif
@@ -0,0 +1,85 @@
+/// \file Ten/IO/MappedFile.hxx
+
+#ifndef TENSEUR_IO_MAPPED_FILE_HXX
+#define TENSEUR_IO_MAPPED_FILE_HXX
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ten::io {
+
+/// \enum MapMode
+/// Access to a memory mapped file
+enum class MapMode {
+   /// Shared read only pages, writing to the tensor is an error
+   ReadOnly,
+   /// Private pages, written pages are copied and the file isn't modified
+   CopyOnWrite
+};
+
+/// \class MappedFile
+/// File mapped in memory, the pages are read on demand
+class MappedFile {
+ private:
+   void *_data = nullptr;
+   std::size_t _size = 0;
+
+ public:
+   /// Map the file at path
+   /// Throws std::runtime_error when the file can't be opened or mapped.
+   explicit MappedFile(const std::string &path,
+                       MapMode mode = MapMode::ReadOnly) {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+         throw std::runtime_error("Tenseur: Cannot open " + path + ": " +
+                                  std::strerror(errno));
+      }
+      struct stat info;
+      if (::fstat(fd, &info) != 0) {
+         ::close(fd);
+         throw std::runtime_error("Tenseur: Cannot stat " + path);
+      }
+      _size = static_cast<std::size_t>(info.st_size);
+      if (_size > 0) {
+         int prot = mode == MapMode::ReadOnly ? PROT_READ
+                                              : (PROT_READ | PROT_WRITE);
+         int flags = mode == MapMode::ReadOnly ? MAP_SHARED : MAP_PRIVATE;
+         _data = ::mmap(nullptr, _size, prot, flags, fd, 0);
+      }
+      ::close(fd);
+      if (_data == MAP_FAILED) {
+         _data = nullptr;
+         throw std::runtime_error("Tenseur: Cannot map " + path + ": " +
+                                  std::strerror(errno));
+      }
+   }
+
+   MappedFile(const MappedFile &) = delete;
+   MappedFile &operator=(const MappedFile &) = delete;
+
+   ~MappedFile() {
+      if (_data) {
+         ::munmap(_data, _size);
+      }
+   }
+
+   /// Returns the address of the first byte of the file
+   [[nodiscard]] std::byte *data() const {
+      return static_cast<std::byte *>(_data);
+   }
+
+   /// Returns the size of the file in bytes
+   [[nodiscard]] std::size_t size() const { return _size; }
+};
+
+} // namespace ten::io
+
+#endif
@@ -0,0 +1,133 @@
+/// \file Ten/IO/Native.hxx
+
+#ifndef TENSEUR_IO_NATIVE_HXX
+#define TENSEUR_IO_NATIVE_HXX
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Ten/IO/Format.hxx>
+#include <Ten/IO/MappedFile.hxx>
+
+namespace ten::io {
+
+// Native tensor files
+// The header is the magic "TENSEUR\0", the version, the type of the elements,
+// the storage order and the rank as 32 bits integers, then the dimensions as
+// 64 bits integers. It is padded with zeros to a multiple of 64 bytes so that
+// the elements of a mapped file are aligned for the simd kernels.
+namespace details {
+static constexpr char nativeMagic[8] = {'T', 'E', 'N', 'S',
+                                        'E', 'U', 'R', '\0'};
+static constexpr std::uint32_t nativeVersion = 1;
+static constexpr std::size_t nativeAlignment = 64;
+
+inline std::size_t nativeHeaderSize(std::size_t rank) {
+   std::size_t size = sizeof(nativeMagic) + 4 * sizeof(std::uint32_t) +
+                      rank * sizeof(std::uint64_t);
+   return (size + nativeAlignment - 1) / nativeAlignment * nativeAlignment;
+}
+
+inline TensorHeader parseNativeHeader(const std::byte *data, std::size_t size,
+                                      const std::string &path) {
+   constexpr std::size_t prefix =
+       sizeof(nativeMagic) + 4 * sizeof(std::uint32_t);
+   if (size < prefix || std::memcmp(data, nativeMagic, sizeof(nativeMagic))) {
+      throw std::runtime_error("Tenseur: " + path + " is not a tensor file.");
+   }
+   std::uint32_t fields[4];
+   std::memcpy(fields, data + sizeof(nativeMagic), sizeof(fields));
+   if (fields[0] != nativeVersion) {
+      throw std::runtime_error("Tenseur: " + path +
+                               " has an unsupported version.");
+   }
+   if (fields[1] < static_cast<std::uint32_t>(DType::float32) ||
+       fields[1] > static_cast<std::uint32_t>(DType::boolean) ||
+       fields[2] > 1) {
+      throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+   }
+   TensorHeader header;
+   header.dtype = static_cast<DType>(fields[1]);
+   header.order =
+       fields[2] == 0 ? StorageOrder::ColMajor : StorageOrder::RowMajor;
+   header.offset = nativeHeaderSize(fields[3]);
+   if (size < header.offset) {
+      throw std::runtime_error("Tenseur: " + path + " is truncated.");
+   }
+   header.shape.resize(fields[3]);
+   for (std::size_t i = 0; i < fields[3]; i++) {
+      std::uint64_t dim;
+      std::memcpy(&dim, data + prefix + i * sizeof(dim), sizeof(dim));
+      header.shape[i] = dim;
+   }
+   // Throws when the number of elements overflows
+   static_cast<void>(header.size());
+   return header;
+}
+
+inline std::string nativeHeader(const TensorHeader &info) {
+   const std::size_t rank = info.shape.size();
+   std::string header(nativeHeaderSize(rank), '\0');
+   char *data = header.data();
+   std::memcpy(data, nativeMagic, sizeof(nativeMagic));
+   std::uint32_t fields[4] = {
+       nativeVersion, static_cast<std::uint32_t>(info.dtype),
+       info.order == StorageOrder::ColMajor ? 0u : 1u,
+       static_cast<std::uint32_t>(rank)};
+   std::memcpy(data + sizeof(nativeMagic), fields, sizeof(fields));
+   for (std::size_t i = 0; i < rank; i++) {
+      std::uint64_t dim = info.shape[i];
+      std::memcpy(data + sizeof(nativeMagic) + sizeof(fields) +
+                      i * sizeof(dim),
+                  &dim, sizeof(dim));
+   }
+   return header;
+}
+} // namespace details
+
+/// \fn readHeader
+/// Read the header of a tensor file
+inline TensorHeader readHeader(const std::string &path) {
+   MappedFile file(path);
+   return details::parseNativeHeader(file.data(), file.size(), path);
+}
+
+/// \fn load
+/// Load a tensor of type T from a tensor file
+/// The file is mapped in memory and the pages are read on demand. The type,
+/// the rank, the storage order and the static dimensions of T must match the
+/// header, otherwise std::runtime_error is thrown.
+template <class T>
+   requires ::ten::isDenseTensor<T>::value
+T load(const std::string &path, MapMode mode = MapMode::CopyOnWrite) {
+   auto file = std::make_shared<MappedFile>(path, mode);
+   auto header = details::parseNativeHeader(file->data(), file->size(), path);
+   return details::mapTensor<T>(header, file, path);
+}
+
+/// \fn save
+/// Save a tensor to a tensor file
+template <class T>
+   requires ::ten::isDenseTensor<T>::value
+void save(const std::string &path, const T &x) {
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot open " + path + ".");
+   }
+   std::string header = details::nativeHeader(details::tensorHeader(x));
+   file.write(header.data(), header.size());
+   details::writeElements(
+       x, [&](const char *data, std::size_t size) { file.write(data, size); });
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot write " + path + ".");
+   }
+}
+
+} // namespace ten::io
+
+#endif
@@ -0,0 +1,571 @@
+/// \file Ten/IO/Npy.hxx
+
+#ifndef TENSEUR_IO_NPY_HXX
+#define TENSEUR_IO_NPY_HXX
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Ten/IO/Format.hxx>
+#include <Ten/IO/MappedFile.hxx>
+
+namespace ten::io {
+
+namespace details {
+// NumPy type strings
+inline DType npyDType(const std::string &descr) {
+   static const std::array<std::pair<const char *, DType>, 16> types{{
+       {"<f4", DType::float32},
+       {"<f8", DType::float64},
+       {"|i1", DType::int8},
+       {"<i1", DType::int8},
+       {"<i2", DType::int16},
+       {"<i4", DType::int32},
+       {"<i8", DType::int64},
+       {"|u1", DType::uint8},
+       {"<u1", DType::uint8},
+       {"<u2", DType::uint16},
+       {"<u4", DType::uint32},
+       {"<u8", DType::uint64},
+       {"<c8", DType::complex64},
+       {"<c16", DType::complex128},
+       {"|b1", DType::boolean},
+       {"<b1", DType::boolean},
+   }};
+   for (const auto &[name, dtype] : types) {
+      if (descr == name) {
+         return dtype;
+      }
+   }
+   throw std::runtime_error("Tenseur: Unsupported npy type " + descr + ".");
+}
+
+inline const char *npyDescr(DType dtype) {
+   switch (dtype) {
+   case DType::float32:
+      return "<f4";
+   case DType::float64:
+      return "<f8";
+   case DType::int8:
+      return "|i1";
+   case DType::int16:
+      return "<i2";
+   case DType::int32:
+      return "<i4";
+   case DType::int64:
+      return "<i8";
+   case DType::uint8:
+      return "|u1";
+   case DType::uint16:
+      return "<u2";
+   case DType::uint32:
+      return "<u4";
+   case DType::uint64:
+      return "<u8";
+   case DType::complex64:
+      return "<c8";
+   case DType::complex128:
+      return "<c16";
+   case DType::boolean:
+      return "|b1";
+   }
+   return "";
+}
+
+static constexpr char npyMagic[] = "\x93NUMPY";
+static constexpr std::size_t npyMagicSize = 6;
+
+// Returns the value of a key of the header dictionary
+inline std::string npyValue(const std::string &dict, const std::string &key) {
+   auto pos = dict.find("'" + key + "'");
+   if (pos == std::string::npos) {
+      throw std::runtime_error("Tenseur: Missing " + key +
+                               " in the npy header.");
+   }
+   pos = dict.find(':', pos);
+   if (pos == std::string::npos) {
+      throw std::runtime_error("Tenseur: Invalid npy header.");
+   }
+   pos = dict.find_first_not_of(' ', pos + 1);
+   if (pos == std::string::npos) {
+      throw std::runtime_error("Tenseur: Invalid npy header.");
+   }
+   std::size_t end;
+   if (dict[pos] == '\'' || dict[pos] == '(') {
+      end = dict.find(dict[pos] == '(' ? ')' : '\'', pos + 1);
+      if (end == std::string::npos) {
+         throw std::runtime_error("Tenseur: Invalid npy header.");
+      }
+      return dict.substr(pos + 1, end - pos - 1);
+   }
+   end = dict.find_first_of(",}", pos);
+   if (end == std::string::npos) {
+      throw std::runtime_error("Tenseur: Invalid npy header.");
+   }
+   return dict.substr(pos, end - pos);
+}
+
+/// Returns the size of the npy header from its first bytes, at least 12
+/// bytes are read
+inline std::size_t npyHeaderSize(const char *data) {
+   if (std::memcmp(data, npyMagic, npyMagicSize) != 0) {
+      throw std::runtime_error("Tenseur: Not a npy file.");
+   }
+   const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+   std::uint8_t major = bytes[6];
+   if (major == 1) {
+      return 10 + (std::size_t(bytes[8]) | std::size_t(bytes[9]) << 8);
+   }
+   if (major == 2 || major == 3) {
+      std::uint32_t len;
+      std::memcpy(&len, bytes + 8, sizeof(len));
+      return 12 + std::size_t(len);
+   }
+   throw std::runtime_error("Tenseur: Unsupported npy version.");
+}
+
+/// Parse a npy header of size bytes
+inline TensorHeader parseNpyHeader(const char *data, std::size_t size) {
+   std::size_t start = data[6] == 1 ? 10 : 12;
+   std::string dict(data + start, size - start);
+   TensorHeader header;
+   header.dtype = npyDType(npyValue(dict, "descr"));
+   header.order = npyValue(dict, "fortran_order") == "True"
+                      ? StorageOrder::ColMajor
+                      : StorageOrder::RowMajor;
+   std::string shape = npyValue(dict, "shape");
+   std::size_t pos = 0;
+   while (pos < shape.size()) {
+      pos = shape.find_first_of("0123456789", pos);
+      if (pos == std::string::npos) {
+         break;
+      }
+      std::size_t end = shape.find_first_not_of("0123456789", pos);
+      try {
+         header.shape.push_back(std::stoull(shape.substr(pos, end - pos)));
+      } catch (const std::out_of_range &) {
+         throw std::runtime_error("Tenseur: Invalid npy header.");
+      }
+      pos = end;
+   }
+   // Throws when the number of elements overflows
+   static_cast<void>(header.size());
+   header.offset = size;
+   return header;
+}
+
+/// Returns the npy header of a tensor, padded to a multiple of 64 bytes
+inline std::string npyHeader(const TensorHeader &info) {
+   const std::size_t rank = info.shape.size();
+   std::string dict = "{'descr': '";
+   dict += npyDescr(info.dtype);
+   dict += "', 'fortran_order': ";
+   dict += (info.order == StorageOrder::ColMajor) ? "True" : "False";
+   dict += ", 'shape': (";
+   for (std::size_t i = 0; i < rank; i++) {
+      dict += std::to_string(info.shape[i]);
+      if (rank == 1 || i + 1 < rank) {
+         dict += ",";
+      }
+      if (i + 1 < rank) {
+         dict += " ";
+      }
+   }
+   dict += "), }";
+   std::size_t prefix = dict.size() + 1 + 10 > 65535 ? 12 : 10;
+   std::size_t total = (prefix + dict.size() + 1 + 63) / 64 * 64;
+   dict.append(total - prefix - dict.size() - 1, ' ');
+   dict += '\n';
+   std::string header(npyMagic, npyMagicSize);
+   std::uint32_t len = static_cast<std::uint32_t>(dict.size());
+   if (prefix == 10) {
+      header += '\x01';
+      header += '\x00';
+      header += static_cast<char>(len & 0xff);
+      header += static_cast<char>((len >> 8) & 0xff);
+   } else {
+      header += '\x02';
+      header += '\x00';
+      header.append(reinterpret_cast<const char *>(&len), sizeof(len));
+   }
+   return header + dict;
+}
+
+// Crc32 of the zip format
+inline std::uint32_t crc32(std::uint32_t crc, const char *data,
+                           std::size_t size) {
+   static const auto table = [] {
+      std::array<std::uint32_t, 256> t{};
+      for (std::uint32_t i = 0; i < 256; i++) {
+         std::uint32_t c = i;
+         for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+         }
+         t[i] = c;
+      }
+      return t;
+   }();
+   crc = ~crc;
+   for (std::size_t i = 0; i < size; i++) {
+      crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^
+            (crc >> 8);
+   }
+   return ~crc;
+}
+
+template <class T> T readLE(const std::byte *data) {
+   T value;
+   std::memcpy(&value, data, sizeof(T));
+   return value;
+}
+
+// Check that the length bytes at offset are in a file of size bytes
+inline void checkZipRange(std::uint64_t offset, std::uint64_t length,
+                          std::size_t size, const std::string &path) {
+   if (offset > size || length > size - offset) {
+      throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+   }
+}
+
+// Member of a zip archive
+struct ZipMember {
+   std::string name;
+   std::uint16_t method;
+   std::uint64_t size;
+   std::uint64_t offset;
+};
+
+// Read the central directory of a zip archive
+inline std::vector<ZipMember> zipMembers(const MappedFile &file,
+                                         const std::string &path) {
+   const std::byte *data = file.data();
+   const std::size_t size = file.size();
+   // End of central directory, followed by a comment of at most 64KB
+   if (size < 22) {
+      throw std::runtime_error("Tenseur: " + path + " is not a npz file.");
+   }
+   std::size_t eocd = size - 22;
+   const std::size_t stop = size > 22 + 65535 ? size - 22 - 65535 : 0;
+   while (readLE<std::uint32_t>(data + eocd) != 0x06054b50) {
+      if (eocd == stop) {
+         throw std::runtime_error("Tenseur: " + path + " is not a npz file.");
+      }
+      eocd--;
+   }
+   std::uint64_t count = readLE<std::uint16_t>(data + eocd + 10);
+   std::uint64_t directory = readLE<std::uint32_t>(data + eocd + 16);
+   // Zip64 end of central directory
+   if (directory == 0xffffffff && eocd >= 20 &&
+       readLE<std::uint32_t>(data + eocd - 20) == 0x07064b50) {
+      std::uint64_t eocd64 = readLE<std::uint64_t>(data + eocd - 12);
+      checkZipRange(eocd64, 56, size, path);
+      if (readLE<std::uint32_t>(data + eocd64) != 0x06064b50) {
+         throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+      }
+      count = readLE<std::uint64_t>(data + eocd64 + 32);
+      directory = readLE<std::uint64_t>(data + eocd64 + 48);
+   }
+   // Each entry of the central directory has at least 46 bytes
+   checkZipRange(directory, 0, size, path);
+   if (count > (size - directory) / 46) {
+      throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+   }
+   std::vector<ZipMember> members;
+   std::size_t pos = directory;
+   for (std::uint64_t i = 0; i < count; i++) {
+      checkZipRange(pos, 46, size, path);
+      if (readLE<std::uint32_t>(data + pos) != 0x02014b50) {
+         throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+      }
+      ZipMember member;
+      member.method = readLE<std::uint16_t>(data + pos + 10);
+      member.size = readLE<std::uint32_t>(data + pos + 24);
+      std::uint16_t nameSize = readLE<std::uint16_t>(data + pos + 28);
+      std::uint16_t extraSize = readLE<std::uint16_t>(data + pos + 30);
+      std::uint16_t commentSize = readLE<std::uint16_t>(data + pos + 32);
+      member.offset = readLE<std::uint32_t>(data + pos + 42);
+      checkZipRange(pos + 46,
+                    std::uint64_t(nameSize) + extraSize + commentSize, size,
+                    path);
+      member.name.assign(reinterpret_cast<const char *>(data + pos + 46),
+                         nameSize);
+      // Zip64 extra field with the sizes and the offset
+      std::size_t extra = pos + 46 + nameSize;
+      std::size_t extraEnd = extra + extraSize;
+      while (extra + 4 <= extraEnd) {
+         std::uint16_t id = readLE<std::uint16_t>(data + extra);
+         std::uint16_t len = readLE<std::uint16_t>(data + extra + 2);
+         std::size_t fieldEnd = extra + 4 + len;
+         if (fieldEnd > extraEnd) {
+            throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+         }
+         if (id == 0x0001) {
+            std::size_t field = extra + 4;
+            if (member.size == 0xffffffff) {
+               checkZipRange(field, 8, fieldEnd, path);
+               member.size = readLE<std::uint64_t>(data + field);
+               field += 8;
+            }
+            if (readLE<std::uint32_t>(data + pos + 20) == 0xffffffff) {
+               field += 8;
+            }
+            if (member.offset == 0xffffffff) {
+               checkZipRange(field, 8, fieldEnd, path);
+               member.offset = readLE<std::uint64_t>(data + field);
+            }
+         }
+         extra = fieldEnd;
+      }
+      members.push_back(member);
+      pos = extraEnd + commentSize;
+   }
+   return members;
+}
+} // namespace details
+
+/// \fn readNpyHeader
+/// Read the header of a npy file
+/// Throws std::runtime_error when the file isn't a valid npy file.
+inline TensorHeader readNpyHeader(const std::string &path) {
+   std::ifstream file(path, std::ios::binary);
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot open " + path + ".");
+   }
+   std::array<char, 12> prefix{};
+   file.read(prefix.data(), prefix.size());
+   if (file.gcount() < 10) {
+      throw std::runtime_error("Tenseur: " + path + " is not a npy file.");
+   }
+   std::size_t size = details::npyHeaderSize(prefix.data());
+   std::string header(size, '\0');
+   file.seekg(0);
+   file.read(header.data(), size);
+   if (static_cast<std::size_t>(file.gcount()) != size) {
+      throw std::runtime_error("Tenseur: " + path + " is truncated.");
+   }
+   return details::parseNpyHeader(header.data(), size);
+}
+
+/// \fn loadNpy
+/// Load a tensor of type T from a npy file
+/// The file is mapped in memory and the pages are read on demand. The type,
+/// the rank, the storage order and the static dimensions of T must match the
+/// header, otherwise std::runtime_error is thrown.
+template <class T>
+   requires ::ten::isDenseTensor<T>::value
+T loadNpy(const std::string &path, MapMode mode = MapMode::CopyOnWrite) {
+   auto file = std::make_shared<MappedFile>(path, mode);
+   if (file->size() < 12) {
+      throw std::runtime_error("Tenseur: " + path + " is not a npy file.");
+   }
+   const char *data = reinterpret_cast<const char *>(file->data());
+   std::size_t size = details::npyHeaderSize(data);
+   if (size > file->size()) {
+      throw std::runtime_error("Tenseur: " + path + " is truncated.");
+   }
+   return details::mapTensor<T>(details::parseNpyHeader(data, size), file,
+                                path);
+}
+
+/// \fn saveNpy
+/// Save a tensor to a npy file
+template <class T>
+   requires ::ten::isDenseTensor<T>::value
+void saveNpy(const std::string &path, const T &x) {
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot open " + path + ".");
+   }
+   std::string header = details::npyHeader(details::tensorHeader(x));
+   file.write(header.data(), header.size());
+   details::writeElements(
+       x, [&](const char *data, std::size_t size) { file.write(data, size); });
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot write " + path + ".");
+   }
+}
+
+/// \fn npzNames
+/// Returns the names of the arrays of a npz file
+inline std::vector<std::string> npzNames(const std::string &path) {
+   MappedFile file(path);
+   std::vector<std::string> names;
+   for (const auto &member : details::zipMembers(file, path)) {
+      std::string name = member.name;
+      if (name.size() > 4 && name.substr(name.size() - 4) == ".npy") {
+         name.resize(name.size() - 4);
+      }
+      names.push_back(name);
+   }
+   return names;
+}
+
+/// \fn loadNpz
+/// Load the array name of an uncompressed npz file as a tensor of type T
+/// The archive is mapped in memory. Compressed archives and arrays of another
+/// type than T throw std::runtime_error.
+template <class T>
+   requires ::ten::isDenseTensor<T>::value
+T loadNpz(const std::string &path, const std::string &name,
+          MapMode mode = MapMode::CopyOnWrite) {
+   auto file = std::make_shared<MappedFile>(path, mode);
+   for (const auto &member : details::zipMembers(*file, path)) {
+      if (member.name != name + ".npy" && member.name != name) {
+         continue;
+      }
+      if (member.method != 0) {
+         throw std::runtime_error("Tenseur: " + path +
+                                  " is compressed, only stored npz files "
+                                  "are supported.");
+      }
+      details::checkZipRange(member.offset, 30, file->size(), path);
+      const std::byte *local = file->data() + member.offset;
+      if (details::readLE<std::uint32_t>(local) != 0x04034b50) {
+         throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+      }
+      std::size_t start = member.offset + 30 +
+                          details::readLE<std::uint16_t>(local + 26) +
+                          details::readLE<std::uint16_t>(local + 28);
+      // The array, starting with the longest npy prefix, is in the file
+      details::checkZipRange(start, std::max<std::uint64_t>(member.size, 12),
+                             file->size(), path);
+      const char *data = reinterpret_cast<const char *>(file->data() + start);
+      std::size_t size = details::npyHeaderSize(data);
+      if (size > member.size) {
+         throw std::runtime_error("Tenseur: " + path + " is corrupted.");
+      }
+      auto header = details::parseNpyHeader(data, size);
+      header.offset += start;
+      return details::mapTensor<T>(header, file, path + ":" + name);
+   }
+   throw std::runtime_error("Tenseur: " + path + " has no array " + name +
+                            ".");
+}
+
+/// \class NpzWriter
+/// Writer of uncompressed npz files
+/// The arrays are added one by one with add(), the archive is complete after
+/// close() or the destruction of the writer.
+class NpzWriter {
+ private:
+   struct Entry {
+      std::string name;
+      std::uint32_t crc;
+      std::uint32_t size;
+      std::uint32_t offset;
+   };
+
+   std::string _path;
+   std::ofstream _file;
+   std::vector<Entry> _entries;
+
+   template <class T> void write(T value) {
+      _file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+   }
+
+ public:
+   explicit NpzWriter(const std::string &path)
+       : _path(path), _file(path, std::ios::binary | std::ios::trunc) {
+      if (!_file) {
+         throw std::runtime_error("Tenseur: Cannot open " + path + ".");
+      }
+   }
+
+   NpzWriter(const NpzWriter &) = delete;
+   NpzWriter &operator=(const NpzWriter &) = delete;
+
+   ~NpzWriter() {
+      if (_file.is_open()) {
+         close();
+      }
+   }
+
+   /// Add the tensor x as the array name
+   template <class T>
+      requires ::ten::isDenseTensor<T>::value
+   void add(const std::string &name, const T &x) {
+      std::string header = details::npyHeader(details::tensorHeader(x));
+      std::uint64_t size =
+          header.size() + x.size() * sizeof(typename T::value_type);
+      std::uint64_t offset = _file.tellp();
+      if (size >= 0xffffffff || offset >= 0xffffffff) {
+         throw std::runtime_error("Tenseur: " + _path +
+                                  " exceeds the size of a zip file.");
+      }
+      Entry entry{name + ".npy", 0, static_cast<std::uint32_t>(size),
+                  static_cast<std::uint32_t>(offset)};
+      // Local header, the crc is written after the data
+      write<std::uint32_t>(0x04034b50);
+      write<std::uint16_t>(20);
+      write<std::uint16_t>(0);
+      write<std::uint16_t>(0);
+      write<std::uint32_t>(0);
+      write<std::uint32_t>(0);
+      write<std::uint32_t>(entry.size);
+      write<std::uint32_t>(entry.size);
+      write<std::uint16_t>(static_cast<std::uint16_t>(entry.name.size()));
+      write<std::uint16_t>(0);
+      _file.write(entry.name.data(), entry.name.size());
+      std::uint32_t crc = details::crc32(0, header.data(), header.size());
+      _file.write(header.data(), header.size());
+      details::writeElements(x, [&](const char *data, std::size_t n) {
+         crc = details::crc32(crc, data, n);
+         _file.write(data, n);
+      });
+      entry.crc = crc;
+      auto end = _file.tellp();
+      _file.seekp(offset + 14);
+      write<std::uint32_t>(crc);
+      _file.seekp(end);
+      _entries.push_back(entry);
+      if (!_file) {
+         throw std::runtime_error("Tenseur: Cannot write " + _path + ".");
+      }
+   }
+
+   /// Write the central directory and close the file
+   void close() {
+      std::uint64_t directory = _file.tellp();
+      for (const auto &entry : _entries) {
+         write<std::uint32_t>(0x02014b50);
+         write<std::uint16_t>(20);
+         write<std::uint16_t>(20);
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint32_t>(entry.crc);
+         write<std::uint32_t>(entry.size);
+         write<std::uint32_t>(entry.size);
+         write<std::uint16_t>(static_cast<std::uint16_t>(entry.name.size()));
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint16_t>(0);
+         write<std::uint32_t>(0);
+         write<std::uint32_t>(entry.offset);
+         _file.write(entry.name.data(), entry.name.size());
+      }
+      std::uint64_t end = _file.tellp();
+      write<std::uint32_t>(0x06054b50);
+      write<std::uint16_t>(0);
+      write<std::uint16_t>(0);
+      write<std::uint16_t>(static_cast<std::uint16_t>(_entries.size()));
+      write<std::uint16_t>(static_cast<std::uint16_t>(_entries.size()));
+      write<std::uint32_t>(static_cast<std::uint32_t>(end - directory));
+      write<std::uint32_t>(static_cast<std::uint32_t>(directory));
+      write<std::uint16_t>(0);
+      _file.close();
+   }
+};
+
+} // namespace ten::io
+
+#endif
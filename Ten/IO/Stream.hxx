@@ -0,0 +1,409 @@
+/// \file Ten/IO/Stream.hxx
+
+#ifndef TENSEUR_IO_STREAM_HXX
+#define TENSEUR_IO_STREAM_HXX
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <Ten/IO/Format.hxx>
+#include <Ten/IO/Native.hxx>
+#include <Ten/IO/Npy.hxx>
+
+namespace ten::io {
+
+/// \enum FileFormat
+/// Format of a tensor file
+enum class FileFormat { Native, Npy };
+
+namespace details {
+// Read the header of a native or npy file
+inline TensorHeader readAnyHeader(const std::string &path) {
+   std::ifstream file(path, std::ios::binary);
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot open " + path + ".");
+   }
+   std::array<char, npyMagicSize> magic{};
+   file.read(magic.data(), magic.size());
+   if (file.gcount() == npyMagicSize &&
+       std::memcmp(magic.data(), npyMagic, npyMagicSize) == 0) {
+      return readNpyHeader(path);
+   }
+   return readHeader(path);
+}
+
+// Read or write size bytes at offset, the partial transfers are resumed
+template <class Transfer, class Ptr>
+void transferAll(Transfer &&transfer, Ptr data, std::size_t size,
+                 std::size_t offset, const std::string &path) {
+   while (size > 0) {
+      ssize_t n = transfer(data, size, static_cast<off_t>(offset));
+      if (n < 0 && errno == EINTR) {
+         continue;
+      }
+      if (n <= 0) {
+         throw std::runtime_error("Tenseur: Cannot transfer " + path + ": " +
+                                  (n < 0 ? std::strerror(errno) : "eof"));
+      }
+      data += n;
+      size -= n;
+      offset += n;
+   }
+}
+
+// Blocks of slices along the outer axis of the storage order
+// The slices along the last dimension of column major tensors and the first
+// dimension of row major tensors are contiguous in the file.
+struct BlockLayout {
+   std::vector<size_type> shape;
+   size_type axis = 0;
+   size_type sliceSize = 1;
+   size_type numSlices = 0;
+   size_type blockSize = 0;
+
+   BlockLayout() = default;
+
+   BlockLayout(const std::vector<size_type> &dims, StorageOrder order,
+               size_type slices)
+       : shape(dims), blockSize(slices) {
+      if (blockSize == 0) {
+         throw std::invalid_argument("Tenseur: Blocks of zero slices.");
+      }
+      axis = (order == StorageOrder::ColMajor) ? shape.size() - 1 : 0;
+      for (size_type i = 0; i < shape.size(); i++) {
+         if (i != axis) {
+            sliceSize = checkedMul(sliceSize, shape[i]);
+         }
+      }
+      numSlices = shape.empty() ? 0 : shape[axis];
+      static_cast<void>(checkedMul(sliceSize, numSlices));
+   }
+
+   [[nodiscard]] size_type numBlocks() const {
+      return (numSlices + blockSize - 1) / blockSize;
+   }
+
+   // Number of slices of the block
+   [[nodiscard]] size_type slices(size_type block) const {
+      return std::min(blockSize, numSlices - block * blockSize);
+   }
+};
+
+// Contiguous view of a block in a buffer
+template <class T>
+T blockView(const std::shared_ptr<typename T::storage_type> &storage,
+            const BlockLayout &layout, size_type slices) {
+   using shape_type = typename T::shape_type;
+   using node_type = typename T::node_type;
+   using stride_type = typename node_type::stride_type;
+   std::array<size_type, shape_type::rank()> dims;
+   for (size_type i = 0; i < shape_type::rank(); i++) {
+      dims[i] = layout.shape[i];
+   }
+   dims[layout.axis] = slices;
+   shape_type shape(dims);
+   return T(
+       std::make_shared<node_type>(storage, shape, stride_type(shape), 0));
+}
+} // namespace details
+
+/// \class BlockReader
+/// Read a tensor file by blocks of slices, with a bounded memory
+///
+/// The blocks are taken along the last dimension of column major tensors
+/// (blocks of columns of a matrix) and along the first dimension of row major
+/// tensors (blocks of rows), so that each block is contiguous in the file.
+/// Each block is a view of one of two buffers: the next block is read in the
+/// background while the current one is processed. The view returned by
+/// block() is overwritten by the following call to next().
+///
+/// Example:
+/// \code
+/// BlockReader<Matrix<float>> reader("data.ten", 1024);
+/// while (reader.next()) {
+///    auto &x = reader.block();
+///    ...
+/// }
+/// \endcode
+template <class T>
+   requires(::ten::isDenseTensor<T>::value && T::isDynamic())
+class BlockReader {
+ public:
+   using tensor_type = T;
+   using value_type = typename T::value_type;
+   using storage_type = typename T::storage_type;
+
+ private:
+   std::string _path;
+   int _fd = -1;
+   TensorHeader _header;
+   details::BlockLayout _layout;
+   std::array<std::shared_ptr<storage_type>, 2> _buffers;
+   std::array<std::future<void>, 2> _pending;
+   /// Index of the next block
+   size_type _next = 0;
+   T _block;
+
+   // Read a block in its buffer in the background
+   void prefetch(size_type block) {
+      const size_type count = _layout.slices(block) * _layout.sliceSize;
+      const std::size_t offset =
+          _header.offset +
+          block * _layout.blockSize * _layout.sliceSize * sizeof(value_type);
+      char *data = reinterpret_cast<char *>(_buffers[block % 2]->data());
+      _pending[block % 2] = std::async(std::launch::async, [=, this] {
+         details::transferAll(
+             [this](char *p, std::size_t n, off_t o) {
+                return ::pread(_fd, p, n, o);
+             },
+             data, count * sizeof(value_type), offset, _path);
+      });
+   }
+
+ public:
+   /// Open the native or npy file at path to be read by blocks of
+   /// blockSize slices
+   /// Throws std::runtime_error when the file doesn't store a tensor of type
+   /// T.
+   BlockReader(const std::string &path, size_type blockSize)
+       : _path(path), _header(details::readAnyHeader(path)) {
+      details::checkHeader<T>(_header, path);
+      _layout = details::BlockLayout(_header.shape, _header.order, blockSize);
+      _fd = ::open(path.c_str(), O_RDONLY);
+      if (_fd < 0) {
+         throw std::runtime_error("Tenseur: Cannot open " + path + ": " +
+                                  std::strerror(errno));
+      }
+      const size_type size =
+          std::min(_layout.blockSize, _layout.numSlices) * _layout.sliceSize;
+      for (auto &buffer : _buffers) {
+         buffer = std::make_shared<storage_type>(size);
+      }
+      if (_layout.numBlocks() > 0) {
+         prefetch(0);
+      }
+   }
+
+   BlockReader(const BlockReader &) = delete;
+   BlockReader &operator=(const BlockReader &) = delete;
+
+   ~BlockReader() {
+      for (auto &pending : _pending) {
+         if (pending.valid()) {
+            pending.wait();
+         }
+      }
+      ::close(_fd);
+   }
+
+   /// Returns the header of the file
+   [[nodiscard]] const TensorHeader &header() const { return _header; }
+
+   /// Returns the dimension along which the blocks are taken
+   [[nodiscard]] size_type axis() const { return _layout.axis; }
+
+   /// Returns the number of blocks
+   [[nodiscard]] size_type numBlocks() const { return _layout.numBlocks(); }
+
+   /// Returns the index of the current block
+   [[nodiscard]] size_type index() const { return _next - 1; }
+
+   /// Returns the index of the first slice of the current block
+   [[nodiscard]] size_type offset() const {
+      return (_next - 1) * _layout.blockSize;
+   }
+
+   /// Move to the next block, returns false after the last block
+   /// Throws std::runtime_error when the block can't be read.
+   bool next() {
+      if (_next == _layout.numBlocks()) {
+         return false;
+      }
+      _pending[_next % 2].get();
+      if (_next + 1 < _layout.numBlocks()) {
+         prefetch(_next + 1);
+      }
+      _block = details::blockView<T>(_buffers[_next % 2], _layout,
+                                     _layout.slices(_next));
+      _next++;
+      return true;
+   }
+
+   /// Returns the current block
+   [[nodiscard]] T &block() { return _block; }
+};
+
+/// \class BlockWriter
+/// Write a tensor file by blocks of slices, with a bounded memory
+///
+/// The blocks are appended along the same dimension as BlockReader. Each
+/// block is copied to one of two buffers and written in the background while
+/// the next one is computed. The file is complete when all the slices have
+/// been written and the writer is closed.
+template <class T>
+   requires(::ten::isDenseTensor<T>::value && T::isDynamic())
+class BlockWriter {
+ public:
+   using tensor_type = T;
+   using value_type = typename T::value_type;
+   using shape_type = typename T::shape_type;
+   using storage_type = typename T::storage_type;
+
+ private:
+   std::string _path;
+   int _fd = -1;
+   TensorHeader _header;
+   details::BlockLayout _layout;
+   std::array<std::shared_ptr<storage_type>, 2> _buffers;
+   std::array<std::future<void>, 2> _pending;
+   /// Number of blocks and slices written
+   size_type _blocks = 0;
+   size_type _slices = 0;
+
+   void writeAll(const char *data, std::size_t size, std::size_t offset) {
+      details::transferAll(
+          [this](const char *p, std::size_t n, off_t o) {
+             return ::pwrite(_fd, p, n, o);
+          },
+          data, size, offset, _path);
+   }
+
+   void wait() {
+      for (auto &pending : _pending) {
+         if (pending.valid()) {
+            pending.get();
+         }
+      }
+   }
+
+ public:
+   /// Create the file at path for a tensor of the given shape, written by
+   /// blocks of at most blockSize slices
+   BlockWriter(const std::string &path, const shape_type &shape,
+               size_type blockSize, FileFormat format = FileFormat::Native)
+       : _path(path) {
+      _header.dtype = details::DTypeOf<value_type>::value;
+      _header.order = T::storageOrder();
+      for (size_type i = 0; i < shape_type::rank(); i++) {
+         _header.shape.push_back(shape.dim(i));
+      }
+      _layout = details::BlockLayout(_header.shape, _header.order, blockSize);
+      std::string header = format == FileFormat::Native
+                               ? details::nativeHeader(_header)
+                               : details::npyHeader(_header);
+      _header.offset = header.size();
+      _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (_fd < 0) {
+         throw std::runtime_error("Tenseur: Cannot open " + path + ": " +
+                                  std::strerror(errno));
+      }
+      writeAll(header.data(), header.size(), 0);
+      const size_type size =
+          std::min(_layout.blockSize, _layout.numSlices) * _layout.sliceSize;
+      for (auto &buffer : _buffers) {
+         buffer = std::make_shared<storage_type>(size);
+      }
+   }
+
+   BlockWriter(const BlockWriter &) = delete;
+   BlockWriter &operator=(const BlockWriter &) = delete;
+
+   ~BlockWriter() {
+      if (_fd >= 0) {
+         for (auto &pending : _pending) {
+            if (pending.valid()) {
+               pending.wait();
+            }
+         }
+         ::close(_fd);
+      }
+   }
+
+   /// Returns the header of the file
+   [[nodiscard]] const TensorHeader &header() const { return _header; }
+
+   /// Returns the dimension along which the blocks are appended
+   [[nodiscard]] size_type axis() const { return _layout.axis; }
+
+   /// Returns the number of slices written
+   [[nodiscard]] size_type slices() const { return _slices; }
+
+   /// Append a block, a tensor or an expression, of at most blockSize slices
+   /// Throws std::invalid_argument when the block doesn't have the dimensions
+   /// of the slices, and std::runtime_error when it can't be written.
+   template <class E> void write(E &&expr) {
+      if constexpr (::ten::isUnaryExpr<std::remove_cvref_t<E>>::value ||
+                    ::ten::isBinaryExpr<std::remove_cvref_t<E>>::value) {
+         write(expr.eval());
+      } else {
+         using B = std::remove_cvref_t<E>;
+         static_assert(std::is_same_v<typename B::value_type, value_type> &&
+                           B::shape_type::rank() == shape_type::rank(),
+                       "Tenseur: Block of another type or rank.");
+         const size_type slices = expr.dim(_layout.axis);
+         bool valid = slices > 0 && slices <= _layout.blockSize &&
+                      _slices + slices <= _layout.numSlices &&
+                      B::storageOrder() == T::storageOrder();
+         for (size_type i = 0; i < shape_type::rank(); i++) {
+            if (i != _layout.axis && expr.dim(i) != _layout.shape[i]) {
+               valid = false;
+            }
+         }
+         if (!valid) {
+            throw std::invalid_argument(
+                "Tenseur: Block of another shape or order than the slices of "
+                "the file.");
+         }
+         // Wait for the write of the buffer two blocks ago
+         auto &pending = _pending[_blocks % 2];
+         if (pending.valid()) {
+            pending.get();
+         }
+         char *data = reinterpret_cast<char *>(_buffers[_blocks % 2]->data());
+         std::size_t size = 0;
+         details::writeElements(expr, [&](const char *p, std::size_t n) {
+            std::memcpy(data + size, p, n);
+            size += n;
+         });
+         const std::size_t offset =
+             _header.offset + _slices * _layout.sliceSize * sizeof(value_type);
+         pending = std::async(std::launch::async, [=, this] {
+            writeAll(data, size, offset);
+         });
+         _blocks++;
+         _slices += slices;
+      }
+   }
+
+   /// Wait for the pending writes and close the file
+   /// Throws std::runtime_error when slices are missing.
+   void close() {
+      if (_fd < 0) {
+         return;
+      }
+      wait();
+      ::close(_fd);
+      _fd = -1;
+      if (_slices != _layout.numSlices) {
+         throw std::runtime_error("Tenseur: " + _path + " is incomplete, " +
+                                  std::to_string(_slices) + " of " +
+                                  std::to_string(_layout.numSlices) +
+                                  " slices written.");
+      }
+   }
+};
+
+} // namespace ten::io
+
+#endif
@@ -1,64 +1,132 @@
 #ifndef TA_KERNELS_STD_SIMD_BINARY_OPS_HXX
 #define TA_KERNELS_STD_SIMD_BINARY_OPS_HXX
 
-#include <experimental/bits/simd.h>
+#include <complex>
 #include <experimental/simd>
+#include <type_traits>
 
 #include <Ten/Config.hxx>
+#include <Ten/Kernels/Simd.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Profile.hxx>
 #include <Ten/Types.hxx>
 
 namespace ten::kernels {
 
-template <::ten::BinaryOperation kind, class A, class B, class C>
-static void binaryOps(const A &a, const B &b, C &c) {
-   size_t n = a.size();
-   constexpr size_t vlen = ::ten::simdVecLen;
+/// \fn binaryOp
+/// Apply the binary operation to two scalars or two simd vectors
+template <::ten::BinaryOperation kind, class V>
+static V binaryOp(const V &a, const V &b) {
    using ::ten::BinaryOperation;
-   using T = typename A::value_type;
-   using vector_type = std::experimental::fixed_size_simd<float, vlen>;
-   using alignment = std::experimental::element_aligned_tag;
+   if constexpr (kind == BinaryOperation::add) {
+      return a + b;
+   } else if constexpr (kind == BinaryOperation::sub) {
+      return a - b;
+   } else if constexpr (kind == BinaryOperation::mul) {
+      return a * b;
+   } else {
+      return a / b;
+   }
+}
+
+namespace details {
+template <class> struct isComplex : std::false_type {};
+template <class T> struct isComplex<std::complex<T>> : std::true_type {};
 
-   for (size_t i = 0; i < n / vlen; i++) {
-      // Load a and b
-      size_t offset = i * vlen;
-      vector_type a_vec;
-      a_vec.copy_from(a.data() + offset, alignment{});
-      vector_type b_vec;
-      b_vec.copy_from(b.data() + offset, alignment{});
-      // c_vec = a_vec ops b_vec
-      vector_type c_vec;
-      switch (kind) {
-      case BinaryOperation::add:
-         c_vec = a_vec + b_vec;
-         break;
-      case BinaryOperation::sub:
-         c_vec = a_vec - b_vec;
-         break;
-      case BinaryOperation::div:
-         c_vec = a_vec / b_vec;
-         break;
-      case BinaryOperation::mul:
-         c_vec = a_vec * b_vec;
-         break;
+// c[i] = a[i] op b[i] for i in [begin, end)
+template <::ten::BinaryOperation kind, class TA, class TB, class T>
+static void binaryOps(const TA *a, const TB *b, T *c, size_t begin,
+                      size_t end) {
+   if constexpr (::ten::isVectorizable<T>::value) {
+      using vector_type = simd_type<T>;
+      simdLoop(
+          c, begin, end,
+          [&](size_t offset) {
+             vector_type a_vec(a + offset, std::experimental::element_aligned);
+             vector_type b_vec(b + offset, std::experimental::element_aligned);
+             vector_type c_vec = binaryOp<kind>(a_vec, b_vec);
+             c_vec.copy_to(c + offset, std::experimental::vector_aligned);
+          },
+          [&](size_t i) {
+             c[i] = binaryOp<kind>(static_cast<T>(a[i]), static_cast<T>(b[i]));
+          });
+   } else {
+      for (size_t i = begin; i < end; i++) {
+         c[i] = binaryOp<kind>(static_cast<T>(a[i]), static_cast<T>(b[i]));
       }
-      // Copy back
-      c_vec.copy_to(c.data() + offset, alignment{});
    }
-   for (size_t i = vlen * (n / vlen); i < n; i++) {
-      switch (kind) {
-      case BinaryOperation::add:
-         c[i] = a[i] + b[i];
-         break;
-      case BinaryOperation::sub:
-         c[i] = a[i] - b[i];
-         break;
-      case BinaryOperation::div:
-         c[i] = a[i] / b[i];
-         break;
-      case BinaryOperation::mul:
-         c[i] = a[i] * b[i];
-         break;
-      }
+}
+
+// Multiply two arrays of complex numbers
+// Written component-wise so that the compiler vectorizes it
+template <class T>
+static void complexMul(const std::complex<T> *a, const std::complex<T> *b,
+                       std::complex<T> *c, size_t begin, size_t end) {
+   const T *x = reinterpret_cast<const T *>(a);
+   const T *y = reinterpret_cast<const T *>(b);
+   T *z = reinterpret_cast<T *>(c);
+   for (size_t i = begin; i < end; i++) {
+      T re = x[2 * i] * y[2 * i] - x[2 * i + 1] * y[2 * i + 1];
+      T im = x[2 * i] * y[2 * i + 1] + x[2 * i + 1] * y[2 * i];
+      z[2 * i] = re;
+      z[2 * i + 1] = im;
+   }
+}
+
+// Name of the kernel in the profiles
+constexpr const char *binaryOpsName(::ten::BinaryOperation kind) {
+   switch (kind) {
+   case ::ten::BinaryOperation::add:
+      return "binaryOps.add";
+   case ::ten::BinaryOperation::sub:
+      return "binaryOps.sub";
+   case ::ten::BinaryOperation::mul:
+      return "binaryOps.mul";
+   default:
+      return "binaryOps.div";
+   }
+}
+} // namespace details
+
+/// \fn binaryOps
+/// c = a op b for dense tensors of float, double, integral or complex types.
+/// Complex additions and substractions are vectorized over the real and
+/// imaginary parts.
+template <::ten::BinaryOperation kind, class A, class B, class C>
+static void binaryOps(const A &a, const B &b, C &c) {
+   using ::ten::BinaryOperation;
+   using T = typename C::value_type;
+   using TA = typename A::value_type;
+   using TB = typename B::value_type;
+   size_t n = c.size();
+   TENSEUR_PROFILE_SCOPE(details::binaryOpsName(kind), "kernel");
+   TENSEUR_PROFILE_COUNT(a.size() * sizeof(TA) + b.size() * sizeof(TB),
+                         n * sizeof(T), n);
+
+   if constexpr (details::isComplex<T>::value && std::is_same_v<T, TA> &&
+                 std::is_same_v<T, TB> &&
+                 (kind == BinaryOperation::add ||
+                  kind == BinaryOperation::sub)) {
+      using R = typename T::value_type;
+      ::ten::parallel::parallelFor(
+          0, 2 * n, ::ten::simdVecLen<R>, [&](size_t first, size_t last) {
+             details::binaryOps<kind>(reinterpret_cast<const R *>(a.data()),
+                                      reinterpret_cast<const R *>(b.data()),
+                                      reinterpret_cast<R *>(c.data()), first,
+                                      last);
+          });
+   } else if constexpr (details::isComplex<T>::value &&
+                        std::is_same_v<T, TA> && std::is_same_v<T, TB> &&
+                        kind == BinaryOperation::mul) {
+      ::ten::parallel::parallelFor(0, n, 1, [&](size_t first, size_t last) {
+         details::complexMul(a.data(), b.data(), c.data(), first, last);
+      });
+   } else {
+      ::ten::parallel::parallelFor(
+          0, n, ::ten::simdVecLen<T>, [&](size_t first, size_t last) {
+             details::binaryOps<kind>(a.data(), b.data(), c.data(), first,
+                                      last);
+          });
    }
 }
 } // namespace ten::kernels
@@ -1,18 +1,48 @@
 #ifndef TEN_KERNELS_BLAS_API_HXX
 #define TEN_KERNELS_BLAS_API_HXX
 
+#include <complex>
 #include <cstddef>
+#include <type_traits>
 
+#include <Ten/Config.hxx>
+#include <Ten/Parallel.hxx>
+
+#ifndef TENSEUR_NO_BLAS
 #ifdef __APPLE__
 #include <Accelerate/Accelerate.h>
+#elif defined(TENSEUR_MKL)
+#include <mkl_cblas.h>
 #else
 #include <cblas.h>
 #endif
+#endif
 
 namespace ten::kernels::blas {
 
 enum class transop : char { no = 'N', trans = 'T' };
 
+enum class uplo : char { upper = 'U', lower = 'L' };
+
+enum class side : char { left = 'L', right = 'R' };
+
+enum class diag : char { nonunit = 'N', unit = 'U' };
+
+/// \typedef isBlasType
+/// Types supported by the BLAS routines, none when TENSEUR_NO_BLAS is defined
+#ifdef TENSEUR_NO_BLAS
+template <class T> struct isBlasType : std::false_type {};
+#else
+template <class T>
+struct isBlasType
+    : std::bool_constant<std::is_same_v<T, float> ||
+                         std::is_same_v<T, double> ||
+                         std::is_same_v<T, std::complex<float>> ||
+                         std::is_same_v<T, std::complex<double>>> {};
+#endif
+
+#ifndef TENSEUR_NO_BLAS
+
 static CBLAS_TRANSPOSE cast(const transop op) {
    if (op == transop::no) {
       return CBLAS_TRANSPOSE::CblasNoTrans;
@@ -21,6 +51,18 @@ static CBLAS_TRANSPOSE cast(const transop op) {
    }
 }
 
+static CBLAS_UPLO cast(const uplo op) {
+   return op == uplo::upper ? CBLAS_UPLO::CblasUpper : CBLAS_UPLO::CblasLower;
+}
+
+static CBLAS_SIDE cast(const side op) {
+   return op == side::left ? CBLAS_SIDE::CblasLeft : CBLAS_SIDE::CblasRight;
+}
+
+static CBLAS_DIAG cast(const diag op) {
+   return op == diag::unit ? CBLAS_DIAG::CblasUnit : CBLAS_DIAG::CblasNonUnit;
+}
+
 // Axpy
 // y = a*x + y
 template <typename T>
@@ -33,8 +75,28 @@ void axpy(const int n, const float a, const float *x, const int incx, float *y,
    cblas_saxpy(n, a, x, incx, y, incy);
 }
 
+template <>
+void axpy(const int n, const double a, const double *x, const int incx,
+          double *y, const int incy) {
+   cblas_daxpy(n, a, x, incx, y, incy);
+}
+
+template <>
+void axpy(const int n, const std::complex<float> a,
+          const std::complex<float> *x, const int incx, std::complex<float> *y,
+          const int incy) {
+   cblas_caxpy(n, &a, x, incx, y, incy);
+}
+
+template <>
+void axpy(const int n, const std::complex<double> a,
+          const std::complex<double> *x, const int incx,
+          std::complex<double> *y, const int incy) {
+   cblas_zaxpy(n, &a, x, incx, y, incy);
+}
+
 // Dot product of two vectors
-// x * y
+// x * y, not conjugated for complex vectors
 template <typename T>
 static T dot(const int n, const T *x, const int incx, const T *y,
              const int incy);
@@ -45,12 +107,36 @@ float dot(const int n, const float *x, const int incx, const float *y,
    return cblas_sdot(n, x, incx, y, incy);
 }
 
+template <>
+double dot(const int n, const double *x, const int incx, const double *y,
+           const int incy) {
+   return cblas_ddot(n, x, incx, y, incy);
+}
+
+template <>
+std::complex<float> dot(const int n, const std::complex<float> *x,
+                        const int incx, const std::complex<float> *y,
+                        const int incy) {
+   std::complex<float> res;
+   cblas_cdotu_sub(n, x, incx, y, incy, &res);
+   return res;
+}
+
+template <>
+std::complex<double> dot(const int n, const std::complex<double> *x,
+                         const int incx, const std::complex<double> *y,
+                         const int incy) {
+   std::complex<double> res;
+   cblas_zdotu_sub(n, x, incx, y, incy, &res);
+   return res;
+}
+
 // Vector matrix multiplication
 // y = alpha * a * x + beta * y
 template <typename T>
 static void gemv(transop trans, const int m, const int n, const T alpha,
                  const T *a, const int lda, const T *x, const int incx,
-                 const T beta, float *y, int incy);
+                 const T beta, T *y, int incy);
 
 template <>
 void gemv(transop trans, const int m, const int n, const float alpha,
@@ -60,6 +146,75 @@ void gemv(transop trans, const int m, const int n, const float alpha,
                incx, beta, y, incy);
 }
 
+template <>
+void gemv(transop trans, const int m, const int n, const double alpha,
+          const double *a, const int lda, const double *x, const int incx,
+          const double beta, double *y, const int incy) {
+   cblas_dgemv(CBLAS_ORDER::CblasColMajor, cast(trans), m, n, alpha, a, lda, x,
+               incx, beta, y, incy);
+}
+
+template <>
+void gemv(transop trans, const int m, const int n,
+          const std::complex<float> alpha, const std::complex<float> *a,
+          const int lda, const std::complex<float> *x, const int incx,
+          const std::complex<float> beta, std::complex<float> *y,
+          const int incy) {
+   cblas_cgemv(CBLAS_ORDER::CblasColMajor, cast(trans), m, n, &alpha, a, lda,
+               x, incx, &beta, y, incy);
+}
+
+template <>
+void gemv(transop trans, const int m, const int n,
+          const std::complex<double> alpha, const std::complex<double> *a,
+          const int lda, const std::complex<double> *x, const int incx,
+          const std::complex<double> beta, std::complex<double> *y,
+          const int incy) {
+   cblas_zgemv(CBLAS_ORDER::CblasColMajor, cast(trans), m, n, &alpha, a, lda,
+               x, incx, &beta, y, incy);
+}
+
+// Rank one update
+// a = alpha * x * y' + a, y not conjugated for complex vectors
+template <typename T>
+static void ger(const int m, const int n, const T alpha, const T *x,
+                const int incx, const T *y, const int incy, T *a,
+                const int lda);
+
+template <>
+void ger(const int m, const int n, const float alpha, const float *x,
+         const int incx, const float *y, const int incy, float *a,
+         const int lda) {
+   cblas_sger(CBLAS_ORDER::CblasColMajor, m, n, alpha, x, incx, y, incy, a,
+              lda);
+}
+
+template <>
+void ger(const int m, const int n, const double alpha, const double *x,
+         const int incx, const double *y, const int incy, double *a,
+         const int lda) {
+   cblas_dger(CBLAS_ORDER::CblasColMajor, m, n, alpha, x, incx, y, incy, a,
+              lda);
+}
+
+template <>
+void ger(const int m, const int n, const std::complex<float> alpha,
+         const std::complex<float> *x, const int incx,
+         const std::complex<float> *y, const int incy, std::complex<float> *a,
+         const int lda) {
+   cblas_cgeru(CBLAS_ORDER::CblasColMajor, m, n, &alpha, x, incx, y, incy, a,
+               lda);
+}
+
+template <>
+void ger(const int m, const int n, const std::complex<double> alpha,
+         const std::complex<double> *x, const int incx,
+         const std::complex<double> *y, const int incy,
+         std::complex<double> *a, const int lda) {
+   cblas_zgeru(CBLAS_ORDER::CblasColMajor, m, n, &alpha, x, incx, y, incy, a,
+               lda);
+}
+
 // General matrix multiplication
 // c = alpha * a * b + beta * c
 template <typename T>
@@ -75,6 +230,279 @@ void gemm(transop transa, transop transb, const int m, const int n, const int k,
                alpha, a, lda, b, ldb, beta, c, ldc);
 }
 
+template <>
+void gemm(transop transa, transop transb, const int m, const int n, const int k,
+          const double alpha, const double *a, const int lda, const double *b,
+          const int ldb, const double beta, double *c, const int ldc) {
+   cblas_dgemm(CBLAS_ORDER::CblasColMajor, cast(transa), cast(transb), m, n, k,
+               alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+template <>
+void gemm(transop transa, transop transb, const int m, const int n, const int k,
+          const std::complex<float> alpha, const std::complex<float> *a,
+          const int lda, const std::complex<float> *b, const int ldb,
+          const std::complex<float> beta, std::complex<float> *c,
+          const int ldc) {
+   cblas_cgemm(CBLAS_ORDER::CblasColMajor, cast(transa), cast(transb), m, n, k,
+               &alpha, a, lda, b, ldb, &beta, c, ldc);
+}
+
+template <>
+void gemm(transop transa, transop transb, const int m, const int n, const int k,
+          const std::complex<double> alpha, const std::complex<double> *a,
+          const int lda, const std::complex<double> *b, const int ldb,
+          const std::complex<double> beta, std::complex<double> *c,
+          const int ldc) {
+   cblas_zgemm(CBLAS_ORDER::CblasColMajor, cast(transa), cast(transb), m, n, k,
+               &alpha, a, lda, b, ldb, &beta, c, ldc);
+}
+
+// Symmetric rank k update
+// c = alpha * a * a' + beta * c or c = alpha * a' * a + beta * c
+// Only the triangle uplo of c is referenced
+template <typename T>
+static void syrk(uplo uplo, transop trans, const int n, const int k,
+                 const T alpha, const T *a, const int lda, const T beta, T *c,
+                 const int ldc);
+
+template <>
+void syrk(uplo uplo, transop trans, const int n, const int k,
+          const float alpha, const float *a, const int lda, const float beta,
+          float *c, const int ldc) {
+   cblas_ssyrk(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), n, k,
+               alpha, a, lda, beta, c, ldc);
+}
+
+template <>
+void syrk(uplo uplo, transop trans, const int n, const int k,
+          const double alpha, const double *a, const int lda, const double beta,
+          double *c, const int ldc) {
+   cblas_dsyrk(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), n, k,
+               alpha, a, lda, beta, c, ldc);
+}
+
+template <>
+void syrk(uplo uplo, transop trans, const int n, const int k,
+          const std::complex<float> alpha, const std::complex<float> *a,
+          const int lda, const std::complex<float> beta,
+          std::complex<float> *c, const int ldc) {
+   cblas_csyrk(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), n, k,
+               &alpha, a, lda, &beta, c, ldc);
+}
+
+template <>
+void syrk(uplo uplo, transop trans, const int n, const int k,
+          const std::complex<double> alpha, const std::complex<double> *a,
+          const int lda, const std::complex<double> beta,
+          std::complex<double> *c, const int ldc) {
+   cblas_zsyrk(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), n, k,
+               &alpha, a, lda, &beta, c, ldc);
+}
+
+// Triangular matrix multiplication
+// b = alpha * op(a) * b if side is left
+// b = alpha * b * op(a) if side is right
+template <typename T>
+static void trmm(side side, uplo uplo, transop transa, diag diag, const int m,
+                 const int n, const T alpha, const T *a, const int lda, T *b,
+                 const int ldb);
+
+template <>
+void trmm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const float alpha, const float *a, const int lda,
+          float *b, const int ldb) {
+   cblas_strmm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, alpha, a, lda, b, ldb);
+}
+
+template <>
+void trmm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const double alpha, const double *a, const int lda,
+          double *b, const int ldb) {
+   cblas_dtrmm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, alpha, a, lda, b, ldb);
+}
+
+template <>
+void trmm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const std::complex<float> alpha,
+          const std::complex<float> *a, const int lda, std::complex<float> *b,
+          const int ldb) {
+   cblas_ctrmm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, &alpha, a, lda, b, ldb);
+}
+
+template <>
+void trmm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const std::complex<double> alpha,
+          const std::complex<double> *a, const int lda,
+          std::complex<double> *b, const int ldb) {
+   cblas_ztrmm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, &alpha, a, lda, b, ldb);
+}
+
+// Triangular solve with multiple right hand sides
+// b = alpha * inv(op(a)) * b if side is left
+// b = alpha * b * inv(op(a)) if side is right
+template <typename T>
+static void trsm(side side, uplo uplo, transop transa, diag diag, const int m,
+                 const int n, const T alpha, const T *a, const int lda, T *b,
+                 const int ldb);
+
+template <>
+void trsm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const float alpha, const float *a, const int lda,
+          float *b, const int ldb) {
+   cblas_strsm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, alpha, a, lda, b, ldb);
+}
+
+template <>
+void trsm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const double alpha, const double *a, const int lda,
+          double *b, const int ldb) {
+   cblas_dtrsm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, alpha, a, lda, b, ldb);
+}
+
+template <>
+void trsm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const std::complex<float> alpha,
+          const std::complex<float> *a, const int lda, std::complex<float> *b,
+          const int ldb) {
+   cblas_ctrsm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, &alpha, a, lda, b, ldb);
+}
+
+template <>
+void trsm(side side, uplo uplo, transop transa, diag diag, const int m,
+          const int n, const std::complex<double> alpha,
+          const std::complex<double> *a, const int lda,
+          std::complex<double> *b, const int ldb) {
+   cblas_ztrsm(CBLAS_ORDER::CblasColMajor, cast(side), cast(uplo), cast(transa),
+               cast(diag), m, n, &alpha, a, lda, b, ldb);
+}
+
+// Packed triangular matrix vector multiplication
+// x = op(a) * x, a being packed by columns
+template <typename T>
+static void tpmv(uplo uplo, transop trans, diag diag, const int n, const T *ap,
+                 T *x, const int incx);
+
+template <>
+void tpmv(uplo uplo, transop trans, diag diag, const int n, const float *ap,
+          float *x, const int incx) {
+   cblas_stpmv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpmv(uplo uplo, transop trans, diag diag, const int n, const double *ap,
+          double *x, const int incx) {
+   cblas_dtpmv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpmv(uplo uplo, transop trans, diag diag, const int n,
+          const std::complex<float> *ap, std::complex<float> *x,
+          const int incx) {
+   cblas_ctpmv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpmv(uplo uplo, transop trans, diag diag, const int n,
+          const std::complex<double> *ap, std::complex<double> *x,
+          const int incx) {
+   cblas_ztpmv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+// Packed triangular solve
+// x = inv(op(a)) * x, a being packed by columns
+template <typename T>
+static void tpsv(uplo uplo, transop trans, diag diag, const int n, const T *ap,
+                 T *x, const int incx);
+
+template <>
+void tpsv(uplo uplo, transop trans, diag diag, const int n, const float *ap,
+          float *x, const int incx) {
+   cblas_stpsv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpsv(uplo uplo, transop trans, diag diag, const int n, const double *ap,
+          double *x, const int incx) {
+   cblas_dtpsv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpsv(uplo uplo, transop trans, diag diag, const int n,
+          const std::complex<float> *ap, std::complex<float> *x,
+          const int incx) {
+   cblas_ctpsv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+template <>
+void tpsv(uplo uplo, transop trans, diag diag, const int n,
+          const std::complex<double> *ap, std::complex<double> *x,
+          const int incx) {
+   cblas_ztpsv(CBLAS_ORDER::CblasColMajor, cast(uplo), cast(trans), cast(diag),
+               n, ap, x, incx);
+}
+
+// Batched general matrix multiplication
+// c[i] = alpha * a[i] * b[i] + beta * c[i] for i in [0, batch), the matrices
+// of the batch being strideA, strideB and strideC elements apart.
+// Calls cblas_?gemm_batch_strided with MKL (TENSEUR_MKL defined), otherwise
+// one gemm per matrix over the threads of the thread pool.
+template <typename T>
+static void gemmBatch(transop transa, transop transb, const int m, const int n,
+                      const int k, const T alpha, const T *a, const int lda,
+                      const size_t strideA, const T *b, const int ldb,
+                      const size_t strideB, const T beta, T *c, const int ldc,
+                      const size_t strideC, const size_t batch) {
+#ifdef TENSEUR_MKL
+   CBLAS_TRANSPOSE ta = cast(transa);
+   CBLAS_TRANSPOSE tb = cast(transb);
+   if constexpr (std::is_same_v<T, float>) {
+      cblas_sgemm_batch_strided(CblasColMajor, ta, tb, m, n, k, alpha, a, lda,
+                                strideA, b, ldb, strideB, beta, c, ldc,
+                                strideC, batch);
+   } else if constexpr (std::is_same_v<T, double>) {
+      cblas_dgemm_batch_strided(CblasColMajor, ta, tb, m, n, k, alpha, a, lda,
+                                strideA, b, ldb, strideB, beta, c, ldc,
+                                strideC, batch);
+   } else if constexpr (std::is_same_v<T, std::complex<float>>) {
+      cblas_cgemm_batch_strided(CblasColMajor, ta, tb, m, n, k, &alpha, a,
+                                lda, strideA, b, ldb, strideB, &beta, c, ldc,
+                                strideC, batch);
+   } else {
+      cblas_zgemm_batch_strided(CblasColMajor, ta, tb, m, n, k, &alpha, a,
+                                lda, strideA, b, ldb, strideB, &beta, c, ldc,
+                                strideC, batch);
+   }
+#else
+   size_t cost = size_t(m) * size_t(n) * size_t(k);
+   ::ten::parallel::parallelFor(
+       0, batch, 1,
+       [&](size_t first, size_t last) {
+          for (size_t i = first; i < last; i++) {
+             gemm(transa, transb, m, n, k, alpha, a + i * strideA, lda,
+                  b + i * strideB, ldb, beta, c + i * strideC, ldc);
+          }
+       },
+       cost);
+#endif
+}
+
+#endif
+
 } // namespace ten::kernels::blas
 
 #endif
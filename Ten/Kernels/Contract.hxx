@@ -0,0 +1,558 @@
+#ifndef TA_KERNELS_CONTRACT_HXX
+#define TA_KERNELS_CONTRACT_HXX
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <Ten/Kernels/Mul.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Profile.hxx>
+#include <Ten/Types.hxx>
+
+// Minimum number of multiply adds of the matrix products of a pairwise
+// contraction evaluated by gemm, smaller ones use the direct loop
+#ifndef TENSEUR_CONTRACT_GEMM_THRESHOLD
+#define TENSEUR_CONTRACT_GEMM_THRESHOLD 4096
+#endif
+
+namespace ten::kernels {
+
+/// \struct ContractOperand
+/// Strided array whose dimensions are labeled by the indices of a contraction
+///
+/// Operands hold a const pointer, the output a mutable one. Intermediate
+/// results own their storage.
+template <class Pointer> struct ContractOperand {
+   Pointer data = nullptr;
+   std::vector<char> labels;
+   std::vector<size_t> dims;
+   std::vector<size_t> strides;
+   std::shared_ptr<void> storage = nullptr;
+
+   /// Returns the position of a label, or labels.size()
+   size_t find(char label) const {
+      return std::find(labels.begin(), labels.end(), label) - labels.begin();
+   }
+
+   bool has(char label) const { return find(label) < labels.size(); }
+
+   /// Returns the stride of a label, 0 for a label of another operand so that
+   /// the operand is broadcast along it
+   size_t stride(char label) const {
+      size_t i = find(label);
+      return i < labels.size() ? strides[i] : 0;
+   }
+};
+
+namespace details {
+// Group of labels of a contraction with their dimensions
+struct LabelGroup {
+   std::vector<char> labels;
+   std::vector<size_t> dims;
+
+   void add(char label, size_t dim) {
+      labels.push_back(label);
+      dims.push_back(dim);
+   }
+
+   size_t size() const {
+      size_t n = 1;
+      for (size_t d : dims) {
+         n *= d;
+      }
+      return n;
+   }
+};
+
+// Merge the repeated labels of an operand, which is read along the diagonal
+// of their dimensions
+template <class Pointer> void mergeRepeated(ContractOperand<Pointer> &x) {
+   ContractOperand<Pointer> y{x.data, {}, {}, {}, x.storage};
+   for (size_t d = 0; d < x.labels.size(); d++) {
+      size_t i = y.find(x.labels[d]);
+      if (i == y.labels.size()) {
+         y.labels.push_back(x.labels[d]);
+         y.dims.push_back(x.dims[d]);
+         y.strides.push_back(x.strides[d]);
+      } else if (y.dims[i] != x.dims[d]) {
+         throw std::invalid_argument(
+             "Tenseur: Contraction index of different dimensions.");
+      } else {
+         y.strides[i] += x.strides[d];
+      }
+   }
+   x = std::move(y);
+}
+
+// Check that every label has the same dimension in all the operands and in
+// the output
+template <class T>
+void checkDims(const std::vector<ContractOperand<const T *>> &operands,
+               const ContractOperand<T *> &c) {
+   LabelGroup all;
+   auto check = [&](char label, size_t dim) {
+      size_t i = std::find(all.labels.begin(), all.labels.end(), label) -
+                 all.labels.begin();
+      if (i == all.labels.size()) {
+         all.add(label, dim);
+      } else if (all.dims[i] != dim) {
+         throw std::invalid_argument(
+             "Tenseur: Contraction index of different dimensions.");
+      }
+   };
+   for (const auto &x : operands) {
+      for (size_t d = 0; d < x.labels.size(); d++) {
+         check(x.labels[d], x.dims[d]);
+      }
+   }
+   for (size_t d = 0; d < c.labels.size(); d++) {
+      check(c.labels[d], c.dims[d]);
+   }
+}
+
+// Offsets in x of the multi-indices of a group, the first label being the
+// fastest
+template <class Operand>
+std::vector<size_t> groupOffsets(const Operand &x, const LabelGroup &group) {
+   std::vector<size_t> offsets(group.size());
+   if (offsets.empty()) {
+      return offsets;
+   }
+   size_t rank = group.labels.size();
+   std::vector<size_t> strides(rank), index(rank, 0);
+   for (size_t d = 0; d < rank; d++) {
+      strides[d] = x.stride(group.labels[d]);
+   }
+   size_t offset = 0;
+   for (size_t i = 0; i < offsets.size(); i++) {
+      offsets[i] = offset;
+      for (size_t d = 0; d < rank; d++) {
+         if (++index[d] < group.dims[d]) {
+            offset += strides[d];
+            break;
+         }
+         offset -= strides[d] * (group.dims[d] - 1);
+         index[d] = 0;
+      }
+   }
+   return offsets;
+}
+
+// Layout of a m x k matrix whose elements are at offsetsM[i] + offsetsK[l]
+// It's read as a column major matrix or as the transpose of one when one of
+// the groups has a unit stride and the other one a constant stride.
+inline std::optional<MatrixLayout>
+tableLayout(const std::vector<size_t> &offsetsM,
+            const std::vector<size_t> &offsetsK) {
+   auto sm = uniformStride(offsetsM);
+   auto sk = uniformStride(offsetsK);
+   if (!sm || !sk) {
+      return std::nullopt;
+   }
+   size_t m = offsetsM.size();
+   size_t k = offsetsK.size();
+   if ((*sm == 1 || m <= 1) && (k <= 1 || *sk >= m)) {
+      return MatrixLayout{blas::transop::no, std::max<size_t>({*sk, m, 1})};
+   }
+   if ((*sk == 1 || k <= 1) && (m <= 1 || *sm >= k)) {
+      return MatrixLayout{blas::transop::trans,
+                          std::max<size_t>({*sm, k, 1})};
+   }
+   return std::nullopt;
+}
+
+// Offsets of the three groups of an operand of a pairwise contraction
+struct ContractTables {
+   std::vector<size_t> batch;
+   std::vector<size_t> rows;
+   std::vector<size_t> cols;
+};
+
+// Copy the batch of matrices of x into a contiguous column major array
+template <class T>
+std::vector<T> packTables(const T *x, const ContractTables &t) {
+   size_t m = t.rows.size();
+   size_t k = t.cols.size();
+   std::vector<T> packed(m * k * t.batch.size());
+   ::ten::parallel::parallelFor(
+       0, t.batch.size(), 1,
+       [&](size_t first, size_t last) {
+          for (size_t b = first; b < last; b++) {
+             T *p = packed.data() + b * m * k;
+             for (size_t l = 0; l < k; l++) {
+                const T *src = x + t.batch[b] + t.cols[l];
+                for (size_t i = 0; i < m; i++) {
+                   p[i + l * m] = src[t.rows[i]];
+                }
+             }
+          }
+       },
+       m * k);
+   return packed;
+}
+
+// c[b, i, j] = sum_l a[b, i, l] * b[b, l, j] by matrix products
+// Transpose, gemm, transpose: the operands without a matrix layout are
+// packed in column major order, and the output is computed in a contiguous
+// array and copied back when it has no matrix layout.
+template <class T>
+void contractGemm(const T *a, const ContractTables &ta, const T *b,
+                  const ContractTables &tb, T *c, const ContractTables &tc) {
+   using blas::transop;
+   size_t m = ta.rows.size();
+   size_t k = ta.cols.size();
+   size_t n = tb.cols.size();
+   size_t batch = tc.batch.size();
+
+   std::vector<T> apacked, bpacked, cpacked;
+   auto la = tableLayout(ta.rows, ta.cols);
+   auto sa = uniformStride(ta.batch);
+   if (!la || !sa) {
+      apacked = packTables(a, ta);
+      a = apacked.data();
+      la = MatrixLayout{transop::no, std::max<size_t>(m, 1)};
+      sa = m * k;
+   }
+   auto lb = tableLayout(tb.rows, tb.cols);
+   auto sb = uniformStride(tb.batch);
+   if (!lb || !sb) {
+      bpacked = packTables(b, tb);
+      b = bpacked.data();
+      lb = MatrixLayout{transop::no, std::max<size_t>(k, 1)};
+      sb = k * n;
+   }
+   auto lc = tableLayout(tc.rows, tc.cols);
+   auto sc = uniformStride(tc.batch);
+   T *cdata = c;
+   if (!lc || !sc) {
+      cpacked.resize(m * n * batch);
+      cdata = cpacked.data();
+      lc = MatrixLayout{transop::no, std::max<size_t>(m, 1)};
+      sc = m * n;
+   }
+
+   if (lc->trans == transop::no) {
+      gemmStridedBatch(la->trans, lb->trans, m, n, k, a, la->ld, *sa, b,
+                       lb->ld, *sb, cdata, lc->ld, *sc, batch);
+   } else {
+      // c' = b' * a'
+      gemmStridedBatch(flip(lb->trans), flip(la->trans), n, m, k, b, lb->ld,
+                       *sb, a, la->ld, *sa, cdata, lc->ld, *sc, batch);
+   }
+
+   if (!cpacked.empty()) {
+      ::ten::parallel::parallelFor(
+          0, batch, 1,
+          [&](size_t first, size_t last) {
+             for (size_t p = first; p < last; p++) {
+                const T *src = cpacked.data() + p * m * n;
+                for (size_t j = 0; j < n; j++) {
+                   T *dst = c + tc.batch[p] + tc.cols[j];
+                   for (size_t i = 0; i < m; i++) {
+                      dst[tc.rows[i]] = src[i + j * m];
+                   }
+                }
+             }
+          },
+          m * n);
+   }
+}
+
+// c[b, i, j] = sum_l a[b, i, l] * b[b, l, j] by a blocked loop
+// Blocks of a and b are gathered into contiguous buffers so that the inner
+// products read contiguous memory whatever the strides of the operands.
+template <class T>
+void contractDirect(const T *a, const ContractTables &ta, const T *b,
+                    const ContractTables &tb, T *c, const ContractTables &tc) {
+   constexpr size_t mb = 32;
+   constexpr size_t nb = 32;
+   constexpr size_t kb = 256;
+   size_t m = ta.rows.size();
+   size_t k = ta.cols.size();
+   size_t n = tb.cols.size();
+   size_t batch = tc.batch.size();
+   size_t rowBlocks = (m + mb - 1) / mb;
+
+   ::ten::parallel::parallelFor(
+       0, batch * rowBlocks, 1,
+       [&](size_t first, size_t last) {
+          std::vector<T> ablock(mb * kb), bblock(kb * nb), cblock(mb * nb);
+          for (size_t task = first; task < last; task++) {
+             size_t p = task / rowBlocks;
+             size_t i0 = (task % rowBlocks) * mb;
+             size_t mi = std::min(mb, m - i0);
+             const T *ap = a + ta.batch[p];
+             const T *bp = b + tb.batch[p];
+             T *cp = c + tc.batch[p];
+             for (size_t j0 = 0; j0 < n; j0 += nb) {
+                size_t nj = std::min(nb, n - j0);
+                std::fill(cblock.begin(), cblock.end(), T(0));
+                for (size_t l0 = 0; l0 < k; l0 += kb) {
+                   size_t kl = std::min(kb, k - l0);
+                   for (size_t i = 0; i < mi; i++) {
+                      for (size_t l = 0; l < kl; l++) {
+                         ablock[i * kl + l] =
+                             ap[ta.rows[i0 + i] + ta.cols[l0 + l]];
+                      }
+                   }
+                   for (size_t j = 0; j < nj; j++) {
+                      for (size_t l = 0; l < kl; l++) {
+                         bblock[j * kl + l] =
+                             bp[tb.rows[l0 + l] + tb.cols[j0 + j]];
+                      }
+                   }
+                   for (size_t i = 0; i < mi; i++) {
+                      for (size_t j = 0; j < nj; j++) {
+                         T s = T(0);
+                         for (size_t l = 0; l < kl; l++) {
+                            s += ablock[i * kl + l] * bblock[j * kl + l];
+                         }
+                         cblock[i * nb + j] += s;
+                      }
+                   }
+                }
+                for (size_t i = 0; i < mi; i++) {
+                   for (size_t j = 0; j < nj; j++) {
+                      cp[tc.rows[i0 + i] + tc.cols[j0 + j]] =
+                          cblock[i * nb + j];
+                   }
+                }
+             }
+          }
+       },
+       mb * n * std::max<size_t>(k, 1));
+}
+
+// Contraction of two operands into c
+// The labels of a and b are split into batch labels (of both operands and of
+// c), contracted labels (not in c), and the free labels of a and of b. The
+// contraction is then a batch of matrix products
+// c[batch, freeA, freeB] = sum_contracted a[batch, freeA, contracted] *
+//                                         b[batch, contracted, freeB]
+// evaluated by gemm when the products are large enough.
+template <class T>
+void contractPair(const ContractOperand<const T *> &a,
+                  const ContractOperand<const T *> &b,
+                  const ContractOperand<T *> &c) {
+   LabelGroup batch, freeA, freeB, contracted;
+   auto classify = [&](char label, size_t dim) {
+      bool inA = a.has(label);
+      bool inB = b.has(label);
+      if (!c.has(label)) {
+         contracted.add(label, dim);
+      } else if (inA && inB) {
+         batch.add(label, dim);
+      } else if (inA) {
+         freeA.add(label, dim);
+      } else {
+         freeB.add(label, dim);
+      }
+   };
+   for (size_t i = 0; i < a.labels.size(); i++) {
+      classify(a.labels[i], a.dims[i]);
+   }
+   for (size_t i = 0; i < b.labels.size(); i++) {
+      if (!a.has(b.labels[i])) {
+         classify(b.labels[i], b.dims[i]);
+      }
+   }
+   ContractTables ta{groupOffsets(a, batch), groupOffsets(a, freeA),
+                     groupOffsets(a, contracted)};
+   ContractTables tb{groupOffsets(b, batch), groupOffsets(b, contracted),
+                     groupOffsets(b, freeB)};
+   ContractTables tc{groupOffsets(c, batch), groupOffsets(c, freeA),
+                     groupOffsets(c, freeB)};
+   size_t m = freeA.size();
+   size_t n = freeB.size();
+   size_t k = contracted.size();
+   TENSEUR_PROFILE_SCOPE("contractPair", "kernel");
+   TENSEUR_PROFILE_COUNT(0, m * n * batch.size() * sizeof(T),
+                         2 * m * n * k * batch.size());
+   if (m * n * batch.size() == 0) {
+      return;
+   }
+   if (k > 1 && m * n * k >= TENSEUR_CONTRACT_GEMM_THRESHOLD) {
+      contractGemm(a.data, ta, b.data, tb, c.data, tc);
+   } else {
+      contractDirect(a.data, ta, b.data, tb, c.data, tc);
+   }
+}
+
+// Sum a over its labels that aren't labels of c
+template <class T>
+void contractSingle(const ContractOperand<const T *> &a,
+                    const ContractOperand<T *> &c) {
+   LabelGroup kept, summed;
+   for (size_t i = 0; i < a.labels.size(); i++) {
+      if (c.has(a.labels[i])) {
+         kept.add(a.labels[i], a.dims[i]);
+      } else {
+         summed.add(a.labels[i], a.dims[i]);
+      }
+   }
+   // Labels of c missing from a are broadcast
+   for (size_t i = 0; i < c.labels.size(); i++) {
+      if (!a.has(c.labels[i])) {
+         kept.add(c.labels[i], c.dims[i]);
+      }
+   }
+   std::vector<size_t> offsetsA = groupOffsets(a, kept);
+   std::vector<size_t> offsetsC = groupOffsets(c, kept);
+   std::vector<size_t> offsetsS = groupOffsets(a, summed);
+   TENSEUR_PROFILE_SCOPE("contractSingle", "kernel");
+   ::ten::parallel::parallelFor(
+       0, offsetsA.size(), 1,
+       [&](size_t first, size_t last) {
+          for (size_t i = first; i < last; i++) {
+             T s = T(0);
+             const T *ap = a.data + offsetsA[i];
+             for (size_t l = 0; l < offsetsS.size(); l++) {
+                s += ap[offsetsS[l]];
+             }
+             c.data[offsetsC[i]] = s;
+          }
+       },
+       std::max<size_t>(offsetsS.size(), 1));
+}
+
+// Contiguous intermediate result of the given labels
+template <class T>
+ContractOperand<T *> makeIntermediate(std::vector<char> labels,
+                                      std::vector<size_t> dims) {
+   ContractOperand<T *> x;
+   x.labels = std::move(labels);
+   x.dims = std::move(dims);
+   x.strides.resize(x.dims.size());
+   size_t size = 1;
+   for (size_t i = 0; i < x.dims.size(); i++) {
+      x.strides[i] = size;
+      size *= x.dims[i];
+   }
+   auto storage = std::make_shared<std::vector<T>>(size);
+   x.data = storage->data();
+   x.storage = storage;
+   return x;
+}
+
+template <class T>
+ContractOperand<const T *> asInput(const ContractOperand<T *> &x) {
+   return ContractOperand<const T *>{x.data, x.labels, x.dims, x.strides,
+                                     x.storage};
+}
+
+// Labels of the result of contracting operands i and j
+// A label is kept if it's a label of the output or of another operand.
+template <class T>
+void keptLabels(const std::vector<ContractOperand<const T *>> &operands,
+                size_t i, size_t j, const ContractOperand<T *> &c,
+                std::vector<char> &labels, std::vector<size_t> &dims) {
+   auto kept = [&](char label) {
+      if (c.has(label)) {
+         return true;
+      }
+      for (size_t p = 0; p < operands.size(); p++) {
+         if (p != i && p != j && operands[p].has(label)) {
+            return true;
+         }
+      }
+      return false;
+   };
+   for (size_t p : {i, j}) {
+      const auto &x = operands[p];
+      for (size_t d = 0; d < x.labels.size(); d++) {
+         if (kept(x.labels[d]) &&
+             std::find(labels.begin(), labels.end(), x.labels[d]) ==
+                 labels.end()) {
+            labels.push_back(x.labels[d]);
+            dims.push_back(x.dims[d]);
+         }
+      }
+   }
+}
+} // namespace details
+
+/// \fn contract
+/// Contraction of labeled operands into the labeled output c
+/// Labels of the operands that aren't labels of c are summed, a label
+/// repeated in an operand reads its diagonal. The operands
+/// are contracted pairwise, the pair of smallest cost first: the number of
+/// multiply adds, then the size of the result. Each pairwise contraction is a
+/// batch of matrix products, computed by gemm after permuting the operands
+/// that aren't laid out as matrices when the products are large enough, and by
+/// a blocked loop otherwise.
+template <class T>
+void contract(std::vector<ContractOperand<const T *>> operands,
+              const ContractOperand<T *> &c) {
+   TENSEUR_PROFILE_SCOPE("contract", "kernel");
+   for (auto &x : operands) {
+      details::mergeRepeated(x);
+   }
+   details::checkDims(operands, c);
+
+   // Sum first the labels of a single operand
+   for (size_t p = 0; p < operands.size() && operands.size() > 1; p++) {
+      std::vector<char> labels;
+      std::vector<size_t> dims;
+      details::keptLabels(operands, p, p, c, labels, dims);
+      if (labels.size() < operands[p].labels.size()) {
+         auto x = details::makeIntermediate<T>(labels, dims);
+         details::contractSingle(operands[p], x);
+         operands[p] = details::asInput(x);
+      }
+   }
+
+   while (operands.size() > 2) {
+      size_t bestI = 0, bestJ = 1;
+      size_t bestCost = 0, bestSize = 0;
+      bool first = true;
+      for (size_t i = 0; i < operands.size(); i++) {
+         for (size_t j = i + 1; j < operands.size(); j++) {
+            std::vector<char> labels;
+            std::vector<size_t> dims;
+            details::keptLabels(operands, i, j, c, labels, dims);
+            details::LabelGroup all;
+            for (size_t p : {i, j}) {
+               for (size_t d = 0; d < operands[p].labels.size(); d++) {
+                  if (std::find(all.labels.begin(), all.labels.end(),
+                                operands[p].labels[d]) == all.labels.end()) {
+                     all.add(operands[p].labels[d], operands[p].dims[d]);
+                  }
+               }
+            }
+            size_t size = 1;
+            for (size_t d : dims) {
+               size *= d;
+            }
+            size_t cost = all.size();
+            if (first || cost < bestCost ||
+                (cost == bestCost && size < bestSize)) {
+               bestI = i;
+               bestJ = j;
+               bestCost = cost;
+               bestSize = size;
+               first = false;
+            }
+         }
+      }
+      std::vector<char> labels;
+      std::vector<size_t> dims;
+      details::keptLabels(operands, bestI, bestJ, c, labels, dims);
+      auto x = details::makeIntermediate<T>(labels, dims);
+      details::contractPair(operands[bestI], operands[bestJ], x);
+      operands.erase(operands.begin() + bestJ);
+      operands[bestI] = details::asInput(x);
+   }
+
+   if (operands.size() == 2) {
+      details::contractPair(operands[0], operands[1], c);
+   } else {
+      details::contractSingle(operands[0], c);
+   }
+}
+
+} // namespace ten::kernels
+
+#endif
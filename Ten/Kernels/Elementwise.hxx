@@ -0,0 +1,153 @@
+#ifndef TA_KERNELS_ELEMENTWISE_HXX
+#define TA_KERNELS_ELEMENTWISE_HXX
+
+#include <algorithm>
+#include <experimental/simd>
+#include <type_traits>
+
+#include <Ten/Config.hxx>
+#include <Ten/Kernels/Simd.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Profile.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::kernels {
+
+namespace details {
+// Tile sizes of the blocked traversal, in runs and in elements of a run
+static constexpr size_t tileRuns = 32;
+static constexpr size_t tileInner = 64;
+
+// Evaluate a range of elements [first, last) of the run into ptr
+template <class E, class T>
+inline void elementwiseRun(const E &expr, T *ptr, size_t run, size_t first,
+                           size_t last) {
+   size_t i = first;
+   if constexpr (::ten::isVectorizable<T>::value) {
+      using vector_type = simd_type<T>;
+      constexpr size_t vlen = vector_type::size();
+      for (; i + vlen <= last; i += vlen) {
+         vector_type c_vec = expr.template load<vector_type>(run, i);
+         c_vec.copy_to(ptr + i, std::experimental::element_aligned);
+      }
+   }
+   for (; i < last; i++) {
+      ptr[i] = expr.template load<T>(run, i);
+   }
+}
+
+// Evaluate an expression with non contiguous inputs into the contiguous c, by
+// runs along the innermost dimension. The expression provides
+// load<V>(run, index) reading the index'th element of a run.
+// When an input isn't read with a unit stride along the runs, as a transposed
+// matrix, the runs are traversed by tiles so that the cache lines of the input
+// are reused by the neighbouring runs of the tile.
+template <class E, class C> void elementwiseStrided(const E &expr, C &c) {
+   using T = typename C::value_type;
+   constexpr size_t innerAxis =
+       C::storageOrder() == ::ten::StorageOrder::ColMajor ? 0 : C::rank() - 1;
+   size_t inner = c.dim(innerAxis);
+   if (inner == 0) {
+      return;
+   }
+   T *data = c.data();
+   size_t runs = c.size() / inner;
+   if (expr.hasUnitInnerStride() || inner <= tileInner) {
+      ::ten::parallel::parallelFor(
+          0, runs, 1,
+          [&](size_t first, size_t last) {
+             for (size_t run = first; run < last; run++) {
+                elementwiseRun(expr, data + run * inner, run, 0, inner);
+             }
+          },
+          inner);
+      return;
+   }
+   size_t tiles = (runs + tileRuns - 1) / tileRuns;
+   ::ten::parallel::parallelFor(
+       0, tiles, 1,
+       [&](size_t first, size_t last) {
+          for (size_t tile = first; tile < last; tile++) {
+             size_t runFirst = tile * tileRuns;
+             size_t runLast = std::min(runFirst + tileRuns, runs);
+             for (size_t i = 0; i < inner; i += tileInner) {
+                size_t iLast = std::min(i + tileInner, inner);
+                for (size_t run = runFirst; run < runLast; run++) {
+                   elementwiseRun(expr, data + run * inner, run, i, iLast);
+                }
+             }
+          }
+       },
+       tileRuns * inner);
+}
+} // namespace details
+
+/// \fn elementwise
+/// Evaluate an elementwise expression into c in a single pass.
+/// The expression provides load<V>(offset) where V is either the value type of
+/// c or a simd vector of it, each input is read once and c is written once.
+/// The loop is split over the threads of the thread pool.
+/// Expressions reading non contiguous views are evaluated by runs along the
+/// innermost dimension, by tiles of runs for transposed views.
+template <class E, class C> static void elementwise(const E &expr, C &c) {
+   using T = typename C::value_type;
+   size_t n = c.size();
+   T *data = c.data();
+   TENSEUR_PROFILE_SCOPE("elementwise", "kernel");
+   TENSEUR_PROFILE_COUNT(0, n * sizeof(T), 0);
+
+   if constexpr (requires { expr.isContiguous(); }) {
+      if (!expr.isContiguous()) {
+         details::elementwiseStrided(expr, c);
+         return;
+      }
+   }
+
+   if constexpr (::ten::isVectorizable<T>::value) {
+      using vector_type = simd_type<T>;
+      ::ten::parallel::parallelFor(
+          0, n, vector_type::size(), [&](size_t first, size_t last) {
+             simdLoop(
+                 data, first, last,
+                 [&](size_t offset) {
+                    vector_type c_vec = expr.template load<vector_type>(offset);
+                    c_vec.copy_to(data + offset,
+                                  std::experimental::vector_aligned);
+                 },
+                 [&](size_t i) { data[i] = expr.template load<T>(i); });
+          });
+   } else {
+      ::ten::parallel::parallelFor(0, n, 1, [&](size_t first, size_t last) {
+         for (size_t i = first; i < last; i++) {
+            data[i] = expr.template load<T>(i);
+         }
+      });
+   }
+}
+
+namespace details {
+// Apply a function to the elements of a
+template <class A, class F> struct UnaryEvaluator {
+   const typename A::value_type *_data;
+   const F &_func;
+
+   template <class V> V load(size_t offset) const {
+      if constexpr (std::experimental::is_simd_v<V>) {
+         return _func(V(_data + offset, std::experimental::element_aligned));
+      } else {
+         return _func(static_cast<V>(_data[offset]));
+      }
+   }
+};
+} // namespace details
+
+/// \fn unaryOps
+/// b[i] = func(a[i]), where func applies to scalars and simd vectors
+template <class A, class B, class F>
+static void unaryOps(const A &a, B &b, const F &func) {
+   elementwise(details::UnaryEvaluator<A, F>{a.data(), func}, b);
+}
+
+} // namespace ten::kernels
+
+#endif
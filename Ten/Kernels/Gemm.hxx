@@ -0,0 +1,418 @@
+#ifndef TA_KERNELS_GEMM_HXX
+#define TA_KERNELS_GEMM_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <experimental/simd>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include <Ten/Config.hxx>
+#include <Ten/Kernels/BlasAPI.hxx>
+#include <Ten/Kernels/Simd.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Storage/Allocator.hxx>
+
+/// Native matrix products used when no BLAS library is available or for value
+/// types without BLAS routines. They take the arguments of the corresponding
+/// column major BLAS routines.
+namespace ten::kernels::native {
+
+using ::ten::kernels::blas::transop;
+
+namespace details {
+// Register tile and cache blocks of the gemm kernel
+// The micro tile of mr x nr elements of c is held in mv * nr simd registers.
+// The packed panel of b (kc x nr) stays in L1, the packed block of a
+// (mc x kc) in L2 and the packed block of b (kc x nc) in L3.
+template <class T> struct GemmBlocking {
+   static constexpr bool vectorized = ::ten::isVectorizable<T>::value;
+   static constexpr size_t vlen = vectorized ? ::ten::simdVecLen<T> : 1;
+   static constexpr size_t mv = vectorized ? 2 : 4;
+   static constexpr size_t mr = mv * vlen;
+   static constexpr size_t nr =
+       vectorized ? (vlen * sizeof(T) >= 64 ? 12 : 6) : 4;
+   static constexpr size_t kc = sizeof(T) <= 4 ? 384 : 256;
+   static constexpr size_t mc = ((sizeof(T) <= 4 ? 480 : 240) / mr) * mr;
+   static constexpr size_t nc = (3072 / nr) * nr;
+};
+
+// Simd vector of the micro kernel, the type itself if it's not vectorizable
+template <class T, bool = GemmBlocking<T>::vectorized> struct GemmVector {
+   using type = T;
+};
+template <class T> struct GemmVector<T, true> {
+   using type = simd_type<T>;
+};
+template <class T> using gemm_vector_type = typename GemmVector<T>::type;
+
+// Call f(integral_constant<I>) for I in [0, N), unrolled
+template <class F, size_t... I>
+inline void unroll(F &&f, std::index_sequence<I...>) {
+   (f(std::integral_constant<size_t, I>()), ...);
+}
+
+template <size_t N, class F> inline void unroll(F &&f) {
+   unroll(f, std::make_index_sequence<N>());
+}
+
+// a * b + c
+// The floating point operations are not contracted in ISO C++ and
+// std::experimental::fma calls the scalar fma, so the fused multiply add
+// instructions are called directly when the simd vector converts to an
+// intrinsic type.
+template <class V> inline V fmadd(const V &a, const V &b, const V &c) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      using T = typename V::value_type;
+#if defined(__AVX512F__)
+      if constexpr (std::is_same_v<T, float> &&
+                    requires { static_cast<__m512>(a); }) {
+         return V(_mm512_fmadd_ps(static_cast<__m512>(a), static_cast<__m512>(b),
+                                  static_cast<__m512>(c)));
+      } else if constexpr (std::is_same_v<T, double> &&
+                           requires { static_cast<__m512d>(a); }) {
+         return V(_mm512_fmadd_pd(static_cast<__m512d>(a),
+                                  static_cast<__m512d>(b),
+                                  static_cast<__m512d>(c)));
+      }
+#endif
+#if defined(__FMA__)
+      if constexpr (std::is_same_v<T, float> &&
+                    requires { static_cast<__m256>(a); }) {
+         return V(_mm256_fmadd_ps(static_cast<__m256>(a), static_cast<__m256>(b),
+                                  static_cast<__m256>(c)));
+      } else if constexpr (std::is_same_v<T, double> &&
+                           requires { static_cast<__m256d>(a); }) {
+         return V(_mm256_fmadd_pd(static_cast<__m256d>(a),
+                                  static_cast<__m256d>(b),
+                                  static_cast<__m256d>(c)));
+      } else if constexpr (std::is_same_v<T, float> &&
+                           requires { static_cast<__m128>(a); }) {
+         return V(_mm_fmadd_ps(static_cast<__m128>(a), static_cast<__m128>(b),
+                               static_cast<__m128>(c)));
+      } else if constexpr (std::is_same_v<T, double> &&
+                           requires { static_cast<__m128d>(a); }) {
+         return V(_mm_fmadd_pd(static_cast<__m128d>(a), static_cast<__m128d>(b),
+                               static_cast<__m128d>(c)));
+      }
+#endif
+   }
+   return a * b + c;
+}
+
+template <class T> std::vector<T, AlignedAllocator<T, 64>> &packBuffer() {
+   thread_local std::vector<T, AlignedAllocator<T, 64>> buffer;
+   return buffer;
+}
+
+// Pack op(a)[i0:i0+mc, l0:l0+kc] in panels of mr rows, padded with zeros
+// Panel p holds the elements (i0 + p * mr + i, l0 + l) at p * kc * mr + l * mr
+template <class T>
+void packA(transop trans, const T *a, size_t lda, size_t i0, size_t mc,
+           size_t l0, size_t kc, T *packed) {
+   constexpr size_t mr = GemmBlocking<T>::mr;
+   for (size_t p = 0; p < mc; p += mr) {
+      size_t rows = std::min(mr, mc - p);
+      T *panel = packed + (p / mr) * kc * mr;
+      for (size_t l = 0; l < kc; l++) {
+         T *dst = panel + l * mr;
+         if (trans == transop::no) {
+            const T *src = a + (i0 + p) + (l0 + l) * lda;
+            for (size_t i = 0; i < rows; i++) {
+               dst[i] = src[i];
+            }
+         } else {
+            const T *src = a + (l0 + l) + (i0 + p) * lda;
+            for (size_t i = 0; i < rows; i++) {
+               dst[i] = src[i * lda];
+            }
+         }
+         for (size_t i = rows; i < mr; i++) {
+            dst[i] = T(0);
+         }
+      }
+   }
+}
+
+// Pack op(b)[l0:l0+kc, j0:j0+nc] in panels of nr columns, padded with zeros
+// Panel q holds the elements (l0 + l, j0 + q * nr + j) at q * kc * nr + l * nr
+template <class T>
+void packB(transop trans, const T *b, size_t ldb, size_t l0, size_t kc,
+           size_t j0, size_t nc, T *packed) {
+   constexpr size_t nr = GemmBlocking<T>::nr;
+   for (size_t q = 0; q < nc; q += nr) {
+      size_t cols = std::min(nr, nc - q);
+      T *panel = packed + (q / nr) * kc * nr;
+      for (size_t j = 0; j < cols; j++) {
+         if (trans == transop::no) {
+            const T *src = b + l0 + (j0 + q + j) * ldb;
+            for (size_t l = 0; l < kc; l++) {
+               panel[l * nr + j] = src[l];
+            }
+         } else {
+            const T *src = b + (j0 + q + j) + l0 * ldb;
+            for (size_t l = 0; l < kc; l++) {
+               panel[l * nr + j] = src[l * ldb];
+            }
+         }
+      }
+      for (size_t j = cols; j < nr; j++) {
+         for (size_t l = 0; l < kc; l++) {
+            panel[l * nr + j] = T(0);
+         }
+      }
+   }
+}
+
+// c[0:mr, 0:nr] = alpha * a * b + beta * c, a and b being packed panels
+// beta equal to zero doesn't read c
+template <class T>
+void microKernel(size_t kc, T alpha, const T *a, const T *b, T beta,
+                 T *c, size_t ldc) {
+   using blocking = GemmBlocking<T>;
+   using V = gemm_vector_type<T>;
+   constexpr size_t vlen = blocking::vlen;
+   constexpr size_t mv = blocking::mv;
+   constexpr size_t mr = blocking::mr;
+   constexpr size_t nr = blocking::nr;
+
+   auto load = [](const T *ptr) {
+      if constexpr (std::experimental::is_simd_v<V>) {
+         return V(ptr, std::experimental::vector_aligned);
+      } else {
+         return *ptr;
+      }
+   };
+
+   V acc[nr][mv];
+   unroll<nr>([&](auto j) {
+      unroll<mv>([&](auto v) { acc[j][v] = V(T(0)); });
+   });
+   for (size_t l = 0; l < kc; l++) {
+      V x[mv];
+      unroll<mv>([&](auto v) { x[v] = load(a + l * mr + v * vlen); });
+      unroll<nr>([&](auto j) {
+         V y(b[l * nr + j]);
+         unroll<mv>([&](auto v) { acc[j][v] = fmadd(x[v], y, acc[j][v]); });
+      });
+   }
+
+   unroll<nr>([&](auto j) {
+      unroll<mv>([&](auto v) {
+         T *ptr = c + j * ldc + v * vlen;
+         V res = V(alpha) * acc[j][v];
+         if constexpr (std::experimental::is_simd_v<V>) {
+            if (beta != T(0)) {
+               res = fmadd(V(beta),
+                           V(ptr, std::experimental::element_aligned), res);
+            }
+            res.copy_to(ptr, std::experimental::element_aligned);
+         } else {
+            *ptr = (beta != T(0)) ? res + beta * (*ptr) : res;
+         }
+      });
+   });
+}
+
+// c[i0:i0+mc, j0:j0+nc] = alpha * a * b + beta * c from packed blocks
+template <class T>
+void macroKernel(size_t mc, size_t nc, size_t kc, T alpha,
+                 const T *a, const T *b, T beta, T *c, size_t ldc) {
+   constexpr size_t mr = GemmBlocking<T>::mr;
+   constexpr size_t nr = GemmBlocking<T>::nr;
+   alignas(64) T tile[mr * nr];
+   for (size_t q = 0; q < nc; q += nr) {
+      size_t cols = std::min(nr, nc - q);
+      const T *panelB = b + (q / nr) * kc * nr;
+      for (size_t p = 0; p < mc; p += mr) {
+         size_t rows = std::min(mr, mc - p);
+         const T *panelA = a + (p / mr) * kc * mr;
+         T *ptr = c + p + q * ldc;
+         if (rows == mr && cols == nr) {
+            microKernel(kc, alpha, panelA, panelB, beta, ptr, ldc);
+         } else {
+            // Partial tile
+            microKernel(kc, T(1), panelA, panelB, T(0), tile, mr);
+            for (size_t j = 0; j < cols; j++) {
+               for (size_t i = 0; i < rows; i++) {
+                  T res = alpha * tile[i + j * mr];
+                  ptr[i + j * ldc] = (beta != T(0))
+                                         ? res + beta * ptr[i + j * ldc]
+                                         : res;
+               }
+            }
+         }
+      }
+   }
+}
+
+// y = alpha * sum of a[:, j] * x[j] + y for a column range, y contiguous
+template <class T>
+void gemvColumns(size_t rows, size_t n, T alpha, const T *a,
+                 size_t lda, const T *x, size_t incx, T *y) {
+   size_t j = 0;
+   for (; j + 4 <= n; j += 4) {
+      T x0 = alpha * x[j * incx], x1 = alpha * x[(j + 1) * incx];
+      T x2 = alpha * x[(j + 2) * incx], x3 = alpha * x[(j + 3) * incx];
+      const T *a0 = a + j * lda, *a1 = a0 + lda, *a2 = a1 + lda,
+              *a3 = a2 + lda;
+      for (size_t i = 0; i < rows; i++) {
+         y[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+      }
+   }
+   for (; j < n; j++) {
+      T xj = alpha * x[j * incx];
+      const T *aj = a + j * lda;
+      for (size_t i = 0; i < rows; i++) {
+         y[i] += aj[i] * xj;
+      }
+   }
+}
+
+// Dot product of a column of a and x
+template <class T>
+T gemvDot(size_t m, const T *a, const T *x, size_t incx) {
+   if constexpr (::ten::isVectorizable<T>::value) {
+      if (incx == 1) {
+         using V = simd_type<T>;
+         constexpr size_t vlen = V::size();
+         V acc0(T(0)), acc1(T(0));
+         size_t i = 0;
+         for (; i + 2 * vlen <= m; i += 2 * vlen) {
+            acc0 = fmadd(V(a + i, std::experimental::element_aligned),
+                         V(x + i, std::experimental::element_aligned), acc0);
+            acc1 = fmadd(V(a + i + vlen, std::experimental::element_aligned),
+                         V(x + i + vlen, std::experimental::element_aligned),
+                         acc1);
+         }
+         T res = std::experimental::reduce(acc0 + acc1);
+         for (; i < m; i++) {
+            res += a[i] * x[i];
+         }
+         return res;
+      }
+   }
+   T res = T(0);
+   for (size_t i = 0; i < m; i++) {
+      res += a[i] * x[i * incx];
+   }
+   return res;
+}
+} // namespace details
+
+/// \fn gemm
+/// General matrix multiplication c = alpha * op(a) * op(b) + beta * c
+/// Column major, with packed panels, cache blocking and a simd register tiled
+/// micro kernel. The row blocks of c are computed in parallel.
+template <class T>
+void gemm(transop transa, transop transb, const size_t m,
+          const size_t n, const size_t k, const T alpha, const T *a,
+          const size_t lda, const T *b, const size_t ldb, const T beta,
+          T *c, const size_t ldc) {
+   using blocking = details::GemmBlocking<T>;
+   constexpr size_t mc = blocking::mc;
+   constexpr size_t nc = blocking::nc;
+   constexpr size_t kc = blocking::kc;
+   constexpr size_t mr = blocking::mr;
+   constexpr size_t nr = blocking::nr;
+   if (m == 0 || n == 0) {
+      return;
+   }
+   if (k == 0 || alpha == T(0)) {
+      for (size_t j = 0; j < n; j++) {
+         for (size_t i = 0; i < m; i++) {
+            c[i + j * ldc] = (beta != T(0)) ? beta * c[i + j * ldc] : T(0);
+         }
+      }
+      return;
+   }
+
+   std::vector<T, AlignedAllocator<T, 64>> packedB(
+       kc * ((std::min(n, nc) + nr - 1) / nr) * nr);
+   size_t numBlocks = (m + mc - 1) / mc;
+
+   for (size_t j0 = 0; j0 < n; j0 += nc) {
+      size_t ncur = std::min(nc, n - j0);
+      for (size_t l0 = 0; l0 < k; l0 += kc) {
+         size_t kcur = std::min(kc, k - l0);
+         T betaBlock = (l0 == 0) ? beta : T(1);
+         details::packB(transb, b, ldb, l0, kcur, j0, ncur, packedB.data());
+
+         ::ten::parallel::parallelFor(
+             0, numBlocks, 1,
+             [&](size_t first, size_t last) {
+                auto &packedA = details::packBuffer<T>();
+                packedA.resize(kc * ((mc + mr - 1) / mr) * mr);
+                for (size_t block = first; block < last; block++) {
+                   size_t i0 = block * mc;
+                   size_t mcur = std::min(mc, m - i0);
+                   details::packA(transa, a, lda, i0, mcur, l0, kcur,
+                                  packedA.data());
+                   details::macroKernel(mcur, ncur, kcur, alpha,
+                                        packedA.data(), packedB.data(),
+                                        betaBlock, c + i0 + j0 * ldc, ldc);
+                }
+             },
+             mc * ncur * kcur / 64);
+      }
+   }
+}
+
+/// \fn gemv
+/// Matrix vector multiplication y = alpha * op(a) * x + beta * y
+/// Column major, a is m x n.
+template <class T>
+void gemv(transop trans, const size_t m, const size_t n, const T alpha,
+          const T *a, const size_t lda, const T *x, const size_t incx,
+          const T beta, T *y, const size_t incy) {
+   size_t ny = (trans == transop::no) ? m : n;
+   for (size_t i = 0; i < ny; i++) {
+      y[i * incy] = (beta != T(0)) ? beta * y[i * incy] : T(0);
+   }
+   if (alpha == T(0)) {
+      return;
+   }
+
+   if (trans == transop::no) {
+      // Blocks of rows of y that stay in L1 while looping over the columns
+      constexpr size_t blockSize = 2048;
+      ::ten::parallel::parallelFor(
+          0, m, blockSize,
+          [&](size_t first, size_t last) {
+             std::vector<T> buffer;
+             for (size_t i0 = first; i0 < last; i0 += blockSize) {
+                size_t rows = std::min(blockSize, last - i0);
+                T *yb = y + i0;
+                if (incy != 1) {
+                   buffer.assign(rows, T(0));
+                   yb = buffer.data();
+                }
+                details::gemvColumns(rows, n, alpha, a + i0, lda, x, incx, yb);
+                if (incy != 1) {
+                   for (size_t i = 0; i < rows; i++) {
+                      y[(i0 + i) * incy] += yb[i];
+                   }
+                }
+             }
+          },
+          n);
+   } else {
+      ::ten::parallel::parallelFor(
+          0, n, 1,
+          [&](size_t first, size_t last) {
+             for (size_t j = first; j < last; j++) {
+                y[j * incy] += alpha * details::gemvDot(m, a + j * lda, x, incx);
+             }
+          },
+          m);
+   }
+}
+
+} // namespace ten::kernels::native
+
+#endif
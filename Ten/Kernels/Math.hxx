@@ -0,0 +1,432 @@
+#ifndef TA_KERNELS_MATH_HXX
+#define TA_KERNELS_MATH_HXX
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <experimental/simd>
+#include <limits>
+#include <type_traits>
+
+#include <Ten/Kernels/Gemm.hxx>
+#include <Ten/Kernels/Simd.hxx>
+
+/// Transcendental functions of float and double scalars and simd vectors
+///
+/// The functions are evaluated without branches, by a range reduction and a
+/// polynomial or rational approximation, in the same way for a scalar and for
+/// each lane of a simd vector. Their maximum errors in ulp (units in the last
+/// place), measured against the functions of double or long double precision
+/// over their whole range, are
+///
+/// | Function        | float | double |
+/// | --------------- | ----- | ------ |
+/// | exp, log, erf   | 1     | 1      |
+/// | expm1           | 2     | 2      |
+/// | log1p           | 3     | 3      |
+/// | tanh, sigmoid   | 3     | 3      |
+/// | pow             | 1     | 1      |
+///
+/// The results of exp below the smallest normal number are subnormal numbers
+/// rounded twice. pow isn't approximated: the small integer exponents are
+/// computed by multiplications, y = 0, 1 or 2 for float and the integers
+/// |y| <= 4 for double within 3 ulp, and the other exponents by std::pow for
+/// each element, in double precision for float.
+namespace ten::kernels::math {
+
+namespace details {
+// Value type of a scalar or a simd vector
+template <class V> struct Scalar {
+   using type = V;
+};
+template <class V>
+   requires std::experimental::is_simd_v<V>
+struct Scalar<V> {
+   using type = typename V::value_type;
+};
+template <class V> using scalar_t = typename Scalar<V>::type;
+
+// Integer of the size of T
+template <class T>
+using int_t = std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>;
+
+// Integers of the size of the elements of V
+template <class V> struct IntVector {
+   using type = int_t<V>;
+};
+template <class V>
+   requires std::experimental::is_simd_v<V>
+struct IntVector<V> {
+   using type = std::experimental::rebind_simd_t<
+       int_t<typename V::value_type>, V>;
+};
+template <class V> using int_vector_t = typename IntVector<V>::type;
+
+// Constants of the floating point format of T
+template <class T> struct Format {
+   static constexpr int mantissa = std::numeric_limits<T>::digits - 1;
+   static constexpr int bias = std::numeric_limits<T>::max_exponent - 1;
+   // Adding shifter rounds to an integer stored in the low bits
+   static constexpr T shifter = T(1.5) * T(std::int64_t(1) << mantissa);
+};
+
+template <class V> inline V fmadd(const V &a, const V &b, const V &c) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return ::ten::kernels::native::details::fmadd(a, b, c);
+   } else {
+#if defined(__FMA__)
+      return std::fma(a, b, c);
+#else
+      return a * b + c;
+#endif
+   }
+}
+
+// Returns a where mask is true and b elsewhere
+template <class M, class V>
+inline V select(const M &mask, const V &a, const V &b) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      V res = b;
+      std::experimental::where(mask, res) = a;
+      return res;
+   } else {
+      return mask ? a : b;
+   }
+}
+
+template <class V> inline V abs(const V &x) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return std::experimental::abs(x);
+   } else {
+      return std::abs(x);
+   }
+}
+
+// Coefficient of a polynomial, a constant or a vector of coefficients
+template <class V, class C> inline V coefficient(const C &c) {
+   if constexpr (std::is_arithmetic_v<C>) {
+      return V(static_cast<scalar_t<V>>(c));
+   } else {
+      return c;
+   }
+}
+
+// Polynomial c0 + x * (c1 + x * (c2 + ...)) by the Horner scheme
+template <class V, class C> inline V horner(const V &, const C &c) {
+   return coefficient<V>(c);
+}
+template <class V, class C, class... Cs>
+inline V horner(const V &x, const C &c, const Cs &...cs) {
+   return fmadd(horner(x, cs...), x, coefficient<V>(c));
+}
+
+// Bits of x as integers of the same size
+template <class V> inline int_vector_t<V> toBits(const V &x) {
+   return std::bit_cast<int_vector_t<V>>(x);
+}
+
+template <class V> inline V fromBits(const int_vector_t<V> &x) {
+   return std::bit_cast<V>(x);
+}
+
+// Returns the small integers n as floating point numbers
+template <class V> inline V toFloat(const int_vector_t<V> &n) {
+   using T = scalar_t<V>;
+   using I = int_vector_t<V>;
+   constexpr T shifter = Format<T>::shifter;
+   return fromBits<V>(n + I(std::bit_cast<int_t<T>>(shifter))) - V(shifter);
+}
+
+// Returns 2^n for normal exponents n
+template <class V> inline V pow2(const int_vector_t<V> &n) {
+   using T = scalar_t<V>;
+   using I = int_vector_t<V>;
+   return fromBits<V>((n + I(Format<T>::bias)) << Format<T>::mantissa);
+}
+
+// x with the sign of y
+template <class V> inline V copysign(const V &x, const V &y) {
+   using T = scalar_t<V>;
+   using I = int_vector_t<V>;
+   const I sign(std::bit_cast<int_t<T>>(T(-0.)));
+   return fromBits<V>((toBits(x) & ~sign) | (toBits(y) & sign));
+}
+
+// Reduction of x = n log(2) + r with |r| <= log(2) / 2
+// Returns exp(r) - 1 and 2^n. x is in the range of the finite results.
+template <class V> inline V expReduced(const V &x, V &scale) {
+   using T = scalar_t<V>;
+   using I = int_vector_t<V>;
+   constexpr T shifter = Format<T>::shifter;
+   // log(2) = ln2hi + ln2lo, n * ln2hi is exact
+   constexpr T ln2hi = std::is_same_v<T, float> ? T(0.693359375)
+                                                : T(6.93147180369123816490e-01);
+   constexpr T ln2lo = std::is_same_v<T, float>
+                           ? T(-2.12194440e-4)
+                           : T(1.90821492927058770002e-10);
+   V t = fmadd(x, V(T(1.44269504088896340736)), V(shifter));
+   V n = t - V(shifter);
+   I k = toBits(t) - I(std::bit_cast<int_t<T>>(shifter));
+   V r = fmadd(n, V(-ln2hi), x);
+   r = fmadd(n, V(-ln2lo), r);
+   // 2^n in two factors, the exponents of the extreme results overflow
+   I half = k >> 1;
+   scale = pow2<V>(half) * pow2<V>(k - half);
+   // Taylor series of exp(r) - 1 = r + r^2 / 2 + r^3 / 6 + ...
+   V p;
+   if constexpr (std::is_same_v<T, float>) {
+      p = horner(r, 1. / 2, 1. / 6, 1. / 24, 1. / 120, 1. / 720, 1. / 5040,
+                 1. / 40320);
+   } else {
+      p = horner(r, 1. / 2, 1. / 6, 1. / 24, 1. / 120, 1. / 720, 1. / 5040,
+                 1. / 40320, 1. / 362880, 1. / 3628800, 1. / 39916800,
+                 1. / 479001600, 1. / 6227020800);
+   }
+   return fmadd(r * r, p, r);
+}
+
+// Clamp x to [lo, hi], NaN is kept
+template <class V>
+inline V clamp(const V &x, scalar_t<V> lo, scalar_t<V> hi) {
+   return select(x < V(lo), V(lo), select(x > V(hi), V(hi), x));
+}
+
+// Bounds of the arguments of exp giving finite non zero results
+template <class T>
+static constexpr T expMin = std::is_same_v<T, float> ? T(-104) : T(-746);
+template <class T>
+static constexpr T expMax = std::is_same_v<T, float> ? T(89) : T(710);
+} // namespace details
+
+/// \fn exp
+/// Exponential
+template <class V> inline V exp(const V &x) {
+   using T = details::scalar_t<V>;
+   V scale;
+   V p = details::expReduced(
+       details::clamp(x, details::expMin<T>, details::expMax<T>), scale);
+   return details::fmadd(scale, p, scale);
+}
+
+/// \fn expm1
+/// exp(x) - 1, accurate for the small x
+template <class V> inline V expm1(const V &x) {
+   using T = details::scalar_t<V>;
+   // exp(x) - 1 rounds to -1 below the lower bound
+   constexpr T lo = std::is_same_v<T, float> ? T(-18) : T(-38);
+   V scale;
+   V p = details::expReduced(details::clamp(x, lo, details::expMax<T>), scale);
+   return details::fmadd(scale, p, scale - V(T(1)));
+}
+
+/// \fn log
+/// Natural logarithm
+template <class V> inline V log(const V &x) {
+   using T = details::scalar_t<V>;
+   using I = details::int_vector_t<V>;
+   using details::select;
+   using format = details::Format<T>;
+   constexpr int scaleBits = format::mantissa + 2;
+   constexpr T ln2hi = std::is_same_v<T, float> ? T(0.693359375)
+                                                : T(6.93147180369123816490e-01);
+   constexpr T ln2lo = std::is_same_v<T, float>
+                           ? T(-2.12194440e-4)
+                           : T(1.90821492927058770002e-10);
+
+   // x = 2^e * m with sqrt(2) / 2 <= m < sqrt(2), the subnormal numbers are
+   // scaled to normal numbers
+   auto subnormal = x < V(std::numeric_limits<T>::min());
+   V y = select(subnormal, x * V(T(std::int64_t(1) << scaleBits)), x);
+   I bits = details::toBits(y);
+   V e = details::toFloat<V>((bits >> format::mantissa) - I(format::bias));
+   e = select(subnormal, e - V(T(scaleBits)), e);
+   const I mantissaMask((details::int_t<T>(1) << format::mantissa) - 1);
+   V m = details::fromBits<V>((bits & mantissaMask) |
+                              details::toBits(V(T(1))));
+   auto large = m > V(T(1.41421356237309504880));
+   m = select(large, m * V(T(0.5)), m);
+   e = select(large, e + V(T(1)), e);
+
+   // log(1 + f) = 2 atanh(s) = 2 s + s * R(s^2) with s = f / (2 + f)
+   V f = m - V(T(1));
+   V s = f / (V(T(2)) + f);
+   V z = s * s;
+   V r;
+   if constexpr (std::is_same_v<T, float>) {
+      r = z * details::horner(z, 2. / 3, 2. / 5, 2. / 7, 2. / 9);
+   } else {
+      r = z * details::horner(z, 2. / 3, 2. / 5, 2. / 7, 2. / 9, 2. / 11,
+                              2. / 13, 2. / 15, 2. / 17, 2. / 19);
+   }
+   V hfsq = V(T(0.5)) * f * f;
+   V res = e * V(ln2hi) - ((hfsq - (s * (hfsq + r) + e * V(ln2lo))) - f);
+
+   // Special values
+   constexpr T inf = std::numeric_limits<T>::infinity();
+   res = select(x == V(inf), x, res);
+   res = select(x == V(T(0)), V(-inf), res);
+   res = select(x < V(T(0)) || x != x,
+                V(std::numeric_limits<T>::quiet_NaN()), res);
+   return res;
+}
+
+/// \fn log1p
+/// log(1 + x), accurate for the small x
+template <class V> inline V log1p(const V &x) {
+   using T = details::scalar_t<V>;
+   using details::select;
+   // The rounding error of u = 1 + x is corrected by x / (u - 1)
+   V u = V(T(1)) + x;
+   V res = select(u == V(T(1)), x, math::log(u) * (x / (u - V(T(1)))));
+   return select(x == V(std::numeric_limits<T>::infinity()), x, res);
+}
+
+/// \fn tanh
+/// Hyperbolic tangent
+template <class V> inline V tanh(const V &x) {
+   using T = details::scalar_t<V>;
+   // tanh(x) rounds to 1 above the bound
+   constexpr T hi = std::is_same_v<T, float> ? T(10) : T(20);
+   V t = math::expm1(V(T(2)) * details::clamp(details::abs(x), T(0), hi));
+   return details::copysign(t / (t + V(T(2))), x);
+}
+
+/// \fn sigmoid
+/// Logistic function 1 / (1 + exp(-x))
+template <class V> inline V sigmoid(const V &x) {
+   using T = details::scalar_t<V>;
+   // exp(x) / (1 + exp(x)) for the negative x, without overflow
+   V e = math::exp(-details::abs(x));
+   V s = V(T(1)) / (V(T(1)) + e);
+   return details::select(x < V(T(0)), e * s, s);
+}
+
+/// \fn erf
+/// Error function
+/// Rational approximations on four ranges of |x| from the FDLIBM library of
+/// Sun Microsystems. The coefficients of the range of each lane are selected
+/// and a single rational function is evaluated.
+template <class V> inline V erf(const V &x) {
+   using T = details::scalar_t<V>;
+   using details::select;
+   // Coefficients of P and Q, by increasing degrees, on the ranges
+   // [0, 0.84375), [0.84375, 1.25), [1.25, 1 / 0.35) and [1 / 0.35, 6)
+   static constexpr double p[4][8] = {
+       {1.28379167095512558561e-01, -3.25042107247001499370e-01,
+        -2.84817495755985104766e-02, -5.77027029648944159157e-03,
+        -2.37630166566501626084e-05, 0., 0., 0.},
+       {-2.36211856075265944077e-03, 4.14856118683748331666e-01,
+        -3.72207876035701323847e-01, 3.18346619901161753674e-01,
+        -1.10894694282396677476e-01, 3.54783043256182359371e-02,
+        -2.16637559486879084300e-03, 0.},
+       {-9.86494403484714822705e-03, -6.93858572707181764372e-01,
+        -1.05586262253232909814e+01, -6.23753324503260060396e+01,
+        -1.62396669462573470355e+02, -1.84605092906711035994e+02,
+        -8.12874355063065934246e+01, -9.81432934416914548592e+00},
+       {-9.86494292470009928597e-03, -7.99283237680523006574e-01,
+        -1.77579549177547519889e+01, -1.60636384855821916062e+02,
+        -6.37566443368389627722e+02, -1.02509513161107724954e+03,
+        -4.83519191608651397019e+02, 0.}};
+   static constexpr double q[4][9] = {
+       {1., 3.97917223959155352819e-01, 6.50222499887672944485e-02,
+        5.08130628187576562776e-03, 1.32494738004321644526e-04,
+        -3.96022827877536812320e-06, 0., 0., 0.},
+       {1., 1.06420880400844228286e-01, 5.40397917702171048937e-01,
+        7.18286544141962662868e-02, 1.26171219808761642112e-01,
+        1.36370839120290507362e-02, 1.19844998467991074170e-02, 0., 0.},
+       {1., 1.96512716674392571292e+01, 1.37657754143519042600e+02,
+        4.34565877475229228821e+02, 6.45387271733267880336e+02,
+        4.29008140027567833386e+02, 1.08635005541779435134e+02,
+        6.57024977031928170135e+00, -6.04244152148580987438e-02},
+       {1., 3.03380607434824582924e+01, 3.25792512996573918826e+02,
+        1.53672958608443695994e+03, 3.19985821950859553908e+03,
+        2.55305040643316442583e+03, 4.74528541206955367215e+02,
+        -2.24409524465858183362e+01, 0.}};
+   // erf(x) rounds to 1 above the bound
+   constexpr T hi = std::is_same_v<T, float> ? T(4) : T(6);
+
+   V ax = details::abs(x);
+   auto small = ax < V(T(0.84375));
+   auto middle = ax < V(T(1.25));
+   auto lower = ax < V(T(1. / 0.35));
+   // Variable of the rational function: x^2, |x| - 1 or 1 / x^2
+   V at = details::clamp(ax, T(1.25), hi);
+   V t = select(small, x * x,
+                select(middle, ax - V(T(1)), V(T(1)) / (at * at)));
+   // Coefficients of the range of each lane, the ranges are nested
+   V num = V(T(0));
+   V den = V(T(0));
+   for (size_t i = 9; i-- > 0;) {
+      V cp(T(i < 8 ? p[3][i] : 0.));
+      V cq(T(q[3][i]));
+      std::experimental::where(lower, cp) = V(T(i < 8 ? p[2][i] : 0.));
+      std::experimental::where(lower, cq) = V(T(q[2][i]));
+      std::experimental::where(middle, cp) = V(T(i < 8 ? p[1][i] : 0.));
+      std::experimental::where(middle, cq) = V(T(q[1][i]));
+      std::experimental::where(small, cp) = V(T(i < 8 ? p[0][i] : 0.));
+      std::experimental::where(small, cq) = V(T(q[0][i]));
+      num = details::fmadd(num, t, cp);
+      den = details::fmadd(den, t, cq);
+   }
+   V r = num / den;
+
+   // erf(x) = x + x R, erx + R and 1 - exp(-x^2 - 0.5625 + R) / x
+   V tail = V(T(1)) -
+            math::exp(details::fmadd(-at, at, V(T(-0.5625))) + r) / at;
+   V res = select(small, details::fmadd(ax, r, ax),
+                  select(middle, V(T(8.45062911510467529297e-01)) + r,
+                         select(ax < V(hi), tail, V(T(1)))));
+   return details::copysign(select(x != x, x, res), x);
+}
+
+namespace details {
+// x^n by multiplications
+template <class V> inline V powInteger(const V &x, unsigned n) {
+   V res(scalar_t<V>(1));
+   V base = x;
+   while (n) {
+      if (n & 1) {
+         res *= base;
+      }
+      base *= base;
+      n >>= 1;
+   }
+   return res;
+}
+} // namespace details
+
+/// \fn pow
+/// x^y for a scalar exponent y
+/// The small integer exponents are computed by multiplications, the others by
+/// std::pow for each element, in double precision for float. exp(y log(x))
+/// loses the accuracy of log(x) multiplied by y.
+template <class V> inline V pow(const V &x, double y) {
+   using T = details::scalar_t<V>;
+   if (y == 0 || y == 1 || y == 2) {
+      return details::powInteger(x, static_cast<unsigned>(y));
+   }
+   if constexpr (std::is_same_v<T, double>) {
+      if (y == std::trunc(y) && std::abs(y) <= 4) {
+         V res = details::powInteger(x, static_cast<unsigned>(std::abs(y)));
+         return y < 0 ? V(T(1)) / res : res;
+      }
+   }
+   auto powElement = [y](T value) {
+      return static_cast<T>(std::pow(static_cast<double>(value), y));
+   };
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return V([&](auto i) { return powElement(x[i]); });
+   } else {
+      return powElement(x);
+   }
+}
+
+/// \fn isMathType
+/// Whether the functions apply to the elements of type T
+template <class T>
+static constexpr bool isMathType =
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+} // namespace ten::kernels::math
+
+#endif
@@ -1,43 +1,510 @@
 #ifndef TA_KERNELS_MUL_HXX
 #define TA_KERNELS_MUL_HXX
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Kernels/BlasAPI.hxx>
+#include <Ten/Kernels/Gemm.hxx>
+#include <Ten/Kernels/StaticMul.hxx>
+#include <Ten/Profile.hxx>
 #include <Ten/Types.hxx>
 
 namespace ten::kernels {
+
+namespace details {
+// Bytes read and written by y = op(a) * x for a m x n matrix a
+template <class T>
+constexpr size_t gemvBytesRead(blas::transop trans, size_t m, size_t n) {
+   return (m * n + (trans == blas::transop::no ? n : m)) * sizeof(T);
+}
+
+template <class T>
+constexpr size_t gemvBytesWritten(blas::transop trans, size_t m, size_t n) {
+   return (trans == blas::transop::no ? m : n) * sizeof(T);
+}
+
+// Call the BLAS gemv for BLAS types or the native one
+template <class T>
+void gemv(blas::transop trans, size_t m, size_t n, T alpha, const T *a,
+          size_t lda, const T *x, size_t incx, T beta, T *y, size_t incy) {
+#ifndef TENSEUR_NO_BLAS
+   if constexpr (blas::isBlasType<T>::value) {
+      TENSEUR_PROFILE_SCOPE("blas.gemv", "kernel");
+      TENSEUR_PROFILE_COUNT(gemvBytesRead<T>(trans, m, n),
+                            gemvBytesWritten<T>(trans, m, n), 2 * m * n);
+      blas::gemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy);
+      return;
+   }
+#endif
+   TENSEUR_PROFILE_SCOPE("native.gemv", "kernel");
+   TENSEUR_PROFILE_COUNT(gemvBytesRead<T>(trans, m, n),
+                         gemvBytesWritten<T>(trans, m, n), 2 * m * n);
+   native::gemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy);
+}
+
+// Call the BLAS gemm for BLAS types or the native one
+template <class T>
+void callGemm(blas::transop transa, blas::transop transb, size_t m, size_t n,
+              size_t k, T alpha, const T *a, size_t lda, const T *b,
+              size_t ldb, T beta, T *c, size_t ldc) {
+#ifndef TENSEUR_NO_BLAS
+   if constexpr (blas::isBlasType<T>::value) {
+      blas::gemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+      return;
+   }
+#endif
+   native::gemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c,
+                ldc);
+}
+
+// Name of the gemm called for T in the profiles
+template <class T> constexpr const char *gemmName() {
+#ifndef TENSEUR_NO_BLAS
+   if constexpr (blas::isBlasType<T>::value) {
+      return "blas.gemm";
+   }
+#endif
+   return "native.gemm";
+}
+
+// Call the BLAS gemm for BLAS types or the native one, recorded in the
+// profiles
+template <class T>
+void gemm(blas::transop transa, blas::transop transb, size_t m, size_t n,
+          size_t k, T alpha, const T *a, size_t lda, const T *b, size_t ldb,
+          T beta, T *c, size_t ldc) {
+   TENSEUR_PROFILE_SCOPE(gemmName<T>(), "kernel");
+   TENSEUR_PROFILE_COUNT((m * k + k * n) * sizeof(T), m * n * sizeof(T),
+                         2 * m * n * k);
+   callGemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+inline blas::transop flip(blas::transop op) {
+   return op == blas::transop::no ? blas::transop::trans : blas::transop::no;
+}
+
+// Column major layout of a matrix
+// A matrix with a unit stride along its rows is read as it is with ld its
+// column stride, a matrix with a unit stride along its columns is read as the
+// transpose of a column major matrix.
+struct MatrixLayout {
+   blas::transop trans;
+   size_t ld;
+};
+
+template <class A> std::optional<MatrixLayout> matrixLayout(const A &a) {
+   size_t rows = a.dim(0);
+   size_t cols = a.dim(1);
+   if (a.stride(0) == 1 || rows <= 1) {
+      return MatrixLayout{blas::transop::no,
+                          std::max<size_t>({a.stride(1), rows, 1})};
+   }
+   if (a.stride(1) == 1 || cols <= 1) {
+      return MatrixLayout{blas::transop::trans,
+                          std::max<size_t>({a.stride(0), cols, 1})};
+   }
+   return std::nullopt;
+}
+
+// Copy of a matrix view with no unit stride in column major order
+template <class A>
+std::vector<typename A::value_type> packMatrix(const A &a) {
+   size_t rows = a.dim(0);
+   size_t cols = a.dim(1);
+   std::vector<typename A::value_type> packed(rows * cols);
+   const auto *data = a.data();
+   for (size_t j = 0; j < cols; j++) {
+      for (size_t i = 0; i < rows; i++) {
+         packed[i + j * rows] = data[i * a.stride(0) + j * a.stride(1)];
+      }
+   }
+   return packed;
+}
+
+// Whether the product c = a * b of static shapes is unrolled at compile time
+// The operands and the output have the same value type and the product is
+// small enough for staticGemm.
+template <class A, class B, class C>
+constexpr bool isUnrolledMul() {
+   if constexpr (A::isStatic() && B::isStatic() && C::isStatic() &&
+                 std::is_same_v<typename A::value_type,
+                                typename C::value_type> &&
+                 std::is_same_v<typename B::value_type,
+                                typename C::value_type>) {
+      constexpr size_t n = B::rank() == 2 ? B::template staticDim<1>() : 1;
+      return isUnrolledGemm<
+          typename C::value_type, A::template staticDim<0>(), n,
+          A::template staticDim<1>(),
+          B::rank() == 2 ? C::storageOrder() : StorageOrder::ColMajor>();
+   } else {
+      return false;
+   }
+}
+} // namespace details
+
 // matrix * vector
+// Small products of static shapes are unrolled at compile time. Otherwise the
+// BLAS routine is selected from the value type (s, d, c or z), other types
+// and builds without BLAS use the native kernel.
+// The matrix and the vector are read through their strides, so that views
+// are multiplied without being copied.
 template <class A, class B, class C>
 void mul(const A &a, const B &b, C &c)
    requires ::ten::isMatrixNode<A>::value && ::ten::isVectorNode<B>::value
 {
+   using T = typename C::value_type;
+   static_assert(std::is_same_v<typename A::value_type, T> &&
+                     std::is_same_v<typename B::value_type, T>,
+                 "Matrix vector multiplication of different value types.");
+   TENSEUR_PROFILE_SCOPE("mul", "kernel");
+   if constexpr (details::isUnrolledMul<A, B, C>()) {
+      TENSEUR_PROFILE_COUNT((a.size() + b.size()) * sizeof(T),
+                            c.size() * sizeof(T), 2 * a.size());
+      staticGemv<A::template staticDim<0>(), A::template staticDim<1>(),
+                 A::storageOrder()>(a.data(), b.data(), c.data());
+      return;
+   }
    size_t m = a.dim(0);
    size_t n = a.dim(1);
    using blas::transop;
-   using T = typename A::value_type;
-   const transop transa = (a.isTransposed() ? transop::trans : transop::no);
-   const size_t lda = (transa == transop::no ? m : n);
-   const size_t incb = 1;
-   const size_t incc = 1;
-   blas::gemv(transa, m, n, T(1.), a.data(), lda, b.data(), incb, T(0.),
-              c.data(), incc);
+   const T *adata = a.data();
+   std::vector<T> packed;
+   auto layout = details::matrixLayout(a);
+   if (!layout) {
+      packed = details::packMatrix(a);
+      adata = packed.data();
+      layout = details::MatrixLayout{transop::no, std::max<size_t>(m, 1)};
+   }
+   const size_t incx = std::max<size_t>(b.stride(0), 1);
+   if (layout->trans == transop::no) {
+      details::gemv(transop::no, m, n, T(1.), adata, layout->ld, b.data(),
+                    incx, T(0.), c.data(), 1);
+   } else {
+      details::gemv(transop::trans, n, m, T(1.), adata, layout->ld, b.data(),
+                    incx, T(0.), c.data(), 1);
+   }
 }
 
 // Multiply two dense matrices
+// Small products of static shapes are unrolled at compile time. Otherwise the
+// BLAS routine is selected from the value type (s, d, c or z), other types
+// and builds without BLAS use the native kernel.
+// The inputs are read through their strides, so that views are multiplied
+// without being copied. For a row major output, c' = b' * a' is computed in
+// column major.
 template <class A, class B, class C>
 void mul(const A &a, const B &b, C &c)
    requires ::ten::isMatrixNode<A>::value && ::ten::isMatrixNode<B>::value &&
             ::ten::isMatrixNode<C>::value
 {
+   using T = typename C::value_type;
+   static_assert(std::is_same_v<typename A::value_type, T> &&
+                     std::is_same_v<typename B::value_type, T>,
+                 "Matrix multiplication of different value types.");
+   TENSEUR_PROFILE_SCOPE("mul", "kernel");
+   if constexpr (details::isUnrolledMul<A, B, C>()) {
+      TENSEUR_PROFILE_COUNT((a.size() + b.size()) * sizeof(T),
+                            c.size() * sizeof(T), 2 * a.size() * b.dim(1));
+      staticGemm<A::template staticDim<0>(), B::template staticDim<1>(),
+                 A::template staticDim<1>(), A::storageOrder(),
+                 B::storageOrder(), C::storageOrder()>(a.data(), b.data(),
+                                                       c.data());
+      return;
+   }
    size_t m = a.dim(0);
    size_t k = a.dim(1);
    size_t n = b.dim(1);
    using blas::transop;
-   using T = typename A::value_type;
-   const transop transa = (a.isTransposed() ? transop::trans : transop::no);
-   const transop transb = (b.isTransposed() ? transop::trans : transop::no);
-   const size_t lda = (transa == transop::no ? m : k);
-   const size_t ldb = (transa == transop::no ? k : n);
-   blas::gemm(transa, transb, m, n, k, T(1.), a.data(), lda, b.data(), ldb,
-              T(0.), c.data(), m);
+   const T *adata = a.data();
+   const T *bdata = b.data();
+   std::vector<T> apacked, bpacked;
+   auto la = details::matrixLayout(a);
+   if (!la) {
+      apacked = details::packMatrix(a);
+      adata = apacked.data();
+      la = details::MatrixLayout{transop::no, std::max<size_t>(m, 1)};
+   }
+   auto lb = details::matrixLayout(b);
+   if (!lb) {
+      bpacked = details::packMatrix(b);
+      bdata = bpacked.data();
+      lb = details::MatrixLayout{transop::no, std::max<size_t>(k, 1)};
+   }
+   if constexpr (C::storageOrder() == ::ten::StorageOrder::RowMajor) {
+      details::gemm(details::flip(lb->trans), details::flip(la->trans), n, m,
+                    k, T(1.), bdata, lb->ld, adata, la->ld, T(0.), c.data(),
+                    std::max<size_t>(n, 1));
+   } else {
+      details::gemm(la->trans, lb->trans, m, n, k, T(1.), adata, la->ld, bdata,
+                    lb->ld, T(0.), c.data(), std::max<size_t>(m, 1));
+   }
+}
+
+namespace details {
+// Index of the first dimension of the matrices of a batch
+// The matrices are the innermost dimensions in the storage order, the first
+// two of a column major tensor and the last two of a row major tensor, so that
+// the matrices of a contiguous tensor are contiguous.
+template <::ten::StorageOrder order, size_type rank>
+constexpr size_type batchMatrixDim() {
+   return order == ::ten::StorageOrder::ColMajor ? 0 : rank - 2;
+}
+
+// Matrix of a batch read through the strides of its tensor
+struct BatchMatrix {
+   size_t rows;
+   size_t cols;
+   size_t rowStride;
+   size_t colStride;
+
+   size_t dim(size_t index) const { return index == 0 ? rows : cols; }
+   size_t stride(size_t index) const {
+      return index == 0 ? rowStride : colStride;
+   }
+};
+
+template <class X> BatchMatrix batchMatrix(const X &x) {
+   constexpr size_type row =
+       batchMatrixDim<X::storageOrder(), X::shape_type::rank()>();
+   return BatchMatrix{x.dim(row), x.dim(row + 1), x.stride(row),
+                      x.stride(row + 1)};
+}
+
+// Copy of a matrix with no unit stride in column major order
+template <class T>
+void packMatrix(const T *data, const BatchMatrix &a, T *packed) {
+   for (size_t j = 0; j < a.cols; j++) {
+      for (size_t i = 0; i < a.rows; i++) {
+         packed[i + j * a.rows] = data[i * a.rowStride + j * a.colStride];
+      }
+   }
+}
+
+// Offsets of the matrices of the operand x of a batched product into c
+// The matrices of c are contiguous and ordered by their batch index in the
+// storage order. A batch dimension of size one, or all of them for a matrix,
+// is broadcast.
+template <class X, class C>
+std::vector<size_t> batchOffsets(const X &x, const C &c, size_t batch) {
+   constexpr size_type rank = C::shape_type::rank();
+   std::vector<size_t> offsets(batch, 0);
+   if constexpr (X::shape_type::rank() == rank) {
+      // Batch dimensions from the innermost to the outermost
+      std::array<size_type, rank> dims{};
+      size_type numDims = 0;
+      for (size_type i = 0; i < rank - 2; i++) {
+         dims[numDims++] = C::storageOrder() == ::ten::StorageOrder::ColMajor
+                               ? i + 2
+                               : rank - 3 - i;
+      }
+      std::array<size_t, rank> index{};
+      size_t offset = 0;
+      for (size_t i = 0; i < batch; i++) {
+         offsets[i] = offset;
+         for (size_type d = 0; d < numDims; d++) {
+            size_type dim = dims[d];
+            size_t stride = x.dim(dim) == 1 ? 0 : x.stride(dim);
+            if (++index[dim] < c.dim(dim)) {
+               offset += stride;
+               break;
+            }
+            offset -= stride * (c.dim(dim) - 1);
+            index[dim] = 0;
+         }
+      }
+   }
+   return offsets;
+}
+
+// Common distance between consecutive offsets, if any
+inline std::optional<size_t>
+uniformStride(const std::vector<size_t> &offsets) {
+   size_t stride = offsets.size() > 1 ? offsets[1] : 0;
+   for (size_t i = 0; i < offsets.size(); i++) {
+      if (offsets[i] != i * stride) {
+         return std::nullopt;
+      }
+   }
+   return stride;
+}
+
+// Products c[i] = op(a[i]) * op(b[i]) of evenly spaced matrices
+// Calls blas::gemmBatch for BLAS types, otherwise the batch is split between
+// the threads. With fewer matrices than threads, each product is parallel.
+template <class T>
+void gemmStridedBatch(blas::transop transa, blas::transop transb, size_t m,
+                      size_t n, size_t k, const T *a, size_t lda,
+                      size_t strideA, const T *b, size_t ldb, size_t strideB,
+                      T *c, size_t ldc, size_t strideC, size_t batch) {
+#ifndef TENSEUR_NO_BLAS
+   if constexpr (blas::isBlasType<T>::value) {
+      blas::gemmBatch(transa, transb, m, n, k, T(1.), a, lda, strideA, b, ldb,
+                      strideB, T(0.), c, ldc, strideC, batch);
+      return;
+   }
+#endif
+   auto multiply = [&](size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+         callGemm(transa, transb, m, n, k, T(1.), a + i * strideA, lda,
+                  b + i * strideB, ldb, T(0.), c + i * strideC, ldc);
+      }
+   };
+   if (batch < ::ten::parallel::threadPool().size()) {
+      multiply(0, batch);
+   } else {
+      ::ten::parallel::parallelFor(0, batch, 1, multiply, m * n * k);
+   }
+}
+
+// Whether the matrices of a batched product of static shapes are unrolled at
+// compile time
+template <class A, class B, class C> constexpr bool isUnrolledBatchMul() {
+   if constexpr (A::isStatic() && B::isStatic() &&
+                 std::is_same_v<typename A::value_type,
+                                typename C::value_type> &&
+                 std::is_same_v<typename B::value_type,
+                                typename C::value_type>) {
+      constexpr size_type rowA =
+          batchMatrixDim<A::storageOrder(), A::shape_type::rank()>();
+      constexpr size_type rowB =
+          batchMatrixDim<B::storageOrder(), B::shape_type::rank()>();
+      return isUnrolledGemm<typename C::value_type,
+                            A::template staticDim<rowA>(),
+                            B::template staticDim<rowB + 1>(),
+                            A::template staticDim<rowA + 1>(),
+                            C::storageOrder()>();
+   } else {
+      return false;
+   }
+}
+} // namespace details
+
+/// \fn batchMul
+/// Batched matrix product c[i] = a[i] * b[i] of dense tensors of rank two or
+/// more
+/// The matrices are the innermost two dimensions in the storage order (see
+/// details::batchMatrixDim), the other dimensions index the batch. A matrix,
+/// or a batch dimension of size one, is broadcast over the batch. c is
+/// contiguous.
+/// Small matrices of static shapes are unrolled at compile time. Operands
+/// whose matrices are evenly spaced are multiplied by gemmStridedBatch, which
+/// calls the batched gemm of blas::gemmBatch for BLAS types. Otherwise the
+/// batch is split between the threads, each matrix being multiplied as by
+/// mul.
+template <class A, class B, class C>
+void batchMul(const A &a, const B &b, C &c) {
+   using T = typename C::value_type;
+   static_assert(std::is_same_v<typename A::value_type, T> &&
+                     std::is_same_v<typename B::value_type, T>,
+                 "Batched matrix multiplication of different value types.");
+   constexpr size_type rank = C::shape_type::rank();
+   constexpr size_type row = details::batchMatrixDim<C::storageOrder(), rank>();
+   size_t m = c.dim(row);
+   size_t n = c.dim(row + 1);
+   size_t k = details::batchMatrix(a).cols;
+   size_t batch = 1;
+   for (size_type i = 0; i < rank; i++) {
+      if (i != row && i != row + 1) {
+         batch *= c.dim(i);
+      }
+   }
+   TENSEUR_PROFILE_SCOPE("batchMul", "kernel");
+   TENSEUR_PROFILE_COUNT((a.size() + b.size()) * sizeof(T),
+                         c.size() * sizeof(T), 2 * m * n * k * batch);
+   if (c.size() == 0) {
+      return;
+   }
+   if (k == 0) {
+      std::fill(c.data(), c.data() + c.size(), T(0));
+      return;
+   }
+
+   std::vector<size_t> offsetsA = details::batchOffsets(a, c, batch);
+   std::vector<size_t> offsetsB = details::batchOffsets(b, c, batch);
+   auto strideA = details::uniformStride(offsetsA);
+   auto strideB = details::uniformStride(offsetsB);
+   const size_t strideC = m * n;
+
+   if constexpr (details::isUnrolledBatchMul<A, B, C>()) {
+      if (a.isContiguous() && b.isContiguous() && strideA && strideB) {
+         staticGemmBatch<A::template staticDim<details::batchMatrixDim<
+                             A::storageOrder(), A::shape_type::rank()>()>(),
+                         B::template staticDim<details::batchMatrixDim<
+                             B::storageOrder(), B::shape_type::rank()>() +
+                             1>(),
+                         A::template staticDim<details::batchMatrixDim<
+                             A::storageOrder(), A::shape_type::rank()>() +
+                             1>(),
+                         A::storageOrder(), B::storageOrder(),
+                         C::storageOrder()>(a.data(), *strideA, b.data(),
+                                            *strideB, c.data(), batch);
+         return;
+      }
+   }
+
+   using blas::transop;
+   auto la = details::matrixLayout(details::batchMatrix(a));
+   auto lb = details::matrixLayout(details::batchMatrix(b));
+   constexpr bool rowMajor = C::storageOrder() == ::ten::StorageOrder::RowMajor;
+   if (la && lb && strideA && strideB) {
+      if constexpr (rowMajor) {
+         details::gemmStridedBatch(details::flip(lb->trans),
+                                   details::flip(la->trans), n, m, k,
+                                   b.data(), lb->ld, *strideB, a.data(),
+                                   la->ld, *strideA, c.data(), n, strideC,
+                                   batch);
+      } else {
+         details::gemmStridedBatch(la->trans, lb->trans, m, n, k, a.data(),
+                                   la->ld, *strideA, b.data(), lb->ld,
+                                   *strideB, c.data(), m, strideC, batch);
+      }
+      return;
+   }
+
+   // Multiply the matrices of [first, last), packing the ones without a unit
+   // stride
+   auto multiply = [&](size_t first, size_t last) {
+      std::vector<T> apacked, bpacked;
+      for (size_t i = first; i < last; i++) {
+         const T *adata = a.data() + offsetsA[i];
+         const T *bdata = b.data() + offsetsB[i];
+         auto lai = la;
+         auto lbi = lb;
+         if (!lai) {
+            apacked.resize(m * k);
+            details::packMatrix(adata, details::batchMatrix(a),
+                                apacked.data());
+            adata = apacked.data();
+            lai = details::MatrixLayout{transop::no, m};
+         }
+         if (!lbi) {
+            bpacked.resize(k * n);
+            details::packMatrix(bdata, details::batchMatrix(b),
+                                bpacked.data());
+            bdata = bpacked.data();
+            lbi = details::MatrixLayout{transop::no, k};
+         }
+         T *cdata = c.data() + i * strideC;
+         if constexpr (rowMajor) {
+            details::callGemm(details::flip(lbi->trans),
+                              details::flip(lai->trans), n, m, k, T(1.),
+                              bdata, lbi->ld, adata, lai->ld, T(0.), cdata, n);
+         } else {
+            details::callGemm(lai->trans, lbi->trans, m, n, k, T(1.), adata,
+                              lai->ld, bdata, lbi->ld, T(0.), cdata, m);
+         }
+      }
+   };
+   // With fewer matrices than threads, each product is parallel
+   if (batch < ::ten::parallel::threadPool().size()) {
+      multiply(0, batch);
+   } else {
+      ::ten::parallel::parallelFor(0, batch, 1, multiply, m * n * k);
+   }
 }
 
 } // namespace ten::kernels
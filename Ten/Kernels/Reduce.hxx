@@ -0,0 +1,832 @@
+#ifndef TA_KERNELS_REDUCE_HXX
+#define TA_KERNELS_REDUCE_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <experimental/simd>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <Ten/Config.hxx>
+#include <Ten/Kernels/Math.hxx>
+#include <Ten/Kernels/Simd.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Profile.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::kernels {
+
+namespace details {
+// Load a simd vector or a scalar of type V from data + offset
+template <class V, class T> static V load(const T *data, size_t offset) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return V(data + offset, std::experimental::element_aligned);
+   } else {
+      return static_cast<V>(data[offset]);
+   }
+}
+
+template <class V> static V minimum(const V &x, const V &y) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return std::experimental::min(x, y);
+   } else {
+      return std::min(x, y);
+   }
+}
+
+template <class V> static V maximum(const V &x, const V &y) {
+   if constexpr (std::experimental::is_simd_v<V>) {
+      return std::experimental::max(x, y);
+   } else {
+      return std::max(x, y);
+   }
+}
+
+// Exponential and logarithm of a scalar or a simd vector
+template <class V> static V exponential(const V &x) {
+   if constexpr (math::isMathType<math::details::scalar_t<V>>) {
+      return math::exp(x);
+   } else {
+      using std::exp;
+      return exp(x);
+   }
+}
+
+template <class V> static V logarithm(const V &x) {
+   if constexpr (math::isMathType<math::details::scalar_t<V>>) {
+      return math::log(x);
+   } else {
+      using std::log;
+      return log(x);
+   }
+}
+
+// Transformations of the elements before their reduction, f(x, k) where k is
+// the index of x in the reduced range
+struct Identity {
+   template <class V> V operator()(const V &x, size_t) const { return x; }
+};
+
+struct Absolute {
+   template <class V> V operator()(const V &x, size_t) const {
+      using std::abs;
+      return abs(x);
+   }
+};
+
+struct Square {
+   template <class V> V operator()(const V &x, size_t) const { return x * x; }
+};
+
+// Squared deviation from the mean
+template <class R> struct Deviation {
+   R mean;
+
+   template <class V> V operator()(const V &x, size_t) const {
+      V d = x - V(mean);
+      return d * d;
+   }
+};
+
+// Squared deviation from the mean of each element of a row
+template <class R> struct RowDeviation {
+   const R *mean;
+
+   template <class V> V operator()(const V &x, size_t k) const {
+      V d = x - load<V>(mean, k);
+      return d * d;
+   }
+};
+
+// Exponential of the difference with the maximum
+template <class R> struct ShiftedExp {
+   R shift;
+
+   template <class V> V operator()(const V &x, size_t) const {
+      return exponential(x - V(shift));
+   }
+};
+
+// Exponential of the difference with the maximum of each element of a row
+template <class R> struct RowShiftedExp {
+   const R *shift;
+
+   template <class V> V operator()(const V &x, size_t k) const {
+      return exponential(x - load<V>(shift, k));
+   }
+};
+
+// log(sum(exp(x))) from the maximum of x and the sum of exp(x - max)
+// An infinite maximum is the result, it would make exp(x - max) a NaN.
+template <class R> static R logSumExp(R shift, R total) {
+   using std::isinf;
+   return isinf(shift) ? shift : shift + logarithm(total);
+}
+
+// Kahan compensated sum
+template <class V> struct KahanSum {
+   V sum = V(0);
+   V comp = V(0);
+
+   void add(const V &x) {
+      V y = x - comp;
+      V t = sum + y;
+      comp = (t - sum) - y;
+      sum = t;
+   }
+
+   void add(const KahanSum &other) {
+      add(other.sum);
+      add(V(-other.comp));
+   }
+
+   V value() const { return sum - comp; }
+};
+
+// Sum of f(data[i]) for i in [first, last) using independent simd
+// accumulators
+template <class R, class T, class F>
+static R sumNaive(const T *data, size_t first, size_t last, const F &f) {
+   R res = R(0);
+   size_t i = first;
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      constexpr size_t vlen = vector_type::size();
+      if (last - first >= vlen) {
+         vector_type acc0(R(0)), acc1(R(0)), acc2(R(0)), acc3(R(0));
+         for (; i + 4 * vlen <= last; i += 4 * vlen) {
+            acc0 += f(load<vector_type>(data, i), i);
+            acc1 += f(load<vector_type>(data, i + vlen), i + vlen);
+            acc2 += f(load<vector_type>(data, i + 2 * vlen), i + 2 * vlen);
+            acc3 += f(load<vector_type>(data, i + 3 * vlen), i + 3 * vlen);
+         }
+         for (; i + vlen <= last; i += vlen) {
+            acc0 += f(load<vector_type>(data, i), i);
+         }
+         res = std::experimental::reduce((acc0 + acc1) + (acc2 + acc3));
+      }
+   }
+   for (; i < last; i++) {
+      res += f(load<R>(data, i), i);
+   }
+   return res;
+}
+
+// Pairwise sum of f(data[i]) for i in [first, last)
+template <class R, class T, class F>
+static R sumPairwise(const T *data, size_t first, size_t last, const F &f) {
+   constexpr size_t blockSize = 32 * ::ten::simdVecLen<R>;
+   if (last - first <= blockSize) {
+      return sumNaive<R>(data, first, last, f);
+   }
+   size_t half = (last - first) / 2;
+   size_t middle = first + half - half % ::ten::simdVecLen<R>;
+   return sumPairwise<R>(data, first, middle, f) +
+          sumPairwise<R>(data, middle, last, f);
+}
+
+// Kahan sum of f(data[i]) for i in [first, last)
+template <class R, class T, class F>
+static KahanSum<R> sumKahan(const T *data, size_t first, size_t last,
+                            const F &f) {
+   KahanSum<R> res;
+   size_t i = first;
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      constexpr size_t vlen = vector_type::size();
+      if (last - first >= vlen) {
+         KahanSum<vector_type> acc;
+         for (; i + vlen <= last; i += vlen) {
+            acc.add(f(load<vector_type>(data, i), i));
+         }
+         for (size_t k = 0; k < vlen; k++) {
+            res.add(acc.sum[k]);
+            res.add(-acc.comp[k]);
+         }
+      }
+   }
+   for (; i < last; i++) {
+      res.add(f(load<R>(data, i), i));
+   }
+   return res;
+}
+
+// Sum of f(data[i]) for i in [0, n)
+// The blocks of the parallel reduction are summed with the given method and
+// their partial sums are combined in order.
+template <class R, class T, class F>
+static R sum(const T *data, size_t n, ::ten::Summation method, const F &f) {
+   using ::ten::Summation;
+   if (method == Summation::kahan) {
+      return ::ten::parallel::parallelReduce(
+                 n, KahanSum<R>(),
+                 [&](size_t first, size_t last) {
+                    return sumKahan<R>(data, first, last, f);
+                 },
+                 [](KahanSum<R> x, const KahanSum<R> &y) {
+                    x.add(y);
+                    return x;
+                 })
+          .value();
+   }
+   return ::ten::parallel::parallelReduce(
+       n, R(0),
+       [&](size_t first, size_t last) {
+          if (method == Summation::pairwise) {
+             return sumPairwise<R>(data, first, last, f);
+          }
+          return sumNaive<R>(data, first, last, f);
+       },
+       [](R x, R y) { return x + y; });
+}
+
+// Product of data[first:last]
+template <class R, class T>
+static R prod(const T *data, size_t first, size_t last) {
+   R res = R(1);
+   size_t i = first;
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      constexpr size_t vlen = vector_type::size();
+      if (last - first >= vlen) {
+         vector_type acc(R(1));
+         for (; i + vlen <= last; i += vlen) {
+            acc *= load<vector_type>(data, i);
+         }
+         res = std::experimental::reduce(acc, std::multiplies<>());
+      }
+   }
+   for (; i < last; i++) {
+      res *= load<R>(data, i);
+   }
+   return res;
+}
+
+// Minimum or maximum of f(data[i]) for i in [first, last)
+template <bool isMin, class T, class F = Identity>
+static T minMax(const T *data, size_t first, size_t last, const F &f = F()) {
+   T res = f(data[first], 0);
+   size_t i = first + 1;
+   if constexpr (::ten::isVectorizable<T>::value) {
+      using vector_type = simd_type<T>;
+      constexpr size_t vlen = vector_type::size();
+      if (last - first >= 2 * vlen) {
+         vector_type acc = f(load<vector_type>(data, first), 0);
+         for (i = first + vlen; i + vlen <= last; i += vlen) {
+            vector_type x = f(load<vector_type>(data, i), i);
+            if constexpr (isMin) {
+               acc = std::experimental::min(acc, x);
+            } else {
+               acc = std::experimental::max(acc, x);
+            }
+         }
+         if constexpr (isMin) {
+            res = std::experimental::hmin(acc);
+         } else {
+            res = std::experimental::hmax(acc);
+         }
+      }
+   }
+   for (; i < last; i++) {
+      if constexpr (isMin) {
+         res = std::min(f(data[i], i), res);
+      } else {
+         res = std::max(f(data[i], i), res);
+      }
+   }
+   return res;
+}
+
+// Value and index of the first minimum or maximum of data[first:last]
+template <bool isMin, class T>
+static std::pair<T, size_t> argMinMax(const T *data, size_t first,
+                                      size_t last) {
+   T value = minMax<isMin>(data, first, last);
+   for (size_t i = first; i < last; i++) {
+      if (data[i] == value) {
+         return {value, i};
+      }
+   }
+   return {data[first], first};
+}
+
+// Minimum or maximum of f(data[i]) for i in [0, n)
+template <bool isMin, class T, class F = Identity>
+static T minMax(const T *data, size_t n, const F &f = F()) {
+   return ::ten::parallel::parallelReduce(
+       n, f(data[0], 0),
+       [&](size_t first, size_t last) {
+          return minMax<isMin>(data, first, last, f);
+       },
+       [](T x, T y) { return isMin ? std::min(x, y) : std::max(x, y); });
+}
+
+// Whether a reduction is undefined for an empty range
+// The sums and the norms of no elements are zero and their product is one.
+template <::ten::ReduceOperation kind>
+inline constexpr bool needsElements =
+    kind != ::ten::ReduceOperation::sum &&
+    kind != ::ten::ReduceOperation::prod &&
+    kind != ::ten::ReduceOperation::norm1 &&
+    kind != ::ten::ReduceOperation::norm2 &&
+    kind != ::ten::ReduceOperation::normInf;
+
+template <::ten::ReduceOperation kind> static void checkNotEmpty(size_t n) {
+   if constexpr (needsElements<kind>) {
+      if (n == 0) {
+         throw std::invalid_argument("Tenseur: Reduction of an empty tensor.");
+      }
+   }
+}
+
+// Reduction of data[0:n] to a value of type R
+template <::ten::ReduceOperation kind, class R, class T>
+static R reduce(const T *data, size_t n, ::ten::Summation method) {
+   using ::ten::ReduceOperation;
+   checkNotEmpty<kind>(n);
+   if constexpr (kind == ReduceOperation::normInf) {
+      if (n == 0) {
+         return R(0);
+      }
+   }
+   if constexpr (kind == ReduceOperation::sum) {
+      return sum<R>(data, n, method, Identity());
+   } else if constexpr (kind == ReduceOperation::mean) {
+      return sum<R>(data, n, method, Identity()) / static_cast<R>(n);
+   } else if constexpr (kind == ReduceOperation::prod) {
+      return ::ten::parallel::parallelReduce(
+          n, R(1),
+          [data](size_t first, size_t last) {
+             return prod<R>(data, first, last);
+          },
+          [](R x, R y) { return x * y; });
+   } else if constexpr (kind == ReduceOperation::min) {
+      return minMax<true>(data, n);
+   } else if constexpr (kind == ReduceOperation::max) {
+      return minMax<false>(data, n);
+   } else if constexpr (kind == ReduceOperation::norm1) {
+      return sum<R>(data, n, method, Absolute());
+   } else if constexpr (kind == ReduceOperation::norm2) {
+      using std::sqrt;
+      return sqrt(sum<R>(data, n, method, Square()));
+   } else if constexpr (kind == ReduceOperation::normInf) {
+      return minMax<false>(data, n, Absolute());
+   } else if constexpr (kind == ReduceOperation::argmin ||
+                        kind == ReduceOperation::argmax) {
+      constexpr bool isMin = kind == ReduceOperation::argmin;
+      using pair_type = std::pair<T, size_t>;
+      return ::ten::parallel::parallelReduce(
+                 n, pair_type(data[0], 0),
+                 [data](size_t first, size_t last) {
+                    return argMinMax<isMin>(data, first, last);
+                 },
+                 [](const pair_type &x, const pair_type &y) {
+                    bool better = isMin ? y.first < x.first : y.first > x.first;
+                    return better ? y : x;
+                 })
+          .second;
+   } else if constexpr (kind == ReduceOperation::var) {
+      R mean = sum<R>(data, n, method, Identity()) / static_cast<R>(n);
+      return sum<R>(data, n, method, Deviation<R>{mean}) / static_cast<R>(n);
+   } else {
+      R shift = static_cast<R>(minMax<false>(data, n));
+      return logSumExp(shift,
+                       sum<R>(data, n, method, ShiftedExp<R>{shift}));
+   }
+}
+
+// out[k] = op(out[k], row[k], k) for k in [0, len)
+template <class R, class T, class Op>
+static void rowOp(R *out, const T *row, size_t len, const Op &op) {
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      simdLoop(
+          out, 0, len,
+          [&](size_t k) {
+             vector_type acc(out + k, std::experimental::vector_aligned);
+             acc = op(acc, load<vector_type>(row, k), k);
+             acc.copy_to(out + k, std::experimental::vector_aligned);
+          },
+          [&](size_t k) { out[k] = op(out[k], load<R>(row, k), k); });
+   } else {
+      for (size_t k = 0; k < len; k++) {
+         out[k] = op(out[k], load<R>(row, k), k);
+      }
+   }
+}
+
+// out[k] = sum of f(x[j * inner + k]) for j in [first, last)
+template <class R, class T, class F>
+static void sumRowsNaive(const T *x, size_t inner, size_t first, size_t last,
+                         size_t len, R *out, const F &f) {
+   std::fill(out, out + len, R(0));
+   for (size_t j = first; j < last; j++) {
+      rowOp(out, x + j * inner, len,
+            [&f](const auto &acc, const auto &v, size_t k) {
+               return acc + f(v, k);
+            });
+   }
+}
+
+// Pairwise version of sumRowsNaive, work holds the partial sums
+template <class R, class T, class F>
+static void sumRowsPairwise(const T *x, size_t inner, size_t first,
+                            size_t last, size_t len, R *out, R *work,
+                            const F &f) {
+   if (last - first <= 8) {
+      sumRowsNaive(x, inner, first, last, len, out, f);
+      return;
+   }
+   size_t middle = first + (last - first) / 2;
+   sumRowsPairwise(x, inner, first, middle, len, out, work, f);
+   sumRowsPairwise(x, inner, middle, last, len, work, work + len, f);
+   rowOp(out, work, len,
+         [](const auto &acc, const auto &v, size_t) { return acc + v; });
+}
+
+// Kahan version of sumRowsNaive
+template <class R, class T, class F>
+static void sumRowsKahan(const T *x, size_t inner, size_t dim, size_t len,
+                         R *out, const F &f) {
+   std::vector<R> comp(len, R(0));
+   std::fill(out, out + len, R(0));
+   for (size_t j = 0; j < dim; j++) {
+      const T *row = x + j * inner;
+      if constexpr (::ten::isVectorizable<R>::value) {
+         using vector_type = simd_type<R>;
+         simdLoop(
+             out, 0, len,
+             [&](size_t k) {
+                KahanSum<vector_type> acc{
+                    vector_type(out + k, std::experimental::vector_aligned),
+                    load<vector_type>(comp.data(), k)};
+                acc.add(f(load<vector_type>(row, k), k));
+                acc.sum.copy_to(out + k, std::experimental::vector_aligned);
+                acc.comp.copy_to(comp.data() + k,
+                                 std::experimental::element_aligned);
+             },
+             [&](size_t k) {
+                KahanSum<R> acc{out[k], comp[k]};
+                acc.add(f(load<R>(row, k), k));
+                out[k] = acc.sum;
+                comp[k] = acc.comp;
+             });
+      } else {
+         for (size_t k = 0; k < len; k++) {
+            KahanSum<R> acc{out[k], comp[k]};
+            acc.add(f(load<R>(row, k), k));
+            out[k] = acc.sum;
+            comp[k] = acc.comp;
+         }
+      }
+   }
+   for (size_t k = 0; k < len; k++) {
+      out[k] -= comp[k];
+   }
+}
+
+// out[k] = sum of f(x[j * inner + k]) for j in [0, dim)
+template <class R, class T, class F>
+static void sumRows(const T *x, size_t inner, size_t dim, size_t len, R *out,
+                    ::ten::Summation method, const F &f) {
+   using ::ten::Summation;
+   if (method == Summation::kahan) {
+      sumRowsKahan(x, inner, dim, len, out, f);
+   } else if (method == Summation::pairwise && dim > 8) {
+      size_t levels = 1;
+      for (size_t m = dim; m > 8; m = (m + 1) / 2) {
+         levels++;
+      }
+      std::vector<R> work(levels * len);
+      sumRowsPairwise(x, inner, size_t(0), dim, len, out, work.data(), f);
+   } else {
+      sumRowsNaive(x, inner, size_t(0), dim, len, out, f);
+   }
+}
+
+// out[k] = max of x[j * inner + k] for j in [0, dim)
+template <class R, class T>
+static void rowMax(const T *x, size_t inner, size_t dim, size_t len, R *out) {
+   rowOp(out, x, len, [](const auto &, const auto &v, size_t) { return v; });
+   for (size_t j = 1; j < dim; j++) {
+      rowOp(out, x + j * inner, len,
+            [](const auto &acc, const auto &v, size_t) {
+               return maximum(acc, v);
+            });
+   }
+}
+
+// Reduction of the dim rows x[j * inner: j * inner + len] into out
+template <::ten::ReduceOperation kind, class R, class T>
+static void reduceRows(const T *x, size_t inner, size_t dim, size_t len,
+                       R *out, ::ten::Summation method) {
+   using ::ten::ReduceOperation;
+   if constexpr (kind == ReduceOperation::sum) {
+      sumRows(x, inner, dim, len, out, method, Identity());
+   } else if constexpr (kind == ReduceOperation::mean) {
+      sumRows(x, inner, dim, len, out, method, Identity());
+      for (size_t k = 0; k < len; k++) {
+         out[k] /= static_cast<R>(dim);
+      }
+   } else if constexpr (kind == ReduceOperation::norm1) {
+      sumRows(x, inner, dim, len, out, method, Absolute());
+   } else if constexpr (kind == ReduceOperation::norm2) {
+      using std::sqrt;
+      sumRows(x, inner, dim, len, out, method, Square());
+      for (size_t k = 0; k < len; k++) {
+         out[k] = sqrt(out[k]);
+      }
+   } else if constexpr (kind == ReduceOperation::var) {
+      std::vector<R> mean(len);
+      sumRows(x, inner, dim, len, mean.data(), method, Identity());
+      for (size_t k = 0; k < len; k++) {
+         mean[k] /= static_cast<R>(dim);
+      }
+      sumRows(x, inner, dim, len, out, method, RowDeviation<R>{mean.data()});
+      for (size_t k = 0; k < len; k++) {
+         out[k] /= static_cast<R>(dim);
+      }
+   } else if constexpr (kind == ReduceOperation::argmin ||
+                        kind == ReduceOperation::argmax) {
+      std::vector<T> best(x, x + len);
+      std::fill(out, out + len, R(0));
+      for (size_t j = 1; j < dim; j++) {
+         const T *row = x + j * inner;
+         for (size_t k = 0; k < len; k++) {
+            bool better = kind == ReduceOperation::argmin ? row[k] < best[k]
+                                                          : row[k] > best[k];
+            if (better) {
+               best[k] = row[k];
+               out[k] = j;
+            }
+         }
+      }
+   } else if constexpr (kind == ReduceOperation::logsumexp) {
+      std::vector<R> shift(len);
+      rowMax(x, inner, dim, len, shift.data());
+      sumRows(x, inner, dim, len, out, method,
+              RowShiftedExp<R>{shift.data()});
+      for (size_t k = 0; k < len; k++) {
+         out[k] = logSumExp(shift[k], out[k]);
+      }
+   } else {
+      // Product, minimum and maximum
+      std::fill(out, out + len, R(0));
+      rowOp(out, x, len, [](const auto &, const auto &v, size_t k) {
+         return kind == ReduceOperation::normInf ? Absolute()(v, k) : v;
+      });
+      for (size_t j = 1; j < dim; j++) {
+         rowOp(out, x + j * inner, len,
+               [](const auto &acc, const auto &v, size_t k) {
+                  if constexpr (kind == ReduceOperation::prod) {
+                     return acc * v;
+                  } else if constexpr (kind == ReduceOperation::min) {
+                     return minimum(acc, v);
+                  } else if constexpr (kind == ReduceOperation::max) {
+                     return maximum(acc, v);
+                  } else {
+                     return maximum(acc, Absolute()(v, k));
+                  }
+               });
+      }
+   }
+}
+} // namespace details
+
+/// \fn min
+/// Minimum of a dense tensor
+template <class A> static typename A::value_type min(const A &a) {
+   details::checkNotEmpty<::ten::ReduceOperation::min>(a.size());
+   return details::minMax<true>(a.data(), a.size());
+}
+
+/// \fn max
+/// Maximum of a dense tensor
+template <class A> static typename A::value_type max(const A &a) {
+   details::checkNotEmpty<::ten::ReduceOperation::max>(a.size());
+   return details::minMax<false>(a.data(), a.size());
+}
+
+/// \fn reduce
+/// Reduction of all the elements of a dense tensor to a value of type R
+template <::ten::ReduceOperation kind, class R, class A>
+static R reduce(const A &a, ::ten::Summation method) {
+   TENSEUR_PROFILE_SCOPE("reduce", "kernel");
+   TENSEUR_PROFILE_COUNT(a.size() * sizeof(typename A::value_type), 0,
+                         a.size());
+   return details::reduce<kind, R>(a.data(), a.size(), method);
+}
+
+/// \fn reduceAxis
+/// Reduction of a dense tensor a along an axis into b.
+/// a is seen as an outer x dim x inner array, where dim is the dimension of the
+/// axis and inner the product of the dimensions stored before it, and b as an
+/// outer x inner array. The rows of inner elements are reduced with simd
+/// vectors, by blocks so that the partial results stay in cache. When inner is
+/// one, each output element is the reduction of a contiguous range.
+template <::ten::ReduceOperation kind, class A, class B>
+static void reduceAxis(const A &a, B &b, size_type axis,
+                       ::ten::Summation method) {
+   using T = typename A::value_type;
+   using R = typename B::value_type;
+   constexpr size_type rank = A::shape_type::rank();
+   constexpr size_t blockSize = 2048;
+   TENSEUR_PROFILE_SCOPE("reduceAxis", "kernel");
+   TENSEUR_PROFILE_COUNT(a.size() * sizeof(T), b.size() * sizeof(R), a.size());
+
+   size_t dim = a.dim(axis);
+   size_t inner = 1;
+   for (size_type i = 0; i < rank; i++) {
+      bool stored = A::storageOrder() == ::ten::StorageOrder::ColMajor
+                        ? i < axis
+                        : i > axis;
+      if (stored) {
+         inner *= a.dim(i);
+      }
+   }
+   const T *x = a.data();
+   R *y = b.data();
+   size_t n = b.size();
+   if (n == 0) {
+      return;
+   }
+   if (dim == 0) {
+      // Reduction of empty rows
+      std::fill(y, y + n, details::reduce<kind, R>(x, 0, method));
+      return;
+   }
+
+   ::ten::parallel::parallelFor(
+       0, n, ::ten::simdVecLen<R>,
+       [&](size_t first, size_t last) {
+          for (size_t i = first; i < last;) {
+             size_t o = i / inner;
+             size_t k = i - o * inner;
+             if (inner == 1) {
+                y[i] = details::reduce<kind, R>(x + o * dim, dim, method);
+                i++;
+                continue;
+             }
+             size_t len = std::min({last - i, inner - k, blockSize});
+             details::reduceRows<kind>(x + o * dim * inner + k, inner, dim, len,
+                                       y + i, method);
+             i += len;
+          }
+       },
+       dim);
+}
+
+namespace details {
+// y[i] = exp(x[i] - shift) for i in [first, last)
+template <class R, class T>
+static void shiftedExp(const T *x, R *y, size_t first, size_t last, R shift) {
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      simdLoop(
+          y, first, last,
+          [&](size_t i) {
+             exponential(load<vector_type>(x, i) - vector_type(shift))
+                 .copy_to(y + i, std::experimental::vector_aligned);
+          },
+          [&](size_t i) { y[i] = exponential(load<R>(x, i) - shift); });
+   } else {
+      for (size_t i = first; i < last; i++) {
+         y[i] = exponential(load<R>(x, i) - shift);
+      }
+   }
+}
+
+// y[i] *= factor for i in [first, last)
+template <class R> static void scale(R *y, size_t first, size_t last, R factor) {
+   if constexpr (::ten::isVectorizable<R>::value) {
+      using vector_type = simd_type<R>;
+      simdLoop(
+          y, first, last,
+          [&](size_t i) {
+             vector_type v(y + i, std::experimental::vector_aligned);
+             v *= factor;
+             v.copy_to(y + i, std::experimental::vector_aligned);
+          },
+          [&](size_t i) { y[i] *= factor; });
+   } else {
+      for (size_t i = first; i < last; i++) {
+         y[i] *= factor;
+      }
+   }
+}
+
+// Softmax of the contiguous range x[0:n] into y
+template <class R, class T>
+static void softmaxRange(const T *x, size_t n, R *y) {
+   R shift = static_cast<R>(minMax<false>(x, size_t(0), n));
+   shiftedExp(x, y, 0, n, shift);
+   scale(y, 0, n, R(1) / sumPairwise<R>(y, 0, n, Identity()));
+}
+
+// Softmax of the dim rows x[j * inner: j * inner + len] into y
+template <class R, class T>
+static void softmaxRows(const T *x, size_t inner, size_t dim, size_t len,
+                        R *y) {
+   std::vector<R> shift(len);
+   std::vector<R> total(len, R(0));
+   rowMax(x, inner, dim, len, shift.data());
+   for (size_t j = 0; j < dim; j++) {
+      R *row = y + j * inner;
+      const T *input = x + j * inner;
+      for (size_t k = 0; k < len; k++) {
+         row[k] = static_cast<R>(input[k]) - shift[k];
+      }
+      shiftedExp(row, row, 0, len, R(0));
+      rowOp(total.data(), row, len,
+            [](const auto &acc, const auto &v, size_t) { return acc + v; });
+   }
+   for (size_t k = 0; k < len; k++) {
+      total[k] = R(1) / total[k];
+   }
+   for (size_t j = 0; j < dim; j++) {
+      rowOp(y + j * inner, total.data(), len,
+            [](const auto &v, const auto &factor, size_t) {
+               return v * factor;
+            });
+   }
+}
+} // namespace details
+
+/// \fn softmax
+/// Softmax of all the elements of a dense tensor a into b,
+/// b = exp(a - max(a)) / sum(exp(a - max(a)))
+/// The maximum is subtracted so that the exponentials don't overflow.
+template <class A, class B> static void softmax(const A &a, B &b) {
+   using R = typename B::value_type;
+   const auto *x = a.data();
+   R *y = b.data();
+   size_t n = a.size();
+   if (n == 0) {
+      return;
+   }
+   R shift = static_cast<R>(details::minMax<false>(x, n));
+   ::ten::parallel::parallelFor(
+       0, n, ::ten::simdVecLen<R>, [&](size_t first, size_t last) {
+          details::shiftedExp(x, y, first, last, shift);
+       });
+   R factor = R(1) / details::sum<R>(y, n, ::ten::Summation::pairwise,
+                                      details::Identity());
+   ::ten::parallel::parallelFor(
+       0, n, ::ten::simdVecLen<R>, [&](size_t first, size_t last) {
+          details::scale(y, first, last, factor);
+       });
+}
+
+/// \fn softmaxAxis
+/// Softmax of a dense tensor a along an axis into b
+/// a and b are split as by reduceAxis into outer x dim x inner arrays, each of
+/// the outer x inner slices of dim elements is normalized independently.
+template <class A, class B>
+static void softmaxAxis(const A &a, B &b, size_type axis) {
+   using T = typename A::value_type;
+   using R = typename B::value_type;
+   constexpr size_type rank = A::shape_type::rank();
+   constexpr size_t blockSize = 2048;
+
+   size_t dim = a.dim(axis);
+   size_t inner = 1;
+   for (size_type i = 0; i < rank; i++) {
+      bool stored = A::storageOrder() == ::ten::StorageOrder::ColMajor
+                        ? i < axis
+                        : i > axis;
+      if (stored) {
+         inner *= a.dim(i);
+      }
+   }
+   const T *x = a.data();
+   R *y = b.data();
+   if (dim == 0) {
+      return;
+   }
+   size_t n = a.size() / dim;
+
+   ::ten::parallel::parallelFor(
+       0, n, ::ten::simdVecLen<R>,
+       [&](size_t first, size_t last) {
+          for (size_t i = first; i < last;) {
+             size_t o = i / inner;
+             size_t k = i - o * inner;
+             size_t offset = o * dim * inner + k;
+             if (inner == 1) {
+                details::softmaxRange(x + offset, dim, y + offset);
+                i++;
+                continue;
+             }
+             size_t len = std::min({last - i, inner - k, blockSize});
+             details::softmaxRows(x + offset, inner, dim, len, y + offset);
+             i += len;
+          }
+       },
+       dim);
+}
+
+} // namespace ten::kernels
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef TA_KERNELS_SIMD_HXX
+#define TA_KERNELS_SIMD_HXX
+
+#include <algorithm>
+#include <cstdint>
+#include <experimental/simd>
+
+#include <Ten/Config.hxx>
+
+namespace ten::kernels {
+
+/// \typedef simd_type
+/// Simd vector of simdVecLen<T> elements of type T
+template <class T>
+using simd_type = std::experimental::simd<
+    T, std::experimental::simd_abi::deduce_t<T, ::ten::simdVecLen<T>>>;
+
+/// \fn simdLoop
+/// Loop over [begin, end) of the output array data. The loop is split into a
+/// scalar head until data + offset is aligned for simd_type<T>, a vector body
+/// and a scalar tail. vec(offset) must store simd_type<T>::size() elements at
+/// data + offset with vector_aligned, scalar(index) a single element.
+template <class T, class VecFunc, class ScalarFunc>
+static void simdLoop(T *data, size_t begin, size_t end, VecFunc &&vec,
+                     ScalarFunc &&scalar) {
+   using vector_type = simd_type<T>;
+   constexpr size_t vlen = vector_type::size();
+   constexpr size_t alignment =
+       std::experimental::memory_alignment_v<vector_type>;
+
+   auto address = reinterpret_cast<std::uintptr_t>(data + begin);
+   size_t head = end;
+   if (address % sizeof(T) == 0) {
+      head = begin + ((alignment - address % alignment) % alignment) / sizeof(T);
+      head = std::min(head, end);
+   }
+   for (size_t i = begin; i < head; i++) {
+      scalar(i);
+   }
+   size_t body = head + ((end - head) / vlen) * vlen;
+   for (size_t offset = head; offset < body; offset += vlen) {
+      vec(offset);
+   }
+   for (size_t i = body; i < end; i++) {
+      scalar(i);
+   }
+}
+
+} // namespace ten::kernels
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef TA_KERNELS_SPARSE_HXX
+#define TA_KERNELS_SPARSE_HXX
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Parallel.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::kernels {
+
+namespace details {
+// Rows of a chunk of a sparse matrix
+// The CSR kernels read the rows of the chunk directly, the CSC kernels look
+// for the first row of the chunk in each column. Each output element is
+// summed in the order of the stored elements, so that the result doesn't
+// depend on the number of threads.
+template <class Storage, class Body>
+void forEachRowEntry(const Storage &s, size_type numCols, size_type first,
+                     size_type last, Body &&body) {
+   const size_type *outer = s.outerIndices().data();
+   const size_type *inner = s.innerIndices().data();
+   const auto *values = s.values().data();
+   if constexpr (Storage::isRowMajor()) {
+      for (size_type i = first; i < last; i++) {
+         for (size_type k = outer[i]; k < outer[i + 1]; k++) {
+            body(i, inner[k], values[k]);
+         }
+      }
+   } else {
+      for (size_type j = 0; j < numCols; j++) {
+         const size_type *begin =
+             std::lower_bound(inner + outer[j], inner + outer[j + 1], first);
+         for (size_type k = begin - inner; k < outer[j + 1] && inner[k] < last;
+              k++) {
+            body(inner[k], j, values[k]);
+         }
+      }
+   }
+}
+
+// Average number of stored elements per row, the cost of a row
+template <class A> size_type rowCost(const A &a) {
+   return std::max<size_type>(1, a.storage()->nnz() / std::max<size_type>(
+                                                          1, a.dim(0)));
+}
+} // namespace details
+
+/// Sparse matrix dense vector product y = a * x
+template <class A, class X, class Y>
+void spmv(const A &a, const X &x, Y &y) {
+   using T = typename Y::value_type;
+   static_assert(::ten::isCompressedStorage<typename A::storage_type>::value,
+                 "Tenseur: Convert coordinate matrices to CSR or CSC with "
+                 "toSparse.");
+   const auto &s = *a.storage();
+   const size_type rows = a.dim(0);
+   const size_type cols = a.dim(1);
+   const auto *px = x.data();
+   const size_type sx = x.stride(0);
+   T *py = y.data();
+   const size_type sy = y.stride(0);
+   ::ten::parallel::parallelFor(
+       0, rows, 64,
+       [&](size_type first, size_type last) {
+          if constexpr (A::storage_type::isRowMajor()) {
+             if (s.empty()) {
+                for (size_type i = first; i < last; i++) {
+                   py[i * sy] = T(0);
+                }
+                return;
+             }
+             const size_type *outer = s.outerIndices().data();
+             const size_type *inner = s.innerIndices().data();
+             const auto *values = s.values().data();
+             for (size_type i = first; i < last; i++) {
+                T sum = T(0);
+                for (size_type k = outer[i]; k < outer[i + 1]; k++) {
+                   sum += values[k] * px[inner[k] * sx];
+                }
+                py[i * sy] = sum;
+             }
+          } else {
+             for (size_type i = first; i < last; i++) {
+                py[i * sy] = T(0);
+             }
+             if (s.empty()) {
+                return;
+             }
+             details::forEachRowEntry(
+                 s, cols, first, last,
+                 [&](size_type i, size_type j, const auto &value) {
+                    py[i * sy] += value * px[j * sx];
+                 });
+          }
+       },
+       details::rowCost(a));
+}
+
+/// Sparse matrix dense matrix product c = a * b
+template <class A, class B, class C>
+void spmm(const A &a, const B &b, C &c) {
+   using T = typename C::value_type;
+   static_assert(::ten::isCompressedStorage<typename A::storage_type>::value,
+                 "Tenseur: Convert coordinate matrices to CSR or CSC with "
+                 "toSparse.");
+   const auto &s = *a.storage();
+   const size_type rows = a.dim(0);
+   const size_type cols = a.dim(1);
+   const size_type n = b.dim(1);
+   const auto *pb = b.data();
+   const size_type sb0 = b.stride(0);
+   const size_type sb1 = b.stride(1);
+   T *pc = c.data();
+   const size_type sc0 = c.stride(0);
+   const size_type sc1 = c.stride(1);
+   ::ten::parallel::parallelFor(
+       0, rows, 16,
+       [&](size_type first, size_type last) {
+          for (size_type j = 0; j < n; j++) {
+             for (size_type i = first; i < last; i++) {
+                pc[i * sc0 + j * sc1] = T(0);
+             }
+          }
+          if (s.empty()) {
+             return;
+          }
+          details::forEachRowEntry(
+              s, cols, first, last,
+              [&](size_type i, size_type k, const auto &value) {
+                 for (size_type j = 0; j < n; j++) {
+                    pc[i * sc0 + j * sc1] += value * pb[k * sb0 + j * sb1];
+                 }
+              });
+       },
+       details::rowCost(a) * std::max<size_type>(1, n));
+}
+
+/// Elementwise addition or subtraction of two sparse matrices of the same
+/// format, the result stores the union of their elements
+template <::ten::BinaryOperation kind, class A, class B, class C>
+void sparseBinaryOps(const A &a, const B &b, C &c) {
+   static_assert(kind == ::ten::BinaryOperation::add ||
+                     kind == ::ten::BinaryOperation::sub,
+                 "Tenseur: Unsupported sparse elementwise operation.");
+   using T = typename C::value_type;
+   using storage_type = typename C::storage_type;
+   using allocator_type = typename storage_type::allocator_type;
+   const auto &sa = *a.storage();
+   const auto &sb = *b.storage();
+   const size_type numOuter =
+       storage_type::isRowMajor() ? a.dim(0) : a.dim(1);
+   // Outer index of an empty storage
+   auto outerIndex = [](const auto &s, size_type i) -> size_type {
+      return s.empty() ? 0 : s.outerIndices()[i];
+   };
+   std::vector<size_type> outer(numOuter + 1, 0);
+   std::vector<size_type> inner;
+   std::vector<T, allocator_type> values;
+   inner.reserve(sa.nnz() + sb.nnz());
+   values.reserve(sa.nnz() + sb.nnz());
+   for (size_type i = 0; i < numOuter; i++) {
+      size_type ka = outerIndex(sa, i);
+      size_type kb = outerIndex(sb, i);
+      const size_type endA = outerIndex(sa, i + 1);
+      const size_type endB = outerIndex(sb, i + 1);
+      while (ka < endA || kb < endB) {
+         size_type ia = ka < endA ? sa.innerIndices()[ka] : size_type(-1);
+         size_type ib = kb < endB ? sb.innerIndices()[kb] : size_type(-1);
+         T va = ia <= ib ? T(sa.values()[ka]) : T(0);
+         T vb = ib <= ia ? T(sb.values()[kb]) : T(0);
+         inner.push_back(std::min(ia, ib));
+         if constexpr (kind == ::ten::BinaryOperation::add) {
+            values.push_back(va + vb);
+         } else {
+            values.push_back(va - vb);
+         }
+         ka += ia <= ib;
+         kb += ib <= ia;
+      }
+      outer[i + 1] = inner.size();
+   }
+   auto storage = std::make_shared<storage_type>(
+       std::move(outer), std::move(inner), std::move(values));
+   c = C(storage, a.shape());
+}
+
+/// Multiplication of a sparse matrix by a scalar, the result has the
+/// elements of b
+template <class T, class B, class C>
+void sparseScale(const T &alpha, const B &b, C &c) {
+   using value_type = typename C::value_type;
+   using storage_type = typename C::storage_type;
+   const auto &s = *b.storage();
+   std::vector<size_type> outer(s.outerIndices());
+   std::vector<size_type> inner(s.innerIndices());
+   std::vector<value_type, typename storage_type::allocator_type> values(
+       s.nnz());
+   for (size_type k = 0; k < s.nnz(); k++) {
+      values[k] = static_cast<value_type>(alpha) * s.values()[k];
+   }
+   auto storage = std::make_shared<storage_type>(
+       std::move(outer), std::move(inner), std::move(values));
+   c = C(storage, b.shape());
+}
+
+} // namespace ten::kernels
+
+#endif
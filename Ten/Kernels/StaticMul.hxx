@@ -0,0 +1,147 @@
+#ifndef TA_KERNELS_STATIC_MUL_HXX
+#define TA_KERNELS_STATIC_MUL_HXX
+
+#include <array>
+#include <bit>
+#include <experimental/simd>
+#include <type_traits>
+#include <utility>
+
+#include <Ten/Config.hxx>
+#include <Ten/Kernels/Gemm.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Types.hxx>
+
+/// Matrix products of static shapes, unrolled at compile time
+namespace ten::kernels {
+
+namespace details {
+// Index of the element (i, j) of a rows x cols matrix stored in order
+template <StorageOrder order, size_type rows, size_type cols>
+constexpr size_type staticIndex(size_type i, size_type j) {
+   if constexpr (order == StorageOrder::ColMajor) {
+      return i + j * rows;
+   } else {
+      return i * cols + j;
+   }
+}
+
+constexpr StorageOrder flip(StorageOrder order) {
+   return order == StorageOrder::ColMajor ? StorageOrder::RowMajor
+                                          : StorageOrder::ColMajor;
+}
+
+// Whether the column major product of m rows is computed in simd vectors
+template <class T, size_type m> constexpr bool isVectorizedColMajor() {
+   if constexpr (::ten::isVectorizable<T>::value) {
+      return std::has_single_bit(m) &&
+             m <= std::experimental::simd_abi::max_fixed_size<T>;
+   } else {
+      return false;
+   }
+}
+
+// Column major c = a * b
+// The k columns of a are loaded in simd vectors of m lanes and stay in
+// registers, the column j of c is the sum of the columns of a scaled by the
+// elements of the column j of b.
+template <size_type m, size_type n, size_type k, StorageOrder orderA,
+          StorageOrder orderB, class T>
+inline void staticGemmColMajor(const T *a, const T *b, T *c) {
+   using ::ten::kernels::native::details::unroll;
+   if constexpr (isVectorizedColMajor<T, m>()) {
+      using V = std::experimental::fixed_size_simd<T, m>;
+      std::array<V, k> columns;
+      unroll<k>([&](auto l) {
+         if constexpr (orderA == StorageOrder::ColMajor) {
+            columns[l] = V(a + l * m, std::experimental::element_aligned);
+         } else {
+            columns[l] = V([&](auto i) { return a[i * k + l]; });
+         }
+      });
+      unroll<n>([&](auto j) {
+         V acc = columns[0] * V(b[staticIndex<orderB, k, n>(0, j)]);
+         unroll<k - 1>([&](auto l) {
+            acc = ::ten::kernels::native::details::fmadd(
+                columns[l + 1], V(b[staticIndex<orderB, k, n>(l + 1, j)]),
+                acc);
+         });
+         acc.copy_to(c + j * m, std::experimental::element_aligned);
+      });
+   } else {
+      unroll<n>([&](auto j) {
+         unroll<m>([&](auto i) {
+            T acc = a[staticIndex<orderA, m, k>(i, 0)] *
+                    b[staticIndex<orderB, k, n>(0, j)];
+            unroll<k - 1>([&](auto l) {
+               acc += a[staticIndex<orderA, m, k>(i, l + 1)] *
+                      b[staticIndex<orderB, k, n>(l + 1, j)];
+            });
+            c[i + j * m] = acc;
+         });
+      });
+   }
+}
+} // namespace details
+
+/// \fn isUnrolledGemm
+/// Whether the product of a m x k matrix by a k x n matrix of static shapes
+/// into a matrix of storage order orderC is unrolled by staticGemm
+/// The vectorized products are unrolled up to stack::maxUnrolledMul multiply
+/// adds and the scalar ones up to stack::maxUnrolledScalarMul.
+template <class T, size_type m, size_type n, size_type k, StorageOrder orderC>
+constexpr bool isUnrolledGemm() {
+   constexpr size_type rows = orderC == StorageOrder::ColMajor ? m : n;
+   return m * n * k <= (details::isVectorizedColMajor<T, rows>()
+                            ? ::ten::stack::maxUnrolledMul
+                            : ::ten::stack::maxUnrolledScalarMul);
+}
+
+/// \fn staticGemm
+/// Product c = a * b of a m x k matrix by a k x n matrix of static shapes
+/// Fully unrolled, for small matrices. A row major c is computed as the
+/// column major c' = b' * a'. c must not alias a or b.
+template <size_type m, size_type n, size_type k, StorageOrder orderA,
+          StorageOrder orderB, StorageOrder orderC, class T>
+inline void staticGemm(const T *a, const T *b, T *c) {
+   static_assert(m > 0 && n > 0 && k > 0, "Tenseur: Empty matrix product.");
+   if constexpr (orderC == StorageOrder::ColMajor) {
+      details::staticGemmColMajor<m, n, k, orderA, orderB>(a, b, c);
+   } else {
+      details::staticGemmColMajor<n, m, k, details::flip(orderB),
+                                  details::flip(orderA)>(b, a, c);
+   }
+}
+
+/// \fn staticGemv
+/// Product y = a * x of a m x n matrix of static shape by a vector
+template <size_type m, size_type n, StorageOrder orderA, class T>
+inline void staticGemv(const T *a, const T *x, T *y) {
+   details::staticGemmColMajor<m, 1, n, orderA, StorageOrder::ColMajor>(a, x,
+                                                                       y);
+}
+
+/// \fn staticGemmBatch
+/// Products c[i] = a[i] * b[i] of batch matrices of static shapes stored
+/// contiguously
+/// The matrices of a (m x k), b (k x n) and c (m x n) follow each other in
+/// memory. A stride of 0 for a or b multiplies every matrix of the batch by
+/// the same matrix. The batch is split between the threads.
+template <size_type m, size_type n, size_type k, StorageOrder orderA,
+          StorageOrder orderB, StorageOrder orderC, class T>
+void staticGemmBatch(const T *a, size_type strideA, const T *b,
+                     size_type strideB, T *c, size_type batch) {
+   ::ten::parallel::parallelFor(
+       0, batch, 64,
+       [&](size_type first, size_type last) {
+          for (size_type i = first; i < last; i++) {
+             staticGemm<m, n, k, orderA, orderB, orderC>(
+                 a + i * strideA, b + i * strideB, c + i * m * n);
+          }
+       },
+       m * n * k);
+}
+
+} // namespace ten::kernels
+
+#endif
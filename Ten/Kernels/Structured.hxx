@@ -0,0 +1,328 @@
+#ifndef TA_KERNELS_STRUCTURED_HXX
+#define TA_KERNELS_STRUCTURED_HXX
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Kernels/BlasAPI.hxx>
+#include <Ten/Parallel.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::kernels {
+
+namespace details {
+// Packed triangular matrix vector product x = a * x
+// The columns of a are read contiguously, the elements of x are updated in
+// the order that leaves the ones still needed unchanged.
+template <bool lower, class T, class U>
+void packedMul(size_type n, const T *ap, U *x, size_type incx) {
+   if constexpr (lower) {
+      for (size_type j = n; j-- > 0;) {
+         const T *col = ap + j * (2 * n - j + 1) / 2;
+         const U t = x[j * incx];
+         x[j * incx] = col[0] * t;
+         for (size_type i = j + 1; i < n; i++) {
+            x[i * incx] += col[i - j] * t;
+         }
+      }
+   } else {
+      for (size_type j = 0; j < n; j++) {
+         const T *col = ap + j * (j + 1) / 2;
+         const U t = x[j * incx];
+         for (size_type i = 0; i < j; i++) {
+            x[i * incx] += col[i] * t;
+         }
+         x[j * incx] = col[j] * t;
+      }
+   }
+}
+
+// Packed triangular solve x = inv(a) * x
+// Forward substitution for lower matrices, backward for upper matrices.
+template <bool lower, class T, class U>
+void packedSolve(size_type n, const T *ap, U *x, size_type incx) {
+   if constexpr (lower) {
+      for (size_type j = 0; j < n; j++) {
+         const T *col = ap + j * (2 * n - j + 1) / 2;
+         x[j * incx] /= col[0];
+         const U t = x[j * incx];
+         for (size_type i = j + 1; i < n; i++) {
+            x[i * incx] -= col[i - j] * t;
+         }
+      }
+   } else {
+      for (size_type j = n; j-- > 0;) {
+         const T *col = ap + j * (j + 1) / 2;
+         x[j * incx] /= col[j];
+         const U t = x[j * incx];
+         for (size_type i = 0; i < j; i++) {
+            x[i * incx] -= col[i] * t;
+         }
+      }
+   }
+}
+
+// Packed triangular product or solve of a vector, by the BLAS tpmv and tpsv
+// for BLAS types
+template <bool solve, bool lower, class T, class U>
+void packedVector(size_type n, const T *ap, U *x, size_type incx) {
+#ifndef TENSEUR_NO_BLAS
+   if constexpr (std::is_same_v<T, U> && blas::isBlasType<T>::value) {
+      constexpr auto uplo = lower ? blas::uplo::lower : blas::uplo::upper;
+      if constexpr (solve) {
+         blas::tpsv(uplo, blas::transop::no, blas::diag::nonunit, n, ap, x,
+                    incx);
+      } else {
+         blas::tpmv(uplo, blas::transop::no, blas::diag::nonunit, n, ap, x,
+                    incx);
+      }
+      return;
+   }
+#endif
+   if constexpr (solve) {
+      packedSolve<lower>(n, ap, x, incx);
+   } else {
+      packedMul<lower>(n, ap, x, incx);
+   }
+}
+
+// Copy the matrix or vector b to c
+template <class B, class C> void copyTo(const B &b, C &c) {
+   using T = typename C::value_type;
+   const auto *pb = b.data();
+   T *pc = c.data();
+   if constexpr (B::isVector()) {
+      for (size_type i = 0; i < b.dim(0); i++) {
+         pc[i * c.stride(0)] = static_cast<T>(pb[i * b.stride(0)]);
+      }
+   } else {
+      for (size_type j = 0; j < b.dim(1); j++) {
+         for (size_type i = 0; i < b.dim(0); i++) {
+            pc[i * c.stride(0) + j * c.stride(1)] =
+                static_cast<T>(pb[i * b.stride(0) + j * b.stride(1)]);
+         }
+      }
+   }
+}
+
+// Triangular product or solve c = op(a) * b
+// Matrices of BLAS types call the level 3 trmm or trsm on the triangle of a
+// unpacked to a n x n column major array, the other matrices apply the packed
+// kernel to the columns of c in parallel.
+template <bool solve, class A, class B, class C>
+void triangular(const A &a, const B &b, C &c) {
+   using T = typename C::value_type;
+   using value_type = typename A::value_type;
+   constexpr bool lower = A::storage_type::isLower();
+   const auto &s = *a.storage();
+   const size_type n = s.dim();
+   copyTo(b, c);
+   if (n == 0 || c.size() == 0) {
+      return;
+   }
+   if constexpr (C::isVector()) {
+      packedVector<solve, lower>(n, s.data(), c.data(), c.stride(0));
+   } else {
+      const size_type m = c.dim(1);
+#ifndef TENSEUR_NO_BLAS
+      if constexpr (std::is_same_v<value_type, T> &&
+                    blas::isBlasType<T>::value) {
+         std::vector<T> full(n * n, T(0));
+         for (size_type j = 0; j < n; j++) {
+            const size_type first = lower ? j : 0;
+            const size_type last = lower ? n : j + 1;
+            for (size_type i = first; i < last; i++) {
+               full[i + j * n] = s.at(i, j);
+            }
+         }
+         constexpr auto uplo = lower ? blas::uplo::lower : blas::uplo::upper;
+         // A row major c is the column major c^T = b^T * a^T
+         constexpr bool colMajor = C::storageOrder() == StorageOrder::ColMajor;
+         const auto side = colMajor ? blas::side::left : blas::side::right;
+         const auto trans =
+             colMajor ? blas::transop::no : blas::transop::trans;
+         const auto diag = blas::diag::nonunit;
+         const int rows = colMajor ? n : m;
+         const int cols = colMajor ? m : n;
+         const int ldc = colMajor ? c.stride(1) : c.stride(0);
+         if constexpr (solve) {
+            blas::trsm(side, uplo, trans, diag, rows, cols, T(1), full.data(),
+                       n, c.data(), ldc);
+         } else {
+            blas::trmm(side, uplo, trans, diag, rows, cols, T(1), full.data(),
+                       n, c.data(), ldc);
+         }
+         return;
+      }
+#endif
+      T *pc = c.data();
+      const size_type sc0 = c.stride(0);
+      const size_type sc1 = c.stride(1);
+      ::ten::parallel::parallelFor(
+          0, m, 1,
+          [&](size_type first, size_type last) {
+             for (size_type j = first; j < last; j++) {
+                if constexpr (solve) {
+                   packedSolve<lower>(n, s.data(), pc + j * sc1, sc0);
+                } else {
+                   packedMul<lower>(n, s.data(), pc + j * sc1, sc0);
+                }
+             }
+          },
+          n * n / 2);
+   }
+}
+} // namespace details
+
+/// Product of a diagonal matrix by a dense matrix or vector c = a * b
+/// The rows of b are scaled by the diagonal of a, the rows of c past the
+/// diagonal are zeros.
+template <class A, class B, class C>
+void diagonalMul(const A &a, const B &b, C &c) {
+   using T = typename C::value_type;
+   const auto *d = a.storage()->data();
+   const size_type p = a.storage()->size();
+   const size_type rows = a.dim(0);
+   const auto *pb = b.data();
+   T *pc = c.data();
+   const size_type sb0 = b.stride(0);
+   const size_type sc0 = c.stride(0);
+   if constexpr (C::isVector()) {
+      for (size_type i = 0; i < rows; i++) {
+         pc[i * sc0] = i < p ? static_cast<T>(d[i]) * pb[i * sb0] : T(0);
+      }
+   } else {
+      const size_type cols = c.dim(1);
+      const size_type sb1 = b.stride(1);
+      const size_type sc1 = c.stride(1);
+      if constexpr (C::storageOrder() == StorageOrder::RowMajor) {
+         ::ten::parallel::parallelFor(
+             0, rows, 16,
+             [&](size_type first, size_type last) {
+                for (size_type i = first; i < last; i++) {
+                   if (i >= p) {
+                      for (size_type j = 0; j < cols; j++) {
+                         pc[i * sc0 + j * sc1] = T(0);
+                      }
+                      continue;
+                   }
+                   const T x = static_cast<T>(d[i]);
+                   for (size_type j = 0; j < cols; j++) {
+                      pc[i * sc0 + j * sc1] = x * pb[i * sb0 + j * sb1];
+                   }
+                }
+             },
+             cols);
+      } else {
+         ::ten::parallel::parallelFor(
+             0, cols, 16,
+             [&](size_type first, size_type last) {
+                for (size_type j = first; j < last; j++) {
+                   for (size_type i = 0; i < p; i++) {
+                      pc[i * sc0 + j * sc1] =
+                          static_cast<T>(d[i]) * pb[i * sb0 + j * sb1];
+                   }
+                   for (size_type i = p; i < rows; i++) {
+                      pc[i * sc0 + j * sc1] = T(0);
+                   }
+                }
+             },
+             rows);
+      }
+   }
+}
+
+/// Product of a dense matrix by a diagonal matrix c = b * a
+/// The columns of b are scaled by the diagonal of a, the columns of c past
+/// the diagonal are zeros.
+template <class B, class A, class C>
+void diagonalMulRight(const B &b, const A &a, C &c) {
+   using T = typename C::value_type;
+   const auto *d = a.storage()->data();
+   const size_type p = a.storage()->size();
+   const size_type rows = c.dim(0);
+   const size_type cols = c.dim(1);
+   const auto *pb = b.data();
+   T *pc = c.data();
+   const size_type sb0 = b.stride(0);
+   const size_type sb1 = b.stride(1);
+   const size_type sc0 = c.stride(0);
+   const size_type sc1 = c.stride(1);
+   ::ten::parallel::parallelFor(
+       0, cols, 16,
+       [&](size_type first, size_type last) {
+          for (size_type j = first; j < last; j++) {
+             if (j >= p) {
+                for (size_type i = 0; i < rows; i++) {
+                   pc[i * sc0 + j * sc1] = T(0);
+                }
+                continue;
+             }
+             const T x = static_cast<T>(d[j]);
+             for (size_type i = 0; i < rows; i++) {
+                pc[i * sc0 + j * sc1] = pb[i * sb0 + j * sb1] * x;
+             }
+          }
+       },
+       rows);
+}
+
+/// Product of a triangular matrix by a dense matrix or vector c = a * b
+template <class A, class B, class C>
+void triangularMul(const A &a, const B &b, C &c) {
+   details::triangular<false>(a, b, c);
+}
+
+/// Solve of the triangular system a * c = b
+template <class A, class B, class C>
+void triangularSolve(const A &a, const B &b, C &c) {
+   details::triangular<true>(a, b, c);
+}
+
+/// Elementwise operation on two structured matrices of the same format
+/// Only the stored elements are computed, the result has the format of the
+/// operands.
+template <::ten::BinaryOperation kind, class A, class B, class C>
+void packedBinaryOps(const A &a, const B &b, C &c) {
+   static_assert(kind != ::ten::BinaryOperation::div,
+                 "Tenseur: Elementwise division of structured matrices.");
+   using T = typename C::value_type;
+   const auto *pa = a.storage()->data();
+   const auto *pb = b.storage()->data();
+   T *pc = c.storage()->data();
+   const size_type size = c.storage()->size();
+   ::ten::parallel::parallelFor(
+       0, size, 4096, [&](size_type first, size_type last) {
+          for (size_type k = first; k < last; k++) {
+             if constexpr (kind == ::ten::BinaryOperation::add) {
+                pc[k] = pa[k] + pb[k];
+             } else if constexpr (kind == ::ten::BinaryOperation::sub) {
+                pc[k] = pa[k] - pb[k];
+             } else {
+                pc[k] = pa[k] * pb[k];
+             }
+          }
+       });
+}
+
+/// Multiplication of a structured matrix by a scalar, only the stored
+/// elements are scaled
+template <class T, class B, class C>
+void packedScale(const T &alpha, const B &b, C &c) {
+   using value_type = typename C::value_type;
+   const value_type x = static_cast<value_type>(alpha);
+   const auto *pb = b.storage()->data();
+   value_type *pc = c.storage()->data();
+   const size_type size = c.storage()->size();
+   ::ten::parallel::parallelFor(
+       0, size, 4096, [&](size_type first, size_type last) {
+          for (size_type k = first; k < last; k++) {
+             pc[k] = x * pb[k];
+          }
+       });
+}
+
+} // namespace ten::kernels
+
+#endif
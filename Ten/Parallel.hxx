@@ -0,0 +1,311 @@
+/// \file Ten/Parallel.hxx
+
+#ifndef TENSEUR_PARALLEL_HXX
+#define TENSEUR_PARALLEL_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Ten/Types.hxx>
+
+// Default number of threads, 0 for the number of hardware threads
+#ifndef TENSEUR_NUM_THREADS
+#define TENSEUR_NUM_THREADS 0
+#endif
+
+// Default minimum number of elements for running a kernel in parallel
+#ifndef TENSEUR_PARALLEL_THRESHOLD
+#define TENSEUR_PARALLEL_THRESHOLD 65536
+#endif
+
+// Number of elements of the blocks of the parallel reductions
+#ifndef TENSEUR_REDUCE_BLOCK_SIZE
+#define TENSEUR_REDUCE_BLOCK_SIZE 16384
+#endif
+
+namespace ten::parallel {
+
+/// \class ThreadPool
+/// Pool of worker threads executing tasks from a shared queue.
+/// A pool of size n has n - 1 workers, the calling thread being the nth.
+class ThreadPool {
+ private:
+   std::vector<std::thread> _workers;
+   std::deque<std::function<void()>> _tasks;
+   std::mutex _mutex;
+   std::condition_variable _condition;
+   bool _stop = false;
+
+   // Whether the current thread is a worker of a pool
+   static bool &isWorker() {
+      thread_local bool worker = false;
+      return worker;
+   }
+
+   void start(size_type numThreads) {
+      _stop = false;
+      for (size_type i = 1; i < numThreads; i++) {
+         _workers.emplace_back([this] {
+            isWorker() = true;
+            while (true) {
+               std::function<void()> task;
+               {
+                  std::unique_lock<std::mutex> lock(_mutex);
+                  _condition.wait(lock,
+                                  [this] { return _stop || !_tasks.empty(); });
+                  if (_stop && _tasks.empty()) {
+                     return;
+                  }
+                  task = std::move(_tasks.front());
+                  _tasks.pop_front();
+               }
+               task();
+            }
+         });
+      }
+   }
+
+   void stop() {
+      {
+         std::lock_guard<std::mutex> lock(_mutex);
+         _stop = true;
+      }
+      _condition.notify_all();
+      for (auto &worker : _workers) {
+         worker.join();
+      }
+      _workers.clear();
+   }
+
+ public:
+   explicit ThreadPool(size_type numThreads) { start(numThreads); }
+
+   ThreadPool(const ThreadPool &) = delete;
+   ThreadPool &operator=(const ThreadPool &) = delete;
+
+   ~ThreadPool() { stop(); }
+
+   /// Returns the number of threads, including the calling thread
+   [[nodiscard]] size_type size() const { return _workers.size() + 1; }
+
+   /// Returns whether the calling thread is a worker thread
+   [[nodiscard]] static bool inWorker() { return isWorker(); }
+
+   /// Set the number of threads
+   /// Must not be called while tasks are running.
+   void resize(size_type numThreads) {
+      if (numThreads == size()) {
+         return;
+      }
+      stop();
+      start(numThreads);
+   }
+
+   /// Push a task to the queue
+   void submit(std::function<void()> &&task) {
+      {
+         std::lock_guard<std::mutex> lock(_mutex);
+         _tasks.push_back(std::move(task));
+      }
+      _condition.notify_one();
+   }
+
+   /// Run a pending task on the calling thread
+   /// Returns false if the queue is empty.
+   bool runPendingTask() {
+      std::function<void()> task;
+      {
+         std::lock_guard<std::mutex> lock(_mutex);
+         if (_tasks.empty()) {
+            return false;
+         }
+         task = std::move(_tasks.front());
+         _tasks.pop_front();
+      }
+      task();
+      return true;
+   }
+
+   /// Wait until done() returns true, running pending tasks meanwhile so that
+   /// nested parallel calls can't deadlock
+   template <class Done> void wait(Done &&done) {
+      while (!done()) {
+         if (!runPendingTask()) {
+            std::this_thread::yield();
+         }
+      }
+   }
+};
+
+namespace details {
+inline size_type defaultNumThreads() {
+   size_type n = TENSEUR_NUM_THREADS;
+   if (n == 0) {
+      n = std::max<size_type>(1, std::thread::hardware_concurrency());
+   }
+   return n;
+}
+
+inline size_type &parallelThreshold() {
+   static size_type threshold = TENSEUR_PARALLEL_THRESHOLD;
+   return threshold;
+}
+} // namespace details
+
+/// Returns the thread pool of the library
+inline ThreadPool &threadPool() {
+   static ThreadPool pool(details::defaultNumThreads());
+   return pool;
+}
+
+namespace details {
+// First exception thrown by the chunks of a parallel loop
+class ChunkErrors {
+ private:
+   std::exception_ptr _error = nullptr;
+   std::mutex _mutex;
+
+ public:
+   // Call body, keeping the first exception it throws
+   template <class Body> void run(Body &&body) noexcept {
+      try {
+         body();
+      } catch (...) {
+         std::lock_guard<std::mutex> lock(_mutex);
+         if (!_error) {
+            _error = std::current_exception();
+         }
+      }
+   }
+
+   void rethrow() {
+      if (_error) {
+         std::rethrow_exception(_error);
+      }
+   }
+};
+
+// Split [begin, end) in one chunk per thread and call body on each chunk
+// The chunks all run before the first exception thrown by body is rethrown,
+// so that the tasks of the pool don't outlive the loop.
+template <class Body>
+void forChunks(size_type begin, size_type end, size_type grain, Body &&body) {
+   ThreadPool &pool = threadPool();
+   size_type n = end - begin;
+   size_type numThreads = pool.size();
+   if (numThreads == 1 || ThreadPool::inWorker()) {
+      body(begin, end);
+      return;
+   }
+   grain = std::max<size_type>(grain, 1);
+   size_type chunk = (n + numThreads - 1) / numThreads;
+   chunk = ((chunk + grain - 1) / grain) * grain;
+   size_type numChunks = (n + chunk - 1) / chunk;
+
+   std::atomic<size_type> remaining(numChunks - 1);
+   ChunkErrors errors;
+   for (size_type k = 1; k < numChunks; k++) {
+      size_type first = begin + k * chunk;
+      size_type last = std::min(end, first + chunk);
+      pool.submit([&body, &remaining, &errors, first, last] {
+         errors.run([&] { body(first, last); });
+         remaining.fetch_sub(1, std::memory_order_release);
+      });
+   }
+   errors.run([&] { body(begin, std::min(end, begin + chunk)); });
+   pool.wait([&remaining] {
+      return remaining.load(std::memory_order_acquire) == 0;
+   });
+   errors.rethrow();
+}
+} // namespace details
+
+/// \fn parallelFor
+/// Call body(first, last) over chunks of [begin, end).
+/// The range is split statically in one chunk per thread, the chunks being
+/// multiple of grain elements. The loop runs on the calling thread when the
+/// range times the cost of an iteration (in elements) is smaller than the
+/// parallel threshold, when there's only one thread or when called from a
+/// worker thread.
+template <class Body>
+void parallelFor(size_type begin, size_type end, size_type grain, Body &&body,
+                 size_type cost = 1) {
+   if (end <= begin) {
+      return;
+   }
+   if ((end - begin) * cost < details::parallelThreshold()) {
+      body(begin, end);
+      return;
+   }
+   details::forChunks(begin, end, grain, body);
+}
+
+/// \fn parallelReduce
+/// Reduce [0, n) by blocks of a fixed size, map(first, last) returns the
+/// partial result of a block and combine(x, y) combines two partial results.
+/// The blocks don't depend on the number of threads and the partial results
+/// are combined in order, so the result is deterministic.
+template <class R, class Map, class Combine>
+R parallelReduce(size_type n, R init, Map &&map, Combine &&combine) {
+   constexpr size_type blockSize = TENSEUR_REDUCE_BLOCK_SIZE;
+   size_type numBlocks = (n + blockSize - 1) / blockSize;
+   if (numBlocks <= 1) {
+      return n == 0 ? init : combine(init, map(size_type(0), n));
+   }
+   std::vector<R> partials(numBlocks, init);
+   auto mapBlocks = [&](size_type first, size_type last) {
+      for (size_type k = first; k < last; k++) {
+         partials[k] = map(k * blockSize, std::min(n, (k + 1) * blockSize));
+      }
+   };
+   if (n < details::parallelThreshold()) {
+      mapBlocks(0, numBlocks);
+   } else {
+      details::forChunks(0, numBlocks, 1, mapBlocks);
+   }
+   R result = init;
+   for (size_type k = 0; k < numBlocks; k++) {
+      result = combine(result, partials[k]);
+   }
+   return result;
+}
+
+} // namespace ten::parallel
+
+namespace ten {
+
+/// \fn setNumThreads
+/// Set the number of threads used by the kernels
+inline void setNumThreads(size_type numThreads) {
+   ::ten::parallel::threadPool().resize(std::max<size_type>(numThreads, 1));
+}
+
+/// \fn numThreads
+/// Returns the number of threads used by the kernels
+[[nodiscard]] inline size_type numThreads() {
+   return ::ten::parallel::threadPool().size();
+}
+
+/// \fn setParallelThreshold
+/// Set the minimum number of elements for running a kernel in parallel
+inline void setParallelThreshold(size_type threshold) {
+   ::ten::parallel::details::parallelThreshold() = threshold;
+}
+
+/// \fn parallelThreshold
+/// Returns the minimum number of elements for running a kernel in parallel
+[[nodiscard]] inline size_type parallelThreshold() {
+   return ::ten::parallel::details::parallelThreshold();
+}
+
+} // namespace ten
+
+#endif
@@ -0,0 +1,263 @@
+/// \file Ten/Plan.hxx
+
+#ifndef TENSEUR_PLAN_HXX
+#define TENSEUR_PLAN_HXX
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <typeindex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <Ten/Expr.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten {
+
+namespace details {
+// Output buffer of an evaluated node of a plan
+// The buffer is produced at the step first and read until the step last, the
+// steps being the evaluated nodes in the order of evaluation.
+struct PlanBuffer {
+   std::type_index type = typeid(void);
+   std::vector<size_type> dims;
+   size_type first = 0;
+   size_type last = 0;
+   bool shareable = true;
+   std::shared_ptr<void> value;
+   std::function<void(const std::shared_ptr<void> &)> set;
+};
+
+// Collect the output buffers of the evaluated nodes of an expression
+class PlanBuilder {
+ private:
+   std::vector<PlanBuffer> _buffers;
+   // Buffers waiting for the step reading them, by node
+   std::unordered_map<const void *, std::vector<size_type>> _visited;
+   size_type _step = 0;
+
+   template <class Node> static constexpr bool isViewNode() {
+      return ::ten::functional::IsViewOutput<typename Node::func_type>::value;
+   }
+
+   // Add the buffer of an evaluated node
+   template <class Node>
+   size_type addBuffer(const std::shared_ptr<Node> &node) {
+      using output_type = typename Node::output_node_type;
+      PlanBuffer buffer;
+      auto value = node.get()->node();
+      buffer.type = typeid(output_type);
+      for (size_type i = 0; i < output_type::rank(); i++) {
+         buffer.dims.push_back(value.get()->dim(i));
+      }
+      buffer.first = _step;
+      buffer.last = _step;
+      buffer.shareable = !isViewNode<Node>();
+      buffer.value = value;
+      Node *ptr = node.get();
+      buffer.set = [ptr](const std::shared_ptr<void> &b) {
+         ptr->setBuffer(std::static_pointer_cast<output_type>(b));
+      };
+      _buffers.push_back(std::move(buffer));
+      return _buffers.size() - 1;
+   }
+
+   // Returns the buffers read by the evaluated ancestor of a node
+   template <class Node>
+   std::vector<size_type> visit(const std::shared_ptr<Node> &node) {
+      if constexpr (!::ten::isUnaryNode<Node>::value &&
+                    !::ten::isBinaryNode<Node>::value) {
+         return {};
+      } else {
+         auto it = _visited.find(node.get());
+         if (it != _visited.end()) {
+            return it->second;
+         }
+         std::vector<size_type> pending;
+         if constexpr (::ten::isUnaryNode<Node>::value) {
+            pending = visit(node.get()->input());
+         } else {
+            pending = visit(node.get()->left());
+            auto right = visit(node.get()->right());
+            pending.insert(pending.end(), right.begin(), right.end());
+         }
+         using output_type = typename Node::output_node_type;
+         if constexpr (!::ten::isScalarNode<output_type>::value) {
+            if (node.get()->evaluated()) {
+               size_type index = addBuffer(node);
+               for (size_type input : pending) {
+                  _buffers[input].last = std::max(_buffers[input].last, _step);
+                  // The view shares the storage of its input
+                  if constexpr (isViewNode<Node>()) {
+                     _buffers[input].shareable = false;
+                  }
+               }
+               _step++;
+               pending = {index};
+            }
+         }
+         _visited[node.get()] = pending;
+         return pending;
+      }
+   }
+
+ public:
+   /// Collect the buffers of an evaluated expression, the output of the
+   /// expression isn't shared
+   template <class Node>
+   std::vector<PlanBuffer> operator()(const std::shared_ptr<Node> &node) {
+      _buffers.clear();
+      _visited.clear();
+      _step = 0;
+      for (size_type index : visit(node)) {
+         _buffers[index].shareable = false;
+      }
+      return std::move(_buffers);
+   }
+};
+
+// Unevaluated copy of the nodes of an expression
+// A node read by several nodes is copied once. The tensor and scalar inputs
+// are shared with the expression.
+class NodeCloner {
+ private:
+   std::unordered_map<const void *, std::shared_ptr<void>> _clones;
+
+ public:
+   template <class Node>
+   std::shared_ptr<Node> operator()(const std::shared_ptr<Node> &node) {
+      if constexpr (!::ten::isUnaryNode<Node>::value &&
+                    !::ten::isBinaryNode<Node>::value) {
+         return node;
+      } else {
+         auto it = _clones.find(node.get());
+         if (it != _clones.end()) {
+            return std::static_pointer_cast<Node>(it->second);
+         }
+         std::shared_ptr<Node> clone;
+         if constexpr (::ten::isUnaryNode<Node>::value) {
+            clone = std::make_shared<Node>(*node.get(),
+                                           (*this)(node.get()->input()));
+         } else {
+            auto left = (*this)(node.get()->left());
+            clone = std::make_shared<Node>(*node.get(), left,
+                                           (*this)(node.get()->right()));
+         }
+         _clones[node.get()] = clone;
+         return clone;
+      }
+   }
+};
+
+// Share the buffers of the same type and shape whose lifetimes don't overlap
+// Returns the number of distinct shared buffers.
+inline size_type shareBuffers(std::vector<PlanBuffer> &buffers) {
+   struct Slot {
+      size_type buffer;
+      size_type last;
+   };
+   std::vector<Slot> slots;
+   // The buffers are ordered by the step producing them
+   for (size_type i = 0; i < buffers.size(); i++) {
+      auto &buffer = buffers[i];
+      if (!buffer.shareable) {
+         continue;
+      }
+      auto slot = std::find_if(slots.begin(), slots.end(), [&](const Slot &s) {
+         const auto &other = buffers[s.buffer];
+         return s.last < buffer.first && other.type == buffer.type &&
+                other.dims == buffer.dims;
+      });
+      if (slot == slots.end()) {
+         slots.push_back(Slot{i, buffer.last});
+      } else {
+         buffer.set(buffers[slot->buffer].value);
+         slot->last = buffer.last;
+      }
+   }
+   return slots.size();
+}
+} // namespace details
+
+/// \class Plan
+/// Compiled expression, evaluated again by run() into the same buffers
+///
+/// The first run evaluates the expression and records the buffers of its
+/// intermediate results with their lifetimes. The intermediate results of the
+/// same shape that are not alive at the same time then share their buffer,
+/// and the following runs evaluate the expression without allocating.
+/// The output of the plan is overwritten by each run. The plan evaluates a
+/// copy of the nodes of the expression, so the runs don't change the compiled
+/// expression, and reads its tensor inputs.
+template <class E> class Plan {
+ public:
+   using expr_type = E;
+   using node_type = typename E::node_type;
+   using evaluated_type = typename node_type::evaluated_type;
+
+ private:
+   E _expr;
+   /// Whether the plan has been run
+   bool _compiled = false;
+   /// Whether the value is up to date with the inputs
+   bool _valid = false;
+   /// Buffers of the evaluated nodes of the first run, waiting to be shared
+   std::vector<details::PlanBuffer> _buffers;
+   /// Number of buffers of the intermediate results
+   size_type _numBuffers = 0;
+
+ public:
+   explicit Plan(const E &expr) : _expr(details::NodeCloner()(expr.node())) {}
+
+   /// Evaluate the expression with the current values of its inputs
+   [[maybe_unused]] evaluated_type run() {
+      _expr.invalidate();
+      if (!_buffers.empty()) {
+         _numBuffers = details::shareBuffers(_buffers);
+         _buffers.clear();
+      }
+      auto value = _expr.eval();
+      if (!_compiled) {
+         _buffers = details::PlanBuilder()(_expr.node());
+         _numBuffers = std::count_if(
+             _buffers.begin(), _buffers.end(),
+             [](const details::PlanBuffer &b) { return b.shareable; });
+         _compiled = true;
+      }
+      _valid = true;
+      return value;
+   }
+
+   /// Returns the value of the expression, evaluated again when the inputs
+   /// were invalidated
+   [[nodiscard]] evaluated_type value() {
+      if (!_valid) {
+         return run();
+      }
+      return _expr.value();
+   }
+
+   /// Mark the inputs as modified, the next call to value() runs the plan
+   void invalidate() { _valid = false; }
+
+   /// Returns the number of buffers of the intermediate results
+   [[nodiscard]] size_type numBuffers() const { return _numBuffers; }
+
+   /// Returns the compiled expression
+   [[nodiscard]] const E &expr() const { return _expr; }
+};
+
+/// \fn compile
+/// Compile an expression into a plan evaluated by Plan::run()
+template <class E>
+   requires ::ten::isUnaryExpr<std::remove_cvref_t<E>>::value ||
+            ::ten::isBinaryExpr<std::remove_cvref_t<E>>::value
+auto compile(E &&expr) {
+   return Plan<std::remove_cvref_t<E>>(expr);
+}
+
+} // namespace ten
+
+#endif
@@ -0,0 +1,393 @@
+/// \file Ten/Profile.hxx
+
+#ifndef TENSEUR_PROFILE_HXX
+#define TENSEUR_PROFILE_HXX
+
+// Profiling of the evaluation of expressions and of the kernels
+//
+// Defining TENSEUR_PROFILE before including Tenseur instruments the eval()
+// of the unary and binary nodes and the kernels. Without it the macros
+// expand to nothing and nothing is recorded. When compiled in, recording
+// is switched on by setting the environment variable TENSEUR_PROFILE or by
+// calling ten::profile::enable().
+
+#ifdef TENSEUR_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#include <Ten/Parallel.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::profile {
+
+/// \struct Event
+/// Timed evaluation of a node or call of a kernel
+///
+/// The counters of an event include the counters of the events nested in
+/// it, a node counts the bytes and flops of the kernels it calls.
+struct Event {
+   /// Name of the function of the node or of the kernel
+   std::string name;
+   /// Category, "node" or "kernel"
+   std::string category;
+   /// Start time in microseconds since the profiler was created
+   double start = 0.;
+   /// Wall time in microseconds
+   double duration = 0.;
+   /// Wall time in microseconds minus the time of the nested events
+   double self = 0.;
+   /// Index of the thread that recorded the event
+   size_type thread = 0;
+   /// Number of threads available to the call
+   size_type threads = 1;
+   /// Number of bytes read
+   size_type bytesRead = 0;
+   /// Number of bytes written
+   size_type bytesWritten = 0;
+   /// Number of floating point operations
+   size_type flops = 0;
+   /// Number of bytes allocated for outputs
+   size_type allocated = 0;
+};
+
+namespace details {
+// Events recorded by all the threads
+class Profiler {
+ private:
+   using clock_type = std::chrono::steady_clock;
+
+   std::mutex _mutex;
+   std::vector<Event> _events;
+   std::atomic<bool> _enabled;
+   std::atomic<size_type> _numThreads = 0;
+   const clock_type::time_point _epoch = clock_type::now();
+
+ public:
+   Profiler() : _enabled(std::getenv("TENSEUR_PROFILE") != nullptr) {}
+
+   ~Profiler();
+
+   static Profiler &instance() {
+      static Profiler profiler;
+      return profiler;
+   }
+
+   [[nodiscard]] bool enabled() const {
+      return _enabled.load(std::memory_order_relaxed);
+   }
+
+   void enable(bool value) { _enabled.store(value, std::memory_order_relaxed); }
+
+   /// Microseconds since the creation of the profiler
+   [[nodiscard]] double now() const {
+      return std::chrono::duration<double, std::micro>(clock_type::now() -
+                                                       _epoch)
+          .count();
+   }
+
+   /// Index of the calling thread, in the order of their first event
+   [[nodiscard]] size_type threadIndex() {
+      thread_local size_type index =
+          _numThreads.fetch_add(1, std::memory_order_relaxed);
+      return index;
+   }
+
+   void record(Event &&event) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _events.push_back(std::move(event));
+   }
+
+   [[nodiscard]] std::vector<Event> events() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _events;
+   }
+
+   void reset() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _events.clear();
+   }
+};
+
+// Readable name of a type, without namespace and template arguments
+// ten::functional::Add<A, B, C> is named Add and
+// ten::functional::Sum<Summation::naive>::Func<A, B> is named Sum.
+template <class T> const std::string &typeName() {
+   static const std::string name = [] {
+      std::string s = typeid(T).name();
+#if defined(__GNUC__)
+      int status = 0;
+      char *demangled =
+          abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+      if (status == 0 && demangled) {
+         s = demangled;
+      }
+      std::free(demangled);
+#endif
+      s = s.substr(0, s.find('<'));
+      size_t pos = s.rfind("::");
+      return pos == std::string::npos ? s : s.substr(pos + 2);
+   }();
+   return name;
+}
+
+// Size in bytes of the elements of an output node
+template <class Node> size_type outputBytes(const Node &node) {
+   if constexpr (requires { typename Node::value_type; }) {
+      return node.size() * sizeof(typename Node::value_type);
+   } else {
+      return sizeof(Node);
+   }
+}
+} // namespace details
+
+/// \class Scope
+/// Record the wall time and the counters of a node or a kernel
+///
+/// The scope is the current one of its thread until it's destroyed, the
+/// counters are added to the current scope. Nothing is recorded when the
+/// profiling is disabled.
+class Scope {
+ private:
+   const char *_name = nullptr;
+   const char *_category = nullptr;
+   Scope *_parent = nullptr;
+   double _start = 0.;
+   double _nested = 0.;
+   size_type _threads = 1;
+   size_type _bytesRead = 0;
+   size_type _bytesWritten = 0;
+   size_type _flops = 0;
+   size_type _allocated = 0;
+
+   static Scope *&current() {
+      thread_local Scope *scope = nullptr;
+      return scope;
+   }
+
+ public:
+   Scope(const char *name, const char *category) {
+      details::Profiler &profiler = details::Profiler::instance();
+      if (!profiler.enabled()) {
+         return;
+      }
+      _name = name;
+      _category = category;
+      _parent = current();
+      _threads = ::ten::parallel::ThreadPool::inWorker()
+                     ? 1
+                     : ::ten::parallel::threadPool().size();
+      current() = this;
+      _start = profiler.now();
+   }
+
+   Scope(const std::string &name, const char *category)
+       : Scope(name.c_str(), category) {}
+
+   Scope(const Scope &) = delete;
+   Scope &operator=(const Scope &) = delete;
+
+   ~Scope() {
+      if (!_name) {
+         return;
+      }
+      details::Profiler &profiler = details::Profiler::instance();
+      double duration = profiler.now() - _start;
+      current() = _parent;
+      if (_parent) {
+         _parent->_nested += duration;
+         _parent->_bytesRead += _bytesRead;
+         _parent->_bytesWritten += _bytesWritten;
+         _parent->_flops += _flops;
+         _parent->_allocated += _allocated;
+      }
+      profiler.record(Event{_name, _category, _start, duration,
+                            duration - _nested, profiler.threadIndex(),
+                            _threads, _bytesRead, _bytesWritten, _flops,
+                            _allocated});
+   }
+
+   /// Add to the counters of the current scope of the thread
+   static void count(size_type read, size_type written, size_type flops) {
+      if (Scope *scope = current()) {
+         scope->_bytesRead += read;
+         scope->_bytesWritten += written;
+         scope->_flops += flops;
+      }
+   }
+
+   /// Add an allocation to the current scope of the thread
+   static void allocation(size_type bytes) {
+      if (Scope *scope = current()) {
+         scope->_allocated += bytes;
+      }
+   }
+};
+
+/// \fn enable
+/// Switch the recording of events on or off
+inline void enable(bool value = true) {
+   details::Profiler::instance().enable(value);
+}
+
+/// \fn enabled
+/// Returns whether events are recorded
+[[nodiscard]] inline bool enabled() {
+   return details::Profiler::instance().enabled();
+}
+
+/// \fn reset
+/// Remove the recorded events
+inline void reset() { details::Profiler::instance().reset(); }
+
+/// \fn events
+/// Returns a copy of the recorded events
+[[nodiscard]] inline std::vector<Event> events() {
+   return details::Profiler::instance().events();
+}
+
+/// \fn summary
+/// Write a table of events aggregated by category and name
+///
+/// Times are in milliseconds, the bandwidth and the GFLOP/s are computed
+/// from the total wall time of the calls.
+inline void summary(std::ostream &os, const std::vector<Event> &events) {
+   struct Total {
+      size_type calls = 0;
+      double time = 0.;
+      double self = 0.;
+      size_type bytes = 0;
+      size_type flops = 0;
+      size_type allocated = 0;
+      size_type threads = 0;
+   };
+   std::map<std::pair<std::string, std::string>, Total> totals;
+   for (const Event &e : events) {
+      Total &t = totals[{e.category, e.name}];
+      t.calls++;
+      t.time += e.duration;
+      t.self += e.self;
+      t.bytes += e.bytesRead + e.bytesWritten;
+      t.flops += e.flops;
+      t.allocated += e.allocated;
+      t.threads = std::max(t.threads, e.threads);
+   }
+   std::ios_base::fmtflags flags = os.flags();
+   std::streamsize precision = os.precision();
+   os << std::left << std::setw(10) << "Category" << std::setw(20) << "Name"
+      << std::right << std::setw(8) << "Calls" << std::setw(12) << "Time(ms)"
+      << std::setw(12) << "Self(ms)" << std::setw(12) << "Mean(us)"
+      << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s"
+      << std::setw(12) << "Alloc(MB)" << std::setw(9) << "Threads"
+      << "\n";
+   os << std::fixed;
+   for (const auto &[key, t] : totals) {
+      // Bytes per microsecond are MB/s
+      double seconds = t.time * 1e-6;
+      os << std::left << std::setw(10) << key.first << std::setw(20)
+         << key.second << std::right << std::setw(8) << t.calls
+         << std::setprecision(3) << std::setw(12) << t.time * 1e-3
+         << std::setw(12) << t.self * 1e-3 << std::setw(12)
+         << t.time / double(t.calls) << std::setprecision(2) << std::setw(10)
+         << (seconds > 0. ? double(t.bytes) * 1e-9 / seconds : 0.)
+         << std::setw(10)
+         << (seconds > 0. ? double(t.flops) * 1e-9 / seconds : 0.)
+         << std::setw(12) << double(t.allocated) * 1e-6 << std::setw(9)
+         << t.threads << "\n";
+   }
+   os.flags(flags);
+   os.precision(precision);
+}
+
+/// Write a table of the recorded events aggregated by category and name
+inline void summary(std::ostream &os) { summary(os, events()); }
+
+/// \fn writeTrace
+/// Write events in the Chrome trace event format
+///
+/// The file can be opened with chrome://tracing or Perfetto, each thread of
+/// the process is a track and the nested events are stacked.
+inline void writeTrace(std::ostream &os, const std::vector<Event> &events) {
+   std::ios_base::fmtflags flags = os.flags();
+   std::streamsize precision = os.precision();
+   os << std::fixed << std::setprecision(3);
+   os << "{\"traceEvents\":[";
+   bool first = true;
+   for (const Event &e : events) {
+      os << (first ? "\n" : ",\n");
+      first = false;
+      os << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+         << "\",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration
+         << ",\"pid\":0,\"tid\":" << e.thread << ",\"args\":{\"threads\":"
+         << e.threads << ",\"bytesRead\":" << e.bytesRead
+         << ",\"bytesWritten\":" << e.bytesWritten << ",\"flops\":" << e.flops
+         << ",\"allocated\":" << e.allocated << "}}";
+   }
+   os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+   os.flags(flags);
+   os.precision(precision);
+}
+
+/// Write the recorded events in the Chrome trace event format
+inline void writeTrace(std::ostream &os) { writeTrace(os, events()); }
+
+/// Write the recorded events to a file in the Chrome trace event format
+inline void writeTrace(const std::string &path) {
+   std::ofstream file(path);
+   if (!file) {
+      throw std::runtime_error("Tenseur: Cannot open the trace file " + path);
+   }
+   writeTrace(file);
+}
+
+// When enabled from the environment, the summary is written to the standard
+// error at exit and the trace to the file TENSEUR_PROFILE_TRACE if it's set.
+inline details::Profiler::~Profiler() {
+   if (!std::getenv("TENSEUR_PROFILE") || _events.empty()) {
+      return;
+   }
+   summary(std::cerr, _events);
+   if (const char *path = std::getenv("TENSEUR_PROFILE_TRACE")) {
+      std::ofstream file(path);
+      writeTrace(file, _events);
+   }
+}
+
+} // namespace ten::profile
+
+/// Record the enclosing block as an event of the given name and category
+#define TENSEUR_PROFILE_SCOPE(name, category)                                 \
+   ::ten::profile::Scope tenseurProfileScope_(name, category)
+
+/// Count bytes read, bytes written and floating point operations
+#define TENSEUR_PROFILE_COUNT(read, written, flops)                           \
+   ::ten::profile::Scope::count(read, written, flops)
+
+/// Count the allocation of an output
+#define TENSEUR_PROFILE_ALLOC(bytes) ::ten::profile::Scope::allocation(bytes)
+
+#else
+
+#define TENSEUR_PROFILE_SCOPE(name, category)
+#define TENSEUR_PROFILE_COUNT(read, written, flops)
+#define TENSEUR_PROFILE_ALLOC(bytes)
+
+#endif
+
+#endif
@@ -1,10 +1,22 @@
 #ifndef TENSEUR_RANDOM
 #define TENSEUR_RANDOM
 
+#include <Ten/Parallel.hxx>
+#include <Ten/Tensor.hxx>
 #include <Ten/Types.hxx>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <experimental/simd>
 #include <initializer_list>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <optional>
 #include <random>
+#include <type_traits>
 
 namespace ten::details {
 template <class RandomEngine>
@@ -18,41 +30,553 @@ auto getEngine = [](const std::optional<size_t> seed) -> decltype(auto) {
       return engine;
    }
 };
+
+// Philox4x32-10 rounds
+// The 32 bits words of the counter x are held in 64 bits integers or simd
+// vectors of 64 bits integers, so that the 32 x 32 -> 64 bits products are
+// computed by a single multiplication.
+template <class V>
+void philoxRounds(std::array<V, 4> &x, std::uint32_t k0, std::uint32_t k1) {
+   constexpr std::uint64_t mask = 0xFFFFFFFF;
+   constexpr std::uint64_t m0 = 0xD2511F53;
+   constexpr std::uint64_t m1 = 0xCD9E8D57;
+   std::uint64_t key0 = k0;
+   std::uint64_t key1 = k1;
+   for (size_type round = 0; round < 10; round++) {
+      const V p0 = x[0] * V(m0);
+      const V p1 = x[2] * V(m1);
+      x = {(p1 >> 32) ^ x[1] ^ V(key0), p1 & V(mask),
+           (p0 >> 32) ^ x[3] ^ V(key1), p0 & V(mask)};
+      key0 = (key0 + 0x9E3779B9) & mask;
+      key1 = (key1 + 0xBB67AE85) & mask;
+   }
 }
+} // namespace ten::details
 
 namespace ten {
-// Random tensor
+/// \class Philox
+/// Philox4x32-10 counter based random number generator
+///
+/// The 4 words of the block of index counter depend only on the seed and the
+/// counter, so that any block is generated without generating the previous
+/// ones. Philox satisfies the uniform random bit generator requirements, the
+/// successive words being those of the blocks 0, 1, 2...
+class Philox {
+ public:
+   using result_type = std::uint32_t;
+
+ private:
+   std::uint32_t _k0 = 0;
+   std::uint32_t _k1 = 0;
+   std::uint64_t _counter = 0;
+   std::array<std::uint32_t, 4> _words{};
+   size_type _index = 4;
+
+ public:
+   /// Construct a generator from a 64 bits seed, the key of the rounds
+   explicit Philox(std::uint64_t seed = 0) noexcept
+       : _k0(static_cast<std::uint32_t>(seed)),
+         _k1(static_cast<std::uint32_t>(seed >> 32)) {}
+
+   /// Returns the block of index counter of the stream
+   [[nodiscard]] std::array<std::uint32_t, 4>
+   block(std::uint64_t counter, std::uint64_t stream = 0) const noexcept {
+      std::array<std::uint64_t, 4> x = {counter & 0xFFFFFFFF, counter >> 32,
+                                        stream & 0xFFFFFFFF, stream >> 32};
+      details::philoxRounds(x, _k0, _k1);
+      return {static_cast<std::uint32_t>(x[0]),
+              static_cast<std::uint32_t>(x[1]),
+              static_cast<std::uint32_t>(x[2]),
+              static_cast<std::uint32_t>(x[3])};
+   }
+
+   /// Returns the key of the rounds
+   [[nodiscard]] std::array<std::uint32_t, 2> key() const noexcept {
+      return {_k0, _k1};
+   }
+
+   static constexpr result_type min() { return 0; }
+   static constexpr result_type max() {
+      return std::numeric_limits<result_type>::max();
+   }
+
+   /// Returns the next word
+   result_type operator()() noexcept {
+      if (_index == 4) {
+         _words = block(_counter++);
+         _index = 0;
+      }
+      return _words[_index++];
+   }
+
+   /// Skip n words
+   void discard(unsigned long long n) noexcept {
+      const unsigned long long available = 4 - _index;
+      if (n <= available) {
+         _index += n;
+         return;
+      }
+      n -= available;
+      _counter += n / 4;
+      _words = block(_counter++);
+      _index = n % 4;
+   }
+};
+
+namespace details {
+template <class> struct isPhiloxDistribution : std::false_type {};
+template <class T>
+struct isPhiloxDistribution<std::normal_distribution<T>>
+    : std::bool_constant<std::is_same_v<T, float> ||
+                         std::is_same_v<T, double>> {};
+template <class T>
+struct isPhiloxDistribution<std::uniform_real_distribution<T>>
+    : std::bool_constant<std::is_same_v<T, float> ||
+                         std::is_same_v<T, double>> {};
+
+template <class> struct isNormalDistribution : std::false_type {};
+template <class T>
+struct isNormalDistribution<std::normal_distribution<T>> : std::true_type {};
+
+/// \class PhiloxSampler
+/// Uniform or normal values of type T at the indices of a tensor
+///
+/// The values are generated by groups of lanes Philox blocks computed at once
+/// in simd vectors, a block giving 4 floats or 2 doubles. The value j of the
+/// lane l of the group g is at the index g * groupSize + j * lanes + l, it only
+/// depends on the seed and its index, not on how the indices are split over
+/// the threads. The normal values are sampled by the Box-Muller transform of
+/// the pairs of uniform values of a lane.
+template <class T> class PhiloxSampler {
+   static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                 "Tenseur: Philox sampling of float or double values.");
+
+ public:
+   static constexpr size_type lanes = 8;
+   static constexpr size_type valuesPerBlock = std::is_same_v<T, float> ? 4 : 2;
+   static constexpr size_type groupSize = valuesPerBlock * lanes;
+
+ private:
+   using word_type = std::experimental::fixed_size_simd<std::uint64_t, lanes>;
+   using vector_type = std::experimental::fixed_size_simd<T, lanes>;
+
+   /// Spacing of the uniform values
+   static constexpr T epsilon =
+       std::is_same_v<T, float> ? T(0x1.0p-24) : T(0x1.0p-53);
+
+   std::uint32_t _k0 = 0;
+   std::uint32_t _k1 = 0;
+   bool _normal = true;
+   /// Mean and standard deviation, or bounds of the uniform distribution
+   T _a = T(0);
+   T _b = T(1);
+
+   // Uniform values in [0, 1) from the words of a block
+   static std::array<vector_type, valuesPerBlock>
+   uniform(const std::array<word_type, 4> &x) {
+      using std::experimental::static_simd_cast;
+      std::array<vector_type, valuesPerBlock> u;
+      if constexpr (std::is_same_v<T, float>) {
+         for (size_type j = 0; j < 4; j++) {
+            u[j] = static_simd_cast<vector_type>(x[j] >> 8) *
+                   vector_type(epsilon);
+         }
+      } else {
+         for (size_type j = 0; j < 2; j++) {
+            word_type bits = (x[2 * j] << 21) ^ (x[2 * j + 1] >> 11);
+            u[j] = static_simd_cast<vector_type>(bits) * vector_type(epsilon);
+         }
+      }
+      return u;
+   }
+
+ public:
+   PhiloxSampler() = default;
+
+   /// Sampler of the distribution with the seed
+   template <class Distribution>
+      requires isPhiloxDistribution<Distribution>::value
+   PhiloxSampler(const Distribution &dist, std::uint64_t seed)
+       : _k0(static_cast<std::uint32_t>(seed)),
+         _k1(static_cast<std::uint32_t>(seed >> 32)) {
+      if constexpr (isNormalDistribution<Distribution>::value) {
+         _normal = true;
+         _a = static_cast<T>(dist.mean());
+         _b = static_cast<T>(dist.stddev());
+      } else {
+         _normal = false;
+         _a = static_cast<T>(dist.a());
+         _b = static_cast<T>(dist.b());
+      }
+   }
+
+   bool operator==(const PhiloxSampler &) const = default;
+
+   /// Write the groupSize values of the group g to out
+   void group(size_type g, T *out) const {
+      std::array<word_type, 4> x;
+      x[0] = word_type([g](auto l) {
+         return (std::uint64_t(g) * lanes + l) & 0xFFFFFFFF;
+      });
+      x[1] = word_type([g](auto l) {
+         return (std::uint64_t(g) * lanes + l) >> 32;
+      });
+      x[2] = word_type(0);
+      x[3] = word_type(0);
+      philoxRounds(x, _k0, _k1);
+      auto u = uniform(x);
+      if (_normal) {
+         using std::experimental::cos;
+         using std::experimental::log;
+         using std::experimental::sin;
+         using std::experimental::sqrt;
+         const vector_type twoPi(T(2) * std::numbers::pi_v<T>);
+         for (size_type j = 0; j < valuesPerBlock; j += 2) {
+            // log of the first value of the pair moved to (0, 1]
+            vector_type r =
+                sqrt(vector_type(T(-2)) * log(u[j] + vector_type(epsilon)));
+            vector_type theta = twoPi * u[j + 1];
+            u[j] = vector_type(_a) + vector_type(_b) * r * cos(theta);
+            u[j + 1] = vector_type(_a) + vector_type(_b) * r * sin(theta);
+         }
+      } else {
+         for (size_type j = 0; j < valuesPerBlock; j++) {
+            u[j] = vector_type(_a) + vector_type(_b - _a) * u[j];
+         }
+      }
+      for (size_type j = 0; j < valuesPerBlock; j++) {
+         u[j].copy_to(out + j * lanes, std::experimental::element_aligned);
+      }
+   }
+
+   /// Returns the value at the index k
+   /// The last group is cached by each thread, so that reading the values of a
+   /// group in sequence generates it once.
+   T value(size_type k) const {
+      struct Cache {
+         PhiloxSampler sampler;
+         size_type group = std::numeric_limits<size_type>::max();
+         std::array<T, groupSize> values;
+      };
+      thread_local Cache cache;
+      const size_type g = k / groupSize;
+      if (cache.group != g || !(cache.sampler == *this)) {
+         group(g, cache.values.data());
+         cache.group = g;
+         cache.sampler = *this;
+      }
+      return cache.values[k % groupSize];
+   }
+
+   /// Fill the n values of data in parallel
+   void fill(T *data, size_type n) const {
+      const size_type groups = (n + groupSize - 1) / groupSize;
+      ::ten::parallel::parallelFor(
+          0, groups, 1,
+          [&](size_type first, size_type last) {
+             for (size_type g = first; g < last; g++) {
+                if ((g + 1) * groupSize <= n) {
+                   group(g, data + g * groupSize);
+                } else {
+                   std::array<T, groupSize> values;
+                   group(g, values.data());
+                   std::copy_n(values.begin(), n - g * groupSize,
+                               data + g * groupSize);
+                }
+             }
+          },
+          groupSize * 16);
+   }
+};
+
+// Seed of a random tensor, drawn from the random device when not given
+inline std::uint64_t randomSeed(const std::optional<size_t> seed) {
+   if (seed.has_value()) {
+      return seed.value();
+   }
+   std::random_device device;
+   return (std::uint64_t(device()) << 32) | device();
+}
+
+// Fill a tensor with the values of a distribution
+template <class RandomEngine, class T, class Distribution>
+void randomFill(T &x, Distribution &dist, const std::optional<size_t> seed) {
+   using value_type = typename T::value_type;
+   if constexpr (std::is_same_v<RandomEngine, ::ten::Philox> &&
+                 isPhiloxDistribution<Distribution>::value &&
+                 std::is_same_v<typename Distribution::result_type,
+                                value_type>) {
+      PhiloxSampler<value_type>(dist, randomSeed(seed))
+          .fill(x.data(), x.size());
+   } else {
+      auto engine = getEngine<RandomEngine>(seed);
+      for (size_t i = 0; i < x.size(); i++) {
+         x[i] = dist(engine);
+      }
+   }
+}
+} // namespace details
+
+/// \fn rand
+/// Random tensor
+/// With the default Philox engine, the normal and uniform real distributions
+/// of float and double values are sampled in parallel, the same seed giving
+/// the same tensor whatever the number of threads. The other engines and
+/// distributions are sampled sequentially.
 template <class T,
           class Distribution = std::normal_distribution<typename T::value_type>,
-          class RandomEngine = std::mt19937>
-   requires(::ten::isDynamicTensor<T>::value)
-auto rand(std::initializer_list<size_t> &&dims,
+          class RandomEngine = Philox>
+   requires(::ten::isDynamicTensor<T>::value &&
+            requires { typename Distribution::result_type; })
+auto rand(std::initializer_list<size_t> &&dims, Distribution dist,
           const std::optional<size_t> seed = std::nullopt) {
    T x(std::move(dims));
-   auto engine = details::getEngine<RandomEngine>(seed);
-   Distribution dist;
-   // Fill with random data
-   for (size_t i = 0; i < x.size(); i++) {
-      x[i] = dist(engine);
-   }
+   details::randomFill<RandomEngine>(x, dist, seed);
    return x;
 }
 
+template <class T,
+          class Distribution = std::normal_distribution<typename T::value_type>,
+          class RandomEngine = Philox>
+   requires(::ten::isDynamicTensor<T>::value)
+auto rand(std::initializer_list<size_t> &&dims,
+          const std::optional<size_t> seed = std::nullopt) {
+   return rand<T, Distribution, RandomEngine>(std::move(dims), Distribution(),
+                                              seed);
+}
+
 // Random static tensor
 template <class T,
           class Distribution = std::normal_distribution<typename T::value_type>,
-          class RandomEngine = std::mt19937>
+          class RandomEngine = Philox>
+   requires(::ten::isStaticTensor<T>::value &&
+            requires { typename Distribution::result_type; })
+auto rand(Distribution dist, const std::optional<size_t> seed = std::nullopt) {
+   T x;
+   details::randomFill<RandomEngine>(x, dist, seed);
+   return x;
+}
+
+template <class T,
+          class Distribution = std::normal_distribution<typename T::value_type>,
+          class RandomEngine = Philox>
    requires(::ten::isStaticTensor<T>::value)
 auto rand(const std::optional<size_t> seed = std::nullopt) {
-   T x;
-   auto engine = details::getEngine<RandomEngine>(seed);
-   Distribution dist;
-   // Fill with random data
-   for (size_t i = 0; i < x.size(); i++) {
-      x[i] = dist(engine);
+   return rand<T, Distribution, RandomEngine>(Distribution(), seed);
+}
+
+/// \class RandomNode
+/// Random tensor of type Tensor generated on demand
+/// The elementwise expressions read the values of the node without storing
+/// them, the other functions read the tensor materialized by eval().
+template <class Tensor> class RandomNode {
+ public:
+   using output_node_type = typename Tensor::node_type;
+   using value_type = typename Tensor::value_type;
+   using shape_type = typename Tensor::shape_type;
+   using sampler_type = details::PhiloxSampler<value_type>;
+   using evaluated_type = Tensor;
+
+ private:
+   shape_type _shape;
+   sampler_type _sampler;
+   std::shared_ptr<output_node_type> _value = nullptr;
+
+ public:
+   RandomNode(const shape_type &shape, const sampler_type &sampler)
+       : _shape(shape), _sampler(sampler) {}
+
+   [[nodiscard]] const shape_type &shape() const { return _shape; }
+
+   [[nodiscard]] const sampler_type &sampler() const { return _sampler; }
+
+   [[nodiscard]] std::shared_ptr<output_node_type> node() { return _value; }
+
+   /// Returns whether the tensor is materialized
+   [[nodiscard]] bool evaluated() const { return _value.get(); }
+
+   /// Materialize the tensor
+   [[maybe_unused]] auto eval() -> evaluated_type {
+      if (!_value) {
+         if constexpr (shape_type::isStatic()) {
+            _value = std::make_shared<output_node_type>();
+         } else {
+            _value = std::make_shared<output_node_type>(_shape);
+         }
+         _sampler.fill(_value.get()->data(), _shape.size());
+      }
+      return evaluated_type(_value);
    }
-   return x;
+};
+
+/// \class RandomExpr
+/// Lazy random tensor, a leaf of expressions
+template <class Tensor>
+class RandomExpr : ::ten::Expr<RandomExpr<Tensor>> {
+ public:
+   using node_type = RandomNode<Tensor>;
+   using output_node_type = typename node_type::output_node_type;
+   using evaluated_type = Tensor;
+
+ private:
+   std::shared_ptr<node_type> _node;
+
+ public:
+   explicit RandomExpr(const std::shared_ptr<node_type> &node) noexcept
+       : _node(node) {}
+
+   [[nodiscard]] std::shared_ptr<node_type> node() const { return _node; }
+
+   [[nodiscard]] bool evaluated() const { return _node.get()->evaluated(); }
+
+   /// Materialize the random tensor
+   [[maybe_unused]] auto eval() -> evaluated_type {
+      return _node.get()->eval();
+   }
+};
+
+/// \fn lazyRand
+/// Random tensor generated by the expressions reading it
+/// The same seed gives the values of rand with the Philox engine.
+/// \code
+/// Matrix<float> b = a + lazyRand<Matrix<float>>({n, n}, seed);
+/// \endcode
+template <class T,
+          class Distribution = std::normal_distribution<typename T::value_type>>
+   requires(::ten::isDynamicTensor<T>::value &&
+            details::isPhiloxDistribution<Distribution>::value)
+auto lazyRand(std::initializer_list<size_t> &&dims, Distribution dist,
+              const std::optional<size_t> seed = std::nullopt) {
+   using shape_type = typename T::shape_type;
+   details::PhiloxSampler<typename T::value_type> sampler(
+       dist, details::randomSeed(seed));
+   return RandomExpr<T>(std::make_shared<RandomNode<T>>(
+       shape_type(std::move(dims)), sampler));
+}
+
+template <class T,
+          class Distribution = std::normal_distribution<typename T::value_type>>
+   requires(::ten::isDynamicTensor<T>::value &&
+            details::isPhiloxDistribution<Distribution>::value)
+auto lazyRand(std::initializer_list<size_t> &&dims,
+              const std::optional<size_t> seed = std::nullopt) {
+   return lazyRand<T, Distribution>(std::move(dims), Distribution(), seed);
 }
+
+namespace details {
+template <class Tensor> struct OutputNodeType<::ten::RandomNode<Tensor>> {
+   using type = typename ::ten::RandomNode<Tensor>::output_node_type;
+};
+
+// The functions that don't fuse the random node read the materialized tensor
+template <class Tensor> struct NodeWrapper<::ten::RandomNode<Tensor>> {
+   static auto shape(const std::shared_ptr<::ten::RandomNode<Tensor>> &node) {
+      return node.get()->shape();
+   }
+   static auto ptr(const std::shared_ptr<::ten::RandomNode<Tensor>> &node) {
+      if (!node.get()->evaluated()) {
+         node.get()->eval();
+      }
+      return node.get()->node().get();
+   }
+};
+
+template <class Tensor>
+struct isElementwiseNode<::ten::RandomNode<Tensor>> : std::true_type {};
+
+// Random leaf
+// The values are read at the linear index of a contiguous tensor of the shape
+// of the node, broadcasted dimensions being read with a zero stride.
+template <class Tensor, size_type Rank, StorageOrder Order>
+struct FusedEvaluator<::ten::RandomNode<Tensor>, Rank, Order> {
+   using node_type = ::ten::RandomNode<Tensor>;
+   using shape_type = typename node_type::shape_type;
+   using value_type = typename node_type::value_type;
+   static constexpr size_type pad = Rank - shape_type::rank();
+   static constexpr StorageOrder nodeOrder = Tensor::storageOrder();
+
+   const node_type *_node;
+   StridedRuns<Rank, Order> _runs;
+   bool _broadcast = false;
+
+   static std::array<size_type, Rank> paddedDims(const node_type &node) {
+      std::array<size_type, Rank> dims;
+      for (size_type i = 0; i < Rank; i++) {
+         dims[i] = i < pad ? 1 : node.shape().dim(i - pad);
+      }
+      return dims;
+   }
+
+   static std::array<size_type, Rank> paddedStrides(const node_type &node) {
+      constexpr size_type rank = shape_type::rank();
+      std::array<size_type, Rank> strides{};
+      size_type stride = 1;
+      for (size_type k = 0; k < rank; k++) {
+         size_type i = nodeOrder == StorageOrder::ColMajor ? k : rank - 1 - k;
+         strides[pad + i] = stride;
+         stride *= node.shape().dim(i);
+      }
+      return strides;
+   }
+
+   explicit FusedEvaluator(const node_type &node)
+       : _node(&node), _runs(paddedDims(node), paddedStrides(node)) {}
+
+   template <class S> void broadcastTo(const S &shape) {
+      static_assert(S::rank() == Rank, "Broadcast to a shape of another rank.");
+      auto dims = paddedDims(*_node);
+      auto strides = paddedStrides(*_node);
+      _broadcast = false;
+      for (size_type i = 0; i < Rank; i++) {
+         if (dims[i] != shape.dim(i)) {
+            dims[i] = shape.dim(i);
+            strides[i] = 0;
+            _broadcast = true;
+         }
+      }
+      _runs = StridedRuns<Rank, Order>(dims, strides);
+   }
+
+   const shape_type &shape() const { return _node->shape(); }
+
+   template <class Out> bool isAliasedWith(const Out &) const { return false; }
+
+   bool isContiguous() const {
+      return !_broadcast && (nodeOrder == Order || shape_type::rank() <= 1);
+   }
+
+   bool hasUnitInnerStride() const {
+      return _runs.innerStride() <= 1 || _runs.innerDim() <= 1;
+   }
+
+   template <class V> V load(size_type offset) const {
+      const auto &sampler = _node->sampler();
+      if constexpr (std::experimental::is_simd_v<V>) {
+         using T = typename V::value_type;
+         return V([&sampler, offset](auto k) {
+            return static_cast<T>(sampler.value(offset + k));
+         });
+      } else {
+         return static_cast<V>(sampler.value(offset));
+      }
+   }
+
+   template <class V> V load(size_type run, size_type index) const {
+      const size_type stride = _runs.innerStride();
+      const size_type position = _runs.position(run) + index * stride;
+      const auto &sampler = _node->sampler();
+      if constexpr (std::experimental::is_simd_v<V>) {
+         using T = typename V::value_type;
+         return V([&sampler, position, stride](auto k) {
+            return static_cast<T>(sampler.value(position + k * stride));
+         });
+      } else {
+         return static_cast<V>(sampler.value(position));
+      }
+   }
+};
+} // namespace details
+
 } // namespace ten
 
 #endif
@@ -1,12 +1,16 @@
 #ifndef TENSEUR_SHAPE_HXX
 #define TENSEUR_SHAPE_HXX
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <initializer_list>
 #include <iostream>
+#include <limits>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include <Ten/Types.hxx>
@@ -113,20 +117,15 @@ template <size_type First, size_type... Rest> class Shape {
       }
    }
 
-   // Construct of Ten::Shape from an array of dimensions
-   /*explicit Shape(const std::array<size_type, fRank>& dims) noexcept :
-     fDynamicDims(dims) {
-      fDynamicSize = 1;
-      for (size_type index = 0; index < fRank; index++)
-         fDynamicSize *= dims[index];
+   /// Construct a dynamic shape from an array of dimensions
+   explicit Shape(const std::array<size_type, _rank> &dims) noexcept
+      requires(_isDynamic)
+       : _dims(dims) {
+      _size = 1;
+      for (size_type index = 0; index < _rank; index++) {
+         _size *= dims[index];
+      }
    }
-   // Construct of Ten::Shape from an array
-   explicit Shape(std::array<size_type, fRank>&& dims) noexcept {
-      fDynamicSize = 1;
-      for (size_type index = 0; index < fRank; index++)
-         fDynamicSize *= dims[index];
-      fDynamicDims = std::move(dims);
-   }*/
 
    /// Returns the rank (number of dimensions)
    [[nodiscard]] inline static constexpr size_type rank() { return _rank; }
@@ -230,6 +229,136 @@ std::ostream &operator<<(std::ostream &os, const Shape<Ts...> &shape) {
 }
 
 namespace details {
+// Shape without the dimension at Axis
+template <size_type Axis, class S, class I> struct RemoveDim;
+template <size_type Axis, class S, size_t... I>
+struct RemoveDim<Axis, S, std::index_sequence<I...>> {
+   using type = ::ten::Shape<S::template staticDim<(I < Axis ? I : I + 1)>()...>;
+};
+
+template <size_type Axis, class S>
+   requires(Axis < S::rank() && S::rank() > 1)
+using remove_dim_t =
+    typename RemoveDim<Axis, S, std::make_index_sequence<S::rank() - 1>>::type;
+
+/// Returns the shape without the dimension at Axis
+template <size_type Axis, class S> auto removeDim(const S &shape) {
+   using shape_type = remove_dim_t<Axis, S>;
+   if constexpr (shape_type::isStatic()) {
+      return shape_type();
+   } else {
+      std::array<size_type, S::rank() - 1> dims;
+      for (size_type i = 0; i + 1 < S::rank(); i++) {
+         dims[i] = shape.dim(i < Axis ? i : i + 1);
+      }
+      return shape_type(dims);
+   }
+}
+
+// Shape with the order of the dimensions reversed
+template <class S, class I> struct ReverseShape;
+template <class S, size_t... I>
+struct ReverseShape<S, std::index_sequence<I...>> {
+   using type = ::ten::Shape<S::template staticDim<S::rank() - 1 - I>()...>;
+};
+
+template <class S>
+using reverse_shape_t =
+    typename ReverseShape<S, std::make_index_sequence<S::rank()>>::type;
+
+/// Returns the shape with the order of the dimensions reversed
+template <class S> auto reverseShape(const S &shape) {
+   using shape_type = reverse_shape_t<S>;
+   if constexpr (shape_type::isStatic()) {
+      return shape_type();
+   } else {
+      std::array<size_type, S::rank()> dims;
+      for (size_type i = 0; i < S::rank(); i++) {
+         dims[i] = shape.dim(S::rank() - 1 - i);
+      }
+      return shape_type(dims);
+   }
+}
+
+// Broadcasting of two shapes
+// The dimensions are aligned from the last one, a missing dimension or a
+// dimension equal to 1 is broadcasted to the dimension of the other shape.
+// The broadcasted shape is static when the dimensions of both shapes are
+// static, otherwise it's dynamic.
+template <class SA, class SB> struct BroadcastShape {
+   static constexpr size_type rank = std::max(SA::rank(), SB::rank());
+
+   // Static dimension of S padded to the rank with leading ones
+   template <class S, size_type I> static consteval size_type paddedDim() {
+      if constexpr (I < rank - S::rank()) {
+         return 1;
+      } else {
+         return S::template staticDim<I - (rank - S::rank())>();
+      }
+   }
+
+   template <size_type I> static consteval bool compatibleDim() {
+      constexpr size_type a = paddedDim<SA, I>();
+      constexpr size_type b = paddedDim<SB, I>();
+      return a == dynamic || b == dynamic || a == b || a == 1 || b == 1;
+   }
+
+   template <size_type I> static consteval size_type dim() {
+      constexpr size_type a = paddedDim<SA, I>();
+      constexpr size_type b = paddedDim<SB, I>();
+      if constexpr (a == dynamic || b == dynamic) {
+         return dynamic;
+      } else {
+         return a == 1 ? b : a;
+      }
+   }
+
+   template <size_t... I>
+   static consteval bool compatible(std::index_sequence<I...>) {
+      return (compatibleDim<I>() && ...);
+   }
+
+   template <size_t... I>
+   static auto staticShape(std::index_sequence<I...>) -> Shape<dim<I>()...>;
+
+   static constexpr bool value = compatible(std::make_index_sequence<rank>());
+
+   using static_type =
+       decltype(staticShape(std::make_index_sequence<rank>()));
+
+   using type = std::conditional_t<
+       std::is_same_v<SA, SB>, SA,
+       std::conditional_t<static_type::isStatic(), static_type,
+                          DynamicShape<rank>>>;
+};
+
+template <class SA, class SB>
+using broadcast_shape_t = typename BroadcastShape<SA, SB>::type;
+
+/// Returns the broadcasted shape of a and b
+/// Throws std::invalid_argument when the shapes are not compatible.
+template <class S, class SA, class SB>
+S broadcastShape(const SA &a, const SB &b) {
+   constexpr size_type rank = S::rank();
+   constexpr size_type padA = rank - SA::rank();
+   constexpr size_type padB = rank - SB::rank();
+   std::array<size_type, rank> dims;
+   for (size_type i = 0; i < rank; i++) {
+      size_type da = i < padA ? 1 : a.dim(i - padA);
+      size_type db = i < padB ? 1 : b.dim(i - padB);
+      if (da != db && da != 1 && db != 1) {
+         throw std::invalid_argument(
+             "Tenseur: Shapes of the operands can't be broadcasted.");
+      }
+      dims[i] = da == 1 ? db : da;
+   }
+   if constexpr (S::isStatic()) {
+      return S();
+   } else {
+      return S(dims);
+   }
+}
+
 // Compute the Nth static stride
 template <size_type N, class S> struct NthStaticStride {
    static constexpr size_type value =
@@ -239,19 +368,32 @@ template <class S> struct NthStaticStride<0, S> {
    static constexpr size_type value = 1;
 };
 
+// Compute the Nth static stride of a row major array
+template <size_type N, class S> consteval size_type nthStaticRowStride() {
+   if constexpr (N + 1 >= S::rank()) {
+      return 1;
+   } else {
+      return nthStaticRowStride<N + 1, S>() * S::template staticDim<N + 1>();
+   }
+}
+
 // Strides stored in an array
-template <class S, class I> struct StaticStrideArray;
+template <class S, StorageOrder order, class I> struct StaticStrideArray;
 template <class S, size_t... I>
-struct StaticStrideArray<S, std::index_sequence<I...>> {
+struct StaticStrideArray<S, StorageOrder::ColMajor, std::index_sequence<I...>> {
    static constexpr std::array<size_type, sizeof...(I)> value{
        NthStaticStride<I, S>::value...};
 };
+template <class S, size_t... I>
+struct StaticStrideArray<S, StorageOrder::RowMajor, std::index_sequence<I...>> {
+   static constexpr std::array<size_type, sizeof...(I)> value{
+       nthStaticRowStride<I, S>()...};
+};
 
 // Compute the static strides
 template <class S, StorageOrder order> consteval auto computeStaticStrides() {
-   if constexpr (order == StorageOrder::ColMajor) {
-      return StaticStrideArray<S, std::make_index_sequence<S::rank()>>::value;
-   }
+   return StaticStrideArray<S, order,
+                            std::make_index_sequence<S::rank()>>::value;
 }
 
 // Dynamic strides
@@ -297,6 +439,11 @@ template <class S, StorageOrder order> class Stride {
       requires(S::isDynamic())
        : _strides(details::computeStrides<S, order>(shape)) {}
 
+   /// Construct the strides of a view from an array of strides
+   explicit Stride(const std::array<size_type, S::rank()> &strides) noexcept
+      requires(S::isDynamic())
+       : _strides(strides) {}
+
    template <size_type Index> static constexpr size_type staticDim() {
       return _staticStrides[Index];
    }
@@ -311,7 +458,78 @@ template <class S, StorageOrder order> class Stride {
    friend std::ostream &operator<<(std::ostream &os, const Stride<S, R> &);
 };
 
+/// \class Slice
+/// Range of indices [first, last) of a dimension with a step
+/// The default slice selects the whole dimension, the last index is clamped to
+/// the dimension.
+class Slice {
+ private:
+   size_type _first = 0;
+   size_type _last = std::numeric_limits<size_type>::max();
+   size_type _step = 1;
+
+ public:
+   Slice() noexcept = default;
+
+   Slice(size_type first, size_type last, size_type step = 1) noexcept
+       : _first(first), _last(last), _step(step) {}
+
+   [[nodiscard]] size_type first() const { return _first; }
+   [[nodiscard]] size_type last() const { return _last; }
+   [[nodiscard]] size_type step() const { return _step; }
+};
+
 namespace details {
+// Traversal of a strided array by runs along its innermost dimension
+// The innermost dimension is the first one for column major arrays and the
+// last one for row major arrays. The runs are numbered in the storage order.
+template <size_type Rank, StorageOrder Order> class StridedRuns {
+ private:
+   std::array<size_type, Rank> _dims;
+   std::array<size_type, Rank> _strides;
+
+ public:
+   static constexpr size_type innerAxis =
+       Order == StorageOrder::ColMajor ? 0 : Rank - 1;
+
+   StridedRuns(const std::array<size_type, Rank> &dims,
+               const std::array<size_type, Rank> &strides) noexcept
+       : _dims(dims), _strides(strides) {}
+
+   /// Length of a run
+   [[nodiscard]] size_type innerDim() const { return _dims[innerAxis]; }
+
+   /// Distance between two consecutive elements of a run
+   [[nodiscard]] size_type innerStride() const { return _strides[innerAxis]; }
+
+   /// Offset of the first element of a run
+   [[nodiscard]] size_type position(size_type run) const {
+      size_type pos = 0;
+      if constexpr (Rank > 1) {
+         if constexpr (Order == StorageOrder::ColMajor) {
+            for (size_type k = 1; k + 1 < Rank; k++) {
+               pos += (run % _dims[k]) * _strides[k];
+               run /= _dims[k];
+            }
+            pos += run * _strides[Rank - 1];
+         } else {
+            for (size_type k = Rank - 2; k > 0; k--) {
+               pos += (run % _dims[k]) * _strides[k];
+               run /= _dims[k];
+            }
+            pos += run * _strides[0];
+         }
+      }
+      return pos;
+   }
+
+   /// Offset of the element at a linear index in the storage order
+   [[nodiscard]] size_type offset(size_type index) const {
+      size_type inner = innerDim();
+      return position(index / inner) + (index % inner) * innerStride();
+   }
+};
+
 template <size_type N, class S, StorageOrder order>
 void printStride(std::ostream &os, const Stride<S, order> &strides) {
    using stride_type = Stride<S, order>;
@@ -0,0 +1,235 @@
+/// \file Ten/Sparse.hxx
+
+#ifndef TENSEUR_SPARSE_HXX
+#define TENSEUR_SPARSE_HXX
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Storage/SparseStorage.hxx>
+#include <Ten/Tensor.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten {
+
+namespace details {
+// Storage of a sparse format
+template <class T, StorageFormat format, class Allocator>
+struct SparseStorageType {
+   using type = CompressedStorage<T, Allocator, format>;
+};
+template <class T, class Allocator>
+struct SparseStorageType<T, StorageFormat::SparseCoo, Allocator> {
+   using type = CooStorage<T, Allocator>;
+};
+} // namespace details
+
+/// \typedef SparseMatrix
+/// SparseMatrix<T, format>, a matrix in coordinate (SparseCoo), compressed
+/// sparse row (SparseCsr) or compressed sparse column (SparseCsc) format
+///
+/// Coordinate matrices are built by inserting elements in their storage and
+/// are converted to CSR or CSC by toSparse for the computations:
+/// \code
+/// SparseMatrix<float, StorageFormat::SparseCoo> coo(rows, cols);
+/// coo.storage()->insert(i, j, value);
+/// auto a = toSparse<StorageFormat::SparseCsr>(coo);
+/// Vector<float> y = a * x;
+/// \endcode
+template <class T, StorageFormat format = StorageFormat::SparseCsr,
+          class Allocator = DefaultAllocator<T>>
+using SparseMatrix = RankedTensor<
+    T, DynamicShape<2>, defaultOrder,
+    typename details::SparseStorageType<T, format, Allocator>::type, Allocator>;
+
+namespace details {
+// Elements of a matrix as (row, column, value) triplets
+template <class T> struct Triplets {
+   std::vector<size_type> rows;
+   std::vector<size_type> cols;
+   std::vector<T> values;
+
+   void push(size_type i, size_type j, const T &value) {
+      rows.push_back(i);
+      cols.push_back(j);
+      values.push_back(value);
+   }
+};
+
+// Check the coordinates of a stored element against the shape
+inline void checkIndices(size_type i, size_type j, size_type rows,
+                         size_type cols) {
+   if (i >= rows || j >= cols) {
+      throw std::out_of_range(
+          "Tenseur: Sparse element index out of the matrix shape.");
+   }
+}
+
+// Nonzero elements of a dense, coordinate or compressed matrix
+template <class T, class M> Triplets<T> triplets(const M &a) {
+   using storage_type = typename M::storage_type;
+   Triplets<T> t;
+   if constexpr (::ten::isDenseStorage<storage_type>::value) {
+      for (size_type j = 0; j < a.dim(1); j++) {
+         for (size_type i = 0; i < a.dim(0); i++) {
+            if (a(i, j) != typename M::value_type(0)) {
+               t.push(i, j, static_cast<T>(a(i, j)));
+            }
+         }
+      }
+   } else if constexpr (::ten::isCooStorage<storage_type>::value) {
+      const auto &s = *a.storage();
+      for (size_type k = 0; k < s.nnz(); k++) {
+         checkIndices(s.rowIndices()[k], s.colIndices()[k], a.dim(0),
+                      a.dim(1));
+         t.push(s.rowIndices()[k], s.colIndices()[k],
+                static_cast<T>(s.values()[k]));
+      }
+   } else {
+      const auto &s = *a.storage();
+      if (s.empty()) {
+         return t;
+      }
+      const size_type numOuter =
+          storage_type::isRowMajor() ? a.dim(0) : a.dim(1);
+      for (size_type i = 0; i < numOuter; i++) {
+         for (size_type k = s.outerIndices()[i]; k < s.outerIndices()[i + 1];
+              k++) {
+            size_type j = s.innerIndices()[k];
+            if constexpr (storage_type::isRowMajor()) {
+               t.push(i, j, static_cast<T>(s.values()[k]));
+            } else {
+               t.push(j, i, static_cast<T>(s.values()[k]));
+            }
+         }
+      }
+   }
+   return t;
+}
+
+// Compressed storage of triplets
+// The triplets are sorted by outer then inner index with a counting sort by
+// outer index, the duplicated elements are summed.
+template <class Storage, class T>
+std::shared_ptr<Storage> compress(const Triplets<T> &t, size_type rows,
+                                  size_type cols) {
+   using allocator_type = typename Storage::allocator_type;
+   constexpr bool rowMajor = Storage::isRowMajor();
+   const size_type numOuter = rowMajor ? rows : cols;
+   const std::vector<size_type> &outerOf = rowMajor ? t.rows : t.cols;
+   const std::vector<size_type> &innerOf = rowMajor ? t.cols : t.rows;
+   std::vector<size_type> counts(numOuter + 1, 0);
+   for (size_type k = 0; k < t.values.size(); k++) {
+      checkIndices(t.rows[k], t.cols[k], rows, cols);
+      counts[outerOf[k] + 1]++;
+   }
+   std::partial_sum(counts.begin(), counts.end(), counts.begin());
+   std::vector<size_type> order(t.values.size());
+   {
+      std::vector<size_type> next(counts.begin(), counts.end() - 1);
+      for (size_type k = 0; k < t.values.size(); k++) {
+         order[next[outerOf[k]]++] = k;
+      }
+   }
+   std::vector<size_type> outer(numOuter + 1, 0);
+   std::vector<size_type> inner;
+   std::vector<typename Storage::value_type, allocator_type> values;
+   inner.reserve(t.values.size());
+   values.reserve(t.values.size());
+   for (size_type i = 0; i < numOuter; i++) {
+      auto first = order.begin() + counts[i];
+      auto last = order.begin() + counts[i + 1];
+      std::stable_sort(first, last, [&](size_type x, size_type y) {
+         return innerOf[x] < innerOf[y];
+      });
+      for (auto it = first; it != last; ++it) {
+         if (inner.size() > outer[i] && inner.back() == innerOf[*it]) {
+            values.back() += t.values[*it];
+         } else {
+            inner.push_back(innerOf[*it]);
+            values.push_back(t.values[*it]);
+         }
+      }
+      outer[i + 1] = inner.size();
+   }
+   return std::make_shared<Storage>(std::move(outer), std::move(inner),
+                                    std::move(values));
+}
+} // namespace details
+
+/// \fn toSparse
+/// Convert a dense or sparse matrix to a sparse matrix of the given format
+/// The zeros of dense matrices aren't stored. The duplicated elements of
+/// coordinate matrices are summed by the conversion to CSR or CSC.
+template <StorageFormat format, class M>
+   requires(::ten::isTensor<M>::value && M::isMatrix() && M::isDynamic())
+[[nodiscard]] auto toSparse(const M &a) {
+   using value_type = typename M::value_type;
+   using result_type = SparseMatrix<value_type, format>;
+   using storage_type = typename result_type::storage_type;
+   using node_type = typename result_type::node_type;
+   auto t = details::triplets<value_type>(a);
+   const DynamicShape<2> shape({a.dim(0), a.dim(1)});
+   if constexpr (format == StorageFormat::SparseCoo) {
+      auto storage = std::make_shared<storage_type>();
+      storage->reserve(t.values.size());
+      for (size_type k = 0; k < t.values.size(); k++) {
+         storage->insert(t.rows[k], t.cols[k], t.values[k]);
+      }
+      return result_type(std::make_shared<node_type>(storage, shape));
+   } else {
+      auto storage =
+          details::compress<storage_type>(t, a.dim(0), a.dim(1));
+      return result_type(std::make_shared<node_type>(storage, shape));
+   }
+}
+
+/// \fn toDense
+/// Convert a sparse matrix to a dense matrix
+template <StorageOrder order = defaultOrder, class M>
+   requires(::ten::isSparseTensor<M>::value)
+[[nodiscard]] auto toDense(const M &a) {
+   using value_type = typename M::value_type;
+   using storage_type = typename M::storage_type;
+   Matrix<value_type, DynamicShape<2>, order> d({a.dim(0), a.dim(1)});
+   std::fill_n(d.data(), d.size(), value_type(0));
+   const auto &s = *a.storage();
+   if constexpr (::ten::isCooStorage<storage_type>::value) {
+      for (size_type k = 0; k < s.nnz(); k++) {
+         details::checkIndices(s.rowIndices()[k], s.colIndices()[k],
+                               a.dim(0), a.dim(1));
+         d(s.rowIndices()[k], s.colIndices()[k]) += s.values()[k];
+      }
+   } else {
+      if (s.empty()) {
+         return d;
+      }
+      const size_type numOuter =
+          storage_type::isRowMajor() ? a.dim(0) : a.dim(1);
+      ::ten::parallel::parallelFor(
+          0, numOuter, 64,
+          [&](size_type first, size_type last) {
+             for (size_type i = first; i < last; i++) {
+                for (size_type k = s.outerIndices()[i];
+                     k < s.outerIndices()[i + 1]; k++) {
+                   size_type j = s.innerIndices()[k];
+                   if constexpr (storage_type::isRowMajor()) {
+                      d(i, j) = s.values()[k];
+                   } else {
+                      d(j, i) = s.values()[k];
+                   }
+                }
+             }
+          },
+          std::max<size_type>(1, s.nnz() / std::max<size_type>(1, numOuter)));
+   }
+   return d;
+}
+
+} // namespace ten
+
+#endif
@@ -0,0 +1,396 @@
+/// \file Ten/Stack.hxx
+
+#ifndef TENSEUR_STACK_HXX
+#define TENSEUR_STACK_HXX
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <Ten/Kernels/BinaryOps.hxx>
+#include <Ten/Kernels/Simd.hxx>
+#include <Ten/Kernels/StaticMul.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten::stack {
+
+/// Returns whether the tensors of value type T, shape Shape and storage
+/// Storage are stored inline
+/// The static tensors of at most maxStackSize bytes hold their elements and
+/// their node by value, they are copied by value and don't allocate.
+template <class T, class Shape, class Storage>
+inline constexpr bool isInline = enableStackAlloc &&
+                                 ::ten::isStaticStorage<Storage>::value &&
+                                 sizeof(T) * Shape::staticSize() <=
+                                     maxStackSize;
+
+// Tensor stored inline
+template <class> struct isInlineTensor : std::false_type {};
+template <class T, class Shape, StorageOrder Order, class Storage,
+          class Allocator>
+struct isInlineTensor<RankedTensor<T, Shape, Order, Storage, Allocator>>
+    : std::bool_constant<isInline<T, Shape, Storage>> {};
+
+// Node stored inline
+template <class> struct isInlineNode : std::false_type {};
+template <class T, class Shape, StorageOrder Order, class Storage,
+          class Allocator>
+struct isInlineNode<TensorNode<T, Shape, Order, Storage, Allocator>>
+    : std::bool_constant<isInline<T, Shape, Storage>> {};
+
+template <::ten::BinaryOperation kind, class Left, class Right>
+class BinaryExpr;
+
+template <class Left, class Right> class MulExpr;
+
+// Matrix product held by value
+template <class> struct isMulExpr : std::false_type {};
+template <class Left, class Right>
+struct isMulExpr<MulExpr<Left, Right>> : std::true_type {};
+
+// Expression held by value
+template <class> struct isValueExpr : std::false_type {};
+template <::ten::BinaryOperation kind, class Left, class Right>
+struct isValueExpr<BinaryExpr<kind, Left, Right>> : std::true_type {};
+template <class Left, class Right>
+struct isValueExpr<MulExpr<Left, Right>> : std::true_type {};
+
+/// \concept ValueOperand
+/// Tensor stored inline or expression held by value
+template <class E>
+concept ValueOperand = isInlineTensor<E>::value || isValueExpr<E>::value;
+
+/// \concept ValueOperation
+/// Elementwise operation evaluated by value, between two operands of the same
+/// static shape and storage order
+/// The product of two matrices is a matrix product, it isn't elementwise.
+template <::ten::BinaryOperation kind, class L, class R>
+concept ValueOperation =
+    ValueOperand<L> && ValueOperand<R> &&
+    std::is_same_v<typename L::shape_type, typename R::shape_type> &&
+    L::storageOrder() == R::storageOrder() &&
+    (kind != ::ten::BinaryOperation::mul || L::rank() != 2);
+
+/// \concept ValueProduct
+/// Product of a matrix by a matrix or a vector evaluated by value, unrolled at
+/// compile time
+/// The operands have the same value type and the product is small enough to
+/// be unrolled, see kernels::isUnrolledGemm.
+template <class L, class R>
+concept ValueProduct =
+    ValueOperand<L> && ValueOperand<R> && L::rank() == 2 &&
+    (R::rank() == 1 || R::rank() == 2) &&
+    std::is_same_v<typename L::value_type, typename R::value_type> &&
+    L::shape_type::template staticDim<1>() ==
+        R::shape_type::template staticDim<0>() &&
+    ::ten::kernels::isUnrolledGemm<
+        typename L::value_type, L::shape_type::template staticDim<0>(),
+        (R::rank() == 2 ? R::shape_type::template staticDim<1>() : 1),
+        L::shape_type::template staticDim<1>(),
+        (R::rank() == 2 ? L::storageOrder() : StorageOrder::ColMajor)>();
+
+/// \concept ScalarOperation
+/// Elementwise operation between a scalar and a value operand
+template <class T, class E>
+concept ScalarOperation = std::is_arithmetic_v<T> && ValueOperand<E>;
+
+namespace details {
+// Operand held by an expression
+// Scalars and temporaries are held by value, lvalues by reference. Matrix
+// products are evaluated once, into a tensor held by the expression.
+template <class E> struct OperandType {
+   using type = std::conditional_t<
+       std::is_lvalue_reference_v<E> &&
+           !std::is_arithmetic_v<std::remove_cvref_t<E>>,
+       const std::remove_cvref_t<E> &, std::remove_cvref_t<E>>;
+};
+template <class E>
+   requires isMulExpr<std::remove_cvref_t<E>>::value
+struct OperandType<E> {
+   using type = typename std::remove_cvref_t<E>::tensor_type;
+};
+template <class E> using Operand = typename OperandType<E>::type;
+
+// Value type of an operand
+template <class E> struct ValueType {
+   using type = typename E::value_type;
+};
+template <class E>
+   requires std::is_arithmetic_v<E>
+struct ValueType<E> {
+   using type = E;
+};
+
+// Returns the element at index of an operand
+template <class E> inline auto load(const E &x, size_type index) {
+   if constexpr (std::is_arithmetic_v<E>) {
+      return x;
+   } else if constexpr (isInlineTensor<E>::value) {
+      return x.data()[index];
+   } else {
+      return x[index];
+   }
+}
+
+// Returns whether the operand can be loaded in simd vectors of value type T
+template <class E, class T> constexpr bool isPackable() {
+   if constexpr (std::is_arithmetic_v<E>) {
+      return true;
+   } else if constexpr (isInlineTensor<E>::value) {
+      return std::is_same_v<typename E::value_type, T>;
+   } else {
+      return std::is_same_v<typename E::value_type, T> && E::packable;
+   }
+}
+
+// Returns the simd vector V of an operand starting at offset
+template <class V, class E> inline V loadPack(const E &x, size_type offset) {
+   if constexpr (std::is_arithmetic_v<E>) {
+      return V(static_cast<typename V::value_type>(x));
+   } else if constexpr (isInlineTensor<E>::value) {
+      return V(x.data() + offset, std::experimental::element_aligned);
+   } else {
+      return x.template pack<V>(offset);
+   }
+}
+
+// Returns a tensor operand, or the evaluated expression
+template <class E> inline decltype(auto) evaluated(const E &x) {
+   if constexpr (isInlineTensor<E>::value) {
+      return (x);
+   } else {
+      return x.eval();
+   }
+}
+} // namespace details
+
+/// \class BinaryExpr
+/// Elementwise operation on tensors stored inline, held by value
+///
+/// The operands are tensors stored inline, expressions held by value or
+/// scalars. The whole expression lives on the stack and is evaluated when it
+/// is assigned to a tensor, by a loop over the elements unrolled at compile
+/// time. Operands passed as lvalues are held by reference and must outlive
+/// the expression, temporaries are moved into it.
+/// \code
+/// SMatrix<float, 3, 3> a, b;
+/// SMatrix<float, 3, 3> c = a + 2.f * b;
+/// \endcode
+template <::ten::BinaryOperation kind, class Left, class Right>
+class BinaryExpr : ::ten::Expr<BinaryExpr<kind, Left, Right>> {
+ private:
+   using left_type = std::remove_cvref_t<Left>;
+   using right_type = std::remove_cvref_t<Right>;
+   /// Tensor operand giving the shape and the storage order
+   using operand_type =
+       std::conditional_t<std::is_arithmetic_v<left_type>, right_type,
+                          left_type>;
+
+ public:
+   using value_type =
+       std::common_type_t<typename details::ValueType<left_type>::type,
+                          typename details::ValueType<right_type>::type>;
+   using shape_type = typename operand_type::shape_type;
+
+   /// \typedef tensor_type
+   /// Type of the evaluated expression
+   using tensor_type =
+       RankedTensor<value_type, shape_type, operand_type::storageOrder(),
+                    ::ten::StaticDenseStorage<value_type, shape_type>, void>;
+
+   /// \typedef node_type
+   /// Node of the evaluated expression, when the expression is the operand
+   /// of an expression of nodes
+   using node_type = typename tensor_type::node_type;
+
+   /// Whether the expression is evaluated in simd vectors
+   static constexpr bool packable =
+       ::ten::isVectorizable<value_type>::value &&
+       details::isPackable<left_type, value_type>() &&
+       details::isPackable<right_type, value_type>();
+
+ private:
+   Left _left;
+   Right _right;
+
+ public:
+   template <class L, class R>
+   BinaryExpr(L &&left, R &&right)
+       : _left(std::forward<L>(left)), _right(std::forward<R>(right)) {}
+
+   [[nodiscard]] static constexpr StorageOrder storageOrder() {
+      return operand_type::storageOrder();
+   }
+
+   [[nodiscard]] static constexpr size_type rank() {
+      return shape_type::rank();
+   }
+
+   [[nodiscard]] static constexpr size_type size() {
+      return shape_type::staticSize();
+   }
+
+   /// Returns the element at a linear index
+   [[nodiscard]] inline value_type operator[](size_type index) const {
+      return ::ten::kernels::binaryOp<kind>(
+          static_cast<value_type>(details::load(_left, index)),
+          static_cast<value_type>(details::load(_right, index)));
+   }
+
+   /// Returns the simd vector V of the elements starting at offset
+   template <class V> [[nodiscard]] inline V pack(size_type offset) const {
+      return ::ten::kernels::binaryOp<kind>(
+          details::loadPack<V>(_left, offset),
+          details::loadPack<V>(_right, offset));
+   }
+
+   /// Evaluate the expression into the elements of a contiguous tensor
+   /// The elements are computed in simd vectors of the native width followed
+   /// by a scalar tail, all of them unrolled at compile time.
+   template <class U> inline void evalTo(U *data) const {
+      constexpr size_type tail = [] {
+         if constexpr (packable && std::is_same_v<U, value_type>) {
+            return size() % ::ten::kernels::simd_type<value_type>::size();
+         } else {
+            return size();
+         }
+      }();
+      constexpr size_type head = size() - tail;
+      if constexpr (head > 0) {
+         using V = ::ten::kernels::simd_type<value_type>;
+         [&]<size_type... index>(std::index_sequence<index...>) {
+            (pack<V>(index * V::size())
+                 .copy_to(data + index * V::size(),
+                          std::experimental::element_aligned),
+             ...);
+         }(std::make_index_sequence<head / V::size()>{});
+      }
+      [&]<size_type... index>(std::index_sequence<index...>) {
+         ((data[head + index] = static_cast<U>((*this)[head + index])), ...);
+      }(std::make_index_sequence<tail>{});
+   }
+
+   /// Evaluate the expression
+   [[nodiscard]] tensor_type eval() const {
+      tensor_type x;
+      evalTo(x.data());
+      return x;
+   }
+
+   /// Returns the node of the evaluated expression
+   [[nodiscard]] std::shared_ptr<node_type> node() const {
+      return eval().node();
+   }
+};
+
+/// \class MulExpr
+/// Product of a matrix by a matrix or a vector of static shapes, held by value
+///
+/// The product is unrolled at compile time by kernels::staticGemm into a
+/// temporary on the stack, it may be assigned to one of its operands.
+/// Operands that are expressions are evaluated first.
+/// \code
+/// SMatrix<float, 4, 4> a, b;
+/// SVector<float, 4> x;
+/// SVector<float, 4> y = a * b * x;
+/// \endcode
+template <class Left, class Right>
+class MulExpr : ::ten::Expr<MulExpr<Left, Right>> {
+ private:
+   using left_type = std::remove_cvref_t<Left>;
+   using right_type = std::remove_cvref_t<Right>;
+
+   static constexpr size_type m = left_type::shape_type::template staticDim<0>();
+   static constexpr size_type k = left_type::shape_type::template staticDim<1>();
+   static constexpr bool isMatrix = right_type::rank() == 2;
+   static constexpr size_type n =
+       isMatrix ? right_type::shape_type::template staticDim<1>() : 1;
+
+ public:
+   using value_type = typename left_type::value_type;
+   using shape_type =
+       std::conditional_t<isMatrix, ::ten::Shape<m, n>, ::ten::Shape<m>>;
+
+   /// \typedef tensor_type
+   /// Type of the evaluated expression, of the storage order of the left
+   /// matrix for a matrix product and of the vector otherwise
+   using tensor_type =
+       RankedTensor<value_type, shape_type,
+                    isMatrix ? left_type::storageOrder()
+                             : right_type::storageOrder(),
+                    ::ten::StaticDenseStorage<value_type, shape_type>, void>;
+
+   /// \typedef node_type
+   /// Node of the evaluated expression
+   using node_type = typename tensor_type::node_type;
+
+ private:
+   Left _left;
+   Right _right;
+
+ public:
+   template <class L, class R>
+   MulExpr(L &&left, R &&right)
+       : _left(std::forward<L>(left)), _right(std::forward<R>(right)) {}
+
+   [[nodiscard]] static constexpr StorageOrder storageOrder() {
+      return tensor_type::storageOrder();
+   }
+
+   [[nodiscard]] static constexpr size_type rank() {
+      return shape_type::rank();
+   }
+
+   [[nodiscard]] static constexpr size_type size() {
+      return shape_type::staticSize();
+   }
+
+   /// Evaluate the product into the elements of a contiguous tensor
+   template <class U> inline void evalTo(U *data) const {
+      const auto &a = details::evaluated(_left);
+      const auto &b = details::evaluated(_right);
+      std::array<value_type, size()> c;
+      if constexpr (isMatrix) {
+         ::ten::kernels::staticGemm<m, n, k, left_type::storageOrder(),
+                                    right_type::storageOrder(),
+                                    storageOrder()>(a.data(), b.data(),
+                                                    c.data());
+      } else {
+         ::ten::kernels::staticGemv<m, k, left_type::storageOrder()>(
+             a.data(), b.data(), c.data());
+      }
+      for (size_type i = 0; i < size(); i++) {
+         data[i] = static_cast<U>(c[i]);
+      }
+   }
+
+   /// Evaluate the expression
+   [[nodiscard]] tensor_type eval() const {
+      tensor_type x;
+      evalTo(x.data());
+      return x;
+   }
+
+   /// Returns the node of the evaluated expression
+   [[nodiscard]] std::shared_ptr<node_type> node() const {
+      return eval().node();
+   }
+};
+
+/// Returns the matrix product held by value
+template <class L, class R> [[nodiscard]] auto makeMul(L &&left, R &&right) {
+   return MulExpr<details::Operand<L>, details::Operand<R>>(
+       std::forward<L>(left), std::forward<R>(right));
+}
+
+/// Returns the expression held by value of an elementwise operation
+template <::ten::BinaryOperation kind, class L, class R>
+[[nodiscard]] auto makeExpr(L &&left, R &&right) {
+   return BinaryExpr<kind, details::Operand<L>, details::Operand<R>>(
+       std::forward<L>(left), std::forward<R>(right));
+}
+
+} // namespace ten::stack
+
+#endif
@@ -0,0 +1,261 @@
+/// \file Ten/Storage/Allocator.hxx
+
+#ifndef TENSEUR_STORAGE_ALLOCATOR_HXX
+#define TENSEUR_STORAGE_ALLOCATOR_HXX
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Maximum number of bytes cached by each thread in the pool allocator
+#ifndef TENSEUR_POOL_MAX_CACHED_BYTES
+#define TENSEUR_POOL_MAX_CACHED_BYTES (std::size_t(1) << 28)
+#endif
+
+namespace ten {
+
+/// \class AlignedAllocator
+/// Allocator of memory aligned to Alignment bytes
+template <class T, std::size_t Alignment = 64> class AlignedAllocator {
+   static_assert(std::has_single_bit(Alignment),
+                 "Alignment must be a power of two");
+
+ public:
+   using value_type = T;
+
+   /// Alignment of the allocated memory in bytes
+   static constexpr std::size_t alignment =
+       Alignment > alignof(T) ? Alignment : alignof(T);
+
+   template <class U> struct rebind {
+      using other = AlignedAllocator<U, Alignment>;
+   };
+
+   AlignedAllocator() noexcept = default;
+
+   template <class U>
+   AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+   [[nodiscard]] T *allocate(std::size_t n) {
+      if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+         throw std::bad_array_new_length();
+      }
+      return static_cast<T *>(
+          ::operator new(n * sizeof(T), std::align_val_t(alignment)));
+   }
+
+   void deallocate(T *ptr, std::size_t) noexcept {
+      ::operator delete(ptr, std::align_val_t(alignment));
+   }
+
+   template <class U>
+   bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+      return true;
+   }
+};
+
+/// \struct PoolStats
+/// Counters of the pool allocator
+struct PoolStats {
+   /// Number of allocations served from a cached buffer
+   std::size_t hits = 0;
+   /// Number of allocations that allocated a new buffer
+   std::size_t misses = 0;
+};
+
+namespace details {
+// Number of size classes per power of two
+static constexpr std::size_t poolSubClasses = 4;
+// Size of the smallest size class in bytes
+static constexpr std::size_t poolMinSize = 64;
+// Number of size classes
+static constexpr std::size_t poolNumClasses =
+    poolSubClasses * std::numeric_limits<std::size_t>::digits + 1;
+
+// Returns the index of the size class of a buffer of bytes bytes and the size
+// of the class in bytes. The classes are spaced by a quarter of a power of
+// two, so that a buffer wastes at most a fifth of its size.
+inline std::pair<std::size_t, std::size_t> poolSizeClass(std::size_t bytes) {
+   if (bytes <= poolMinSize) {
+      return {0, poolMinSize};
+   }
+   std::size_t power = std::bit_width(bytes - 1) - 1;
+   std::size_t base = std::size_t(1) << power;
+   std::size_t step = base / poolSubClasses;
+   std::size_t sub = (bytes - base + step - 1) / step;
+   std::size_t index =
+       (power - std::bit_width(poolMinSize) + 1) * poolSubClasses + sub;
+   return {index, base + sub * step};
+}
+
+inline std::atomic<std::size_t> &poolHits() {
+   static std::atomic<std::size_t> hits(0);
+   return hits;
+}
+
+inline std::atomic<std::size_t> &poolMisses() {
+   static std::atomic<std::size_t> misses(0);
+   return misses;
+}
+
+// Free lists of a thread, by size class
+// The cached buffers are freed when the thread exits.
+template <std::size_t Alignment> class PoolCache {
+ private:
+   std::array<std::vector<void *>, poolNumClasses> _free;
+   std::size_t _bytes = 0;
+
+   // Set when the cache of the thread has been destroyed, buffers freed later
+   // (by thread local or static tensors) bypass the cache
+   static inline thread_local bool _destroyed = false;
+
+ public:
+   PoolCache() = default;
+   PoolCache(const PoolCache &) = delete;
+   PoolCache &operator=(const PoolCache &) = delete;
+
+   ~PoolCache() {
+      release();
+      _destroyed = true;
+   }
+
+   static bool destroyed() { return _destroyed; }
+
+   void *allocate(std::size_t bytes) {
+      auto [index, size] = poolSizeClass(bytes);
+      auto &list = _free[index];
+      if (!list.empty()) {
+         void *ptr = list.back();
+         list.pop_back();
+         _bytes -= size;
+         poolHits().fetch_add(1, std::memory_order_relaxed);
+         return ptr;
+      }
+      poolMisses().fetch_add(1, std::memory_order_relaxed);
+      return ::operator new(size, std::align_val_t(Alignment));
+   }
+
+   void deallocate(void *ptr, std::size_t bytes) noexcept {
+      auto [index, size] = poolSizeClass(bytes);
+      if (_bytes + size <= TENSEUR_POOL_MAX_CACHED_BYTES) {
+         try {
+            _free[index].push_back(ptr);
+            _bytes += size;
+            return;
+         } catch (...) {
+         }
+      }
+      ::operator delete(ptr, std::align_val_t(Alignment));
+   }
+
+   // Free the cached buffers
+   void release() noexcept {
+      for (auto &list : _free) {
+         for (void *ptr : list) {
+            ::operator delete(ptr, std::align_val_t(Alignment));
+         }
+         list.clear();
+      }
+      _bytes = 0;
+   }
+
+   // Number of cached bytes
+   std::size_t cachedBytes() const { return _bytes; }
+};
+
+template <std::size_t Alignment> PoolCache<Alignment> &poolCache() {
+   thread_local PoolCache<Alignment> cache;
+   return cache;
+}
+
+template <std::size_t Alignment> void *poolAllocate(std::size_t bytes) {
+   if (PoolCache<Alignment>::destroyed()) {
+      poolMisses().fetch_add(1, std::memory_order_relaxed);
+      return ::operator new(poolSizeClass(bytes).second,
+                            std::align_val_t(Alignment));
+   }
+   return poolCache<Alignment>().allocate(bytes);
+}
+
+template <std::size_t Alignment>
+void poolDeallocate(void *ptr, std::size_t bytes) noexcept {
+   if (PoolCache<Alignment>::destroyed()) {
+      ::operator delete(ptr, std::align_val_t(Alignment));
+   } else {
+      poolCache<Alignment>().deallocate(ptr, bytes);
+   }
+}
+} // namespace details
+
+/// \class PoolAllocator
+/// Allocator caching the freed buffers in thread local free lists by size
+/// class, so that the next allocation of the same size class on the thread
+/// reuses them. Buffers are aligned to Alignment bytes. Each thread caches at
+/// most TENSEUR_POOL_MAX_CACHED_BYTES bytes, larger amounts are freed.
+template <class T, std::size_t Alignment = 64> class PoolAllocator {
+   static_assert(std::has_single_bit(Alignment),
+                 "Alignment must be a power of two");
+
+ public:
+   using value_type = T;
+
+   /// Alignment of the allocated memory in bytes
+   static constexpr std::size_t alignment =
+       Alignment > alignof(T) ? Alignment : alignof(T);
+
+   template <class U> struct rebind {
+      using other = PoolAllocator<U, Alignment>;
+   };
+
+   PoolAllocator() noexcept = default;
+
+   template <class U>
+   PoolAllocator(const PoolAllocator<U, Alignment> &) noexcept {}
+
+   [[nodiscard]] T *allocate(std::size_t n) {
+      if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+         throw std::bad_array_new_length();
+      }
+      return static_cast<T *>(details::poolAllocate<alignment>(n * sizeof(T)));
+   }
+
+   void deallocate(T *ptr, std::size_t n) noexcept {
+      details::poolDeallocate<alignment>(ptr, n * sizeof(T));
+   }
+
+   /// Free the buffers cached by the calling thread
+   static void release() noexcept { details::poolCache<alignment>().release(); }
+
+   /// Returns the number of bytes cached by the calling thread
+   [[nodiscard]] static std::size_t cachedBytes() {
+      return details::poolCache<alignment>().cachedBytes();
+   }
+
+   template <class U>
+   bool operator==(const PoolAllocator<U, Alignment> &) const noexcept {
+      return true;
+   }
+};
+
+/// \fn poolStats
+/// Returns the hit and miss counters of the pool allocators
+[[nodiscard]] inline PoolStats poolStats() {
+   return PoolStats{details::poolHits().load(std::memory_order_relaxed),
+                    details::poolMisses().load(std::memory_order_relaxed)};
+}
+
+/// \fn resetPoolStats
+/// Reset the counters of the pool allocators
+inline void resetPoolStats() {
+   details::poolHits().store(0, std::memory_order_relaxed);
+   details::poolMisses().store(0, std::memory_order_relaxed);
+}
+
+} // namespace ten
+
+#endif
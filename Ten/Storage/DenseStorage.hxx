@@ -10,31 +10,49 @@
 namespace ten {
 /// \class DenseStorage
 /// Dense array
+/// The array is allocated by the allocator, or is memory owned by another
+/// object such as a memory mapped file, kept alive by the storage.
 template <typename T, typename Allocator> class DenseStorage final {
  public:
    using value_type = T;
    using allocator_type = Allocator;
    using allocator_traits = std::allocator_traits<Allocator>;
 
-   template <class To> using casted_type = DenseStorage<To, Allocator>;
+   template <class To>
+   using casted_type =
+       DenseStorage<To, typename allocator_traits::template rebind_alloc<To>>;
 
  private:
    allocator_type _allocator{};
    size_type _size = 0;
    T *_data = nullptr;
+   /// Owner of external memory, the data isn't deallocated when set
+   std::shared_ptr<void> _owner = nullptr;
 
  public:
    DenseStorage() noexcept {}
 
-   DenseStorage(size_type size) noexcept
-       : _size(size),
-         _data(allocator_traits::allocate(_allocator, size * sizeof(T))) {}
+   DenseStorage(size_type size)
+       : _size(size), _data(allocator_traits::allocate(_allocator, size)) {}
+
+   /// Construct a storage of size elements over external memory kept alive by
+   /// owner
+   DenseStorage(T *data, size_type size, std::shared_ptr<void> owner) noexcept
+       : _size(size), _data(data), _owner(std::move(owner)) {}
+
+   DenseStorage(const DenseStorage &) = delete;
+   DenseStorage &operator=(const DenseStorage &) = delete;
 
    ~DenseStorage() {
-      if (_data)
-         delete[] _data;
+      if (_data && !_owner)
+         allocator_traits::deallocate(_allocator, _data, _size);
    }
 
+   /// Returns whether the data is external memory
+   [[nodiscard]] bool isExternal() const { return _owner != nullptr; }
+
+   [[nodiscard]] size_type size() const { return _size; }
+
    [[nodiscard]] inline const T *data() const { return _data; }
 
    [[nodiscard]] inline T *data() { return _data; }
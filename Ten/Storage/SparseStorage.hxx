@@ -0,0 +1,147 @@
+#ifndef TENSEUR_STORAGE_SPARSE_HXX
+#define TENSEUR_STORAGE_SPARSE_HXX
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Types.hxx>
+
+namespace ten {
+/// \class CooStorage
+/// Sparse coordinate storage of a matrix
+/// The nonzero elements are appended in any order with insert(), the
+/// duplicated coordinates are summed by the conversion to a compressed
+/// storage. The dimensions are given by the shape of the tensor, the indices
+/// are checked against it by the conversions.
+template <typename T, typename Allocator> class CooStorage final {
+ public:
+   using value_type = T;
+   using allocator_type = Allocator;
+   using allocator_traits = std::allocator_traits<Allocator>;
+
+   template <class To>
+   using casted_type =
+       CooStorage<To, typename allocator_traits::template rebind_alloc<To>>;
+
+ private:
+   std::vector<size_type> _rows;
+   std::vector<size_type> _cols;
+   std::vector<T, Allocator> _values;
+
+ public:
+   CooStorage() noexcept {}
+
+   /// Construct an empty storage, the size of the dense tensor is ignored
+   explicit CooStorage(size_type) noexcept {}
+
+   CooStorage(const CooStorage &) = delete;
+   CooStorage &operator=(const CooStorage &) = delete;
+
+   /// Append the element (row, col)
+   void insert(size_type row, size_type col, const T &value) {
+      _rows.push_back(row);
+      _cols.push_back(col);
+      _values.push_back(value);
+   }
+
+   /// Reserve memory for n nonzero elements
+   void reserve(size_type n) {
+      _rows.reserve(n);
+      _cols.reserve(n);
+      _values.reserve(n);
+   }
+
+   /// Returns the number of stored elements
+   [[nodiscard]] size_type nnz() const { return _values.size(); }
+
+   [[nodiscard]] const std::vector<size_type> &rowIndices() const {
+      return _rows;
+   }
+   [[nodiscard]] const std::vector<size_type> &colIndices() const {
+      return _cols;
+   }
+   [[nodiscard]] const std::vector<T, Allocator> &values() const {
+      return _values;
+   }
+
+   [[nodiscard]] inline const T *data() const { return _values.data(); }
+   [[nodiscard]] inline T *data() { return _values.data(); }
+};
+
+/// \class CompressedStorage
+/// Compressed sparse row (CSR) or column (CSC) storage of a matrix
+///
+/// The elements of the outer index i (the row i of CSR, the column i of CSC)
+/// are stored from outerIndices()[i] to outerIndices()[i + 1], with their
+/// inner indices in increasing order. An empty storage is a matrix of zeros.
+template <typename T, typename Allocator, StorageFormat Format>
+class CompressedStorage final {
+   static_assert(Format == StorageFormat::SparseCsr ||
+                     Format == StorageFormat::SparseCsc,
+                 "Tenseur: Compressed storage must be CSR or CSC.");
+
+ public:
+   using value_type = T;
+   using allocator_type = Allocator;
+   using allocator_traits = std::allocator_traits<Allocator>;
+
+   template <class To>
+   using casted_type =
+       CompressedStorage<To,
+                         typename allocator_traits::template rebind_alloc<To>,
+                         Format>;
+
+ private:
+   std::vector<size_type> _outer;
+   std::vector<size_type> _inner;
+   std::vector<T, Allocator> _values;
+
+ public:
+   CompressedStorage() noexcept {}
+
+   /// Construct an empty storage, the size of the dense tensor is ignored
+   explicit CompressedStorage(size_type) noexcept {}
+
+   /// Construct a storage from its outer indices, inner indices and values
+   CompressedStorage(std::vector<size_type> &&outer,
+                     std::vector<size_type> &&inner,
+                     std::vector<T, Allocator> &&values) noexcept
+       : _outer(std::move(outer)), _inner(std::move(inner)),
+         _values(std::move(values)) {}
+
+   CompressedStorage(const CompressedStorage &) = delete;
+   CompressedStorage &operator=(const CompressedStorage &) = delete;
+
+   /// Returns the storage format
+   [[nodiscard]] static constexpr StorageFormat format() { return Format; }
+
+   /// Returns whether the rows are the outer dimension
+   [[nodiscard]] static constexpr bool isRowMajor() {
+      return Format == StorageFormat::SparseCsr;
+   }
+
+   /// Returns the number of stored elements
+   [[nodiscard]] size_type nnz() const { return _values.size(); }
+
+   /// Returns whether no element is stored
+   [[nodiscard]] bool empty() const { return _values.empty(); }
+
+   [[nodiscard]] const std::vector<size_type> &outerIndices() const {
+      return _outer;
+   }
+   [[nodiscard]] const std::vector<size_type> &innerIndices() const {
+      return _inner;
+   }
+   [[nodiscard]] const std::vector<T, Allocator> &values() const {
+      return _values;
+   }
+   [[nodiscard]] std::vector<T, Allocator> &values() { return _values; }
+
+   [[nodiscard]] inline const T *data() const { return _values.data(); }
+   [[nodiscard]] inline T *data() { return _values.data(); }
+};
+
+} // namespace ten
+
+#endif
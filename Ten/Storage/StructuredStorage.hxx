@@ -0,0 +1,177 @@
+#ifndef TENSEUR_STORAGE_STRUCTURED_HXX
+#define TENSEUR_STORAGE_STRUCTURED_HXX
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <Ten/Types.hxx>
+
+namespace ten {
+/// \class DiagonalStorage
+/// Diagonal of a matrix
+/// A m x n diagonal matrix stores its min(m, n) diagonal elements, the other
+/// elements are zeros.
+template <typename T, typename Allocator> class DiagonalStorage final {
+ public:
+   using value_type = T;
+   using allocator_type = Allocator;
+   using allocator_traits = std::allocator_traits<Allocator>;
+
+   template <class To>
+   using casted_type =
+       DiagonalStorage<To,
+                       typename allocator_traits::template rebind_alloc<To>>;
+
+ private:
+   std::vector<T, Allocator> _values;
+
+ public:
+   DiagonalStorage() noexcept {}
+
+   /// Construct a storage of n diagonal elements
+   explicit DiagonalStorage(size_type n) : _values(n) {}
+
+   /// Construct the storage of a matrix of the given shape
+   template <class Shape>
+      requires(Shape::rank() == 2)
+   explicit DiagonalStorage(const Shape &shape)
+       : _values(std::min(shape.dim(0), shape.dim(1))) {}
+
+   DiagonalStorage(const DiagonalStorage &) = delete;
+   DiagonalStorage &operator=(const DiagonalStorage &) = delete;
+
+   /// Returns the number of stored elements
+   [[nodiscard]] size_type size() const { return _values.size(); }
+
+   /// Returns whether the element (i, j) is stored
+   [[nodiscard]] static bool isStored(size_type i, size_type j) {
+      return i == j;
+   }
+
+   /// Returns the stored element (i, i)
+   [[nodiscard]] T &at(size_type i, size_type) { return _values[i]; }
+   [[nodiscard]] const T &at(size_type i, size_type) const {
+      return _values[i];
+   }
+
+   /// Returns the element (i, j) of the matrix
+   [[nodiscard]] T value(size_type i, size_type j) const {
+      return i == j ? _values[i] : T(0);
+   }
+
+   [[nodiscard]] inline const T *data() const { return _values.data(); }
+   [[nodiscard]] inline T *data() { return _values.data(); }
+};
+
+/// \class TriangularStorage
+/// Packed lower (LowerTr) or upper (UpperTr) triangular n x n matrix
+///
+/// The n(n + 1) / 2 elements of the triangle are packed by columns as in the
+/// packed BLAS routines. The column j of a lower triangular matrix holds the
+/// rows j to n - 1, the column j of an upper triangular matrix the rows 0 to
+/// j.
+template <typename T, typename Allocator, StorageFormat Format>
+class TriangularStorage final {
+   static_assert(Format == StorageFormat::LowerTr ||
+                     Format == StorageFormat::UpperTr,
+                 "Tenseur: Triangular storage must be LowerTr or UpperTr.");
+
+ public:
+   using value_type = T;
+   using allocator_type = Allocator;
+   using allocator_traits = std::allocator_traits<Allocator>;
+
+   template <class To>
+   using casted_type =
+       TriangularStorage<To,
+                         typename allocator_traits::template rebind_alloc<To>,
+                         Format>;
+
+ private:
+   size_type _n = 0;
+   std::vector<T, Allocator> _values;
+
+   template <class Shape> static size_type squareDim(const Shape &shape) {
+      if (shape.dim(0) != shape.dim(1)) {
+         throw std::invalid_argument(
+             "Tenseur: Triangular matrices must be square.");
+      }
+      return shape.dim(0);
+   }
+
+ public:
+   TriangularStorage() noexcept {}
+
+   /// Construct the storage of a n x n triangular matrix
+   explicit TriangularStorage(size_type n) : _n(n), _values(n * (n + 1) / 2) {}
+
+   /// Construct the storage of a square matrix of the given shape
+   /// Throws std::invalid_argument when the shape isn't square.
+   template <class Shape>
+      requires(Shape::rank() == 2)
+   explicit TriangularStorage(const Shape &shape)
+       : TriangularStorage(squareDim(shape)) {}
+
+   TriangularStorage(const TriangularStorage &) = delete;
+   TriangularStorage &operator=(const TriangularStorage &) = delete;
+
+   /// Returns the storage format
+   [[nodiscard]] static constexpr StorageFormat format() { return Format; }
+
+   /// Returns whether the matrix is lower triangular
+   [[nodiscard]] static constexpr bool isLower() {
+      return Format == StorageFormat::LowerTr;
+   }
+
+   /// Returns the dimension n of the matrix
+   [[nodiscard]] size_type dim() const { return _n; }
+
+   /// Returns the number of stored elements
+   [[nodiscard]] size_type size() const { return _values.size(); }
+
+   /// Returns the index of the first stored element of the column j
+   [[nodiscard]] size_type columnOffset(size_type j) const {
+      if constexpr (isLower()) {
+         return j * (2 * _n - j + 1) / 2;
+      } else {
+         return j * (j + 1) / 2;
+      }
+   }
+
+   /// Returns whether the element (i, j) is stored
+   [[nodiscard]] static bool isStored(size_type i, size_type j) {
+      return isLower() ? i >= j : i <= j;
+   }
+
+   /// Returns the index of the stored element (i, j)
+   [[nodiscard]] size_type index(size_type i, size_type j) const {
+      if constexpr (isLower()) {
+         return columnOffset(j) + i - j;
+      } else {
+         return columnOffset(j) + i;
+      }
+   }
+
+   /// Returns the stored element (i, j)
+   [[nodiscard]] T &at(size_type i, size_type j) {
+      return _values[index(i, j)];
+   }
+   [[nodiscard]] const T &at(size_type i, size_type j) const {
+      return _values[index(i, j)];
+   }
+
+   /// Returns the element (i, j) of the matrix
+   [[nodiscard]] T value(size_type i, size_type j) const {
+      return isStored(i, j) ? _values[index(i, j)] : T(0);
+   }
+
+   [[nodiscard]] inline const T *data() const { return _values.data(); }
+   [[nodiscard]] inline T *data() { return _values.data(); }
+};
+
+} // namespace ten
+
+#endif
@@ -0,0 +1,136 @@
+/// \file Ten/Structured.hxx
+
+#ifndef TENSEUR_STRUCTURED_HXX
+#define TENSEUR_STRUCTURED_HXX
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <Ten/Storage/StructuredStorage.hxx>
+#include <Ten/Tensor.hxx>
+#include <Ten/Types.hxx>
+
+namespace ten {
+
+namespace details {
+// Storage of a structured format
+template <class T, StorageFormat format, class Allocator>
+struct StructuredStorageType {
+   using type = TriangularStorage<T, Allocator, format>;
+};
+template <class T, class Allocator>
+struct StructuredStorageType<T, StorageFormat::Diagonal, Allocator> {
+   using type = DiagonalStorage<T, Allocator>;
+};
+} // namespace details
+
+/// \typedef StructuredMatrix
+/// StructuredMatrix<T, format>, a diagonal (Diagonal), lower triangular
+/// (LowerTr) or upper triangular (UpperTr) matrix storing only its diagonal
+/// or its packed triangle
+///
+/// The stored elements are set through the storage or converted from a dense
+/// matrix by toStructured:
+/// \code
+/// LowerTrMatrix<float> l({n, n});
+/// l.storage()->at(i, j) = value; // i >= j
+/// auto u = toStructured<StorageFormat::UpperTr>(a);
+/// Matrix<float> c = u * b;
+/// Vector<float> x = solve(u, y);
+/// \endcode
+template <class T, StorageFormat format, class Allocator = DefaultAllocator<T>>
+using StructuredMatrix = RankedTensor<
+    T, DynamicShape<2>, defaultOrder,
+    typename details::StructuredStorageType<T, format, Allocator>::type,
+    Allocator>;
+
+/// \typedef DiagonalMatrix
+/// Diagonal matrix
+template <class T, class Allocator = DefaultAllocator<T>>
+using DiagonalMatrix = StructuredMatrix<T, StorageFormat::Diagonal, Allocator>;
+
+/// \typedef LowerTrMatrix
+/// Lower triangular matrix
+template <class T, class Allocator = DefaultAllocator<T>>
+using LowerTrMatrix = StructuredMatrix<T, StorageFormat::LowerTr, Allocator>;
+
+/// \typedef UpperTrMatrix
+/// Upper triangular matrix
+template <class T, class Allocator = DefaultAllocator<T>>
+using UpperTrMatrix = StructuredMatrix<T, StorageFormat::UpperTr, Allocator>;
+
+/// \fn toStructured
+/// Convert a dense matrix to a diagonal or triangular matrix
+/// The elements outside of the diagonal or of the triangle are ignored.
+/// Triangular matrices must be square.
+template <StorageFormat format, class M>
+   requires(::ten::isDenseTensor<M>::value && M::isMatrix())
+[[nodiscard]] auto toStructured(const M &a) {
+   using value_type = typename M::value_type;
+   using result_type = StructuredMatrix<value_type, format>;
+   if constexpr (format != StorageFormat::Diagonal) {
+      if (a.dim(0) != a.dim(1)) {
+         throw std::invalid_argument(
+             "Tenseur: Triangular matrices must be square.");
+      }
+   }
+   result_type s({a.dim(0), a.dim(1)});
+   auto &storage = *s.storage();
+   for (size_type j = 0; j < a.dim(1); j++) {
+      for (size_type i = 0; i < a.dim(0); i++) {
+         if (storage.isStored(i, j)) {
+            storage.at(i, j) = a(i, j);
+         }
+      }
+   }
+   return s;
+}
+
+/// \fn toDense
+/// Convert a diagonal or triangular matrix to a dense matrix
+template <StorageOrder order = defaultOrder, class M>
+   requires(::ten::isStructuredTensor<M>::value)
+[[nodiscard]] auto toDense(const M &a) {
+   using value_type = typename M::value_type;
+   Matrix<value_type, DynamicShape<2>, order> d({a.dim(0), a.dim(1)});
+   const auto &s = *a.storage();
+   ::ten::parallel::parallelFor(
+       0, a.dim(1), 64,
+       [&](size_type first, size_type last) {
+          for (size_type j = first; j < last; j++) {
+             for (size_type i = 0; i < a.dim(0); i++) {
+                d(i, j) = s.value(i, j);
+             }
+          }
+       },
+       a.dim(0));
+   return d;
+}
+
+/// \fn solve
+/// Solve the triangular system a * x = b for a dense matrix or vector b
+/// Calls the BLAS trsm or tpsv for BLAS types.
+template <class A, class B>
+   requires ::ten::isExpr<std::remove_cvref_t<A>> &&
+            ::ten::isExpr<std::remove_cvref_t<B>>
+[[nodiscard]] auto solve(A &&a, B &&b) {
+   using L = std::remove_cvref_t<A>;
+   using R = std::remove_cvref_t<B>;
+   using left_type =
+       typename details::OutputNodeType<typename L::node_type>::type;
+   using right_type =
+       typename details::OutputNodeType<typename R::node_type>::type;
+   static_assert(traits::TriangularNode<left_type>,
+                 "Tenseur: solve expects a triangular matrix.");
+   return ::ten::BinaryExpr<
+       typename L::node_type, typename R::node_type,
+       ::ten::functional::TriangularSolve<left_type,
+                                          right_type>::template Func>(
+       a.node(), b.node());
+}
+
+} // namespace ten
+
+#endif
@@ -9,6 +9,7 @@
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -17,10 +18,13 @@
 #include <Ten/Expr.hxx>
 #include <Ten/Functional.hxx>
 #include <Ten/Shape.hxx>
+#include <Ten/Stack.hxx>
 #include <Ten/Types.hxx>
 #include <Ten/Utils.hxx>
 
 #include <Ten/Storage/DenseStorage.hxx>
+#include <Ten/Storage/SparseStorage.hxx>
+#include <Ten/Storage/StructuredStorage.hxx>
 
 namespace ten {
 
@@ -43,24 +47,40 @@ template <typename LeftExpr, typename RightExpr>
 auto operator+(LeftExpr &&left, RightExpr &&right) {
    using L = std::remove_cvref_t<LeftExpr>;
    using R = std::remove_cvref_t<RightExpr>;
-   return ::ten::BinaryExpr<
-       typename L::node_type, typename R::node_type,
-       ::ten::functional::BinaryFunc<::ten::BinaryOperation::add>::Func>(
-       left.node(), right.node());
+   if constexpr (::ten::stack::ValueOperation<::ten::BinaryOperation::add, L,
+                                              R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::add>(
+          std::forward<LeftExpr>(left), std::forward<RightExpr>(right));
+   } else {
+      return ::ten::BinaryExpr<
+          typename L::node_type, typename R::node_type,
+          ::ten::functional::BinaryFunc<::ten::BinaryOperation::add>::Func>(
+          left.node(), right.node());
+   }
 }
 
 template <typename T, typename E>
    requires ::ten::isExpr<std::remove_cvref_t<E>> && std::is_floating_point_v<T>
 auto operator+(T &&scalar, E &&expr) {
    using R = std::remove_cvref_t<E>;
-   return Scalar<T>(scalar) + std::forward<R>(expr);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::add>(
+          std::forward<T>(scalar), std::forward<E>(expr));
+   } else {
+      return Scalar<T>(scalar) + std::forward<R>(expr);
+   }
 }
 
 template <typename E, typename T>
    requires ::ten::isExpr<std::remove_cvref_t<E>> && std::is_floating_point_v<T>
 auto operator+(E &&expr, T &&scalar) {
    using R = std::remove_cvref_t<E>;
-   return std::forward<R>(expr) + Scalar<T>(scalar);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::add>(
+          std::forward<E>(expr), std::forward<T>(scalar));
+   } else {
+      return std::forward<R>(expr) + Scalar<T>(scalar);
+   }
 }
 
 // Substract two expressions
@@ -70,24 +90,40 @@ template <typename LeftExpr, typename RightExpr>
 auto operator-(LeftExpr &&left, RightExpr &&right) {
    using L = std::remove_cvref_t<LeftExpr>;
    using R = std::remove_cvref_t<RightExpr>;
-   return ::ten::BinaryExpr<
-       typename L::node_type, typename R::node_type,
-       ::ten::functional::BinaryFunc<::ten::BinaryOperation::sub>::Func>(
-       left.node(), right.node());
+   if constexpr (::ten::stack::ValueOperation<::ten::BinaryOperation::sub, L,
+                                              R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::sub>(
+          std::forward<LeftExpr>(left), std::forward<RightExpr>(right));
+   } else {
+      return ::ten::BinaryExpr<
+          typename L::node_type, typename R::node_type,
+          ::ten::functional::BinaryFunc<::ten::BinaryOperation::sub>::Func>(
+          left.node(), right.node());
+   }
 }
 
 template <typename T, typename E>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator-(T &&scalar, E &&expr) {
    using R = std::remove_cvref_t<E>;
-   return Scalar<T>(scalar) - std::forward<R>(expr);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::sub>(
+          std::forward<T>(scalar), std::forward<E>(expr));
+   } else {
+      return Scalar<T>(scalar) - std::forward<R>(expr);
+   }
 }
 
 template <typename E, typename T>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator-(E &&expr, T &&scalar) {
    using R = std::remove_cvref_t<E>;
-   return std::forward<R>(expr) - Scalar<T>(scalar);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::sub>(
+          std::forward<E>(expr), std::forward<T>(scalar));
+   } else {
+      return std::forward<R>(expr) - Scalar<T>(scalar);
+   }
 }
 
 // Multiply two expressions
@@ -97,27 +133,46 @@ template <typename LeftExpr, typename RightExpr>
 auto operator*(LeftExpr &&left, RightExpr &&right) {
    using L = std::remove_cvref_t<LeftExpr>;
    using R = std::remove_cvref_t<RightExpr>;
-   return ::ten::BinaryExpr<typename L::node_type,
-         typename R::node_type,
-         ::ten::functional::Mul<
-            typename L::node_type,
-            typename R::node_type
-         >::template Func
-      >(left.node(), right.node());
+   if constexpr (::ten::stack::ValueOperation<::ten::BinaryOperation::mul, L,
+                                              R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::mul>(
+          std::forward<LeftExpr>(left), std::forward<RightExpr>(right));
+   } else if constexpr (::ten::stack::ValueProduct<L, R>) {
+      return ::ten::stack::makeMul(std::forward<LeftExpr>(left),
+                                   std::forward<RightExpr>(right));
+   } else {
+      return ::ten::BinaryExpr<typename L::node_type,
+            typename R::node_type,
+            ::ten::functional::Mul<
+               typename details::OutputNodeType<typename L::node_type>::type,
+               typename details::OutputNodeType<typename R::node_type>::type
+            >::template Func
+         >(left.node(), right.node());
+   }
 }
 
 template <typename T, typename E>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator*(T &&scalar, E &&expr) {
    using R = std::remove_cvref_t<E>;
-   return Scalar<T>(scalar) * std::forward<R>(expr);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::mul>(
+          std::forward<T>(scalar), std::forward<E>(expr));
+   } else {
+      return Scalar<T>(scalar) * std::forward<R>(expr);
+   }
 }
 
 template <typename E, typename T>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator*(E &&expr, T &&scalar) {
    using R = std::remove_cvref_t<E>;
-   return std::forward<R>(expr) * Scalar<T>(scalar);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::mul>(
+          std::forward<E>(expr), std::forward<T>(scalar));
+   } else {
+      return std::forward<R>(expr) * Scalar<T>(scalar);
+   }
 }
 
 // Divide two expressions
@@ -127,24 +182,40 @@ template <typename LeftExpr, typename RightExpr>
 auto operator/(LeftExpr &&left, RightExpr &&right) {
    using L = std::remove_cvref_t<LeftExpr>;
    using R = std::remove_cvref_t<RightExpr>;
-   return ::ten::BinaryExpr<
-       typename L::node_type, typename R::node_type,
-       ::ten::functional::BinaryFunc<::ten::BinaryOperation::div>::Func>(
-       left.node(), right.node());
+   if constexpr (::ten::stack::ValueOperation<::ten::BinaryOperation::div, L,
+                                              R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::div>(
+          std::forward<LeftExpr>(left), std::forward<RightExpr>(right));
+   } else {
+      return ::ten::BinaryExpr<
+          typename L::node_type, typename R::node_type,
+          ::ten::functional::BinaryFunc<::ten::BinaryOperation::div>::Func>(
+          left.node(), right.node());
+   }
 }
 
 template <typename T, typename E>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator/(T &&scalar, E &&expr) {
    using R = std::remove_cvref_t<E>;
-   return Scalar<T>(scalar) / std::forward<R>(expr);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::div>(
+          std::forward<T>(scalar), std::forward<E>(expr));
+   } else {
+      return Scalar<T>(scalar) / std::forward<R>(expr);
+   }
 }
 
 template <typename E, typename T>
    requires ::ten::isExpr<std::remove_cvref_t<E>>
 auto operator/(E &&expr, T &&scalar) {
    using R = std::remove_cvref_t<E>;
-   return std::forward<R>(expr) / Scalar<T>(scalar);
+   if constexpr (::ten::stack::ScalarOperation<std::remove_cvref_t<T>, R>) {
+      return ::ten::stack::makeExpr<::ten::BinaryOperation::div>(
+          std::forward<E>(expr), std::forward<T>(scalar));
+   } else {
+      return std::forward<R>(expr) / Scalar<T>(scalar);
+   }
 }
 
 /// \class ScalarOperations
@@ -292,6 +363,20 @@ struct TensorOperations {
    [[nodiscard]] static constexpr bool isMatrix() { return Shape::rank() == 2; }
 };
 
+namespace details {
+// Allocate the storage of a tensor of the given shape
+// Structured storages are constructed from the shape of the matrix, the other
+// storages from its number of elements.
+template <class Storage, class Shape>
+Storage *allocateStorage(const Shape &shape) {
+   if constexpr (std::is_constructible_v<Storage, const Shape &>) {
+      return new Storage(shape);
+   } else {
+      return new Storage(shape.size());
+   }
+}
+} // namespace details
+
 /// \class TensorNode
 /// Tensor node
 template <class T, class Shape, StorageOrder Order, class Storage,
@@ -310,78 +395,141 @@ class TensorNode
 
    using stride_type = typename base_type::stride_type;
 
+   /// Whether the storage is held inline, by value
+   static constexpr bool inlineStorage =
+       ::ten::stack::isInline<T, Shape, Storage>;
+
  private:
-   /// Optional shape (only for dynamic tensors)
+   using storage_holder =
+       std::conditional_t<inlineStorage, Storage, std::shared_ptr<Storage>>;
+
+   /// Shape, set at construction for static tensors
    std::optional<Shape> _shape = std::nullopt;
    /// optional stride (only for dynamic tensors)
    std::optional<stride_type> _stride = std::nullopt;
    /// Storage
-   std::shared_ptr<Storage> _storage = nullptr;
+   storage_holder _storage{};
+   /// Offset of the first element in the storage
+   size_type _offset = 0;
+   /// Is a view of the storage of another tensor
+   bool _view = false;
+   /// Whether the elements are stored contiguously in the storage order
+   bool _contiguous = true;
    /// Is transposed
    bool _transposed = false;
 
  private:
+   /// Returns the shape of a static tensor
+   static std::optional<Shape> staticShape() {
+      if constexpr (Shape::isStatic()) {
+         return Shape();
+      } else {
+         return std::nullopt;
+      }
+   }
+
+   /// Returns a new storage of a static tensor
+   static storage_holder staticStorage() {
+      if constexpr (inlineStorage) {
+         return Storage();
+      } else {
+         return storage_holder(new Storage());
+      }
+   }
+
+   /// Returns a pointer to the storage
+   [[nodiscard]] Storage *storagePtr() {
+      if constexpr (inlineStorage) {
+         return &_storage;
+      } else {
+         return _storage.get();
+      }
+   }
+   [[nodiscard]] const Storage *storagePtr() const {
+      return const_cast<TensorNode *>(this)->storagePtr();
+   }
+
+   /// Returns whether the strides are the strides of a contiguous array
+   static bool hasContiguousStrides(const Shape &shape,
+                                    const stride_type &strides) {
+      auto contiguous = details::computeStrides<Shape, Order>(shape);
+      for (size_type i = 0; i < Shape::rank(); i++) {
+         if (shape.dim(i) > 1 && strides.dim(i) != contiguous[i]) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /// Returns the offset of the element at a linear index of a non contiguous
+   /// view
+   [[nodiscard]] size_type viewOffset(size_type index) const {
+      return stridedRuns().offset(index);
+   }
+
    /// Returns the value at the indices
+   /// A single index is the linear index in the storage order.
    [[nodiscard]] inline typename base_type::value_type &
    at(size_type index, auto... tail) noexcept {
       static constexpr size_type rank = Shape::rank();
       constexpr size_type n = sizeof...(tail);
       static_assert(n == 0 || n == (rank - 1), "Invalid number of indices.");
-      if constexpr (rank == 1) {
-         return (*_storage.get())[index];
-      }
-      std::array<size_type, Shape::rank()> indices{
-          index, static_cast<size_type>(tail)...};
+      T *ptr = data();
       if constexpr (Shape::isDynamic()) {
-         size_type idx = details::linearIndex(_stride.value(), indices);
-         return (*_storage.get())[idx];
+         if constexpr (n == 0) {
+            return _contiguous ? ptr[index] : ptr[viewOffset(index)];
+         } else {
+            std::array<size_type, Shape::rank()> indices{
+                index, static_cast<size_type>(tail)...};
+            return ptr[details::linearIndex(_stride.value(), indices)];
+         }
       } else {
-         size_type idx = details::staticLinearIndex<stride_type>(indices);
-         return (*_storage.get())[idx];
+         if constexpr (n == 0) {
+            return ptr[index];
+         } else {
+            std::array<size_type, Shape::rank()> indices{
+                index, static_cast<size_type>(tail)...};
+            return ptr[details::staticLinearIndex<stride_type>(indices)];
+         }
       }
    }
 
    /// Returns the value at the indices
    [[nodiscard]] inline const typename base_type::value_type &
    at(size_type index, auto... tail) const noexcept {
-      static constexpr size_type rank = Shape::rank();
-      constexpr size_type n = sizeof...(tail);
-      static_assert(n == 0 || n == (rank - 1), "Invalid number of indices.");
-      if constexpr (rank == 1) {
-         return (*_storage.get())[index];
-      }
-      std::array<size_type, Shape::rank()> indices{
-          index, static_cast<size_type>(tail)...};
-      if constexpr (Shape::isDynamic()) {
-         size_type idx = details::linearIndex(_stride.value(), indices);
-         return (*_storage.get())[idx];
-      } else {
-         size_type idx = details::staticLinearIndex<stride_type>(indices);
-         return (*_storage.get())[idx];
-      }
+      return const_cast<TensorNode *>(this)->at(index, tail...);
    }
 
  public:
    /// Construct a static TensorNode
-   TensorNode() noexcept
-       : _shape(std::nullopt), _stride(std::nullopt), _storage(new Storage()) {}
+   TensorNode()
+       : _shape(staticShape()), _stride(std::nullopt),
+         _storage(staticStorage()) {}
 
    /// Construct a TensorNode from a list of shape
-   explicit TensorNode(std::initializer_list<size_type> &&shape) noexcept
+   explicit TensorNode(std::initializer_list<size_type> &&shape)
       requires(Shape::isDynamic())
-       : _shape(std::move(shape)), _storage(new Storage(_shape.value().size())),
+       : _shape(std::move(shape)),
+         _storage(details::allocateStorage<Storage>(_shape.value())),
          _stride(typename base_type::stride_type(_shape.value())) {}
 
    /// Construct a TensorNode from the shape
-   explicit TensorNode(const Shape &shape) noexcept
+   explicit TensorNode(const Shape &shape)
       requires(Shape::isDynamic())
-       : _shape(shape), _storage(new Storage(shape.size())),
+       : _shape(shape), _storage(details::allocateStorage<Storage>(shape)),
          _stride(typename base_type::stride_type(_shape.value())) {}
 
    // Construct a TensoNode from storage
+   // An inline storage is a copy of the storage.
    explicit TensorNode(const std::shared_ptr<Storage> &storage) noexcept
       requires(Shape::isStatic())
-       : _storage(storage) {}
+       : _shape(Shape()) {
+      if constexpr (inlineStorage) {
+         _storage = *storage.get();
+      } else {
+         _storage = storage;
+      }
+   }
 
    // Construct a TensoNode from storage
    // FIXME Check size
@@ -391,6 +539,17 @@ class TensorNode
        : _storage(storage), _shape(shape),
          _stride(typename base_type::stride_type(_shape.value())) {}
 
+   /// Construct a view of a storage from its shape, strides and the offset of
+   /// its first element, transposed is set for the views transposing another
+   /// tensor
+   explicit TensorNode(const std::shared_ptr<Storage> &storage,
+                       const Shape &shape, const stride_type &strides,
+                       size_type offset, bool transposed = false) noexcept
+      requires(Shape::isDynamic())
+       : _shape(shape), _stride(strides), _storage(storage), _offset(offset),
+         _view(true), _contiguous(hasContiguousStrides(shape, strides)),
+         _transposed(transposed) {}
+
    TensorNode(TensorNode &&) = default;
    TensorNode(const TensorNode &) = default;
    // Assignment
@@ -415,12 +574,63 @@ class TensorNode
       return _stride.value();
    }
 
-   [[nodiscard]] T *data() { return _storage.get()->data(); }
-   [[nodiscard]] const T *data() const { return _storage.get()->data(); }
+   /// Returns the stride of the index'th dimension
+   [[nodiscard]] size_type stride(size_type index) const {
+      if constexpr (Shape::isDynamic()) {
+         return _stride.value().dim(index);
+      } else {
+         return details::computeStrides<Shape, Order>(Shape())[index];
+      }
+   }
+
+   /// Returns the traversal of the elements by runs along the innermost
+   /// dimension
+   [[nodiscard]] details::StridedRuns<Shape::rank(), Order>
+   stridedRuns() const {
+      std::array<size_type, Shape::rank()> dims;
+      std::array<size_type, Shape::rank()> strides;
+      for (size_type i = 0; i < Shape::rank(); i++) {
+         dims[i] = dim(i);
+         strides[i] = stride(i);
+      }
+      return details::StridedRuns<Shape::rank(), Order>(dims, strides);
+   }
+
+   /// Returns a pointer to the first element
+   [[nodiscard]] T *data() { return storagePtr()->data() + _offset; }
+   [[nodiscard]] const T *data() const {
+      return storagePtr()->data() + _offset;
+   }
+
+   /// Returns the offset of the first element in the storage
+   [[nodiscard]] size_type offset() const { return _offset; }
+
+   /// Returns whether the node is a view of the storage of another node
+   [[nodiscard]] bool isView() const { return _view; }
+
+   /// Returns whether the elements are contiguous in the storage order
+   [[nodiscard]] bool isContiguous() const { return _contiguous; }
 
    [[nodiscard]] bool isTransposed() const { return _transposed; }
 
-   [[nodiscard]] std::shared_ptr<Storage> storage() const { return _storage; }
+   [[nodiscard]] std::shared_ptr<Storage> storage() const
+      requires(!inlineStorage)
+   {
+      return _storage;
+   }
+
+   /// Returns whether the node is the only owner of its storage
+   /// A storage over external memory, such as a read only mapped file, isn't
+   /// owned.
+   [[nodiscard]] bool ownsStorage() const {
+      if constexpr (inlineStorage) {
+         return true;
+      } else if constexpr (requires { _storage.get()->isExternal(); }) {
+         return _storage.use_count() == 1 && !_storage.get()->isExternal();
+      } else {
+         return _storage.use_count() == 1;
+      }
+   }
 
    /// Overloading the [] operator
    [[nodiscard]] inline const typename base_type::value_type &
@@ -446,27 +656,20 @@ class TensorNode
    void resize(std::initializer_list<size_type> &&dims) {
       _shape = Shape(std::move(dims));
       _stride = stride_type(_shape.value());
-      _storage.reset(new Storage(_shape.value().size()));
+      _storage.reset(details::allocateStorage<Storage>(_shape.value()));
+      _offset = 0;
+      _view = false;
+      _contiguous = true;
    }
 };
 
-namespace details {
-template <typename Storage> struct AllocatorType {
-   using type = typename Storage::allocator_type;
-};
-template <class T, class Shape>
-struct AllocatorType<::ten::StaticDenseStorage<T, Shape>> {
-   using type = void;
-};
-} // namespace details
-
 /// \class Tensor
 ///
 /// Tensor represented by a multidimentional array.
 template <class T, class Shape, StorageOrder Order = defaultOrder,
           class Storage = DefaultStorage<T, Shape>,
           class Allocator = details::AllocatorType<Storage>::type>
-class RankedTensor final
+class RankedTensor
     : public Expr<RankedTensor<T, Shape, Order, Storage, Allocator>>,
       public TensorOperations<T, Shape, Order, Storage, Allocator>,
       public TensorBase {
@@ -489,26 +692,99 @@ class RankedTensor final
    /// Node type
    using node_type = TensorNode<T, Shape, Order, Storage, Allocator>;
 
+   /// \typedef view_type
+   /// Type of the views of the tensor
+   template <size_type Rank = Shape::rank()>
+   using view_type = TensorView<
+       RankedTensor<T, DynamicShape<Rank>, Order, Storage, Allocator>>;
+
+   /// Whether the node is held inline, by value
+   /// Small static tensors hold their node and their elements, they are
+   /// copied by value and don't allocate.
+   static constexpr bool inlineNode = ::ten::stack::isInline<T, Shape, Storage>;
+
  private:
-   /// Shared pointer to the node
-   // TODO Slice / View / or TilledTensor
-   std::shared_ptr<node_type> _node = nullptr;
+   using node_holder = std::conditional_t<inlineNode, node_type,
+                                          std::shared_ptr<node_type>>;
+   struct NoSharedNode {};
+   using shared_holder = std::conditional_t<inlineNode,
+                                            std::shared_ptr<node_type>,
+                                            NoSharedNode>;
+
+   /// Node, or shared pointer to the node
+   node_holder _node{};
+   /// Shared node of a tensor holding its node inline, set by node()
+   mutable shared_holder _shared{};
+
+   /// Returns a new node
+   template <class... Args> static node_holder makeNode(Args &&...args) {
+      if constexpr (inlineNode) {
+         return node_type(std::forward<Args>(args)...);
+      } else {
+         return std::make_shared<node_type>(std::forward<Args>(args)...);
+      }
+   }
+
+   /// Returns the node
+   [[nodiscard]] node_type &nodeRef() {
+      if constexpr (inlineNode) {
+         return _shared ? *_shared.get() : _node;
+      } else {
+         return *_node.get();
+      }
+   }
+   [[nodiscard]] const node_type &nodeRef() const {
+      return const_cast<RankedTensor *>(this)->nodeRef();
+   }
+
+   /// Returns a node owning its elements
+   /// A view of the storage of another tensor is copied, so that writing to
+   /// the tensor doesn't write to the viewed one.
+   static std::shared_ptr<node_type>
+   ownedNode(const std::shared_ptr<node_type> &node) {
+      if constexpr (Shape::isDynamic() && isDenseStorage<Storage>::value) {
+         if (node.get()->isView()) {
+            return details::contiguousCopy(*node.get());
+         }
+      }
+      return node;
+   }
+
+   /// Returns a view of the storage
+   template <size_type Rank>
+   [[nodiscard]] view_type<Rank>
+   makeView(const std::array<size_type, Rank> &dims,
+            const std::array<size_type, Rank> &strides,
+            size_type offset) const {
+      using view_node_type = typename view_type<Rank>::node_type;
+      using view_shape_type = typename view_node_type::shape_type;
+      using view_stride_type = typename view_node_type::stride_type;
+      return view_type<Rank>(std::make_shared<view_node_type>(
+          nodeRef().storage(), view_shape_type(dims),
+          view_stride_type(strides), nodeRef().offset() + offset));
+   }
 
  public:
    /// Constructor for static Tensor
-   RankedTensor() noexcept : _node(std::make_shared<node_type>()) {}
+   RankedTensor() : _node(makeNode()) {}
 
    /// Constructor for Tensor with a storage of type Ten::DenseStorage
-   explicit RankedTensor(std::initializer_list<size_type> &&shape) noexcept
+   explicit RankedTensor(std::initializer_list<size_type> &&shape)
       requires(Shape::isDynamic())
-       : _node(std::make_shared<node_type>(std::move(shape))) {}
+       : _node(makeNode(std::move(shape))) {}
 
    /// Constructor of Tensor from shape
-   explicit RankedTensor(const Shape &shape) noexcept
-       : _node(std::make_shared<node_type>(shape)) {}
+   explicit RankedTensor(const Shape &shape) : _node(makeNode(shape)) {}
 
    /// Constructor of Tensor from a shared pointer to TensorNode
-   RankedTensor(const std::shared_ptr<node_type> &node) : _node(node) {}
+   /// A tensor holding its node inline copies the node.
+   RankedTensor(const std::shared_ptr<node_type> &node) {
+      if constexpr (inlineNode) {
+         _node = *node.get();
+      } else {
+         _node = node;
+      }
+   }
 
    /// Asignment from an expression
    /// FIXME convert from any compatible output type
@@ -516,95 +792,315 @@ class RankedTensor final
       requires(::ten::isUnaryExpr<std::remove_cvref_t<Expr>>::value ||
                ::ten::isBinaryExpr<std::remove_cvref_t<Expr>>::value)
    RankedTensor(Expr &&expr) {
-      _node = expr.eval().node();
+      if constexpr (inlineNode) {
+         *this = expr.eval();
+      } else {
+         _node = ownedNode(expr.eval().node());
+      }
+   }
+
+   /// Construction from a view, the tensor owns a copy of its elements
+   template <class View>
+      requires(::ten::isTensorView<std::remove_cvref_t<View>>::value &&
+               std::is_same_v<typename std::remove_cvref_t<View>::node_type,
+                              node_type>)
+   RankedTensor(View &&view)
+       : _node(details::contiguousCopy(*view.node().get())) {}
+
+   /// Construction from an expression held by value, evaluated in place
+   template <class Expr>
+      requires(inlineNode &&
+               ::ten::stack::isValueExpr<std::remove_cvref_t<Expr>>::value &&
+               std::is_same_v<typename std::remove_cvref_t<Expr>::shape_type,
+                              Shape>)
+   RankedTensor(const Expr &expr) : _node(makeNode()) {
+      expr.evalTo(data());
    }
 
    /// Vector
-   explicit RankedTensor(size_type size) noexcept
+   explicit RankedTensor(size_type size)
       requires(Shape::isDynamic() && Shape::rank() == 1)
    {
-      _node =
-          std::make_shared<node_type>(std::initializer_list<size_type>{size});
+      _node = makeNode(std::initializer_list<size_type>{size});
    }
 
    /// Matrix
-   explicit RankedTensor(size_type rows, size_type cols) noexcept
+   explicit RankedTensor(size_type rows, size_type cols)
       requires(Shape::isDynamic() && Shape::rank() == 2)
    {
-      _node = std::make_shared<node_type>(
-          std::initializer_list<size_type>{rows, cols});
+      _node = makeNode(std::initializer_list<size_type>{rows, cols});
    }
 
    /// Assignment operator
-   RankedTensor(const RankedTensor &t) { _node = t._node; }
+   /// A tensor holding its node inline copies the elements.
+   RankedTensor(const RankedTensor &t) {
+      if constexpr (inlineNode) {
+         _node = t.nodeRef();
+      } else {
+         _node = t._node;
+      }
+   }
 
    RankedTensor(RankedTensor &&) = default;
 
    RankedTensor &operator=(const RankedTensor &t) {
-      _node = t._node;
+      if constexpr (inlineNode) {
+         if (this != &t) {
+            nodeRef() = t.nodeRef();
+         }
+      } else {
+         _node = t._node;
+      }
+      return *this;
+   }
+   RankedTensor &operator=(RankedTensor &&t) {
+      if constexpr (inlineNode) {
+         if (this != &t) {
+            nodeRef() = t.nodeRef();
+         }
+      } else {
+         _node = std::move(t._node);
+      }
+      return *this;
+   }
+
+   /// Assignment from a view, the tensor owns a copy of its elements
+   template <class View>
+      requires(::ten::isTensorView<std::remove_cvref_t<View>>::value &&
+               std::is_same_v<typename std::remove_cvref_t<View>::node_type,
+                              node_type>)
+   RankedTensor &operator=(View &&view) {
+      _node = details::contiguousCopy(*view.node().get());
+      return *this;
+   }
+
+   /// Assignment from an expression
+   /// The expression is evaluated directly into the storage of the tensor when
+   /// the tensor is the only owner of its node and storage and the shapes
+   /// match, otherwise the tensor takes the node of the evaluated expression,
+   /// or a copy of it when it is a view of another tensor.
+   template <class Expr>
+      requires(::ten::isUnaryExpr<std::remove_cvref_t<Expr>>::value ||
+               ::ten::isBinaryExpr<std::remove_cvref_t<Expr>>::value)
+   RankedTensor &operator=(Expr &&expr) {
+      using output_type =
+          typename std::remove_cvref_t<Expr>::node_type::output_node_type;
+      if constexpr (inlineNode) {
+         nodeRef() = expr.eval().nodeRef();
+         return *this;
+      } else {
+         if constexpr (std::is_same_v<output_type, node_type>) {
+            if (_node && _node.use_count() == 1 &&
+                _node.get()->ownsStorage()) {
+               _node = expr.eval(_node).node();
+               return *this;
+            }
+         }
+         _node = ownedNode(expr.eval().node());
+         return *this;
+      }
+   }
+
+   /// Assignment from an expression held by value, evaluated in place
+   /// The elementwise expressions may read the tensor they are assigned to.
+   template <class Expr>
+      requires(inlineNode &&
+               ::ten::stack::isValueExpr<std::remove_cvref_t<Expr>>::value &&
+               std::is_same_v<typename std::remove_cvref_t<Expr>::shape_type,
+                              Shape>)
+   RankedTensor &operator=(const Expr &expr) {
+      expr.evalTo(data());
       return *this;
    }
-   RankedTensor &operator=(RankedTensor &&t) = default;
 
    // TODO Iterators
 
    /// Returns the shape
    [[nodiscard]] inline const Shape &shape() const {
-      return _node.get()->shape();
+      return nodeRef().shape();
    }
 
    /// Returns the strides
    [[nodiscard]] inline const typename base_type::stride_type &strides() const {
-      return _node.get()->strides();
+      return nodeRef().strides();
    }
 
    /// Returns the dynamic size
-   [[nodiscard]] inline size_type size() const { return _node.get()->size(); }
+   [[nodiscard]] inline size_type size() const { return nodeRef().size(); }
 
    /// Returns the index'th dynamic dimension
    [[nodiscard]] inline size_type dim(size_type index) const {
-      return _node.get()->dim(index);
+      return nodeRef().dim(index);
    }
 
    // Returns the shared ptr to the node
-   [[nodiscard]] std::shared_ptr<node_type> node() const { return _node; }
+   // A tensor holding its node inline moves it to a shared node the first
+   // time, so that the expressions and the plans built from the tensor see
+   // its later changes. Taking the first node isn't thread safe.
+   [[nodiscard]] std::shared_ptr<node_type> node() const {
+      if constexpr (inlineNode) {
+         if (!_shared) {
+            _shared = std::make_shared<node_type>(_node);
+         }
+         return _shared;
+      } else {
+         return _node;
+      }
+   }
 
    /// Get the data
-   [[nodiscard]] const T *data() const { return _node.get()->data(); }
-   [[nodiscard]] T *data() { return _node.get()->data(); }
+   [[nodiscard]] const T *data() const { return nodeRef().data(); }
+   [[nodiscard]] T *data() { return nodeRef().data(); }
 
    [[nodiscard]] std::shared_ptr<Storage> storage() const {
-      return _node.get()->storage();
+      return nodeRef().storage();
    }
 
    /// Overloading the [] operator
    [[nodiscard]] inline const typename base_type::value_type &
    operator[](size_type index) const noexcept {
-      return (*_node.get())[index];
+      return nodeRef()[index];
    }
    [[nodiscard]] inline typename base_type::value_type &
    operator[](size_type index) noexcept {
-      return (*_node.get())[index];
+      return nodeRef()[index];
    }
 
    /// Overloading the () operator
    [[nodiscard]] inline const typename base_type::value_type &
    operator()(auto... index) const noexcept {
-      return (*_node.get())(index...);
+      return nodeRef()(index...);
    }
    [[nodiscard]] inline typename base_type::value_type &
    operator()(auto... index) noexcept {
-      return (*_node.get())(index...);
+      return nodeRef()(index...);
    }
 
    /// Is transposed
    [[nodiscard]] bool isTransposed() const {
-      return _node.get()->isTransposed();
+      return nodeRef().isTransposed();
+   }
+
+   /// Returns the stride of the index'th dimension
+   [[nodiscard]] inline size_type stride(size_type index) const {
+      return nodeRef().stride(index);
+   }
+
+   /// Returns whether the tensor is a view of the storage of another tensor
+   [[nodiscard]] bool isView() const { return nodeRef().isView(); }
+
+   /// Returns whether the elements are contiguous in the storage order
+   [[nodiscard]] bool isContiguous() const {
+      return nodeRef().isContiguous();
+   }
+
+   /// Returns the offset of the first element in the storage
+   [[nodiscard]] size_type offset() const { return nodeRef().offset(); }
+
+   /// Returns a view of the elements selected by a slice per dimension
+   /// The view shares the storage of the tensor, no element is copied.
+   /// x.slice({{0, 4}, {}, {1, 9, 2}}) selects the rows 0 to 3, all the
+   /// columns and every other index from 1 to 8 of the last dimension.
+   [[nodiscard]] view_type<> slice(std::initializer_list<Slice> &&slices) const
+      requires(Shape::isDynamic())
+   {
+      if (slices.size() != Shape::rank()) {
+         throw std::out_of_range("Tenseur: Expected one slice per dimension.");
+      }
+      std::array<size_type, Shape::rank()> dims;
+      std::array<size_type, Shape::rank()> strides;
+      size_type offset = 0;
+      size_type index = 0;
+      for (const Slice &slice : slices) {
+         size_type last = std::min(slice.last(), dim(index));
+         if (slice.step() == 0 || slice.first() > last) {
+            throw std::out_of_range("Tenseur: Invalid slice.");
+         }
+         dims[index] = (last - slice.first() + slice.step() - 1) / slice.step();
+         strides[index] = stride(index) * slice.step();
+         offset += slice.first() * stride(index);
+         index++;
+      }
+      return makeView<Shape::rank()>(dims, strides, offset);
+   }
+
+   /// Returns a view of the index'th row of a matrix
+   [[nodiscard]] view_type<1> row(size_type index) const
+      requires(Shape::isDynamic() && Shape::rank() == 2)
+   {
+      if (index >= dim(0)) {
+         throw std::out_of_range("Tenseur: Row index out of range.");
+      }
+      return makeView<1>({dim(1)}, {stride(1)}, index * stride(0));
+   }
+
+   /// Returns a view of the index'th column of a matrix
+   [[nodiscard]] view_type<1> col(size_type index) const
+      requires(Shape::isDynamic() && Shape::rank() == 2)
+   {
+      if (index >= dim(1)) {
+         throw std::out_of_range("Tenseur: Column index out of range.");
+      }
+      return makeView<1>({dim(0)}, {stride(0)}, index * stride(1));
+   }
+
+   /// Returns a view of the block of rows x cols elements of a matrix starting
+   /// at (i, j)
+   [[nodiscard]] view_type<2> block(size_type i, size_type j, size_type rows,
+                                    size_type cols) const
+      requires(Shape::isDynamic() && Shape::rank() == 2)
+   {
+      if (i + rows > dim(0) || j + cols > dim(1)) {
+         throw std::out_of_range("Tenseur: Block out of range.");
+      }
+      return makeView<2>({rows, cols}, {stride(0), stride(1)},
+                         i * stride(0) + j * stride(1));
    }
 
    // Resize
    void resize(std::initializer_list<size_type> &&dims) {
-      _node.get()->resize(std::move(dims));
+      nodeRef().resize(std::move(dims));
+   }
+};
+
+/// \class TensorView
+/// View of the elements of a tensor
+///
+/// A view shares the storage of the tensor it is taken from, with its own
+/// offset, shape and strides (see slice, row, col and block). Assigning to a
+/// view writes into the viewed storage, while a tensor constructed or assigned
+/// from a view owns a copy of its elements.
+template <class Tensor> class TensorView final : public Tensor {
+ public:
+   using node_type = typename Tensor::node_type;
+
+   explicit TensorView(const std::shared_ptr<node_type> &node)
+       : Tensor(node) {}
+
+   TensorView(const TensorView &) = default;
+   TensorView(TensorView &&) = default;
+
+   /// Assignment from an expression, written into the viewed storage
+   template <class Expr>
+      requires(::ten::isUnaryExpr<std::remove_cvref_t<Expr>>::value ||
+               ::ten::isBinaryExpr<std::remove_cvref_t<Expr>>::value)
+   TensorView &operator=(Expr &&expr) {
+      auto value = expr.eval();
+      details::assignToView(*value.node().get(), *this->node().get());
+      return *this;
+   }
+
+   /// Assignment from a tensor or a view, its elements are copied into the
+   /// viewed storage
+   template <class X>
+      requires(::ten::isTensor<X>::value && !std::is_same_v<X, TensorView>)
+   TensorView &operator=(const X &x) {
+      details::assignToView(*x.node().get(), *this->node().get());
+      return *this;
+   }
+   TensorView &operator=(const TensorView &view) {
+      details::assignToView(*view.node().get(), *this->node().get());
+      return *this;
    }
 };
 
@@ -1087,7 +1583,8 @@ template <class T, size_type Rank = 1, StorageOrder Order = defaultOrder>
 /// Functions
 
 /// \fn min
-/// Returns the maximum of an expression
+/// Returns the minimum of an expression
+/// Throws std::invalid_argument when the tensor is empty.
 template <class E>
    requires isExpr<std::remove_cvref_t<E>>
 auto min(E &&expr) {
@@ -1098,6 +1595,7 @@ auto min(E &&expr) {
 
 /// \fn max
 /// Return the maximum of an tensor or an expression
+/// Throws std::invalid_argument when the tensor is empty.
 template <class E>
    requires isExpr<std::remove_cvref_t<E>>
 auto max(E &&expr) {
@@ -1106,6 +1604,261 @@ auto max(E &&expr) {
        expr.node());
 }
 
+namespace details {
+// Reduction of an expression to a scalar
+template <ReduceOperation kind, class E>
+auto reduce(E &&expr, Summation method) {
+   using node_type = typename std::remove_cvref_t<E>::node_type;
+   return UnaryExpr<node_type, functional::Reduce<kind>::template Func>(
+       expr.node(), method);
+}
+
+// Reduction of an expression along an axis
+template <ReduceOperation kind, size_type axis, class E>
+auto reduceAxis(E &&expr, Summation method) {
+   using node_type = typename std::remove_cvref_t<E>::node_type;
+   return UnaryExpr<node_type,
+                    functional::ReduceAxis<kind, axis>::template Func>(
+       expr.node(), method);
+}
+} // namespace details
+
+/// \fn sum
+/// Returns the sum of the elements of a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto sum(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::sum>(std::forward<E>(expr), method);
+}
+
+/// sum<axis>(x)
+/// Returns the sum along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto sum(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::sum, axis>(std::forward<E>(expr),
+                                                          method);
+}
+
+/// \fn mean
+/// Returns the mean of the elements of a tensor or an expression
+/// Throws std::invalid_argument when the tensor is empty.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto mean(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::mean>(std::forward<E>(expr), method);
+}
+
+/// mean<axis>(x)
+/// Returns the mean along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto mean(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::mean, axis>(std::forward<E>(expr),
+                                                          method);
+}
+
+/// \fn prod
+/// Returns the product of the elements of a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto prod(E &&expr) {
+   return details::reduce<ReduceOperation::prod>(std::forward<E>(expr),
+                                                Summation::naive);
+}
+
+/// prod<axis>(x)
+/// Returns the product along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto prod(E &&expr) {
+   return details::reduceAxis<ReduceOperation::prod, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// min<axis>(x)
+/// Returns the minimum along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto min(E &&expr) {
+   return details::reduceAxis<ReduceOperation::min, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// max<axis>(x)
+/// Returns the maximum along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto max(E &&expr) {
+   return details::reduceAxis<ReduceOperation::max, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// \fn norm1
+/// Returns the L1 norm (sum of the absolute values) of a tensor or an
+/// expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto norm1(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::norm1>(std::forward<E>(expr), method);
+}
+
+/// norm1<axis>(x)
+/// Returns the L1 norm along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto norm1(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::norm1, axis>(std::forward<E>(expr),
+                                                          method);
+}
+
+/// \fn norm2
+/// Returns the euclidean norm of a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto norm2(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::norm2>(std::forward<E>(expr), method);
+}
+
+/// norm2<axis>(x)
+/// Returns the euclidean norm along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto norm2(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::norm2, axis>(std::forward<E>(expr),
+                                                          method);
+}
+
+/// \fn normInf
+/// Returns the infinity norm (maximum absolute value) of a tensor or an
+/// expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto normInf(E &&expr) {
+   return details::reduce<ReduceOperation::normInf>(std::forward<E>(expr),
+                                                Summation::naive);
+}
+
+/// normInf<axis>(x)
+/// Returns the infinity norm along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto normInf(E &&expr) {
+   return details::reduceAxis<ReduceOperation::normInf, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// \fn argmin
+/// Returns the index of the first minimum of a tensor or an expression
+/// Throws std::invalid_argument when the tensor is empty.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto argmin(E &&expr) {
+   return details::reduce<ReduceOperation::argmin>(std::forward<E>(expr),
+                                                Summation::naive);
+}
+
+/// argmin<axis>(x)
+/// Returns the indices of the minimums along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto argmin(E &&expr) {
+   return details::reduceAxis<ReduceOperation::argmin, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// \fn argmax
+/// Returns the index of the first maximum of a tensor or an expression
+/// Throws std::invalid_argument when the tensor is empty.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto argmax(E &&expr) {
+   return details::reduce<ReduceOperation::argmax>(std::forward<E>(expr),
+                                                Summation::naive);
+}
+
+/// argmax<axis>(x)
+/// Returns the indices of the maximums along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto argmax(E &&expr) {
+   return details::reduceAxis<ReduceOperation::argmax, axis>(std::forward<E>(expr),
+                                                          Summation::naive);
+}
+
+/// \fn variance
+/// Returns the variance of the elements of a tensor or an expression
+/// Throws std::invalid_argument when the tensor is empty.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto variance(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::var>(std::forward<E>(expr), method);
+}
+
+/// variance<axis>(x)
+/// Returns the variance along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto variance(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::var, axis>(std::forward<E>(expr),
+                                                          method);
+}
+
+/// \fn logsumexp
+/// Returns log(sum(exp(x))) of the elements of a tensor or an expression
+/// The maximum is factored out so that the exponentials don't overflow.
+/// Throws std::invalid_argument when the tensor is empty.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto logsumexp(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduce<ReduceOperation::logsumexp>(std::forward<E>(expr),
+                                                      method);
+}
+
+/// logsumexp<axis>(x)
+/// Returns log(sum(exp(x))) along an axis
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto logsumexp(E &&expr, Summation method = Summation::pairwise) {
+   return details::reduceAxis<ReduceOperation::logsumexp, axis>(
+       std::forward<E>(expr), method);
+}
+
+/// \fn transpose
+/// Returns the transpose of a tensor or an expression, the order of the
+/// dimensions is reversed.
+/// Tensors of dynamic shape are transposed without a copy, the result is a
+/// view of their storage with the shape and the strides reversed, which the
+/// matrix products read as a transposed operand.
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto transpose(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Transpose>(
+       expr.node());
+}
+
+/// \fn batchMul
+/// Returns the batched matrix product of two tensors or expressions
+/// The matrices are the two innermost dimensions in the storage order, the
+/// first two of a column major tensor and the last two of a row major one,
+/// and the other dimensions index the batch. A matrix or a batch dimension of
+/// size one is broadcast over the batch of the other operand, as in
+/// batchMul(q, w) for q of shape {m, k, batch} and w of shape {k, n}.
+template <class A, class B>
+   requires isExpr<std::remove_cvref_t<A>> && isExpr<std::remove_cvref_t<B>>
+auto batchMul(A &&a, B &&b) {
+   using L = std::remove_cvref_t<A>;
+   using R = std::remove_cvref_t<B>;
+   return BinaryExpr<
+       typename L::node_type, typename R::node_type,
+       functional::BatchMul<
+           typename details::OutputNodeType<typename L::node_type>::type,
+           typename details::OutputNodeType<
+               typename R::node_type>::type>::template Func>(a.node(),
+                                                             b.node());
+}
+
 /// \fn abs
 /// Returns the absolute value of a scalar, a tensor or an expression
 template <class E>
@@ -1126,6 +1879,99 @@ auto sqrt(E &&expr) {
        expr.node());
 }
 
+/// \fn exp
+/// Returns the exponential of a scalar, a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto exp(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Exp>(
+       expr.node());
+}
+
+/// \fn log
+/// Returns the natural logarithm of a scalar, a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto log(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Log>(
+       expr.node());
+}
+
+/// \fn log1p
+/// Returns log(1 + x) of a scalar, a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto log1p(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Log1p>(
+       expr.node());
+}
+
+/// \fn tanh
+/// Returns the hyperbolic tangent of a scalar, a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto tanh(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Tanh>(
+       expr.node());
+}
+
+/// \fn sigmoid
+/// Returns the logistic sigmoid 1 / (1 + exp(-x)) of a scalar, a tensor or
+/// an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto sigmoid(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Sigmoid>(
+       expr.node());
+}
+
+/// \fn erf
+/// Returns the error function of a scalar, a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto erf(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Erf>(
+       expr.node());
+}
+
+/// \fn pow
+/// Returns the elements of a scalar, a tensor or an expression raised to the
+/// power n
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto pow(E &&expr, double n) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Pow>(
+       expr.node(), n);
+}
+
+/// \fn softmax
+/// Returns the softmax exp(x - max(x)) / sum(exp(x - max(x))) of the elements
+/// of a tensor or an expression
+template <class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto softmax(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type, functional::Softmax>(
+       expr.node());
+}
+
+/// softmax<axis>(x)
+/// Returns the softmax along an axis, the slices along the axis sum to one
+template <size_type axis, class E>
+   requires isExpr<std::remove_cvref_t<E>>
+auto softmax(E &&expr) {
+   using expr_type = std::remove_cvref_t<E>;
+   return UnaryExpr<typename expr_type::node_type,
+                    functional::SoftmaxAxis<axis>::template Func>(expr.node());
+}
+
 } // namespace ten
 
 #endif
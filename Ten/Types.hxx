@@ -8,6 +8,8 @@
 #include <type_traits>
 #include <concepts>
 
+#include <Ten/Storage/Allocator.hxx>
+
 namespace ten {
 /// \enum format
 /// Format type
@@ -16,6 +18,10 @@ enum class StorageFormat {
    Dense,
    /// Sparse coordinate format
    SparseCoo,
+   /// Compressed sparse row format
+   SparseCsr,
+   /// Compressed sparse column format
+   SparseCsc,
    /// Diagonal format
    Diagonal,
    /// Lower triangular format
@@ -52,9 +58,18 @@ class TensorBase {
 // BinaryExpr)
 template <class Derived> class Expr;
 
+// Forward declaration of the views of tensors
+template <class Tensor> class TensorView;
+
+template <class> struct isTensorView : std::false_type {};
+template <class Tensor>
+struct isTensorView<TensorView<Tensor>> : std::true_type {};
+
 // Concept for Expression type
+// A view is an expression through the tensor type it derives from.
 template <typename T>
-concept isExpr = std::is_base_of_v<::ten::Expr<T>, T>;
+concept isExpr =
+    std::is_base_of_v<::ten::Expr<T>, T> || isTensorView<T>::value;
 
 // Scalar type
 template <class T> class Scalar;
@@ -115,9 +130,26 @@ struct isStaticTensor<RankedTensor<Scalar, Shape, order, Storage, Allocator>> {
    static constexpr bool value = Shape::isStatic();
 };
 
+// A view has the traits of the tensor type it derives from
+template <class Tensor>
+struct isTensor<TensorView<Tensor>> : isTensor<Tensor> {};
+template <class Tensor>
+struct isVector<TensorView<Tensor>> : isVector<Tensor> {};
+template <class Tensor>
+struct isMatrix<TensorView<Tensor>> : isMatrix<Tensor> {};
+template <class Tensor>
+struct isDynamicTensor<TensorView<Tensor>> : isDynamicTensor<Tensor> {};
+template <class Tensor>
+struct isStaticTensor<TensorView<Tensor>> : isStaticTensor<Tensor> {};
+
 /// \typedef DefaultAllocator
-/// Default allocator type
-template <typename T> using DefaultAllocator = std::allocator<T>;
+/// Default allocator type, memory aligned to 64 bytes for the simd kernels.
+/// Defining TENSEUR_POOL_ALLOCATOR makes the pool allocator the default.
+#ifdef TENSEUR_POOL_ALLOCATOR
+template <typename T> using DefaultAllocator = PoolAllocator<T, 64>;
+#else
+template <typename T> using DefaultAllocator = AlignedAllocator<T, 64>;
+#endif
 
 // Storage
 template <class T, class Allocator> class DenseStorage;
@@ -129,11 +161,80 @@ struct isDenseStorage<DenseStorage<T, Allocator>> : std::true_type {};
 template <class T, class Allocator>
 struct isDenseStorage<StaticDenseStorage<T, Allocator>> : std::true_type {};
 
+template <class T, class Allocator> class CooStorage;
+template <class T, class Allocator, StorageFormat format>
+class CompressedStorage;
+
+/// \typedef CsrStorage
+/// Compressed sparse row storage
+template <class T, class Allocator>
+using CsrStorage = CompressedStorage<T, Allocator, StorageFormat::SparseCsr>;
+
+/// \typedef CscStorage
+/// Compressed sparse column storage
+template <class T, class Allocator>
+using CscStorage = CompressedStorage<T, Allocator, StorageFormat::SparseCsc>;
+
+// Sparse storage traits
+template <class> struct isCooStorage : std::false_type {};
+template <class T, class Allocator>
+struct isCooStorage<CooStorage<T, Allocator>> : std::true_type {};
+
+template <class> struct isCompressedStorage : std::false_type {};
+template <class T, class Allocator, StorageFormat format>
+struct isCompressedStorage<CompressedStorage<T, Allocator, format>>
+    : std::true_type {};
+
+template <class Storage>
+struct isSparseStorage
+    : std::bool_constant<isCooStorage<Storage>::value ||
+                         isCompressedStorage<Storage>::value> {};
+
+template <class T, class Allocator> class DiagonalStorage;
+template <class T, class Allocator, StorageFormat format>
+class TriangularStorage;
+
+/// \typedef LowerTrStorage
+/// Packed lower triangular storage
+template <class T, class Allocator>
+using LowerTrStorage = TriangularStorage<T, Allocator, StorageFormat::LowerTr>;
+
+/// \typedef UpperTrStorage
+/// Packed upper triangular storage
+template <class T, class Allocator>
+using UpperTrStorage = TriangularStorage<T, Allocator, StorageFormat::UpperTr>;
+
+// Structured storage traits
+template <class> struct isDiagonalStorage : std::false_type {};
+template <class T, class Allocator>
+struct isDiagonalStorage<DiagonalStorage<T, Allocator>> : std::true_type {};
+
+template <class> struct isTriangularStorage : std::false_type {};
+template <class T, class Allocator, StorageFormat format>
+struct isTriangularStorage<TriangularStorage<T, Allocator, format>>
+    : std::true_type {};
+
+template <class Storage>
+struct isStructuredStorage
+    : std::bool_constant<isDiagonalStorage<Storage>::value ||
+                         isTriangularStorage<Storage>::value> {};
+
 // Storage of static shape
 template <class> struct isStaticStorage : std::false_type {};
 template <class T, class Allocator>
 struct isStaticStorage<StaticDenseStorage<T, Allocator>> : std::true_type {};
 
+namespace details {
+// Allocator type of a storage
+template <typename Storage> struct AllocatorType {
+   using type = typename Storage::allocator_type;
+};
+template <class T, class Shape>
+struct AllocatorType<::ten::StaticDenseStorage<T, Shape>> {
+   using type = void;
+};
+} // namespace details
+
 /// \typedef DefaultStorage
 /// Default storage type
 template <class T, class Shape>
@@ -149,6 +250,26 @@ struct isDenseTensor<RankedTensor<Scalar, Shape, order, Storage, Allocator>> {
    static constexpr bool value = isDenseStorage<Storage>::value;
 };
 
+// Sparse tensor
+template <class> struct isSparseTensor : std::false_type {};
+template <class Scalar, class Shape, StorageOrder order, class Storage,
+          class Allocator>
+struct isSparseTensor<RankedTensor<Scalar, Shape, order, Storage, Allocator>> {
+   static constexpr bool value = isSparseStorage<Storage>::value;
+};
+
+// Structured tensor
+template <class> struct isStructuredTensor : std::false_type {};
+template <class Scalar, class Shape, StorageOrder order, class Storage,
+          class Allocator>
+struct isStructuredTensor<
+    RankedTensor<Scalar, Shape, order, Storage, Allocator>> {
+   static constexpr bool value = isStructuredStorage<Storage>::value;
+};
+
+template <class Tensor>
+struct isDenseTensor<TensorView<Tensor>> : isDenseTensor<Tensor> {};
+
 // Dense vector
 template <class> struct isDenseVector : std::false_type {};
 template <class Scalar, class Shape, StorageOrder order, class Storage,
@@ -167,12 +288,19 @@ struct isDenseMatrix<RankedTensor<Scalar, Shape, order, Storage, Allocator>> {
        isDenseStorage<Storage>::value && Shape::rank() == 2;
 };
 
+template <class Tensor>
+struct isDenseVector<TensorView<Tensor>> : isDenseVector<Tensor> {};
+template <class Tensor>
+struct isDenseMatrix<TensorView<Tensor>> : isDenseMatrix<Tensor> {};
+
 // Vector node
 template <class> struct isVectorNode : std::false_type {};
 template <class Scalar, class Shape, StorageOrder order, class Storage,
           class Allocator>
 struct isVectorNode<TensorNode<Scalar, Shape, order, Storage, Allocator>> {
-   static constexpr bool value = Shape::rank() == 1;
+   static constexpr bool value =
+       Shape::rank() == 1 && !isSparseStorage<Storage>::value &&
+       !isStructuredStorage<Storage>::value;
 };
 
 template <class T>
@@ -183,12 +311,30 @@ template <class> struct isMatrixNode : std::false_type {};
 template <class Scalar, class Shape, StorageOrder order, class Storage,
           class Allocator>
 struct isMatrixNode<TensorNode<Scalar, Shape, order, Storage, Allocator>> {
-   static constexpr bool value = Shape::rank() == 2;
+   static constexpr bool value =
+       Shape::rank() == 2 && !isSparseStorage<Storage>::value &&
+       !isStructuredStorage<Storage>::value;
 };
 
 template <class T>
 concept MatrixNode = isMatrixNode<T>::value;
 
+// Sparse matrix node
+template <class> struct isSparseNode : std::false_type {};
+template <class Scalar, class Shape, StorageOrder order, class Storage,
+          class Allocator>
+struct isSparseNode<TensorNode<Scalar, Shape, order, Storage, Allocator>> {
+   static constexpr bool value = isSparseStorage<Storage>::value;
+};
+
+// Diagonal or triangular matrix node
+template <class> struct isStructuredNode : std::false_type {};
+template <class Scalar, class Shape, StorageOrder order, class Storage,
+          class Allocator>
+struct isStructuredNode<TensorNode<Scalar, Shape, order, Storage, Allocator>> {
+   static constexpr bool value = isStructuredStorage<Storage>::value;
+};
+
 // Concepts
 template <class A, class B>
 concept SameShape =
@@ -263,6 +409,9 @@ template <class> struct isBinaryExpr : std::false_type {};
 template <class L, class R, template <typename...> class Func, typename... Args>
 struct isBinaryExpr<BinaryExpr<L, R, Func, Args...>> : std::true_type {};
 
+// Asynchronous evaluation of an expression
+template <class E> class Future;
+
 namespace traits {
 // Concepts
 template <typename T>
@@ -270,12 +419,49 @@ concept ScalarNode = isScalarNode<T>::value;
 
 template <typename T>
 concept TensorNode = isTensorNode<T>::value;
+
+template <typename T>
+concept SparseNode = TensorNode<T> && isSparseNode<T>::value;
+
+template <typename T>
+concept StructuredNode = TensorNode<T> && isStructuredNode<T>::value;
+
+template <typename T>
+concept DiagonalNode =
+    StructuredNode<T> && isDiagonalStorage<typename T::storage_type>::value;
+
+template <typename T>
+concept TriangularNode =
+    StructuredNode<T> && isTriangularStorage<typename T::storage_type>::value;
 } // namespace traits
 
 
 // Binary operation
 enum class BinaryOperation { add, sub, div, mul};
 
+// Reduction operation
+enum class ReduceOperation {
+   sum,
+   mean,
+   prod,
+   min,
+   max,
+   norm1,
+   norm2,
+   normInf,
+   argmin,
+   argmax,
+   var,
+   logsumexp
+};
+
+/// \enum Summation
+/// Summation algorithm of the reductions
+/// naive: simd accumulation, the error grows linearly with the size
+/// pairwise: recursive pairwise summation, the error grows with log(size)
+/// kahan: compensated summation, the error doesn't depend on the size
+enum class Summation { naive, pairwise, kahan };
+
 } // namespace ten
 
 namespace ten::stack {
@@ -291,6 +477,20 @@ static constexpr bool enableStackAlloc = TENSEUR_ENABLE_STACK_ALLOC;
 #define TENSEUR_MAX_STACK_SIZE 400
 #endif
 static constexpr size_type maxStackSize = TENSEUR_MAX_STACK_SIZE;
+
+// Maximum number of multiply adds m * n * k of the matrix products of static
+// shapes unrolled at compile time, the larger products call the BLAS
+// The vectorized kernel is unrolled up to maxUnrolledMul multiply adds, the
+// scalar one, which generates a lot more code, up to maxUnrolledScalarMul.
+#ifndef TENSEUR_MAX_UNROLLED_MUL
+#define TENSEUR_MAX_UNROLLED_MUL 4096
+#endif
+static constexpr size_type maxUnrolledMul = TENSEUR_MAX_UNROLLED_MUL;
+#ifndef TENSEUR_MAX_UNROLLED_SCALAR_MUL
+#define TENSEUR_MAX_UNROLLED_SCALAR_MUL 512
+#endif
+static constexpr size_type maxUnrolledScalarMul =
+    TENSEUR_MAX_UNROLLED_SCALAR_MUL;
 } // namespace ten::stack
 
 #endif
@@ -5,6 +5,34 @@
 #include <Eigen/Core>
 using namespace Eigen;
 
+// Small matrices of fixed size
+template <int N> void benchStatic(ankerl::nanobench::Bench &bench) {
+   Matrix<float, N, N> a, b, c;
+   Matrix<float, N, 1> x, y;
+   int k = 0;
+   for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+         a(j, i) = k;
+         b(j, i) = k;
+         k++;
+      }
+      x(i) = i;
+   }
+   std::string size = std::to_string(N) + "x" + std::to_string(N);
+   bench.run("StaticGemm" + size, [&] {
+      c.noalias() = a * b;
+      ankerl::nanobench::doNotOptimizeAway(c);
+   });
+   bench.run("StaticGemv" + size, [&] {
+      y.noalias() = a * x;
+      ankerl::nanobench::doNotOptimizeAway(y);
+   });
+   bench.run("StaticSum" + size, [&] {
+      c = a + b;
+      ankerl::nanobench::doNotOptimizeAway(c);
+   });
+}
+
 int main(int argc, char **argv) {
    if (argc > 2) {
       std::cerr << "./EigenBench [file_name]" << std::endl;
@@ -46,6 +74,13 @@ int main(int argc, char **argv) {
       bench.run("Mul2", [&] { MatrixXf d = a.array() * b.array(); });
    }
 
+   // Fixed sizes
+   benchStatic<2>(bench);
+   benchStatic<3>(bench);
+   benchStatic<4>(bench);
+   benchStatic<8>(bench);
+   benchStatic<16>(bench);
+
    std::ofstream file(fileName + ".csv");
    ankerl::nanobench::render(ankerl::nanobench::templates::csv(), bench, file);
 
@@ -4,6 +4,29 @@
 
 #include <Ten/Tensor>
 
+// Small matrices of static shape
+template <size_t N> void benchStatic(ankerl::nanobench::Bench &bench) {
+   using namespace ten;
+   auto a = iota<SMatrix<float, N, N>>();
+   auto b = iota<SMatrix<float, N, N>>();
+   auto x = iota<SVector<float, N>>();
+   SMatrix<float, N, N> c;
+   SVector<float, N> y;
+   std::string size = std::to_string(N) + "x" + std::to_string(N);
+   bench.run("StaticGemm" + size, [&] {
+      c = a * b;
+      ankerl::nanobench::doNotOptimizeAway(c);
+   });
+   bench.run("StaticGemv" + size, [&] {
+      y = a * x;
+      ankerl::nanobench::doNotOptimizeAway(y);
+   });
+   bench.run("StaticSum" + size, [&] {
+      c = a + b;
+      ankerl::nanobench::doNotOptimizeAway(c);
+   });
+}
+
 int main(int argc, char **argv) {
    if (argc > 2) {
       std::cerr << "./TenseurBench [file_name]" << std::endl;
@@ -77,6 +100,13 @@ int main(int argc, char **argv) {
       });
    }
 
+   // Static shapes
+   benchStatic<2>(bench);
+   benchStatic<3>(bench);
+   benchStatic<4>(bench);
+   benchStatic<8>(bench);
+   benchStatic<16>(bench);
+
    std::ofstream file(fileName + ".csv");
    ankerl::nanobench::render(ankerl::nanobench::templates::csv(), bench, file);
 
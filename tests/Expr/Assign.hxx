@@ -0,0 +1,79 @@
+#ifndef TENSEUR_TESTS_EXPR_ASSIGN
+#define TENSEUR_TESTS_EXPR_ASSIGN
+
+#include <Ten/Tensor.hxx>
+#include <Ten/Tests.hxx>
+
+#include "Ref.hxx"
+
+using namespace ten;
+
+TEST(Assign, EvalIntoDestination) {
+   size_t size = 10;
+   Vector<float> a = iota<float>({size});
+   Vector<float> b = iota<float>({size});
+   Vector<float> c = zeros<Vector<float>>({size});
+   const float *data = c.data();
+   c = a + b;
+
+   ASSERT_EQ(c.data(), data);
+   ASSERT_TRUE(tests::equal(c, tests::add(a, b)));
+}
+
+TEST(Assign, SharedDestination) {
+   size_t size = 10;
+   Vector<float> a = iota<float>({size});
+   Vector<float> c = zeros<Vector<float>>({size});
+   Vector<float> d = c;
+   c = a * a;
+
+   ASSERT_NE(c.data(), d.data());
+   ASSERT_EQ(d[1], 0.f);
+   ASSERT_TRUE(tests::equal(c, tests::mul(a, a)));
+}
+
+TEST(Assign, ShapeMismatch) {
+   Vector<float> a = iota<float>({10});
+   Vector<float> c = zeros<Vector<float>>({5});
+   c = a - a;
+
+   ASSERT_EQ(c.size(), 10);
+}
+
+TEST(Assign, AliasedOutput) {
+   size_t n = 100;
+   Matrix<float> x = iota<Matrix<float>>({n, n});
+   Matrix<float> ref = iota<Matrix<float>>({n, n});
+   // Read through the transposed strides of the output
+   auto e = x + transpose(x);
+   Matrix<float> y = e.eval(x.node());
+   ASSERT_NE(y.data(), x.data());
+   for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_EQ(y(i, j), ref(i, j) + ref(j, i));
+         ASSERT_EQ(x(i, j), ref(i, j));
+      }
+   }
+   // Broadcasted row and shifted slice of the output
+   auto b = x + x.row(0);
+   Matrix<float> z = b.eval(x.node());
+   auto shifted = x.slice({{1, n}, {1, n}});
+   auto t = x.slice({{0, n - 1}, {0, n - 1}});
+   auto c = 2.f * shifted;
+   Matrix<float> w = c.eval(t.node());
+   ASSERT_NE(z.data(), x.data());
+   ASSERT_NE(w.data(), t.data());
+   for (size_t i = 0; i + 1 < n; i++) {
+      for (size_t j = 0; j + 1 < n; j++) {
+         ASSERT_EQ(z(i, j), ref(i, j) + ref(0, j));
+         ASSERT_EQ(w(i, j), 2.f * ref(i + 1, j + 1));
+      }
+   }
+   // The output read at the position it's written to is used
+   auto d = x + x;
+   Matrix<float> u = d.eval(x.node());
+   ASSERT_EQ(u.data(), x.data());
+   ASSERT_EQ(x(3, 7), 2.f * ref(3, 7));
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TENSEUR_TESTS_EXPR_ASYNC
+#define TENSEUR_TESTS_EXPR_ASYNC
+
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Async, IndependentProducts) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t n = 64;
+   Matrix<double> a({n, n});
+   Matrix<double> b({n, n});
+   Matrix<double> c({n, n});
+   Matrix<double> d({n, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = double(i % 7);
+      b[i] = double(i % 5) - 2.;
+      c[i] = double(i % 3);
+      d[i] = 1. / double(1 + i % 11);
+   }
+   Matrix<double> ref = (a * b) + 2. * (c * d);
+
+   auto future = ((a * b) + 2. * (c * d)).evalAsync();
+   Matrix<double> x = future.get();
+   ASSERT_TRUE(future.ready());
+   for (size_t i = 0; i < ref.size(); i++) {
+      ASSERT_DOUBLE_EQ(x[i], ref[i]);
+   }
+
+   // Reductions of independent subexpressions
+   auto s = evalAsync(sum<0>(a * b) + sum<0>(exp(c)));
+   Vector<double> y = s.get();
+   Vector<double> sab = sum<0>(a * b);
+   Vector<double> sc = sum<0>(exp(c));
+   for (size_t j = 0; j < n; j++) {
+      ASSERT_DOUBLE_EQ(y[j], sab[j] + sc[j]);
+   }
+
+   // A single node is evaluated by evalAsync, its kernels use every thread
+   auto p = (a * b).evalAsync();
+   ASSERT_TRUE(p.ready());
+   Matrix<double> z = p.get();
+   Matrix<double> ab = a * b;
+   for (size_t i = 0; i < ab.size(); i++) {
+      ASSERT_DOUBLE_EQ(z[i], ab[i]);
+   }
+}
+
+TEST(Async, SharedNodes) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t n = 32;
+   Matrix<float> a = iota<Matrix<float>>({n, n});
+   Matrix<float> b = fill<Matrix<float>>({n, n}, 0.5f);
+   auto m = a * b;
+   auto e = (m + m) - transpose(m);
+   Matrix<float> x = e.evalAsync().get();
+   ASSERT_TRUE(m.evaluated());
+   Matrix<float> p = m.value();
+   for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_FLOAT_EQ(x(i, j), 2.f * p(i, j) - p(j, i));
+      }
+   }
+   // An evaluated expression is ready
+   auto f = e.evalAsync();
+   ASSERT_TRUE(f.ready());
+   ASSERT_EQ(f.get().data(), x.data());
+}
+
+TEST(Async, Exception) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   Matrix<float> a = fill<Matrix<float>>({8, 8}, 1.f);
+   Matrix<float> b = fill<Matrix<float>>({5, 5}, 1.f);
+   auto future = ((a * a) + sqrt(b)).evalAsync();
+   ASSERT_THROW(future.get(), std::invalid_argument);
+   // Also thrown by get() when evaluated by evalAsync
+   auto single = (a + b).evalAsync();
+   ASSERT_THROW(single.get(), std::invalid_argument);
+
+   // Without worker threads the expression is evaluated by evalAsync
+   setNumThreads(1);
+   auto g = (a * a + a).evalAsync();
+   ASSERT_TRUE(g.ready());
+   Matrix<float> c = g.get();
+   ASSERT_FLOAT_EQ(c(3, 4), 9.f);
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef TENSEUR_TESTS_BINARY_OPS_ADD
 #define TENSEUR_TESTS_BINARY_OPS_ADD
 
+#include <complex>
+#include <cstdint>
+
 #include <Ten/Tensor.hxx>
 #include <Ten/Tests.hxx>
 
@@ -54,4 +57,47 @@ TEST(Div, DenseVector_DenseVector) {
    ASSERT_TRUE(tests::equal(c, c_ref));
 }
 
+template <typename> class BinaryOpsKernel : public ::testing::Test {};
+TYPED_TEST_SUITE_P(BinaryOpsKernel);
+
+TYPED_TEST_P(BinaryOpsKernel, AllSizes) {
+   using T = TypeParam;
+   // Sizes around the simd vector length to cover the head and the tail
+   for (size_t size = 1; size < 4 * simdVecLen<T> + 3; size++) {
+      Vector<T> a = iota<Vector<T>>({size});
+      Vector<T> b = fill<Vector<T>>({size}, T(2));
+      Vector<T> c(size);
+      kernels::binaryOps<BinaryOperation::add>(*a.node(), *b.node(),
+                                               *c.node());
+      ASSERT_TRUE(tests::equal(c, tests::add(a, b)));
+      kernels::binaryOps<BinaryOperation::div>(*a.node(), *b.node(),
+                                               *c.node());
+      ASSERT_TRUE(tests::equal(c, tests::div(a, b)));
+      Vector<T> d = a * b - a;
+      ASSERT_TRUE(tests::equal(d, a));
+   }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(BinaryOpsKernel, AllSizes);
+using binaryOpsTypes = ::testing::Types<float, double, int32_t, int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(BinaryOps, BinaryOpsKernel, binaryOpsTypes);
+
+TEST(Mul, ComplexVector) {
+   using T = std::complex<double>;
+   size_t size = 7;
+   Vector<T> a(size);
+   Vector<T> b(size);
+   for (size_t i = 0; i < size; i++) {
+      a[i] = T(i, 1.);
+      b[i] = T(2., -double(i));
+   }
+   Vector<T> c(size);
+   kernels::binaryOps<BinaryOperation::mul>(*a.node(), *b.node(), *c.node());
+   Vector<T> d = a + b;
+   for (size_t i = 0; i < size; i++) {
+      ASSERT_NEAR(std::abs(c[i] - a[i] * b[i]), 0., 1e-12);
+      ASSERT_NEAR(std::abs(d[i] - (a[i] + b[i])), 0., 1e-12);
+   }
+}
+
 #endif
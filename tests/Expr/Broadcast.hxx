@@ -0,0 +1,110 @@
+#ifndef TENSEUR_TESTS_EXPR_BROADCAST
+#define TENSEUR_TESTS_EXPR_BROADCAST
+
+#include <stdexcept>
+
+#include <Ten/Tensor.hxx>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Broadcast, MatrixRow) {
+   size_t m = 13;
+   size_t n = 7;
+   Matrix<float> a({m, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i);
+   }
+   // A vector is aligned with the last dimension
+   Vector<float> v = iota<float>({n});
+   Matrix<float> b = a + v;
+   Matrix<float> c = v * a;
+   ASSERT_EQ(b.dim(0), m);
+   ASSERT_EQ(b.dim(1), n);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_EQ(b(i, j), a(i, j) + v[j]);
+         ASSERT_EQ(c(i, j), v[j] * a(i, j));
+      }
+   }
+}
+
+TEST(Broadcast, MatrixColumn) {
+   size_t m = 21;
+   size_t n = 5;
+   Matrix<double> a({m, n});
+   Matrix<double> bias({m, 1});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = double(i);
+   }
+   for (size_t i = 0; i < m; i++) {
+      bias[i] = double(i + 1);
+   }
+   Matrix<double> b = a / bias - bias;
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_DOUBLE_EQ(b(i, j), a(i, j) / bias[i] - bias[i]);
+      }
+   }
+
+   // Outer sum of a column and a row
+   Matrix<double> r({1, n});
+   for (size_t j = 0; j < n; j++) {
+      r[j] = double(10 * j);
+   }
+   Matrix<double> o = bias + r;
+   ASSERT_EQ(o.dim(0), m);
+   ASSERT_EQ(o.dim(1), n);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_EQ(o(i, j), bias[i] + r[j]);
+      }
+   }
+}
+
+TEST(Broadcast, Rank3) {
+   Tensor<float, 3> a({4, 3, 6});
+   Matrix<float> b({3, 6});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i);
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = float(2 * i);
+   }
+   Tensor<float, 3> c = a - b;
+   for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 3; j++) {
+         for (size_t k = 0; k < 6; k++) {
+            ASSERT_EQ(c(i, j, k), a(i, j, k) - b(j, k));
+         }
+      }
+   }
+}
+
+TEST(Broadcast, StaticShape) {
+   StaticMatrix<float, 3, 4> a;
+   StaticVector<float, 4> v;
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i);
+   }
+   for (size_t i = 0; i < v.size(); i++) {
+      v[i] = float(i + 1);
+   }
+   auto e = a + v;
+   static_assert(
+       std::is_same_v<decltype(e.eval()), StaticMatrix<float, 3, 4>>);
+   StaticMatrix<float, 3, 4> b = e;
+   for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 4; j++) {
+         ASSERT_EQ(b(i, j), a(i, j) + v[j]);
+      }
+   }
+}
+
+TEST(Broadcast, Incompatible) {
+   Matrix<float> a({4, 3});
+   Vector<float> v({4});
+   ASSERT_THROW((a + v).eval(), std::invalid_argument);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef TENSEUR_TESTS_EXPR_CONTRACT
+#define TENSEUR_TESTS_EXPR_CONTRACT
+
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Contract, MatrixProduct) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   // Large enough for the gemm path, the operands are read as matrices
+   size_t m = 12, p = 9, k = 40, n = 15;
+   Tensor<double, 3> a({m, p, k});
+   Matrix<double> b({k, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = double(i % 7) - 3.;
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = double(i % 5) * 0.5;
+   }
+   Tensor<double, 3> c = contract<"ijk,kl->ijl">(a, b);
+   // The permuted result is scattered back
+   Tensor<double, 3> d = contract<"ijk,kl->lji">(a, b);
+   ASSERT_EQ(c.dim(0), m);
+   ASSERT_EQ(c.dim(1), p);
+   ASSERT_EQ(c.dim(2), n);
+   ASSERT_EQ(d.dim(0), n);
+   ASSERT_EQ(d.dim(2), m);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < p; j++) {
+         for (size_t l = 0; l < n; l++) {
+            double s = 0.;
+            for (size_t q = 0; q < k; q++) {
+               s += a(i, j, q) * b(q, l);
+            }
+            ASSERT_DOUBLE_EQ(c(i, j, l), s);
+            ASSERT_DOUBLE_EQ(d(l, j, i), s);
+         }
+      }
+   }
+}
+
+TEST(Contract, Batch) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t b = 6, m = 20, k = 24, n = 18;
+   using tensor_type = Tensor<float, 3, StorageOrder::RowMajor>;
+   tensor_type x({b, m, k});
+   tensor_type y({b, n, k});
+   for (size_t i = 0; i < x.size(); i++) {
+      x[i] = float(i % 11) - 5.f;
+   }
+   for (size_t i = 0; i < y.size(); i++) {
+      y[i] = float(i % 3) * 0.25f;
+   }
+   // Batch index in the middle of the result, contracted index is the last one
+   tensor_type z = contract<"bmk,bnk->mbn">(x, y);
+   // Small contraction evaluated by the direct loop
+   Tensor<float, 2, StorageOrder::RowMajor> w =
+       contract<"bmk,bmk->bm">(x, x);
+   for (size_t p = 0; p < b; p++) {
+      for (size_t i = 0; i < m; i++) {
+         for (size_t j = 0; j < n; j++) {
+            float s = 0.f;
+            for (size_t q = 0; q < k; q++) {
+               s += x(p, i, q) * y(p, j, q);
+            }
+            ASSERT_FLOAT_EQ(z(i, p, j), s);
+         }
+         float t = 0.f;
+         for (size_t q = 0; q < k; q++) {
+            t += x(p, i, q) * x(p, i, q);
+         }
+         ASSERT_FLOAT_EQ(w(p, i), t);
+      }
+   }
+}
+
+TEST(Contract, Implicit) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t n = 5;
+   Matrix<double> a = iota<Matrix<double>>({n, n});
+   Matrix<double> b = fill<Matrix<double>>({n, n}, 0.5);
+   Matrix<double> c = fill<Matrix<double>>({n, n}, 2.);
+
+   // Trace and diagonal
+   Scalar<double> trace = contract<"ii->">(a);
+   Vector<double> diag = contract<"ii->i">(a);
+   double t = 0.;
+   for (size_t i = 0; i < n; i++) {
+      t += a(i, i);
+      ASSERT_DOUBLE_EQ(diag[i], a(i, i));
+   }
+   ASSERT_DOUBLE_EQ(trace.value(), t);
+
+   // Without "->" the result has the indices appearing once
+   Matrix<double> ab = a * b;
+   Matrix<double> x = contract<"ij,jk">(a, b);
+   Matrix<double> y = contract<"jk,ij">(b, a);
+   // Chain of three operands and operand expression
+   Matrix<double> z = contract<"ij,jk,kl->il">(a, b, c);
+   Matrix<double> e = contract<"ij,jk->ik">(a + a, b);
+   Matrix<double> abc = ab * c;
+   for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_DOUBLE_EQ(x(i, j), ab(i, j));
+         ASSERT_DOUBLE_EQ(y(i, j), ab(i, j));
+         ASSERT_DOUBLE_EQ(z(i, j), abc(i, j));
+         ASSERT_DOUBLE_EQ(e(i, j), 2. * ab(i, j));
+      }
+   }
+
+   // Sum over all the indices
+   Scalar<double> s = contract<"ij->">(b);
+   ASSERT_DOUBLE_EQ(s.value(), 0.5 * double(n * n));
+
+   Matrix<double> d({n + 1, n});
+   ASSERT_THROW(contract<"ij,jk">(a, d), std::invalid_argument);
+   ASSERT_THROW(contract<"ii">(d), std::invalid_argument);
+}
+
+#endif
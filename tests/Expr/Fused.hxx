@@ -0,0 +1,56 @@
+#ifndef TENSEUR_TESTS_EXPR_FUSED
+#define TENSEUR_TESTS_EXPR_FUSED
+
+#include <cmath>
+
+#include <Ten/Tensor.hxx>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Fused, ChainElementwise) {
+   size_t size = 23;
+   Vector<float> a = iota<float>({size});
+   Vector<float> b = iota<float>({size});
+   Vector<float> c = fill<float, 1>({size}, 2.f);
+   Vector<float> d = fill<float, 1>({size}, 1.f);
+   Vector<float> e = sqrt(a + b * c) - d;
+
+   Vector<float> e_ref(size);
+   for (size_t i = 0; i < size; i++) {
+      e_ref[i] = std::sqrt(a[i] + b[i] * c[i]) - d[i];
+   }
+   ASSERT_TRUE(tests::equal(e, e_ref));
+}
+
+TEST(Fused, NoIntermediateEvaluation) {
+   size_t size = 10;
+   Vector<float> a = iota<float>({size});
+   Vector<float> b = iota<float>({size});
+   auto c = a + b;
+   auto d = sqrt(c * a);
+   d.eval();
+   ASSERT_TRUE(d.evaluated());
+   ASSERT_FALSE(c.evaluated());
+}
+
+TEST(Fused, ScalarBroadcast) {
+   size_t size = 11;
+   Vector<double> a = iota<double>({size});
+   Vector<double> b = abs(2. * a - a * a);
+
+   Vector<double> b_ref(size);
+   for (size_t i = 0; i < size; i++) {
+      b_ref[i] = std::abs(2. * a[i] - a[i] * a[i]);
+   }
+   ASSERT_TRUE(tests::equal(b, b_ref));
+}
+
+TEST(Fused, StaticVector) {
+   auto a = iota<StaticVector<float, 5>>();
+   auto b = iota<StaticVector<float, 5>>();
+   StaticVector<float, 5> c = sqrt(a * b);
+   ASSERT_TRUE(tests::same_values(c, a));
+}
+
+#endif
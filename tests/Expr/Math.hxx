@@ -0,0 +1,239 @@
+#ifndef TENSEUR_TESTS_EXPR_MATH
+#define TENSEUR_TESTS_EXPR_MATH
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+// Distance in units in the last place between x and the reference y
+template <class T> double ulp(T x, long double y) {
+   T ref = static_cast<T>(y);
+   T spacing = std::nextafter(std::abs(ref), std::numeric_limits<T>::max()) -
+               std::abs(ref);
+   if (spacing == T(0) || !std::isfinite(spacing)) {
+      spacing = std::numeric_limits<T>::denorm_min();
+   }
+   return double(std::abs(static_cast<long double>(x) - y) / spacing);
+}
+
+// Maximum error in ulp of f against ref over n points of [lo, hi]
+template <class T, class F, class G>
+double maxUlp(F f, G ref, T lo, T hi, size_t n = 4099) {
+   Vector<T> x({n});
+   for (size_t i = 0; i < n; i++) {
+      x[i] = lo + (hi - lo) * T(i) / T(n - 1);
+   }
+   Vector<T> y = f(x);
+   double err = 0.;
+   for (size_t i = 0; i < n; i++) {
+      err = std::max(err, ulp(y[i], ref(static_cast<long double>(x[i]))));
+   }
+   return err;
+}
+} // namespace
+
+TEST(Math, Accuracy) {
+   auto expf = [](const auto &x) { return exp(x); };
+   auto logf = [](const auto &x) { return log(x); };
+   auto log1pf = [](const auto &x) { return log1p(x); };
+   auto tanhf = [](const auto &x) { return tanh(x); };
+   auto erff = [](const auto &x) { return erf(x); };
+   auto sigmoidf = [](const auto &x) { return sigmoid(x); };
+   auto sigmoidRef = [](long double x) { return 1.L / (1.L + std::exp(-x)); };
+
+   ASSERT_LE(maxUlp<float>(expf, [](long double x) { return std::exp(x); },
+                           -80.f, 80.f),
+             1.);
+   ASSERT_LE(maxUlp<double>(expf, [](long double x) { return std::exp(x); },
+                            -700., 700.),
+             1.);
+   ASSERT_LE(maxUlp<float>(logf, [](long double x) { return std::log(x); },
+                           1e-30f, 1e30f),
+             1.);
+   ASSERT_LE(maxUlp<double>(logf, [](long double x) { return std::log(x); },
+                            1e-300, 1e300),
+             1.);
+   ASSERT_LE(maxUlp<float>(log1pf,
+                           [](long double x) { return std::log1p(x); }, -0.9f,
+                           10.f),
+             3.);
+   ASSERT_LE(maxUlp<double>(tanhf, [](long double x) { return std::tanh(x); },
+                            -20., 20.),
+             3.);
+   ASSERT_LE(maxUlp<float>(sigmoidf, sigmoidRef, -80.f, 80.f), 3.);
+   ASSERT_LE(maxUlp<float>(erff, [](long double x) { return std::erf(x); },
+                           -5.f, 5.f),
+             1.);
+   ASSERT_LE(maxUlp<double>(erff, [](long double x) { return std::erf(x); },
+                            -7., 7.),
+             1.);
+}
+
+TEST(Math, SpecialValues) {
+   Vector<float> x({4});
+   x[0] = 0.f;
+   x[1] = std::numeric_limits<float>::infinity();
+   x[2] = -std::numeric_limits<float>::infinity();
+   x[3] = std::numeric_limits<float>::quiet_NaN();
+   Vector<float> e = exp(x);
+   Vector<float> l = log(x);
+   Vector<float> t = tanh(x);
+   Vector<float> s = sigmoid(x);
+   ASSERT_EQ(e[0], 1.f);
+   ASSERT_TRUE(std::isinf(e[1]));
+   ASSERT_EQ(e[2], 0.f);
+   ASSERT_TRUE(std::isnan(e[3]));
+   ASSERT_TRUE(std::isinf(l[0]) && l[0] < 0.f);
+   ASSERT_TRUE(std::isinf(l[1]));
+   ASSERT_TRUE(std::isnan(l[2]));
+   ASSERT_EQ(t[1], 1.f);
+   ASSERT_EQ(t[2], -1.f);
+   ASSERT_EQ(s[0], 0.5f);
+   ASSERT_EQ(s[1], 1.f);
+   ASSERT_EQ(s[2], 0.f);
+}
+
+TEST(Math, Fused) {
+   size_t n = 1001;
+   Vector<double> a({n});
+   for (size_t i = 0; i < n; i++) {
+      a[i] = double(i) / double(n) - 0.5;
+   }
+   Vector<double> b = 2. * exp(a) + tanh(sigmoid(a) - a);
+   Vector<double> c = log(2. * exp(a)) - log1p(exp(a) - exp(a)) - a;
+   for (size_t i = 0; i < n; i++) {
+      double x = a[i];
+      double s = 1. / (1. + std::exp(-x));
+      ASSERT_NEAR(b[i], 2. * std::exp(x) + std::tanh(s - x), 1e-14);
+      ASSERT_NEAR(c[i], std::log(2.), 1e-15);
+   }
+}
+
+TEST(Math, Pow) {
+   size_t n = 257;
+   Vector<float> a({n});
+   Vector<double> b({n});
+   for (size_t i = 0; i < n; i++) {
+      a[i] = 0.1f + float(i) / 16.f;
+      b[i] = double(i) / 8. - 16.;
+   }
+   Vector<float> c = pow(a, 2.5);
+   Vector<float> d = pow(2.f * a, -0.3);
+   Vector<double> e = pow(b, 3.);
+   Vector<double> f = pow(b, -2.);
+   for (size_t i = 0; i < n; i++) {
+      ASSERT_LE(ulp(c[i], std::pow(static_cast<long double>(a[i]), 2.5L)), 1.);
+      ASSERT_FLOAT_EQ(d[i], std::pow(2.f * a[i], -0.3f));
+      ASSERT_DOUBLE_EQ(e[i], b[i] * b[i] * b[i]);
+      if (b[i] != 0.) {
+         ASSERT_DOUBLE_EQ(f[i], 1. / (b[i] * b[i]));
+      }
+   }
+   Vector<double> g = pow(b, 0.5);
+   ASSERT_TRUE(std::isnan(g[0]));
+   ASSERT_DOUBLE_EQ(g[n - 1], std::sqrt(b[n - 1]));
+   // Large results of non integer exponents are as accurate as std::pow
+   const double y = 30.7;
+   double err = maxUlp<double>(
+       [&](const auto &x) { return pow(x, y); },
+       [&](long double x) { return std::pow(x, static_cast<long double>(y)); },
+       1., 1e9);
+   ASSERT_LE(err, 1.);
+}
+
+TEST(Math, Softmax) {
+   size_t m = 37, n = 53;
+   Matrix<float> a({m, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      // Large values would overflow exp(x)
+      a[i] = float((i * 13) % 17) * 100.f;
+   }
+   Matrix<float> rows = softmax<1>(a);
+   Matrix<float> cols = softmax<0>(a);
+   Matrix<float> all = softmax(a);
+   for (size_t i = 0; i < m; i++) {
+      float mx = a(i, 0);
+      for (size_t j = 0; j < n; j++) {
+         mx = std::max(mx, a(i, j));
+      }
+      double s = 0.;
+      for (size_t j = 0; j < n; j++) {
+         double ref = std::exp(double(a(i, j) - mx));
+         double total = 0.;
+         for (size_t k = 0; k < n; k++) {
+            total += std::exp(double(a(i, k) - mx));
+         }
+         ASSERT_NEAR(rows(i, j), ref / total, 1e-6);
+         s += rows(i, j);
+      }
+      ASSERT_NEAR(s, 1., 1e-5);
+   }
+   for (size_t j = 0; j < n; j++) {
+      double s = 0.;
+      for (size_t i = 0; i < m; i++) {
+         ASSERT_TRUE(std::isfinite(cols(i, j)));
+         s += cols(i, j);
+      }
+      ASSERT_NEAR(s, 1., 1e-5);
+   }
+   double s = 0.;
+   for (size_t i = 0; i < all.size(); i++) {
+      s += all[i];
+   }
+   ASSERT_NEAR(s, 1., 1e-5);
+
+   // Static tensors and expressions
+   auto x = iota<STensor<double, 2, 3, 4>>();
+   auto y = softmax<1>(2. * x).eval();
+   for (size_t i = 0; i < 2; i++) {
+      for (size_t k = 0; k < 4; k++) {
+         ASSERT_NEAR(y(i, 0, k) + y(i, 1, k) + y(i, 2, k), 1., 1e-14);
+      }
+   }
+}
+
+TEST(Math, LogSumExp) {
+   size_t m = 37, n = 53;
+   Matrix<double> a({m, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = double((i * 13) % 17) * 100.;
+   }
+   for (auto method : {Summation::naive, Summation::pairwise, Summation::kahan}) {
+      Vector<double> rows = logsumexp<1>(a, method);
+      Vector<double> cols = logsumexp<0>(a, method);
+      for (size_t i = 0; i < m; i++) {
+         double mx = a(i, 0);
+         for (size_t j = 0; j < n; j++) {
+            mx = std::max(mx, a(i, j));
+         }
+         double s = 0.;
+         for (size_t j = 0; j < n; j++) {
+            s += std::exp(a(i, j) - mx);
+         }
+         ASSERT_NEAR(rows[i], mx + std::log(s), 1e-12 * mx);
+      }
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_TRUE(std::isfinite(cols[j]));
+      }
+   }
+   Scalar<double> all = logsumexp(a);
+   ASSERT_NEAR(all.value(), 1600. + std::log(double(std::count_if(
+                                        a.data(), a.data() + a.size(),
+                                        [](double x) { return x == 1600.; }))),
+               1e-9);
+
+   Vector<float> inf({3});
+   inf[0] = 1.f;
+   inf[1] = std::numeric_limits<float>::infinity();
+   inf[2] = 2.f;
+   Scalar<float> r = logsumexp(inf);
+   ASSERT_TRUE(std::isinf(r.value()));
+}
+
+#endif
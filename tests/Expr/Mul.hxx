@@ -0,0 +1,371 @@
+#ifndef TENSEUR_TESTS_EXPR_MUL
+#define TENSEUR_TESTS_EXPR_MUL
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+template <typename> class Gemm : public ::testing::Test {};
+TYPED_TEST_SUITE_P(Gemm);
+
+TYPED_TEST_P(Gemm, MatrixMatrix) {
+   using T = TypeParam;
+   size_t m = 7, k = 5, n = 3;
+   Matrix<T> a({m, k});
+   Matrix<T> b({k, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = T(i % 5) - T(2);
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = T(i % 3) + T(1);
+   }
+   Matrix<T> c = a * b;
+   ASSERT_EQ(c.dim(0), m);
+   ASSERT_EQ(c.dim(1), n);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         T s = T(0);
+         for (size_t l = 0; l < k; l++) {
+            s += a(i, l) * b(l, j);
+         }
+         ASSERT_EQ(c(i, j), s);
+      }
+   }
+}
+
+TYPED_TEST_P(Gemm, MatrixVector) {
+   using T = TypeParam;
+   size_t m = 9, n = 4;
+   Matrix<T> a({m, n});
+   Vector<T> x({n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = T(i % 7) - T(3);
+   }
+   for (size_t i = 0; i < n; i++) {
+      x[i] = T(i) + T(1);
+   }
+   Vector<T> y = a * x;
+   ASSERT_EQ(y.size(), m);
+   for (size_t i = 0; i < m; i++) {
+      T s = T(0);
+      for (size_t j = 0; j < n; j++) {
+         s += a(i, j) * x[j];
+      }
+      ASSERT_EQ(y[i], s);
+   }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(Gemm, MatrixMatrix, MatrixVector);
+using GemmTypes = ::testing::Types<float, double, std::complex<float>,
+                                   std::complex<double>>;
+INSTANTIATE_TYPED_TEST_SUITE_P(Blas, Gemm, GemmTypes);
+
+template <typename> class NativeGemm : public ::testing::Test {};
+TYPED_TEST_SUITE_P(NativeGemm);
+
+// Tolerance of the native kernels, relative to the number of terms
+template <class T> double nativeTolerance(size_t k) {
+   if constexpr (std::is_integral_v<T>) {
+      return 0.;
+   } else {
+      return 1e-5 * double(k);
+   }
+}
+
+TYPED_TEST_P(NativeGemm, Transposes) {
+   using T = TypeParam;
+   using kernels::blas::transop;
+   // k spans two blocks of the kernel, m and n leave partial tiles
+   size_t m = 37, n = 29, k = 419;
+   std::vector<T> a(m * k), b(k * n), c(m * n);
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = T(int(i % 7) - 3);
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = T(int(i % 5) - 1);
+   }
+   for (auto transa : {transop::no, transop::trans}) {
+      for (auto transb : {transop::no, transop::trans}) {
+         size_t lda = (transa == transop::no ? m : k);
+         size_t ldb = (transb == transop::no ? k : n);
+         std::fill(c.begin(), c.end(), T(1));
+         kernels::native::gemm(transa, transb, m, n, k, T(2), a.data(), lda,
+                               b.data(), ldb, T(3), c.data(), m);
+         for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < n; j++) {
+               T s = T(0);
+               for (size_t l = 0; l < k; l++) {
+                  T x = (transa == transop::no ? a[i + l * lda] : a[l + i * lda]);
+                  T y = (transb == transop::no ? b[l + j * ldb] : b[j + l * ldb]);
+                  s += x * y;
+               }
+               s = T(2) * s + T(3);
+               ASSERT_LE(std::abs(c[i + j * m] - s), nativeTolerance<T>(k));
+            }
+         }
+      }
+   }
+}
+
+TYPED_TEST_P(NativeGemm, Gemv) {
+   using T = TypeParam;
+   using kernels::blas::transop;
+   size_t m = 53, n = 21;
+   std::vector<T> a(m * n), x(m), y(m);
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = T(int(i % 9) - 4);
+   }
+   for (size_t i = 0; i < m; i++) {
+      x[i] = T(int(i % 4) + 1);
+   }
+   for (auto trans : {transop::no, transop::trans}) {
+      size_t ny = (trans == transop::no ? m : n);
+      std::fill(y.begin(), y.end(), T(1));
+      kernels::native::gemv(trans, m, n, T(1), a.data(), m, x.data(), 1, T(2),
+                            y.data(), 1);
+      for (size_t i = 0; i < ny; i++) {
+         T s = T(2);
+         size_t nx = (trans == transop::no ? n : m);
+         for (size_t j = 0; j < nx; j++) {
+            s += (trans == transop::no ? a[i + j * m] : a[j + i * m]) * x[j];
+         }
+         ASSERT_LE(std::abs(y[i] - s), nativeTolerance<T>(nx));
+      }
+   }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(NativeGemm, Transposes, Gemv);
+using NativeGemmTypes = ::testing::Types<float, double, int32_t,
+                                         std::complex<double>>;
+INSTANTIATE_TYPED_TEST_SUITE_P(Native, NativeGemm, NativeGemmTypes);
+
+// Reference product of column major or row major matrices
+template <class A, class B>
+static std::vector<float> referenceMul(const A &a, const B &b, size_t m,
+                                       size_t n, size_t k) {
+   std::vector<float> c(m * n, 0.f);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         for (size_t l = 0; l < k; l++) {
+            c[i + j * m] += a(i, l) * b(l, j);
+         }
+      }
+   }
+   return c;
+}
+
+TEST(StaticMul, Orders) {
+   using col = SMatrix<float, 3, 5>;
+   using row = SMatrix<float, 3, 5, StorageOrder::RowMajor>;
+   auto a = iota<col>();
+   row ar;
+   for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 5; j++) {
+         ar(i, j) = a(i, j);
+      }
+   }
+   auto b = iota<SMatrix<float, 5, 4>>(1.f);
+   auto ref = referenceMul(a, b, 3, 4, 5);
+   SMatrix<float, 3, 4> c = a * b;
+   SMatrix<float, 3, 4, StorageOrder::RowMajor> d = ar * b;
+   for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 4; j++) {
+         ASSERT_FLOAT_EQ(c(i, j), ref[i + j * 3]);
+         ASSERT_FLOAT_EQ(d(i, j), ref[i + j * 3]);
+      }
+   }
+   // Matrix vector product and chained products
+   auto x = iota<SVector<float, 4>>();
+   SVector<float, 3> y = a * b * x;
+   for (size_t i = 0; i < 3; i++) {
+      float s = 0.f;
+      for (size_t j = 0; j < 4; j++) {
+         s += c(i, j) * x[j];
+      }
+      ASSERT_FLOAT_EQ(y[i], s);
+   }
+}
+
+TEST(StaticMul, ValueExpr) {
+   auto a = iota<SMatrix<float, 4, 4>>();
+   auto b = fill<SMatrix<float, 4, 4>>(0.5f);
+   auto e = a * b + a;
+   static_assert(stack::isValueExpr<decltype(e)>::value);
+   SMatrix<float, 4, 4> c = e;
+   auto ref = referenceMul(a, b, 4, 4, 4);
+   for (size_t i = 0; i < 16; i++) {
+      ASSERT_FLOAT_EQ(c[i], ref[i] + a[i]);
+   }
+   // The product may be assigned to one of its operands
+   a = a * b;
+   for (size_t i = 0; i < 16; i++) {
+      ASSERT_FLOAT_EQ(a[i], ref[i]);
+   }
+}
+
+TEST(StaticMul, Large) {
+   // Above the unrolling threshold, the product goes through kernels::mul
+   auto a = fill<SMatrix<double, 20, 20>>(1.);
+   auto b = iota<SMatrix<double, 20, 20>>();
+   static_assert(!stack::ValueProduct<decltype(a), decltype(b)>);
+   // The scalar kernel is unrolled for smaller products than the vectorized
+   static_assert(kernels::isUnrolledGemm<float, 16, 16, 16,
+                                         StorageOrder::ColMajor>());
+   static_assert(!kernels::isUnrolledGemm<float, 9, 9, 9,
+                                          StorageOrder::ColMajor>());
+   static_assert(kernels::isUnrolledGemm<float, 8, 8, 8,
+                                         StorageOrder::ColMajor>());
+   SMatrix<double, 20, 20> c = a * b;
+   for (size_t j = 0; j < 20; j++) {
+      double s = 0.;
+      for (size_t l = 0; l < 20; l++) {
+         s += b(l, j);
+      }
+      ASSERT_DOUBLE_EQ(c(7, j), s);
+   }
+}
+
+TEST(StaticMul, Batch) {
+   constexpr size_t m = 2, n = 3, k = 4, batch = 100;
+   std::vector<float> a(m * k * batch), b(k * n), c(m * n * batch);
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i % 7);
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = float(i % 5) - 2.f;
+   }
+   // Every matrix of a by the same matrix b
+   kernels::staticGemmBatch<m, n, k, StorageOrder::ColMajor,
+                            StorageOrder::ColMajor, StorageOrder::ColMajor>(
+       a.data(), m * k, b.data(), 0, c.data(), batch);
+   for (size_t p = 0; p < batch; p++) {
+      for (size_t i = 0; i < m; i++) {
+         for (size_t j = 0; j < n; j++) {
+            float s = 0.f;
+            for (size_t l = 0; l < k; l++) {
+               s += a[p * m * k + i + l * m] * b[l + j * k];
+            }
+            ASSERT_FLOAT_EQ(c[p * m * n + i + j * m], s);
+         }
+      }
+   }
+}
+
+TEST(BatchMul, ColMajor) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t m = 7, k = 5, n = 6, batch = 9;
+   Tensor<double, 3> a({m, k, batch});
+   Tensor<double, 3> b({k, n, batch});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = double(i % 7) - 3.;
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = double(i % 5) * 0.5;
+   }
+   Matrix<double> w = iota<Matrix<double>>({k, n});
+   Tensor<double, 3> c = batchMul(a, b);
+   Tensor<double, 3> d = batchMul(a, w);
+   ASSERT_EQ(c.dim(0), m);
+   ASSERT_EQ(c.dim(1), n);
+   ASSERT_EQ(c.dim(2), batch);
+   for (size_t p = 0; p < batch; p++) {
+      for (size_t i = 0; i < m; i++) {
+         for (size_t j = 0; j < n; j++) {
+            double s = 0., t = 0.;
+            for (size_t l = 0; l < k; l++) {
+               s += a(i, l, p) * b(l, j, p);
+               t += a(i, l, p) * w(l, j);
+            }
+            ASSERT_DOUBLE_EQ(c(i, j, p), s);
+            ASSERT_DOUBLE_EQ(d(i, j, p), t);
+         }
+      }
+   }
+
+   Tensor<double, 3> e({k, n, 2});
+   ASSERT_THROW(batchMul(a, e).eval(), std::invalid_argument);
+   Tensor<double, 3> g({n, n, batch});
+   ASSERT_THROW(batchMul(a, g).eval(), std::invalid_argument);
+}
+
+TEST(BatchMul, RowMajor) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t m = 33, k = 17, n = 20, batch = 12;
+   using tensor_type = Tensor<float, 3, StorageOrder::RowMajor>;
+   tensor_type a({batch, m, k});
+   tensor_type b({batch, k, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i % 11) - 5.f;
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = float(i % 3) - 1.f;
+   }
+   tensor_type c = batchMul(a, b);
+   for (size_t p = 0; p < batch; p++) {
+      for (size_t i = 0; i < m; i++) {
+         for (size_t j = 0; j < n; j++) {
+            float s = 0.f;
+            for (size_t l = 0; l < k; l++) {
+               s += a(p, i, l) * b(p, l, j);
+            }
+            ASSERT_FLOAT_EQ(c(p, i, j), s);
+         }
+      }
+   }
+}
+
+TEST(BatchMul, Broadcast) {
+   // Two batch dimensions, the second one of b is broadcast
+   size_t m = 4, k = 3, n = 5;
+   Tensor<float, 4> a({m, k, 2, 3});
+   Tensor<float, 4> b({k, n, 2, 1});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i % 13);
+   }
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = float(i % 4) - 1.f;
+   }
+   Tensor<float, 4> c = batchMul(a, b);
+   ASSERT_EQ(c.dim(2), 2);
+   ASSERT_EQ(c.dim(3), 3);
+   for (size_t p = 0; p < 2; p++) {
+      for (size_t q = 0; q < 3; q++) {
+         for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < n; j++) {
+               float s = 0.f;
+               for (size_t l = 0; l < k; l++) {
+                  s += a(i, l, p, q) * b(l, j, p, 0);
+               }
+               ASSERT_FLOAT_EQ(c(i, j, p, q), s);
+            }
+         }
+      }
+   }
+
+   // Small static matrices are unrolled
+   auto x = iota<STensor<double, 2, 3, 10>>();
+   auto y = iota<SMatrix<double, 3, 4>>();
+   Tensor<double, 3> z = batchMul(x, y);
+   for (size_t p = 0; p < 10; p++) {
+      for (size_t i = 0; i < 2; i++) {
+         for (size_t j = 0; j < 4; j++) {
+            double s = 0.;
+            for (size_t l = 0; l < 3; l++) {
+               s += x(i, l, p) * y(l, j);
+            }
+            ASSERT_DOUBLE_EQ(z(i, j, p), s);
+         }
+      }
+   }
+}
+
+#endif
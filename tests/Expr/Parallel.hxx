@@ -0,0 +1,69 @@
+#ifndef TENSEUR_TESTS_EXPR_PARALLEL
+#define TENSEUR_TESTS_EXPR_PARALLEL
+
+#include <atomic>
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+#include "Ref.hxx"
+
+using namespace ten;
+
+TEST(Parallel, BinaryOps) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   setParallelThreshold(100);
+   ASSERT_EQ(numThreads(), 4);
+
+   size_t size = 1003;
+   Vector<float> a = iota<float>({size});
+   Vector<float> b = iota<float>({size});
+   Vector<float> c = sqrt(a * b) + 2.f * a;
+   for (size_t i = 0; i < size; i++) {
+      ASSERT_FLOAT_EQ(c[i], 3.f * a[i]);
+   }
+}
+
+TEST(Parallel, Reductions) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(100);
+   size_t size = 100000;
+   Vector<double> a = iota<double>({size});
+   a[5 * size / 7] = -10.;
+   a[3 * size / 7] = 2. * size;
+
+   for (size_t n : {1, 3, 4}) {
+      setNumThreads(n);
+      Scalar<double> x = min(a);
+      Scalar<double> y = max(a);
+      ASSERT_EQ(x.value(), -10.);
+      ASSERT_EQ(y.value(), 2. * size);
+   }
+}
+
+TEST(Parallel, Exception) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   setParallelThreshold(1);
+   // Thrown by the calling thread and by the workers
+   for (size_t failing : {size_t(0), size_t(900)}) {
+      std::atomic<size_t> count = 0;
+      auto body = [&](size_t first, size_t last) {
+         count += last - first;
+         if (first <= failing && failing < last) {
+            throw std::runtime_error("chunk");
+         }
+      };
+      ASSERT_THROW(parallel::parallelFor(0, 1000, 1, body), std::runtime_error);
+      // Every chunk has run
+      ASSERT_EQ(count.load(), 1000);
+   }
+   // The pool still runs the kernels
+   Vector<float> a = iota<float>({1000});
+   Vector<float> b = a + a;
+   ASSERT_EQ(b[999], 1998.f);
+}
+
+#endif
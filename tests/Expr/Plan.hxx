@@ -0,0 +1,92 @@
+#ifndef TENSEUR_TESTS_EXPR_PLAN
+#define TENSEUR_TESTS_EXPR_PLAN
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Plan, Run) {
+   size_t size = 100;
+   Vector<float> a = iota<float>({size});
+   Vector<float> b = iota<float>({size});
+   auto plan = compile(sqrt(a * b) + a);
+   Vector<float> c = plan.run();
+   const float *data = c.data();
+   for (size_t i = 0; i < size; i++) {
+      ASSERT_FLOAT_EQ(c[i], 2.f * float(i));
+   }
+
+   // New values of the inputs are evaluated into the same output
+   for (size_t i = 0; i < size; i++) {
+      a[i] = 1.f;
+   }
+   Vector<float> d = plan.run();
+   ASSERT_EQ(d.data(), data);
+   for (size_t i = 0; i < size; i++) {
+      ASSERT_FLOAT_EQ(d[i], std::sqrt(float(i)) + 1.f);
+   }
+}
+
+TEST(Plan, Invalidate) {
+   size_t size = 10;
+   Vector<double> a = iota<double>({size});
+   auto plan = compile(a + a);
+   ASSERT_EQ(plan.value()[3], 6.);
+   a[3] = 0.;
+   ASSERT_EQ(plan.value()[3], 6.);
+   plan.invalidate();
+   ASSERT_EQ(plan.value()[3], 0.);
+}
+
+TEST(Plan, CompiledExpression) {
+   size_t size = 10;
+   Vector<float> a = iota<float>({size});
+   auto e = sqrt(a) + a;
+   auto plan = compile(e);
+   Vector<float> c = plan.run();
+   // The runs evaluate a copy of the expression
+   ASSERT_FALSE(e.evaluated());
+   Vector<float> d = e.eval();
+   ASSERT_NE(d.data(), c.data());
+   a[2] = 0.f;
+   Vector<float> x = plan.run();
+   ASSERT_EQ(x[2], 0.f);
+   ASSERT_TRUE(e.evaluated());
+   ASSERT_EQ(e.value().data(), d.data());
+   ASSERT_FLOAT_EQ(d[2], std::sqrt(2.f) + 2.f);
+}
+
+TEST(Plan, SharedBuffers) {
+   size_t n = 8;
+   Matrix<float> a({n, n});
+   Matrix<float> b({n, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i % 7);
+      b[i] = float(i % 5);
+   }
+   // The products a * b and b * a have disjoint lifetimes
+   auto plan = compile((a * b) * a + (b * a) * b);
+   Matrix<float> c = plan.run();
+   ASSERT_EQ(plan.numBuffers(), 4);
+   Matrix<float> ab = a * b;
+   Matrix<float> ba = b * a;
+   Matrix<float> x = ab * a;
+   Matrix<float> y = ba * b;
+   Matrix<float> d = plan.run();
+   ASSERT_EQ(plan.numBuffers(), 3);
+   for (size_t i = 0; i < c.size(); i++) {
+      ASSERT_EQ(d[i], x[i] + y[i]);
+   }
+   a[0] = 100.f;
+   Matrix<float> ab2 = a * b;
+   Matrix<float> x2 = ab2 * a;
+   Matrix<float> ba2 = b * a;
+   Matrix<float> y2 = ba2 * b;
+   Matrix<float> e = plan.run();
+   for (size_t i = 0; i < e.size(); i++) {
+      ASSERT_EQ(e[i], x2[i] + y2[i]);
+   }
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef TENSEUR_TESTS_EXPR_REDUCE
+#define TENSEUR_TESTS_EXPR_REDUCE
+
+#include <cmath>
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Reduce, Full) {
+   size_t size = 1001;
+   Vector<double> a({size});
+   for (size_t i = 0; i < size; i++) {
+      a[i] = (i % 7 == 0) ? -double(i) : double(i);
+   }
+   double sum1 = 0., abs1 = 0., sq = 0.;
+   for (size_t i = 0; i < size; i++) {
+      sum1 += a[i];
+      abs1 += std::abs(a[i]);
+      sq += a[i] * a[i];
+   }
+   double m = sum1 / size;
+   double v = 0.;
+   for (size_t i = 0; i < size; i++) {
+      v += (a[i] - m) * (a[i] - m);
+   }
+
+   for (auto method : {Summation::naive, Summation::pairwise, Summation::kahan}) {
+      Scalar<double> s = sum(a, method);
+      Scalar<double> mu = mean(a, method);
+      Scalar<double> n1 = norm1(a, method);
+      Scalar<double> n2 = norm2(a, method);
+      Scalar<double> var = variance(a, method);
+      ASSERT_DOUBLE_EQ(s.value(), sum1);
+      ASSERT_DOUBLE_EQ(mu.value(), m);
+      ASSERT_DOUBLE_EQ(n1.value(), abs1);
+      ASSERT_DOUBLE_EQ(n2.value(), std::sqrt(sq));
+      ASSERT_NEAR(var.value(), v / size, 1e-9 * v / size);
+   }
+   Scalar<double> ninf = normInf(a);
+   Scalar<size_t> imin = argmin(a);
+   Scalar<size_t> imax = argmax(a);
+   ASSERT_EQ(ninf.value(), 1000.);
+   ASSERT_EQ(imin.value(), 994);
+   ASSERT_EQ(imax.value(), 1000);
+}
+
+TEST(Reduce, Integers) {
+   Vector<int32_t> a = iota<Vector<int32_t>>({10}, 1);
+   Scalar<int32_t> s = sum(a);
+   Scalar<double> m = mean(a);
+   Scalar<int32_t> p = prod(a);
+   ASSERT_EQ(s.value(), 55);
+   ASSERT_EQ(m.value(), 5.5);
+   ASSERT_EQ(p.value(), 3628800);
+}
+
+TEST(Reduce, Empty) {
+   Vector<double> a({0});
+   Scalar<double> s = sum(a);
+   Scalar<double> p = prod(a);
+   Scalar<double> n2 = norm2(a);
+   Scalar<double> ninf = normInf(a);
+   ASSERT_EQ(s.value(), 0.);
+   ASSERT_EQ(p.value(), 1.);
+   ASSERT_EQ(n2.value(), 0.);
+   ASSERT_EQ(ninf.value(), 0.);
+   ASSERT_THROW(min(a).eval(), std::invalid_argument);
+   ASSERT_THROW(max(a).eval(), std::invalid_argument);
+   ASSERT_THROW(mean(a).eval(), std::invalid_argument);
+   ASSERT_THROW(argmin(a).eval(), std::invalid_argument);
+   ASSERT_THROW(argmax(a).eval(), std::invalid_argument);
+   ASSERT_THROW(variance(a).eval(), std::invalid_argument);
+   ASSERT_THROW(logsumexp(a).eval(), std::invalid_argument);
+
+   // Reductions along an empty axis
+   Matrix<double> b({3, 0});
+   Vector<double> c = sum<1>(b);
+   Vector<double> d = prod<1>(b);
+   ASSERT_EQ(c.size(), 3);
+   for (size_t i = 0; i < 3; i++) {
+      ASSERT_EQ(c[i], 0.);
+      ASSERT_EQ(d[i], 1.);
+   }
+   ASSERT_THROW(mean<1>(b).eval(), std::invalid_argument);
+   ASSERT_THROW(argmax<1>(b).eval(), std::invalid_argument);
+}
+
+TEST(Reduce, Kahan) {
+   size_t size = 1 << 20;
+   Vector<float> a = fill<Vector<float>>({size}, 0.1f);
+   Scalar<float> s = sum(a, Summation::kahan);
+   ASSERT_NEAR(s.value(), 0.1 * size, 1e-6 * size);
+}
+
+TEST(Reduce, Axis) {
+   size_t m = 37, n = 53;
+   Matrix<float> a({m, n});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float((i * 13) % 17) - 8.f;
+   }
+
+   Vector<float> rows = sum<1>(a);
+   Vector<float> cols = sum<0>(a);
+   Vector<size_t> imax = argmax<0>(a);
+   Vector<float> maxs = max<1>(a);
+   ASSERT_EQ(rows.size(), m);
+   ASSERT_EQ(cols.size(), n);
+   for (size_t i = 0; i < m; i++) {
+      float s = 0.f, mx = a(i, 0);
+      for (size_t j = 0; j < n; j++) {
+         s += a(i, j);
+         mx = std::max(mx, a(i, j));
+      }
+      ASSERT_FLOAT_EQ(rows[i], s);
+      ASSERT_EQ(maxs[i], mx);
+   }
+   for (size_t j = 0; j < n; j++) {
+      float s = 0.f;
+      size_t k = 0;
+      for (size_t i = 0; i < m; i++) {
+         s += a(i, j);
+         if (a(i, j) > a(k, j)) {
+            k = i;
+         }
+      }
+      ASSERT_FLOAT_EQ(cols[j], s);
+      ASSERT_EQ(imax[j], k);
+   }
+
+   for (auto method : {Summation::naive, Summation::pairwise, Summation::kahan}) {
+      Vector<float> mu = mean<1>(a, method);
+      Vector<float> var = variance<1>(a, method);
+      for (size_t i = 0; i < m; i++) {
+         float s = 0.f, v = 0.f;
+         for (size_t j = 0; j < n; j++) {
+            s += a(i, j);
+         }
+         s /= n;
+         for (size_t j = 0; j < n; j++) {
+            v += (a(i, j) - s) * (a(i, j) - s);
+         }
+         ASSERT_NEAR(mu[i], s, 1e-5);
+         ASSERT_NEAR(var[i], v / n, 1e-4);
+      }
+   }
+}
+
+TEST(Reduce, StaticAxis) {
+   STensor<float, 2, 3, 4> a;
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i);
+   }
+   auto b = sum<1>(a).eval();
+   ASSERT_EQ(b.size(), 8);
+   for (size_t i = 0; i < 2; i++) {
+      for (size_t k = 0; k < 4; k++) {
+         float s = a(i, 0, k) + a(i, 1, k) + a(i, 2, k);
+         ASSERT_FLOAT_EQ(b(i, k), s);
+      }
+   }
+}
+
+#endif
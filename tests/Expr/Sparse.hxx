@@ -0,0 +1,118 @@
+#ifndef TENSEUR_TESTS_EXPR_SPARSE
+#define TENSEUR_TESTS_EXPR_SPARSE
+
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+// Banded matrix with a few elements on its diagonals
+template <class T> Matrix<T> sparseTestMatrix(size_t rows, size_t cols) {
+   Matrix<T> a({rows, cols});
+   for (size_t j = 0; j < cols; j++) {
+      for (size_t i = 0; i < rows; i++) {
+         bool stored = i == j || i == j + 2 || j == i + 3;
+         a(i, j) = stored ? T(1 + (i * 7 + j * 3) % 11) : T(0);
+      }
+   }
+   return a;
+}
+} // namespace
+
+TEST(Sparse, Coo) {
+   SparseMatrix<float, StorageFormat::SparseCoo> coo({3, 4});
+   coo.storage()->insert(2, 1, 1.f);
+   coo.storage()->insert(0, 3, 2.f);
+   coo.storage()->insert(2, 1, 3.f);
+   auto csr = toSparse<StorageFormat::SparseCsr>(coo);
+   // The duplicated elements are summed
+   ASSERT_EQ(csr.storage()->nnz(), 2);
+   auto d = toDense(csr);
+   ASSERT_EQ(d(2, 1), 4.f);
+   ASSERT_EQ(d(0, 3), 2.f);
+   ASSERT_EQ(d(1, 1), 0.f);
+   ASSERT_TRUE(tests::equal(d, toDense(coo)));
+
+   // Elements outside of the shape are rejected by the conversions
+   SparseMatrix<float, StorageFormat::SparseCoo> bad({3, 4});
+   bad.storage()->insert(1, 4, 1.f);
+   ASSERT_THROW(toSparse<StorageFormat::SparseCsr>(bad), std::out_of_range);
+   ASSERT_THROW(toSparse<StorageFormat::SparseCoo>(bad), std::out_of_range);
+   ASSERT_THROW(toDense(bad), std::out_of_range);
+}
+
+TEST(Sparse, Conversions) {
+   auto a = sparseTestMatrix<double>(9, 7);
+   auto csr = toSparse<StorageFormat::SparseCsr>(a);
+   auto csc = toSparse<StorageFormat::SparseCsc>(csr);
+   ASSERT_EQ(csr.storage()->nnz(), csc.storage()->nnz());
+   ASSERT_TRUE(tests::equal(toDense(csr), a));
+   ASSERT_TRUE(tests::equal(toDense(csc), a));
+   auto r = toDense<StorageOrder::RowMajor>(csc);
+   ASSERT_EQ(r(3, 1), a(3, 1));
+   ASSERT_EQ(r(0, 3), a(0, 3));
+}
+
+TEST(Sparse, Spmv) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   auto a = sparseTestMatrix<float>(301, 203);
+   Vector<float> x({203});
+   for (size_t i = 0; i < 203; i++) {
+      x[i] = float(i % 5) - 2.f;
+   }
+   Vector<float> expected = a * x;
+   auto csr = toSparse<StorageFormat::SparseCsr>(a);
+   auto csc = toSparse<StorageFormat::SparseCsc>(a);
+   for (size_t n : {1, 4}) {
+      setNumThreads(n);
+      Vector<float> y = csr * x;
+      Vector<float> z = csc * x;
+      ASSERT_TRUE(tests::equal(y, expected));
+      ASSERT_TRUE(tests::equal(z, expected));
+   }
+   Vector<float> w({202});
+   ASSERT_THROW(Vector<float>(csr * w), std::invalid_argument);
+}
+
+TEST(Sparse, Spmm) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   auto a = sparseTestMatrix<double>(40, 30);
+   Matrix<double> b({30, 6});
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = double(i % 7) - 3.;
+   }
+   Matrix<double> expected = a * b;
+   auto csr = toSparse<StorageFormat::SparseCsr>(a);
+   auto csc = toSparse<StorageFormat::SparseCsc>(a);
+   Matrix<double> c = csr * b;
+   Matrix<double> d = csc * b;
+   ASSERT_TRUE(tests::equal(c, expected));
+   ASSERT_TRUE(tests::equal(d, expected));
+}
+
+TEST(Sparse, Elementwise) {
+   auto a = sparseTestMatrix<float>(8, 8);
+   Matrix<float> b({8, 8});
+   for (size_t i = 0; i < b.size(); i++) {
+      b[i] = (i % 3 == 0) ? float(i) : 0.f;
+   }
+   auto sa = toSparse<StorageFormat::SparseCsr>(a);
+   auto sb = toSparse<StorageFormat::SparseCsr>(b);
+   SparseMatrix<float> sum = sa + sb;
+   SparseMatrix<float> diff = sa - sb;
+   SparseMatrix<float> scaled = 2.f * sa;
+   ASSERT_EQ(scaled.storage()->nnz(), sa.storage()->nnz());
+   Matrix<float> expectedSum = a + b;
+   Matrix<float> expectedDiff = a - b;
+   Matrix<float> expectedScaled = 2.f * a;
+   ASSERT_TRUE(tests::equal(toDense(sum), expectedSum));
+   ASSERT_TRUE(tests::equal(toDense(diff), expectedDiff));
+   ASSERT_TRUE(tests::equal(toDense(scaled), expectedScaled));
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef TENSEUR_TESTS_EXPR_STACK
+#define TENSEUR_TESTS_EXPR_STACK
+
+#include <cmath>
+#include <type_traits>
+
+#include <Ten/Tensor.hxx>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+TEST(Stack, InlineStorage) {
+   static_assert(SMatrix<float, 3, 3>::inlineNode);
+   static_assert(STensor<double, 2, 3, 4>::inlineNode);
+   static_assert(!SMatrix<double, 16, 16>::inlineNode);
+   static_assert(!Matrix<float>::inlineNode);
+   static_assert(sizeof(SMatrix<float, 4, 4>) >= 16 * sizeof(float));
+
+   auto a = iota<SMatrix<float, 3, 3>>();
+   SMatrix<float, 3, 3> b = a;
+   b(0, 0) = 10.f;
+   ASSERT_EQ(a(0, 0), 0.f);
+   ASSERT_EQ(b(0, 0), 10.f);
+   ASSERT_EQ(b(2, 1), a(2, 1));
+}
+
+TEST(Stack, ValueExpr) {
+   auto a = iota<SMatrix<float, 4, 4>>();
+   auto b = fill<SMatrix<float, 4, 4>>(2.f);
+   auto e = a + 2.f * b - a / b;
+   static_assert(stack::isValueExpr<decltype(e)>::value);
+   SMatrix<float, 4, 4> c = e;
+   for (size_t i = 0; i < 16; i++) {
+      ASSERT_FLOAT_EQ(c[i], a[i] + 2.f * b[i] - a[i] / b[i]);
+   }
+   // Elementwise product of vectors and of tensors of rank 3
+   auto x = iota<SVector<double, 5>>();
+   SVector<double, 5> y = x * x + 1.;
+   auto t = iota<STensor<float, 2, 3, 2>>();
+   STensor<float, 2, 3, 2> u = t * t;
+   for (size_t i = 0; i < 5; i++) {
+      ASSERT_EQ(y[i], x[i] * x[i] + 1.);
+   }
+   for (size_t i = 0; i < t.size(); i++) {
+      ASSERT_EQ(u[i], t[i] * t[i]);
+   }
+}
+
+TEST(Stack, Aliasing) {
+   auto a = iota<SVector<float, 6>>();
+   auto b = fill<SVector<float, 6>>(1.f);
+   a = a + b;
+   a = 2.f * a - b;
+   for (size_t i = 0; i < 6; i++) {
+      ASSERT_EQ(a[i], 2.f * (float(i) + 1.f) - 1.f);
+   }
+}
+
+TEST(Stack, NodeExpr) {
+   auto a = iota<SVector<float, 5>>();
+   auto b = fill<SVector<float, 5>>(3.f);
+   // Value expression operand of a function
+   SVector<float, 5> c = sqrt(a + b);
+   // Transpose through the nodes
+   auto m = iota<SMatrix<float, 2, 3>>();
+   SMatrix<float, 3, 2> n = transpose(m + m);
+   for (size_t i = 0; i < 5; i++) {
+      ASSERT_FLOAT_EQ(c[i], std::sqrt(a[i] + b[i]));
+   }
+   for (size_t i = 0; i < 2; i++) {
+      for (size_t j = 0; j < 3; j++) {
+         ASSERT_EQ(n(j, i), 2.f * m(i, j));
+      }
+   }
+   // Large static tensors are allocated
+   auto x = fill<SMatrix<double, 16, 16>>(1.);
+   SMatrix<double, 16, 16> y = x + x;
+   ASSERT_EQ(y(15, 15), 2.);
+}
+
+TEST(Stack, Reference) {
+   // The plans and the expressions see the later changes of inline tensors
+   auto x = fill<SMatrix<float, 3, 3>>(4.f);
+   auto plan = compile(sqrt(x));
+   SMatrix<float, 3, 3> a = plan.run();
+   x(1, 2) = 9.f;
+   SMatrix<float, 3, 3> b = plan.run();
+   auto e = sqrt(x);
+   x = fill<SMatrix<float, 3, 3>>(16.f);
+   SMatrix<float, 3, 3> c = e;
+   ASSERT_EQ(a(1, 2), 2.f);
+   ASSERT_EQ(b(1, 2), 3.f);
+   ASSERT_EQ(b(0, 0), 2.f);
+   ASSERT_EQ(c(1, 2), 4.f);
+   // Copies are still independent
+   SMatrix<float, 3, 3> y = x;
+   y(0, 0) = 1.f;
+   ASSERT_EQ(x(0, 0), 16.f);
+}
+
+#endif
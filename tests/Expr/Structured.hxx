@@ -0,0 +1,213 @@
+#ifndef TENSEUR_TESTS_EXPR_STRUCTURED
+#define TENSEUR_TESTS_EXPR_STRUCTURED
+
+#include <cmath>
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+// Well conditioned square matrix with a dominant diagonal
+template <class T, StorageOrder order = defaultOrder>
+Matrix<T, DynamicShape<2>, order> structuredTestMatrix(size_t n) {
+   Matrix<T, DynamicShape<2>, order> a({n, n});
+   for (size_t j = 0; j < n; j++) {
+      for (size_t i = 0; i < n; i++) {
+         a(i, j) = i == j ? T(n + 1) : T((i * 5 + j * 3) % 7) / T(7);
+      }
+   }
+   return a;
+}
+
+// Compare two matrices of any storage order element by element
+template <class A, class B>
+testing::AssertionResult sameElements(const A &a, const B &b) {
+   for (size_t j = 0; j < a.dim(1); j++) {
+      for (size_t i = 0; i < a.dim(0); i++) {
+         if (std::abs(a(i, j) - b(i, j)) > 1e-3) {
+            return testing::AssertionFailure()
+                   << "Different values at (" << i << ", " << j << ")";
+         }
+      }
+   }
+   return testing::AssertionSuccess();
+}
+} // namespace
+
+TEST(Structured, Conversions) {
+   auto a = structuredTestMatrix<float>(5);
+   auto l = toStructured<StorageFormat::LowerTr>(a);
+   auto u = toStructured<StorageFormat::UpperTr>(a);
+   auto d = toStructured<StorageFormat::Diagonal>(a);
+   ASSERT_EQ(l.storage()->size(), 15);
+   ASSERT_EQ(u.storage()->size(), 15);
+   ASSERT_EQ(d.storage()->size(), 5);
+   auto dl = toDense(l);
+   auto du = toDense(u);
+   auto dd = toDense<StorageOrder::RowMajor>(d);
+   for (size_t i = 0; i < 5; i++) {
+      for (size_t j = 0; j < 5; j++) {
+         ASSERT_EQ(dl(i, j), i >= j ? a(i, j) : 0.f);
+         ASSERT_EQ(du(i, j), i <= j ? a(i, j) : 0.f);
+         ASSERT_EQ(dd(i, j), i == j ? a(i, j) : 0.f);
+      }
+   }
+   LowerTrMatrix<float> m({3, 3});
+   m.storage()->at(2, 1) = 4.f;
+   ASSERT_EQ(m.storage()->data()[4], 4.f);
+   ASSERT_THROW((LowerTrMatrix<float>({3, 4})), std::invalid_argument);
+   Matrix<float> r({3, 2});
+   ASSERT_THROW(toStructured<StorageFormat::UpperTr>(r), std::invalid_argument);
+   ASSERT_EQ(toStructured<StorageFormat::Diagonal>(r).storage()->size(), 2);
+}
+
+TEST(Structured, DiagonalMul) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   auto a = structuredTestMatrix<double>(40);
+   auto d = toStructured<StorageFormat::Diagonal>(a);
+   auto dd = toDense(d);
+   Matrix<double> b({40, 30});
+   Matrix<double, DynamicShape<2>, StorageOrder::RowMajor> br({40, 30});
+   Vector<double> x({40});
+   for (size_t i = 0; i < 40; i++) {
+      x[i] = double(i % 3) - 1.;
+      for (size_t j = 0; j < 30; j++) {
+         b(i, j) = double((i + 2 * j) % 9);
+         br(i, j) = b(i, j);
+      }
+   }
+   Matrix<double> rows = d * b;
+   Matrix<double> expected = dd * b;
+   ASSERT_TRUE(tests::equal(rows, expected));
+   auto rowsr = d * br;
+   ASSERT_TRUE(sameElements(rowsr.eval(), expected));
+   Vector<double> y = d * x;
+   Vector<double> z = dd * x;
+   ASSERT_TRUE(tests::equal(y, z));
+   Matrix<double> bt({30, 40});
+   for (size_t i = 0; i < 30; i++) {
+      for (size_t j = 0; j < 40; j++) {
+         bt(i, j) = b(j, i);
+      }
+   }
+   Matrix<double> cols = bt * d;
+   Matrix<double> expectedCols = bt * dd;
+   ASSERT_TRUE(tests::equal(cols, expectedCols));
+   // Rectangular diagonal matrix
+   DiagonalMatrix<double> r({50, 40});
+   for (size_t i = 0; i < 40; i++) {
+      r.storage()->at(i, i) = double(i + 1);
+   }
+   Matrix<double> c = r * b;
+   Matrix<double> expectedRect = toDense(r) * b;
+   ASSERT_TRUE(tests::equal(c, expectedRect));
+}
+
+TEST(Structured, TriangularMul) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   auto a = structuredTestMatrix<float>(33);
+   auto l = toStructured<StorageFormat::LowerTr>(a);
+   auto u = toStructured<StorageFormat::UpperTr>(a);
+   Matrix<float> b({33, 17});
+   Matrix<float, DynamicShape<2>, StorageOrder::RowMajor> br({33, 17});
+   Vector<float> x({33});
+   for (size_t i = 0; i < 33; i++) {
+      x[i] = float(i % 4);
+      for (size_t j = 0; j < 17; j++) {
+         b(i, j) = float((3 * i + j) % 5) - 2.f;
+         br(i, j) = b(i, j);
+      }
+   }
+   Matrix<float> dl = toDense(l);
+   Matrix<float> du = toDense(u);
+   Matrix<float> cl = l * b;
+   Matrix<float> cu = u * b;
+   Matrix<float> expectedL = dl * b;
+   Matrix<float> expectedU = du * b;
+   ASSERT_TRUE(tests::equal(cl, expectedL));
+   ASSERT_TRUE(tests::equal(cu, expectedU));
+   auto clr = l * br;
+   auto cur = u * br;
+   ASSERT_TRUE(sameElements(clr.eval(), expectedL));
+   ASSERT_TRUE(sameElements(cur.eval(), expectedU));
+   Vector<float> yl = l * x;
+   Vector<float> yu = u * x;
+   Vector<float> expectedYl = dl * x;
+   Vector<float> expectedYu = du * x;
+   ASSERT_TRUE(tests::equal(yl, expectedYl));
+   ASSERT_TRUE(tests::equal(yu, expectedYu));
+   Vector<float> w({32});
+   ASSERT_THROW(Vector<float>(l * w), std::invalid_argument);
+}
+
+TEST(Structured, Solve) {
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   auto a = structuredTestMatrix<double>(25);
+   auto l = toStructured<StorageFormat::LowerTr>(a);
+   auto u = toStructured<StorageFormat::UpperTr>(a);
+   Matrix<double> b({25, 9});
+   Matrix<double, DynamicShape<2>, StorageOrder::RowMajor> br({25, 9});
+   Vector<double> y({25});
+   for (size_t i = 0; i < 25; i++) {
+      y[i] = double(i % 6) - 3.;
+      for (size_t j = 0; j < 9; j++) {
+         b(i, j) = double((i * j) % 7);
+         br(i, j) = b(i, j);
+      }
+   }
+   Vector<double> xl = solve(l, y);
+   Vector<double> xu = solve(u, y);
+   Vector<double> rl = l * xl;
+   Vector<double> ru = u * xu;
+   ASSERT_TRUE(tests::equal(rl, y));
+   ASSERT_TRUE(tests::equal(ru, y));
+   Matrix<double> zl = solve(l, b);
+   Matrix<double> zu = solve(u, b);
+   Matrix<double> sl = l * zl;
+   Matrix<double> su = u * zu;
+   ASSERT_TRUE(tests::equal(sl, b));
+   ASSERT_TRUE(tests::equal(su, b));
+   auto zr = solve(u, br).eval();
+   ASSERT_TRUE(sameElements(zr, zu));
+}
+
+TEST(Structured, Elementwise) {
+   auto a = structuredTestMatrix<float>(6);
+   auto b = structuredTestMatrix<float>(6);
+   for (size_t i = 0; i < 6; i++) {
+      b(i, 0) = 1.f;
+   }
+   auto la = toStructured<StorageFormat::LowerTr>(a);
+   auto lb = toStructured<StorageFormat::LowerTr>(b);
+   LowerTrMatrix<float> sum = la + lb;
+   LowerTrMatrix<float> diff = la - lb;
+   LowerTrMatrix<float> scaled = 2.f * la;
+   ASSERT_EQ(sum.storage()->size(), 21);
+   Matrix<float> expectedSum = a + b;
+   Matrix<float> expectedDiff = a - b;
+   for (size_t i = 0; i < 6; i++) {
+      for (size_t j = 0; j <= i; j++) {
+         ASSERT_EQ(sum.storage()->at(i, j), expectedSum(i, j));
+         ASSERT_EQ(diff.storage()->at(i, j), expectedDiff(i, j));
+         ASSERT_EQ(scaled.storage()->at(i, j), 2.f * a(i, j));
+      }
+   }
+   auto da = toStructured<StorageFormat::Diagonal>(a);
+   auto db = toStructured<StorageFormat::Diagonal>(b);
+   DiagonalMatrix<float> prod = da * db;
+   for (size_t i = 0; i < 6; i++) {
+      ASSERT_EQ(prod.storage()->at(i, i), a(i, i) * b(i, i));
+   }
+   UpperTrMatrix<float> u({5, 5});
+   ASSERT_THROW(UpperTrMatrix<float>(toStructured<StorageFormat::UpperTr>(a) +
+                                     u),
+                std::invalid_argument);
+}
+
+#endif
@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
 
+#include "Assign.hxx"
+#include "Async.hxx"
 #include "BinaryOps.hxx"
+#include "Broadcast.hxx"
+#include "Contract.hxx"
+#include "Fused.hxx"
+#include "Math.hxx"
+#include "Mul.hxx"
+#include "Parallel.hxx"
+#include "Plan.hxx"
+#include "Reduce.hxx"
+#include "Sparse.hxx"
+#include "Stack.hxx"
+#include "Structured.hxx"
 
 int main(int argc, char **argv) {
 
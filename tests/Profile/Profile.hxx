@@ -0,0 +1,114 @@
+#ifndef TENSEUR_TESTS_PROFILE_PROFILE
+#define TENSEUR_TESTS_PROFILE_PROFILE
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+// Evaluate c = a * b + a for n x n matrices
+Matrix<double> mulAdd(size_t n) {
+   Matrix<double> a = iota<Matrix<double>>({n, n});
+   Matrix<double> b = fill<Matrix<double>>({n, n}, 0.5);
+   Matrix<double> c = a * b + a;
+   return c;
+}
+
+const profile::Event *findEvent(const std::vector<profile::Event> &events,
+                                const std::string &name) {
+   auto it = std::find_if(events.begin(), events.end(),
+                          [&](const auto &e) { return e.name == name; });
+   return it == events.end() ? nullptr : &*it;
+}
+} // namespace
+
+TEST(Profile, Disabled) {
+   profile::enable(false);
+   profile::reset();
+   Matrix<double> c = mulAdd(16);
+   ASSERT_FALSE(profile::enabled());
+   ASSERT_TRUE(profile::events().empty());
+}
+
+TEST(Profile, Events) {
+   tests::ParallelSettings settings;
+   setNumThreads(4);
+   size_t n = 64;
+   profile::enable();
+   profile::reset();
+   Matrix<double> c = mulAdd(n);
+   profile::enable(false);
+   auto events = profile::events();
+
+   const profile::Event *mul = findEvent(events, "Mul");
+   ASSERT_NE(mul, nullptr);
+   ASSERT_EQ(mul->category, "node");
+   ASSERT_EQ(mul->flops, 2 * n * n * n);
+   ASSERT_EQ(mul->bytesWritten, n * n * sizeof(double));
+   ASSERT_EQ(mul->bytesRead, 2 * n * n * sizeof(double));
+   ASSERT_EQ(mul->allocated, n * n * sizeof(double));
+   ASSERT_EQ(mul->threads, 4);
+   ASSERT_GE(mul->self, 0.);
+   ASSERT_LE(mul->self, mul->duration);
+
+   // The kernels are nested in the node
+   const profile::Event *kernel = findEvent(events, "mul");
+   ASSERT_NE(kernel, nullptr);
+   ASSERT_EQ(kernel->category, "kernel");
+   ASSERT_EQ(kernel->flops, mul->flops);
+   ASSERT_GE(kernel->start, mul->start);
+   ASSERT_LE(kernel->duration, mul->duration);
+   const profile::Event *gemm = findEvent(events, "blas.gemm");
+   if (!gemm) {
+      gemm = findEvent(events, "native.gemm");
+   }
+   ASSERT_NE(gemm, nullptr);
+   ASSERT_EQ(gemm->flops, mul->flops);
+
+   // The addition is evaluated by the elementwise kernel
+   const profile::Event *elementwise = findEvent(events, "elementwise");
+   ASSERT_NE(elementwise, nullptr);
+   ASSERT_EQ(elementwise->bytesWritten, n * n * sizeof(double));
+   ASSERT_EQ(std::count_if(events.begin(), events.end(),
+                           [](const auto &e) { return e.category == "node"; }),
+             2);
+}
+
+TEST(Profile, Output) {
+   profile::enable();
+   profile::reset();
+   Matrix<double> c = mulAdd(32);
+   Matrix<double> d = mulAdd(32);
+   profile::enable(false);
+   auto events = profile::events();
+
+   std::ostringstream summary;
+   profile::summary(summary);
+   std::string table = summary.str();
+   ASSERT_NE(table.find("GFLOP/s"), std::string::npos);
+   ASSERT_NE(table.find("Mul"), std::string::npos);
+   ASSERT_NE(table.find("elementwise"), std::string::npos);
+   // A line per name, calls are aggregated
+   size_t lines = std::count(table.begin(), table.end(), '\n');
+   ASSERT_LT(lines, events.size() + 1);
+
+   std::ostringstream trace;
+   profile::writeTrace(trace);
+   std::string json = trace.str();
+   ASSERT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+   size_t count = 0;
+   for (size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos;
+        pos = json.find("\"ph\":\"X\"", pos + 1)) {
+      count++;
+   }
+   ASSERT_EQ(count, events.size());
+   ASSERT_NE(json.find("\"name\":\"Mul\",\"cat\":\"node\""), std::string::npos);
+   ASSERT_NE(json.find("\"flops\":65536"), std::string::npos);
+}
+
+#endif
@@ -1,11 +1,33 @@
 #ifndef TENSEUR_TESTS_TESTS
 #define TENSEUR_TESTS_TESTS
 
+#include <Ten/Parallel.hxx>
 #include <Ten/Types.hxx>
 #include <gtest/gtest.h>
 #include <type_traits>
 
 namespace ten::tests {
+// Restore the number of threads and the parallel threshold at the end of a
+// test, also when an assertion returns early
+class ParallelSettings {
+ private:
+   size_type _threads;
+   size_type _threshold;
+
+ public:
+   ParallelSettings()
+       : _threads(::ten::numThreads()),
+         _threshold(::ten::parallelThreshold()) {}
+
+   ParallelSettings(const ParallelSettings &) = delete;
+   ParallelSettings &operator=(const ParallelSettings &) = delete;
+
+   ~ParallelSettings() {
+      ::ten::setNumThreads(_threads);
+      ::ten::setParallelThreshold(_threshold);
+   }
+};
+
 // Compare the value type of two tensors
 template <class A, class B>
 testing::AssertionResult same_value_type(const A &a, const B &b) {
@@ -73,9 +95,15 @@ testing::AssertionResult equal(const A &a, const B &b, double eps = 1e-3) {
    testing::AssertionResult r_shape = same_shape(a, b);
    if (!r_shape)
       return r_shape;
-   testing::AssertionResult r_values = same_values(a, b, eps);
-   if (!r_values)
-      return r_values;
+   if constexpr (std::is_integral_v<typename A::value_type>) {
+      testing::AssertionResult r_values = same_values(a, b);
+      if (!r_values)
+         return r_values;
+   } else {
+      testing::AssertionResult r_values = same_values(a, b, eps);
+      if (!r_values)
+         return r_values;
+   }
 
    return testing::AssertionSuccess();
 }
@@ -0,0 +1,63 @@
+#ifndef TENSEUR_TESTS_TENSOR_ALLOCATOR
+#define TENSEUR_TESTS_TENSOR_ALLOCATOR
+
+#include <cstdint>
+#include <limits>
+#include <new>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+TEST(Allocator, Aligned) {
+   using namespace ten;
+   for (size_t size : {1, 3, 17, 1000}) {
+      Vector<float> a({size});
+      Matrix<double> b({size, 3});
+      ASSERT_EQ(reinterpret_cast<std::uintptr_t>(a.data()) % 64, 0);
+      ASSERT_EQ(reinterpret_cast<std::uintptr_t>(b.data()) % 64, 0);
+   }
+}
+
+TEST(Allocator, Failure) {
+   using namespace ten;
+   // The allocation failures propagate out of the constructors
+   size_t size = std::numeric_limits<size_t>::max() / 2;
+   ASSERT_THROW(Vector<float> a({size}), std::bad_alloc);
+   ASSERT_THROW(Vector<double> b(size), std::bad_alloc);
+}
+
+TEST(Allocator, Pool) {
+   using namespace ten;
+   using allocator_type = PoolAllocator<float>;
+   using vector_type =
+       Vector<float, defaultOrder, DenseStorage<float, allocator_type>>;
+
+   allocator_type::release();
+   resetPoolStats();
+   const float *data = nullptr;
+   {
+      vector_type a = fill<vector_type>({1000}, 1.f);
+      data = a.data();
+      ASSERT_EQ(reinterpret_cast<std::uintptr_t>(data) % 64, 0);
+   }
+   ASSERT_EQ(poolStats().hits, 0);
+   ASSERT_EQ(poolStats().misses, 1);
+   ASSERT_GE(allocator_type::cachedBytes(), 1000 * sizeof(float));
+
+   // Same size class
+   vector_type b({990});
+   ASSERT_EQ(b.data(), data);
+   ASSERT_EQ(poolStats().hits, 1);
+
+   // Expression evaluation reuses the buffers of the intermediate nodes
+   vector_type c = fill<vector_type>({990}, 2.f);
+   for (size_t i = 0; i < 4; i++) {
+      vector_type d = 2.f * (b + c);
+   }
+   ASSERT_GE(poolStats().hits, 4);
+
+   allocator_type::release();
+   ASSERT_EQ(allocator_type::cachedBytes(), 0);
+}
+
+#endif
@@ -0,0 +1,323 @@
+#ifndef TENSEUR_TESTS_TENSOR_IO
+#define TENSEUR_TESTS_TENSOR_IO
+
+#include <Ten/IO.hxx>
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace ten;
+
+namespace {
+std::string ioTestPath(const std::string &name) {
+   return (std::filesystem::temp_directory_path() / ("tenseur_" + name))
+       .string();
+}
+
+// Write a npy file of version 1.0 with the header dictionary dict padded with
+// spaces, followed by size bytes of zeros
+void writeNpyTest(const std::string &path, std::string dict, size_t size) {
+   dict.append((64 - (10 + dict.size()) % 64) % 64, ' ');
+   std::ofstream file(path, std::ios::binary);
+   file.write("\x93NUMPY\x01\x00", 8);
+   file.put(static_cast<char>(dict.size() & 0xff));
+   file.put(static_cast<char>(dict.size() >> 8));
+   file << dict;
+   file << std::string(size, '\0');
+}
+
+template <class M> void fillIOTest(M &a) {
+   for (size_t i = 0; i < a.dim(0); i++) {
+      for (size_t j = 0; j < a.dim(1); j++) {
+         a(i, j) = float(10 * i + j);
+      }
+   }
+}
+} // namespace
+
+TEST(IO, Native) {
+   Matrix<float> a(3, 5);
+   fillIOTest(a);
+   std::string path = ioTestPath("native.ten");
+   io::save(path, a);
+   auto header = io::readHeader(path);
+   ASSERT_EQ(header.dtype, io::DType::float32);
+   ASSERT_EQ(header.shape.size(), 2);
+   ASSERT_EQ(header.offset % 64, 0);
+   auto b = io::load<Matrix<float>>(path);
+   ASSERT_TRUE(b.storage()->isExternal());
+   ASSERT_EQ(b.dim(0), 3);
+   ASSERT_EQ(b.dim(1), 5);
+   ASSERT_TRUE(tests::equal(a, b));
+   // Copy on write pages don't modify the file
+   b(0, 0) = 42.0f;
+   auto c = io::load<Matrix<float>>(path, io::MapMode::ReadOnly);
+   ASSERT_EQ(c(0, 0), 0.0f);
+   // Expressions assigned to a mapped tensor aren't written to the mapping
+   c = a + a;
+   ASSERT_FALSE(c.storage()->isExternal());
+   ASSERT_EQ(c(1, 2), 2.0f * a(1, 2));
+   std::remove(path.c_str());
+}
+
+TEST(IO, NativeView) {
+   Matrix<double> a(4, 6);
+   fillIOTest(a);
+   auto v = a.slice({{1, 3}, {2, 6}});
+   std::string path = ioTestPath("view.ten");
+   io::save(path, v);
+   auto b = io::load<Matrix<double>>(path);
+   ASSERT_EQ(b.dim(0), 2);
+   ASSERT_EQ(b.dim(1), 4);
+   for (size_t i = 0; i < 2; i++) {
+      for (size_t j = 0; j < 4; j++) {
+         ASSERT_EQ(b(i, j), a(i + 1, j + 2));
+      }
+   }
+   std::remove(path.c_str());
+}
+
+TEST(IO, Npy) {
+   Matrix<float, DynamicShape<2>, StorageOrder::RowMajor> a(3, 4);
+   fillIOTest(a);
+   std::string path = ioTestPath("row.npy");
+   io::saveNpy(path, a);
+   auto header = io::readNpyHeader(path);
+   ASSERT_EQ(header.order, StorageOrder::RowMajor);
+   ASSERT_EQ(header.shape[0], 3);
+   ASSERT_EQ(header.shape[1], 4);
+   ASSERT_EQ(header.offset, 128);
+   auto b =
+       io::loadNpy<Matrix<float, DynamicShape<2>, StorageOrder::RowMajor>>(
+           path);
+   ASSERT_TRUE(b.storage()->isExternal());
+   ASSERT_TRUE(tests::equal(a, b));
+   // Static shapes are copied
+   auto c = io::loadNpy<SMatrix<float, 3, 4, StorageOrder::RowMajor>>(path);
+   ASSERT_TRUE(tests::same_values(a, c));
+   std::remove(path.c_str());
+}
+
+TEST(IO, NpyHeader) {
+   // Header written by numpy.save for a float64 array of shape (2, 3)
+   std::string dict = "{'descr': '<f8', 'fortran_order': True, "
+                      "'shape': (2, 3), }";
+   dict.append(128 - 10 - dict.size() - 1, ' ');
+   dict += '\n';
+   std::string path = ioTestPath("numpy.npy");
+   {
+      std::ofstream file(path, std::ios::binary);
+      file.write("\x93NUMPY\x01\x00", 8);
+      file.put(static_cast<char>(dict.size()));
+      file.put(0);
+      file << dict;
+      for (int i = 0; i < 6; i++) {
+         double value = i;
+         file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+      }
+   }
+   auto a = io::loadNpy<Matrix<double>>(path);
+   ASSERT_EQ(a.dim(0), 2);
+   ASSERT_EQ(a.dim(1), 3);
+   ASSERT_EQ(a(1, 2), 5.0);
+   ASSERT_EQ(a(0, 1), 2.0);
+   std::remove(path.c_str());
+}
+
+TEST(IO, ShapeOverflow) {
+   // The number of elements overflows to 0
+   std::string path = ioTestPath("overflow.npy");
+   writeNpyTest(path,
+                "{'descr': '<f4', 'fortran_order': True, "
+                "'shape': (4294967296, 4294967296), }",
+                8);
+   ASSERT_THROW(io::loadNpy<Matrix<float>>(path), std::runtime_error);
+   ASSERT_THROW(io::readNpyHeader(path), std::runtime_error);
+   std::remove(path.c_str());
+
+   path = ioTestPath("overflow.ten");
+   io::save(path, Matrix<float>(2, 2));
+   {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      std::uint64_t dims[2] = {std::uint64_t(1) << 32, std::uint64_t(1) << 32};
+      file.seekp(24);
+      file.write(reinterpret_cast<const char *>(dims), sizeof(dims));
+   }
+   ASSERT_THROW(io::load<Matrix<float>>(path), std::runtime_error);
+   ASSERT_THROW((io::BlockReader<Matrix<float>>(path, 1)),
+                std::runtime_error);
+   std::remove(path.c_str());
+}
+
+TEST(IO, NpyMalformed) {
+   std::string path = ioTestPath("malformed.npy");
+   // Header ending at the key of a value, without padding
+   std::string dict = "{'fortran_order': True, 'shape': (2, 3),";
+   dict.append(64 - 10 - dict.size() - 8, ' ');
+   dict += "'descr':";
+   // Values without their closing quote or parenthesis
+   for (std::string header :
+        {dict, std::string("{'fortran_order': True, 'descr': '<f8"),
+         std::string("{'descr': '<f8', 'fortran_order': True, 'shape': (2")}) {
+      writeNpyTest(path, header, 48);
+      ASSERT_THROW(io::readNpyHeader(path), std::runtime_error);
+      ASSERT_THROW(io::loadNpy<Matrix<double>>(path), std::runtime_error);
+   }
+   std::remove(path.c_str());
+}
+
+TEST(IO, Npz) {
+   Matrix<float> a(3, 5);
+   fillIOTest(a);
+   Vector<double> x(7);
+   for (size_t i = 0; i < 7; i++) {
+      x[i] = double(i) / 2.0;
+   }
+   std::string path = ioTestPath("arrays.npz");
+   {
+      io::NpzWriter writer(path);
+      writer.add("a", a);
+      writer.add("x", x);
+   }
+   auto names = io::npzNames(path);
+   ASSERT_EQ(names.size(), 2);
+   ASSERT_EQ(names[0], "a");
+   ASSERT_EQ(names[1], "x");
+   auto b = io::loadNpz<Matrix<float>>(path, "a");
+   ASSERT_TRUE(tests::equal(a, b));
+   auto y = io::loadNpz<Vector<double>>(path, "x");
+   ASSERT_TRUE(tests::equal(x, y));
+   ASSERT_THROW(io::loadNpz<Vector<double>>(path, "z"), std::runtime_error);
+   std::remove(path.c_str());
+}
+
+TEST(IO, NpzCorrupted) {
+   Vector<double> x(7);
+   std::string path = ioTestPath("corrupted.npz");
+   {
+      io::NpzWriter writer(path);
+      writer.add("x", x);
+   }
+   std::string bytes;
+   {
+      std::ifstream file(path, std::ios::binary);
+      bytes.assign(std::istreambuf_iterator<char>(file), {});
+   }
+   // Write the archive with the 32 bits field at pos set to value
+   auto corrupt = [&](size_t pos, std::uint32_t value) {
+      std::string copy = bytes;
+      std::memcpy(copy.data() + pos, &value, sizeof(value));
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(copy.data(), copy.size());
+   };
+   size_t eocd = bytes.size() - 22;
+   std::uint32_t directory;
+   std::memcpy(&directory, bytes.data() + eocd + 16, sizeof(directory));
+   // Offset of the central directory
+   corrupt(eocd + 16, 0xfffffff0);
+   ASSERT_THROW(io::npzNames(path), std::runtime_error);
+   // Lengths of the name and of the extra field of the member
+   corrupt(directory + 28, 0xffffffff);
+   ASSERT_THROW(io::npzNames(path), std::runtime_error);
+   // Offset of the member
+   corrupt(directory + 42, bytes.size() - 10);
+   ASSERT_THROW(io::loadNpz<Vector<double>>(path, "x"), std::runtime_error);
+   // Truncated archive
+   {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(bytes.data(), directory - 8);
+   }
+   ASSERT_THROW(io::npzNames(path), std::runtime_error);
+   std::remove(path.c_str());
+}
+
+TEST(IO, Mismatch) {
+   Matrix<float> a(2, 3);
+   fillIOTest(a);
+   std::string path = ioTestPath("mismatch.ten");
+   io::save(path, a);
+   ASSERT_THROW(io::load<Matrix<double>>(path), std::runtime_error);
+   ASSERT_THROW((io::load<Tensor<float, 3>>(path)), std::runtime_error);
+   ASSERT_THROW(
+       (io::load<Matrix<float, DynamicShape<2>, StorageOrder::RowMajor>>(path)),
+       std::runtime_error);
+   ASSERT_THROW((io::load<SMatrix<float, 3, 2>>(path)), std::runtime_error);
+   ASSERT_THROW(io::loadNpy<Matrix<float>>(path), std::runtime_error);
+   ASSERT_THROW(io::load<Matrix<float>>(ioTestPath("missing.ten")),
+                std::runtime_error);
+   std::remove(path.c_str());
+}
+
+TEST(IO, BlockReader) {
+   Matrix<float> a(5, 11);
+   fillIOTest(a);
+   std::string path = ioTestPath("blocks.ten");
+   io::save(path, a);
+   io::BlockReader<Matrix<float>> reader(path, 4);
+   ASSERT_EQ(reader.numBlocks(), 3);
+   ASSERT_EQ(reader.axis(), 1);
+   Vector<float> sums(5);
+   for (size_t i = 0; i < 5; i++) {
+      sums[i] = 0.0f;
+   }
+   size_t cols = 0;
+   while (reader.next()) {
+      auto &block = reader.block();
+      ASSERT_TRUE(block.isView());
+      ASSERT_EQ(block.dim(0), 5);
+      ASSERT_EQ(block.dim(1), reader.index() < 2 ? 4 : 3);
+      for (size_t j = 0; j < block.dim(1); j++) {
+         for (size_t i = 0; i < 5; i++) {
+            ASSERT_EQ(block(i, j), a(i, reader.offset() + j));
+            sums[i] += block(i, j);
+         }
+      }
+      cols += block.dim(1);
+   }
+   ASSERT_EQ(cols, 11);
+   ASSERT_FALSE(reader.next());
+   ASSERT_EQ(sums[1], 10.0f * 11 + 55.0f);
+   std::remove(path.c_str());
+}
+
+TEST(IO, BlockWriter) {
+   using RowMatrix = Matrix<float, DynamicShape<2>, StorageOrder::RowMajor>;
+   RowMatrix a(7, 3);
+   fillIOTest(a);
+   std::string path = ioTestPath("blocks.npy");
+   {
+      io::BlockWriter<RowMatrix> writer(path, a.shape(), 3,
+                                        io::FileFormat::Npy);
+      ASSERT_EQ(writer.axis(), 0);
+      for (size_t first = 0; first < 7; first += 3) {
+         size_t last = std::min<size_t>(first + 3, 7);
+         RowMatrix block(last - first, 3);
+         for (size_t i = first; i < last; i++) {
+            for (size_t j = 0; j < 3; j++) {
+               block(i - first, j) = a(i, j);
+            }
+         }
+         // Expressions are evaluated into the buffers of the writer
+         writer.write(2.0f * block);
+      }
+      ASSERT_THROW(writer.write(a), std::invalid_argument);
+      writer.close();
+   }
+   auto b = io::loadNpy<RowMatrix>(path);
+   ASSERT_TRUE(tests::equal(b, RowMatrix(2.0f * a)));
+   // Missing slices
+   {
+      io::BlockWriter<RowMatrix> writer(path, a.shape(), 4);
+      writer.write(a.slice({{0, 4}, {0, 3}}));
+      ASSERT_THROW(writer.close(), std::runtime_error);
+   }
+   std::remove(path.c_str());
+}
+
+#endif
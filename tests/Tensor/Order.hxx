@@ -0,0 +1,95 @@
+#ifndef TENSEUR_TESTS_TENSOR_ORDER
+#define TENSEUR_TESTS_TENSOR_ORDER
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+template <class M> void fillOrderTest(M &a) {
+   for (size_t i = 0; i < a.dim(0); i++) {
+      for (size_t j = 0; j < a.dim(1); j++) {
+         a(i, j) = float(10 * i + j);
+      }
+   }
+}
+
+using RowMatrix = Matrix<float, DynamicShape<2>, StorageOrder::RowMajor>;
+} // namespace
+
+TEST(Order, StaticStrides) {
+   SMatrix<float, 3, 4, StorageOrder::RowMajor> a;
+   ASSERT_EQ(a.stride(0), 4);
+   ASSERT_EQ(a.stride(1), 1);
+   STensor<float, 2, 3, 4> b;
+   ASSERT_EQ(b.stride(0), 1);
+   ASSERT_EQ(b.stride(2), 6);
+   fillOrderTest(a);
+   // Linear index in row major order
+   ASSERT_EQ(a[5], a(1, 1));
+   ASSERT_EQ(a.data()[2 * 4 + 3], 23.f);
+}
+
+TEST(Order, DynamicStrides) {
+   RowMatrix a({3, 5});
+   ASSERT_EQ(a.stride(0), 5);
+   ASSERT_EQ(a.stride(1), 1);
+   fillOrderTest(a);
+   ASSERT_EQ(a.data()[7], a(1, 2));
+   auto r = a.row(2);
+   ASSERT_TRUE(r.isContiguous());
+   ASSERT_EQ(r[4], a(2, 4));
+}
+
+TEST(Order, MixedElementwise) {
+   size_t m = 70;
+   size_t n = 90;
+   Matrix<float> a({m, n});
+   RowMatrix b({m, n});
+   fillOrderTest(a);
+   fillOrderTest(b);
+   Matrix<float> c = a + b;
+   RowMatrix d = b - (a + c);
+   for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+         ASSERT_EQ(c(i, j), a(i, j) + b(i, j));
+         ASSERT_EQ(d(i, j), b(i, j) - (a(i, j) + c(i, j)));
+      }
+   }
+}
+
+TEST(Order, Gemm) {
+   RowMatrix a({6, 4});
+   RowMatrix b({4, 5});
+   Matrix<float> bc({4, 5});
+   fillOrderTest(a);
+   fillOrderTest(b);
+   fillOrderTest(bc);
+   RowMatrix c = a * b;
+   RowMatrix d = a * bc;
+   for (size_t i = 0; i < 6; i++) {
+      for (size_t j = 0; j < 5; j++) {
+         float s = 0.f;
+         for (size_t l = 0; l < 4; l++) {
+            s += a(i, l) * b(l, j);
+         }
+         ASSERT_EQ(c(i, j), s);
+         ASSERT_EQ(d(i, j), s);
+      }
+   }
+   Vector<float> x({4});
+   for (size_t l = 0; l < 4; l++) {
+      x[l] = float(l + 1);
+   }
+   Vector<float> y = a * x;
+   for (size_t i = 0; i < 6; i++) {
+      float s = 0.f;
+      for (size_t l = 0; l < 4; l++) {
+         s += a(i, l) * x[l];
+      }
+      ASSERT_EQ(y[i], s);
+   }
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef TENSEUR_TESTS_TENSOR_RANDOM
 #define TENSEUR_TESTS_TENSOR_RANDOM
 
+#include <cmath>
+#include <random>
+
 #include <Ten/Tensor>
 #include <Ten/Tests.hxx>
 
@@ -13,4 +16,79 @@ TEST(Random, RandomFloatTensor) {
    ASSERT_TRUE(tests::same_values(x, y));
 }
 
+TEST(Random, Philox) {
+   using namespace ten;
+
+   // Known answer of Philox4x32-10 for a zero key and counter
+   auto block = Philox(0).block(0);
+   ASSERT_EQ(block[0], 0x6627e8d5u);
+   ASSERT_EQ(block[1], 0xe169c58du);
+   ASSERT_EQ(block[2], 0xbc57ac4cu);
+   ASSERT_EQ(block[3], 0x9b00dbd8u);
+   Philox engine(7);
+   engine.discard(6);
+   ASSERT_EQ(engine(), Philox(7).block(1)[2]);
+}
+
+TEST(Random, Reproducible) {
+   using namespace ten;
+
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   setNumThreads(1);
+   auto x = rand<Matrix<double>>({301, 77}, 42);
+   auto u = rand<Vector<float>>(
+       {1001}, std::uniform_real_distribution<float>(-2.f, 3.f), 42);
+   setNumThreads(4);
+   auto y = rand<Matrix<double>>({301, 77}, 42);
+   auto v = rand<Vector<float>>(
+       {1001}, std::uniform_real_distribution<float>(-2.f, 3.f), 42);
+   auto z = rand<Matrix<double>>({301, 77}, 43);
+   for (size_t i = 0; i < x.size(); i++) {
+      ASSERT_EQ(x[i], y[i]);
+   }
+   for (size_t i = 0; i < u.size(); i++) {
+      ASSERT_EQ(u[i], v[i]);
+      ASSERT_TRUE(u[i] >= -2.f && u[i] < 3.f);
+   }
+   ASSERT_NE(x[0], z[0]);
+   // Moments of the standard normal distribution
+   double mean = 0.;
+   double var = 0.;
+   for (size_t i = 0; i < x.size(); i++) {
+      mean += x[i];
+      var += x[i] * x[i];
+   }
+   mean /= x.size();
+   var = var / x.size() - mean * mean;
+   ASSERT_LT(std::abs(mean), 0.02);
+   ASSERT_LT(std::abs(var - 1.), 0.03);
+}
+
+TEST(Random, LazyRand) {
+   using namespace ten;
+
+   tests::ParallelSettings settings;
+   setParallelThreshold(16);
+   Matrix<float> a({45, 31});
+   for (size_t i = 0; i < a.size(); i++) {
+      a[i] = float(i % 13);
+   }
+   auto noise = rand<Matrix<float>>({45, 31}, 5);
+   Matrix<float> b = a + lazyRand<Matrix<float>>({45, 31}, 5);
+   for (size_t i = 0; i < a.size(); i++) {
+      ASSERT_EQ(b[i], a[i] + noise[i]);
+   }
+   // Broadcasted random vector
+   auto row = rand<Vector<float>>({31}, 9);
+   Matrix<float> c = a + lazyRand<Vector<float>>({31}, 9);
+   ASSERT_EQ(c(3, 7), a(3, 7) + row[7]);
+   ASSERT_EQ(c(44, 30), a(44, 30) + row[30]);
+   // Non elementwise functions read the materialized tensor
+   auto r = lazyRand<Matrix<float>>({31, 4}, 5);
+   Matrix<float> d = a * r;
+   Matrix<float> e = a * rand<Matrix<float>>({31, 4}, 5);
+   ASSERT_TRUE(tests::equal(d, e));
+}
+
 #endif
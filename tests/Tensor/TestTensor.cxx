@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
+#include "Allocator.hxx"
 #include "Cast.hxx"
+#include "IO.hxx"
+#include "Order.hxx"
 #include "Traits.hxx"
 #include "Random.hxx"
+#include "View.hxx"
 
 int main(int argc, char **argv) {
 
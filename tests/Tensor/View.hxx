@@ -0,0 +1,260 @@
+#ifndef TENSEUR_TESTS_TENSOR_VIEW
+#define TENSEUR_TESTS_TENSOR_VIEW
+
+#include <stdexcept>
+
+#include <Ten/Tensor>
+#include <Ten/Tests.hxx>
+
+using namespace ten;
+
+namespace {
+Matrix<float> viewTestMatrix(size_t rows, size_t cols) {
+   Matrix<float> a({rows, cols});
+   for (size_t j = 0; j < cols; j++) {
+      for (size_t i = 0; i < rows; i++) {
+         a(i, j) = float(10 * i + j);
+      }
+   }
+   return a;
+}
+} // namespace
+
+TEST(View, Slice) {
+   auto a = viewTestMatrix(6, 8);
+   auto v = a.slice({{1, 5}, {0, 8, 3}});
+   ASSERT_TRUE(v.isView());
+   ASSERT_FALSE(v.isContiguous());
+   ASSERT_EQ(v.data(), a.data() + 1);
+   ASSERT_EQ(v.dim(0), 4);
+   ASSERT_EQ(v.dim(1), 3);
+   for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 3; j++) {
+         ASSERT_EQ(v(i, j), a(i + 1, 3 * j));
+      }
+   }
+   // Linear index in column major order
+   ASSERT_EQ(v[5], a(2, 3));
+
+   // Views share the storage
+   v(0, 1) = -1.f;
+   ASSERT_EQ(a(1, 3), -1.f);
+
+   // Slice of a slice
+   auto w = v.slice({{1, 4, 2}, {}});
+   ASSERT_EQ(w.dim(0), 2);
+   ASSERT_EQ(w.dim(1), 3);
+   ASSERT_EQ(w(1, 2), a(4, 6));
+
+   ASSERT_THROW(a.slice({{0, 2}}), std::out_of_range);
+   ASSERT_THROW(a.slice({{4, 2}, {}}), std::out_of_range);
+}
+
+TEST(View, RowColBlock) {
+   auto a = viewTestMatrix(5, 7);
+   auto r = a.row(2);
+   auto c = a.col(3);
+   auto b = a.block(1, 2, 3, 4);
+   ASSERT_EQ(r.size(), 7);
+   ASSERT_EQ(c.size(), 5);
+   ASSERT_TRUE(c.isContiguous());
+   ASSERT_FALSE(r.isContiguous());
+   for (size_t j = 0; j < 7; j++) {
+      ASSERT_EQ(r[j], a(2, j));
+   }
+   for (size_t i = 0; i < 5; i++) {
+      ASSERT_EQ(c[i], a(i, 3));
+   }
+   for (size_t i = 0; i < 3; i++) {
+      for (size_t j = 0; j < 4; j++) {
+         ASSERT_EQ(b(i, j), a(i + 1, j + 2));
+      }
+   }
+   // A block of full columns is contiguous
+   ASSERT_TRUE(a.block(0, 2, 5, 3).isContiguous());
+   ASSERT_THROW(a.block(3, 0, 3, 1), std::out_of_range);
+}
+
+TEST(View, Elementwise) {
+   auto a = viewTestMatrix(9, 11);
+   auto b = viewTestMatrix(9, 11);
+   auto x = a.block(1, 2, 5, 6);
+   auto y = b.slice({{0, 10, 2}, {5, 11}});
+   Matrix<float> c = x + y / x;
+   ASSERT_FALSE(c.isView());
+   for (size_t i = 0; i < 5; i++) {
+      for (size_t j = 0; j < 6; j++) {
+         ASSERT_FLOAT_EQ(c(i, j), x(i, j) + y(i, j) / x(i, j));
+      }
+   }
+   // Contiguous views with an offset use the linear path
+   auto z = a.block(0, 3, 9, 4);
+   Vector<float> s = a.col(2) - z.col(1);
+   for (size_t i = 0; i < 9; i++) {
+      ASSERT_EQ(s[i], a(i, 2) - a(i, 4));
+   }
+}
+
+TEST(View, Assign) {
+   auto a = viewTestMatrix(4, 6);
+   auto b = viewTestMatrix(4, 6);
+   auto v = a.block(1, 1, 2, 3);
+   v = b.block(0, 0, 2, 3) + b.block(2, 3, 2, 3);
+   for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 6; j++) {
+         float expected = (i >= 1 && i < 3 && j >= 1 && j < 4)
+                              ? b(i - 1, j - 1) + b(i + 1, j + 2)
+                              : float(10 * i + j);
+         ASSERT_EQ(a(i, j), expected);
+      }
+   }
+
+   // Assignment of a tensor copies its elements into the view
+   Matrix<float> c = fill<Matrix<float>>({2, 3}, -1.f);
+   v = c;
+   ASSERT_EQ(a(2, 3), -1.f);
+   ASSERT_EQ(a(0, 0), 0.f);
+}
+
+TEST(View, Owning) {
+   auto a = viewTestMatrix(4, 6);
+   auto b = viewTestMatrix(2, 3);
+   // Tensors initialized or assigned from views own a copy of the elements
+   Matrix<float> t = a.block(1, 1, 2, 3);
+   ASSERT_FALSE(t.isView());
+   ASSERT_NE(t.data(), a.data() + 5);
+   t = b + b;
+   Matrix<float> u = transpose(a);
+   ASSERT_FALSE(u.isView());
+   ASSERT_EQ(u(4, 3), a(3, 4));
+   u = transpose(b);
+   u(0, 0) = 100.f;
+   Vector<float> r({6});
+   r = a.row(2);
+   r[0] = 100.f;
+   for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 6; j++) {
+         ASSERT_EQ(a(i, j), float(10 * i + j));
+      }
+   }
+   ASSERT_EQ(t(1, 2), 2.f * b(1, 2));
+   ASSERT_EQ(u(2, 1), b(1, 2));
+}
+
+TEST(View, Gemm) {
+   auto a = viewTestMatrix(12, 10);
+   auto b = viewTestMatrix(10, 14);
+   auto x = a.block(2, 1, 6, 5);
+   auto y = b.slice({{3, 8}, {0, 14, 2}});
+   Matrix<float> c = x * y;
+   ASSERT_EQ(c.dim(0), 6);
+   ASSERT_EQ(c.dim(1), 7);
+   for (size_t i = 0; i < 6; i++) {
+      for (size_t j = 0; j < 7; j++) {
+         float s = 0.f;
+         for (size_t l = 0; l < 5; l++) {
+            s += x(i, l) * y(l, j);
+         }
+         ASSERT_EQ(c(i, j), s);
+      }
+   }
+   Vector<float> z = x * a.row(3).slice({{0, 5}});
+   for (size_t i = 0; i < 6; i++) {
+      float s = 0.f;
+      for (size_t l = 0; l < 5; l++) {
+         s += x(i, l) * a(3, l);
+      }
+      ASSERT_EQ(z[i], s);
+   }
+}
+
+TEST(View, Reduce) {
+   auto a = viewTestMatrix(7, 5);
+   auto v = a.slice({{0, 7, 3}, {1, 4}});
+   float expected = 0.f;
+   for (size_t i = 0; i < v.dim(0); i++) {
+      for (size_t j = 0; j < v.dim(1); j++) {
+         expected += v(i, j);
+      }
+   }
+   Scalar<float> s = sum(v);
+   ASSERT_EQ(s.value(), expected);
+   Vector<float> m = max<0>(v);
+   for (size_t j = 0; j < v.dim(1); j++) {
+      ASSERT_EQ(m[j], v(2, j));
+   }
+}
+
+TEST(View, Transpose) {
+   auto a = viewTestMatrix(70, 90);
+   auto t = transpose(a).eval();
+   ASSERT_TRUE(t.isView());
+   ASSERT_TRUE(t.isTransposed());
+   ASSERT_EQ(t.data(), a.data());
+   ASSERT_EQ(t.dim(0), 90);
+   ASSERT_EQ(t.dim(1), 70);
+   ASSERT_EQ(t(4, 3), a(3, 4));
+
+   // Elementwise by tiles of runs
+   auto b = viewTestMatrix(90, 70);
+   Matrix<float> c = transpose(a) + b;
+   for (size_t i = 0; i < 90; i++) {
+      for (size_t j = 0; j < 70; j++) {
+         ASSERT_EQ(c(i, j), a(j, i) + b(i, j));
+      }
+   }
+
+   // Transpose of a transpose
+   Matrix<float> u = transpose(transpose(a));
+   ASSERT_FALSE(u.isTransposed());
+   ASSERT_TRUE(u.isContiguous());
+
+   // Static tensors are copied
+   SMatrix<float, 2, 3> s;
+   for (size_t i = 0; i < 6; i++) {
+      s[i] = float(i);
+   }
+   SMatrix<float, 3, 2> st = transpose(s);
+   for (size_t i = 0; i < 2; i++) {
+      for (size_t j = 0; j < 3; j++) {
+         ASSERT_EQ(st(j, i), s(i, j));
+      }
+   }
+}
+
+TEST(View, TransposeGemm) {
+   auto a = viewTestMatrix(8, 6);
+   auto b = viewTestMatrix(8, 5);
+   Matrix<float> c = transpose(a) * b;
+   ASSERT_EQ(c.dim(0), 6);
+   ASSERT_EQ(c.dim(1), 5);
+   for (size_t i = 0; i < 6; i++) {
+      for (size_t j = 0; j < 5; j++) {
+         float s = 0.f;
+         for (size_t l = 0; l < 8; l++) {
+            s += a(l, i) * b(l, j);
+         }
+         ASSERT_EQ(c(i, j), s);
+      }
+   }
+   Matrix<float> d = a * transpose(a);
+   for (size_t i = 0; i < 8; i++) {
+      for (size_t j = 0; j < 8; j++) {
+         float s = 0.f;
+         for (size_t l = 0; l < 6; l++) {
+            s += a(i, l) * a(j, l);
+         }
+         ASSERT_EQ(d(i, j), s);
+      }
+   }
+   Vector<float> z = transpose(a) * a.col(1);
+   for (size_t i = 0; i < 6; i++) {
+      float s = 0.f;
+      for (size_t l = 0; l < 8; l++) {
+         s += a(l, i) * a(l, 1);
+      }
+      ASSERT_EQ(z[i], s);
+   }
+}
+
+#endif